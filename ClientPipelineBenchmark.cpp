@@ -0,0 +1,650 @@
+/***********************************************************************
+ClientPipelineBenchmark - Headless utility to measure the per-frame CPU
+costs of the collaborative network viewer's client pipeline, from
+decoding simulation updates to preparing render-ready node data, on
+synthetic or recorded simulation update streams without requiring a
+display or a running Vrui environment.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <new>
+#include <stdexcept>
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <Threads/TripleBuffer.h>
+#include <Realtime/Time.h>
+#include <Math/Math.h>
+#include <Math/Constants.h>
+#include <Math/Random.h>
+#include <Geometry/Point.h>
+#include <Geometry/Vector.h>
+#include <Geometry/OrthogonalTransformation.h>
+
+#include "ParticleTypes.h"
+#include "NetworkViewerProtocol.h"
+#include "SimulationUpdateAssembler.h"
+#include "RenderingParameters.h"
+#include "SimulationScheduler.h"
+#include "RaySpherePicker.h"
+#include "SessionPlayer.h"
+#include "NodeRenderData.icpp"
+
+/**********************************************************************
+Replacements for the global allocation functions to count the number of
+allocations made by each stage of the client pipeline:
+**********************************************************************/
+
+namespace {
+
+size_t numAllocations=0; // Total number of memory allocations
+size_t numAllocatedBytes=0; // Total number of allocated bytes
+
+void* countedAlloc(size_t size) // Allocates a block of memory and counts the allocation
+	{
+	__sync_fetch_and_add(&numAllocations,size_t(1));
+	__sync_fetch_and_add(&numAllocatedBytes,size);
+	void* result=malloc(size>0?size:1);
+	if(result==0)
+		throw std::bad_alloc();
+	return result;
+	}
+
+}
+
+void* operator new(size_t size)
+	{
+	return countedAlloc(size);
+	}
+
+void* operator new[](size_t size)
+	{
+	return countedAlloc(size);
+	}
+
+void operator delete(void* ptr) throw()
+	{
+	free(ptr);
+	}
+
+void operator delete[](void* ptr) throw()
+	{
+	free(ptr);
+	}
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+typedef Collab::Plugins::NetworkViewerProtocol NetworkViewerProtocol;
+typedef NetworkViewerProtocol::Version Version;
+typedef NetworkViewerProtocol::NVPoint NVPoint;
+typedef std::vector<NVPoint> NVPointList;
+typedef std::vector<Misc::UInt8> MessageBody;
+
+class MessageSource // Class to read encoded messages from memory using the same interface as collaboration messages
+	{
+	/* Elements: */
+	private:
+	const Misc::UInt8* readPtr; // Pointer to the next unread byte
+	const Misc::UInt8* end; // Pointer behind the last byte of the message
+	
+	/* Constructors and destructors: */
+	public:
+	MessageSource(const MessageBody& body)
+		:readPtr(&body.front()),end(&body.front()+body.size())
+		{
+		}
+	
+	/* Methods: */
+	size_t getUnread(void) const // Returns the number of unread bytes
+		{
+		return size_t(end-readPtr);
+		}
+	template <class DataParam>
+	DataParam read(void) // Reads a single value
+		{
+		DataParam result;
+		memcpy(&result,readPtr,sizeof(DataParam));
+		readPtr+=sizeof(DataParam);
+		return result;
+		}
+	template <class DataParam>
+	void read(DataParam* data,size_t numItems) // Reads an array of values
+		{
+		memcpy(data,readPtr,numItems*sizeof(DataParam));
+		readPtr+=numItems*sizeof(DataParam);
+		}
+	};
+
+class MessageSink // Class to encode messages into memory using the same interface as collaboration messages
+	{
+	/* Elements: */
+	private:
+	MessageBody& body; // Message body being written
+	
+	/* Constructors and destructors: */
+	public:
+	MessageSink(MessageBody& sBody)
+		:body(sBody)
+		{
+		body.clear();
+		}
+	
+	/* Methods: */
+	template <class DataParam>
+	void write(const DataParam& data) // Writes a single value
+		{
+		const Misc::UInt8* dPtr=reinterpret_cast<const Misc::UInt8*>(&data);
+		body.insert(body.end(),dPtr,dPtr+sizeof(DataParam));
+		}
+	};
+
+struct SyntheticColor // Structure for node colors
+	{
+	/* Elements: */
+	public:
+	Misc::UInt8 rgba[4];
+	
+	/* Methods: */
+	Misc::UInt8 operator[](int index) const
+		{
+		return rgba[index];
+		}
+	};
+
+class SyntheticNetwork // Class providing the node colors and radii of a network of random sizes in the same way as a visual network
+	{
+	/* Embedded classes: */
+	public:
+	typedef std::vector<SyntheticColor> ColorList;
+	
+	/* Elements: */
+	private:
+	std::vector<Scalar> nodeSizes; // Node sizes
+	ColorList nodeColors; // Node colors
+	unsigned int colorVersion; // Version number of the node color array
+	Index changedColorsBegin,changedColorsEnd; // Half-open range of node colors changed by the most recent color change
+	
+	/* Constructors and destructors: */
+	public:
+	SyntheticNetwork(Index numNodes)
+		:colorVersion(0),changedColorsBegin(0),changedColorsEnd(0)
+		{
+		nodeSizes.reserve(numNodes);
+		nodeColors.reserve(numNodes);
+		for(Index i=0;i<numNodes;++i)
+			{
+			nodeSizes.push_back(Math::randUniformCO(Scalar(0.5),Scalar(2)));
+			SyntheticColor c;
+			for(int j=0;j<3;++j)
+				c.rgba[j]=Misc::UInt8(Math::randUniformCO(0.0,256.0));
+			c.rgba[3]=255U;
+			nodeColors.push_back(c);
+			}
+		}
+	
+	/* Methods: */
+	const ColorList& getNodeColors(void) const
+		{
+		return nodeColors;
+		}
+	unsigned int getColorVersion(void) const
+		{
+		return colorVersion;
+		}
+	Index getChangedColorsBegin(void) const
+		{
+		return changedColorsBegin;
+		}
+	Index getChangedColorsEnd(void) const
+		{
+		return changedColorsEnd;
+		}
+	void calcNodeRadii(Scalar nodeRadius,bool useNodeSize,Scalar nodeSizeExponent,std::vector<Scalar>& nodeRadii) const
+		{
+		nodeRadii.resize(nodeSizes.size());
+		for(size_t i=0;i<nodeSizes.size();++i)
+			nodeRadii[i]=useNodeSize?nodeRadius*Math::pow(nodeSizes[i],nodeSizeExponent):nodeRadius;
+		}
+	void highlightNodes(Index begin,Index end) // Inverts the colors of the given range of nodes, as a selection change would
+		{
+		for(Index i=begin;i<end;++i)
+			for(int j=0;j<3;++j)
+				nodeColors[i].rgba[j]=255U-nodeColors[i].rgba[j];
+		changedColorsBegin=begin;
+		changedColorsEnd=end;
+		++colorVersion;
+		}
+	};
+
+struct StageStats // Structure to accumulate the costs of one stage of the client pipeline
+	{
+	/* Elements: */
+	public:
+	const char* name; // Name of the stage
+	double time; // Total time spent in the stage in seconds
+	size_t numRuns; // Number of times the stage was run
+	size_t numAllocations; // Total number of memory allocations made by the stage
+	size_t numAllocatedBytes; // Total number of bytes allocated by the stage
+	
+	/* Constructors and destructors: */
+	StageStats(const char* sName)
+		:name(sName),time(0.0),numRuns(0),numAllocations(0),numAllocatedBytes(0)
+		{
+		}
+	};
+
+class StageTimer // Class to measure the time and memory allocations of a single run of a stage
+	{
+	/* Elements: */
+	private:
+	Realtime::TimePointMonotonic startTime; // Time at which the stage started
+	size_t startAllocations; // Number of allocations when the stage started
+	size_t startAllocatedBytes; // Number of allocated bytes when the stage started
+	
+	/* Constructors and destructors: */
+	public:
+	StageTimer(void)
+		:startAllocations(numAllocations),startAllocatedBytes(numAllocatedBytes)
+		{
+		}
+	
+	/* Methods: */
+	void stop(StageStats& stats) // Adds the costs of the stage since the timer was created to the given statistics
+		{
+		stats.time+=double(Realtime::TimePointMonotonic()-startTime);
+		++stats.numRuns;
+		stats.numAllocations+=numAllocations-startAllocations;
+		stats.numAllocatedBytes+=numAllocatedBytes-startAllocatedBytes;
+		}
+	};
+
+/****************
+Helper functions:
+****************/
+
+void encodeUpdate(Version networkVersion,const NVPointList& positions,MessageBody& body) // Encodes a simulation update message body as sent by the server
+	{
+	MessageSink sink(body);
+	sink.write(networkVersion);
+	sink.write(Misc::UInt32(positions.size()));
+	for(NVPointList::const_iterator pIt=positions.begin();pIt!=positions.end();++pIt)
+		for(int i=0;i<3;++i)
+			sink.write((*pIt)[i]);
+	}
+
+void encodeChunks(Version networkVersion,Misc::UInt32 sequenceNumber,const NVPointList& positions,std::vector<MessageBody>& chunks) // Encodes the simulation update chunk message bodies of a simulation update as sent by the server
+	{
+	const size_t maxChunkParticles=SimulationUpdateAssembler::maxChunkParticles;
+	size_t numParticles=positions.size();
+	chunks.resize((numParticles+maxChunkParticles-1)/maxChunkParticles);
+	std::vector<MessageBody>::iterator cIt=chunks.begin();
+	for(size_t firstParticle=0;firstParticle<numParticles;firstParticle+=maxChunkParticles,++cIt)
+		{
+		size_t numChunkParticles=Math::min(numParticles-firstParticle,maxChunkParticles);
+		MessageSink sink(*cIt);
+		sink.write(networkVersion);
+		sink.write(sequenceNumber);
+		sink.write(Misc::UInt32(numParticles));
+		sink.write(Misc::UInt32(firstParticle));
+		sink.write(Misc::UInt16(numChunkParticles));
+		for(size_t i=firstParticle;i<firstParticle+numChunkParticles;++i)
+			for(int j=0;j<3;++j)
+				sink.write(positions[i][j]);
+		}
+	}
+
+void decodeUpdate(const MessageBody& body,Version networkVersion,Threads::TripleBuffer<NVPointList>& positions) // Decodes a simulation update message body in the same way as the network viewer client
+	{
+	MessageSource source(body);
+	Version msgNetworkVersion=source.read<Version>();
+	size_t numParticles=source.read<Misc::UInt32>();
+	
+	/* Read all particle positions directly into the triple buffer slot in a single block: */
+	NVPointList& points=positions.startNewValue();
+	points.resize(numParticles);
+	if(numParticles>0)
+		source.read(points.front().getComponents(),numParticles*3);
+	if(msgNetworkVersion==networkVersion)
+		positions.postNewValue();
+	}
+
+void decodeUpdatePerElement(const MessageBody& body,Version networkVersion,Threads::TripleBuffer<NVPointList>& positions) // Decodes a simulation update message body one coordinate at a time, as the network viewer client did before decoding updates in bulk
+	{
+	MessageSource source(body);
+	Version msgNetworkVersion=source.read<Version>();
+	size_t numParticles=source.read<Misc::UInt32>();
+	
+	/* Read all particle positions one coordinate at a time and append them to the triple buffer slot: */
+	NVPointList& points=positions.startNewValue();
+	points.clear();
+	points.reserve(numParticles);
+	for(size_t i=0;i<numParticles;++i)
+		{
+		Point ppos;
+		for(int j=0;j<3;++j)
+			ppos[j]=Scalar(source.read<NetworkViewerProtocol::NVScalar>());
+		points.push_back(ppos);
+		}
+	if(msgNetworkVersion==networkVersion)
+		positions.postNewValue();
+	}
+
+void decodeChunk(const MessageBody& body,Version networkVersion,SimulationUpdateAssembler& assembler,Threads::TripleBuffer<NVPointList>& positions) // Decodes a simulation update chunk message body in the same way as the network viewer client
+	{
+	MessageSource source(body);
+	Version msgNetworkVersion=source.read<Version>();
+	Misc::UInt32 sequenceNumber=source.read<Misc::UInt32>();
+	size_t numParticles=source.read<Misc::UInt32>();
+	size_t firstParticle=source.read<Misc::UInt32>();
+	size_t numChunkParticles=source.read<Misc::UInt16>();
+	
+	int actions=assembler.startChunk(networkVersion,msgNetworkVersion,sequenceNumber,numParticles,firstParticle,numChunkParticles,source.getUnread());
+	bool post=(actions&SimulationUpdateAssembler::PostPrevious)!=0;
+	if(actions&SimulationUpdateAssembler::ReadChunk)
+		{
+		if(numChunkParticles>0)
+			source.read(assembler.getChunkPositions(firstParticle)->getComponents(),numChunkParticles*3);
+		if(assembler.finishChunk(firstParticle,sequenceNumber))
+			post=true;
+		}
+	
+	/* Post a copy of the assembled positions: */
+	if(post)
+		{
+		positions.startNewValue()=assembler.getPositions();
+		positions.postNewValue();
+		assembler.posted();
+		}
+	}
+
+void printStats(const std::vector<StageStats>& stats) // Prints the per-update costs of all stages
+	{
+	printf("  %-24s %12s %12s %12s\n","Stage","ms/run","allocs/run","KB/run");
+	for(std::vector<StageStats>::const_iterator sIt=stats.begin();sIt!=stats.end();++sIt)
+		{
+		double numRuns=double(Math::max(sIt->numRuns,size_t(1)));
+		printf("  %-24s %12.3f %12.1f %12.1f\n",sIt->name,sIt->time*1000.0/numRuns,double(sIt->numAllocations)/numRuns,double(sIt->numAllocatedBytes)/(1024.0*numRuns));
+		}
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	Index minNumNodes=10000;
+	Index maxNumNodes=1000000;
+	const char* sessionFileName=0;
+	unsigned int numUpdates=20;
+	unsigned int numThreads=0;
+	bool serial=false;
+	unsigned int numPicks=16;
+	unsigned int numLabels=1000;
+	unsigned int maxVisibleLabels=1024;
+	Index numHighlightedNodes=100;
+	for(int argi=1;argi<argc;++argi)
+		{
+		if(argv[argi][0]=='-')
+			{
+			if(strcasecmp(argv[argi]+1,"nodes")==0&&argi+2<argc)
+				{
+				minNumNodes=Index(atoi(argv[++argi]));
+				maxNumNodes=Index(atoi(argv[++argi]));
+				}
+			else if(strcasecmp(argv[argi]+1,"session")==0&&argi+1<argc)
+				sessionFileName=argv[++argi];
+			else if(strcasecmp(argv[argi]+1,"updates")==0&&argi+1<argc)
+				numUpdates=(unsigned int)(atoi(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"threads")==0&&argi+1<argc)
+				numThreads=(unsigned int)(atoi(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"serial")==0)
+				serial=true;
+			else if(strcasecmp(argv[argi]+1,"picks")==0&&argi+1<argc)
+				numPicks=(unsigned int)(atoi(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"labels")==0&&argi+2<argc)
+				{
+				numLabels=(unsigned int)(atoi(argv[++argi]));
+				maxVisibleLabels=(unsigned int)(atoi(argv[++argi]));
+				}
+			else if(strcasecmp(argv[argi]+1,"highlight")==0&&argi+1<argc)
+				numHighlightedNodes=Index(atoi(argv[++argi]));
+			else
+				fprintf(stderr,"ClientPipelineBenchmark: Ignoring command line option %s\n",argv[argi]);
+			}
+		else
+			fprintf(stderr,"ClientPipelineBenchmark: Ignoring command line argument %s\n",argv[argi]);
+		}
+	if(minNumNodes==0||maxNumNodes<minNumNodes||numUpdates==0)
+		{
+		fprintf(stderr,"Usage: %s [-nodes <minimum number of nodes> <maximum number of nodes>] [-session <session recording file name>] [-updates <number of simulation updates>] [-threads <number of threads>] [-serial] [-picks <number of picks per update>] [-labels <number of labels> <maximum number of visible labels>] [-highlight <number of nodes changing color>]\n",argv[0]);
+		return 1;
+		}
+	
+	try
+		{
+		/* Open a recorded session if requested, which determines the number of nodes: */
+		SessionPlayer* player=0;
+		if(sessionFileName!=0)
+			{
+			player=new SessionPlayer(sessionFileName);
+			minNumNodes=maxNumNodes=player->getNumNodes();
+			printf("Replaying recorded session of network %s with %u nodes\n",player->getNetworkName().c_str(),(unsigned int)(player->getNumNodes()));
+			}
+		
+		/* Create the thread pool to prepare node vertices: */
+		SimulationScheduler* scheduler=serial?0:new SimulationScheduler(numThreads);
+		printf("Preparing node data with %u threads\n",scheduler!=0?scheduler->getNumThreads():1U);
+		
+		/* Run the benchmark for network sizes increasing by factors of ten: */
+		for(Index numNodes=minNumNodes;numNodes<=maxNumNodes;numNodes=numNodes<=maxNumNodes/10?numNodes*10:maxNumNodes+1)
+			{
+			/* Create a network of random node sizes and colors, and random node start positions and velocities: */
+			SyntheticNetwork network(numNodes);
+			Scalar domainSize=Math::pow(Scalar(numNodes),Scalar(1.0/3.0));
+			NVPointList basePositions;
+			std::vector<Geometry::Vector<NetworkViewerProtocol::NVScalar,3> > velocities;
+			if(player==0)
+				{
+				basePositions.reserve(numNodes);
+				velocities.reserve(numNodes);
+				for(Index i=0;i<numNodes;++i)
+					{
+					NVPoint p;
+					Geometry::Vector<NetworkViewerProtocol::NVScalar,3> v;
+					for(int j=0;j<3;++j)
+						{
+						p[j]=NetworkViewerProtocol::NVScalar(Math::randUniformCO(-domainSize*Scalar(0.5),domainSize*Scalar(0.5)));
+						v[j]=NetworkViewerProtocol::NVScalar(Math::randUniformCO(Scalar(-0.01),Scalar(0.01)));
+						}
+					basePositions.push_back(p);
+					velocities.push_back(v);
+					}
+				}
+			else
+				player->seek(0.0);
+			
+			/* Select random nodes to label: */
+			std::vector<unsigned int> labeledNodes;
+			for(unsigned int i=0;i<numLabels;++i)
+				labeledNodes.push_back((unsigned int)(Math::randUniformCO(0.0,double(numNodes))));
+			
+			/* Create the client pipeline's state: */
+			const Version networkVersion=1;
+			Threads::TripleBuffer<NVPointList> positions;
+			SimulationUpdateAssembler assembler;
+			Threads::TripleBuffer<NVPointList> datagramPositions;
+			RenderingParameters renderingParameters;
+			NodeRenderData renderData(scheduler);
+			Geometry::OrthogonalTransformation<double,3> navigation=Geometry::OrthogonalTransformation<double,3>::identity;
+			Geometry::Point<double,3> headPos(0.0,0.0,double(domainSize));
+			std::vector<NodeRenderData::NodeDistance> shownLabels;
+			
+			std::vector<StageStats> stats;
+			stats.push_back(StageStats("Decode update"));
+			stats.push_back(StageStats("Decode update per element"));
+			stats.push_back(StageStats("Decode update chunks"));
+			stats.push_back(StageStats("Calculate node radii"));
+			stats.push_back(StageStats("Build vertex stream"));
+			stats.push_back(StageStats("Update node hierarchy"));
+			stats.push_back(StageStats("Pick nodes"));
+			stats.push_back(StageStats("Select labels"));
+			stats.push_back(StageStats("Update node colors"));
+			
+			/* Calculate the node radii once, as the client does after receiving a network: */
+			{
+			StageTimer timer;
+			renderData.updateNodeRadii(&network,renderingParameters);
+			timer.stop(stats[3]);
+			}
+			
+			/* Replay the simulation update stream: */
+			MessageBody update;
+			std::vector<MessageBody> chunks;
+			NVPointList frame;
+			double time=0.0;
+			unsigned int positionVersion=0;
+			unsigned int numPicked=0;
+			for(unsigned int updateIndex=0;updateIndex<numUpdates;++updateIndex)
+				{
+				/* Create the next simulation update's node positions: */
+				if(player!=0)
+					{
+					bool newFrame=false;
+					while(!newFrame&&time<=player->getDuration())
+						{
+						newFrame=player->advance(time);
+						time+=0.001;
+						}
+					if(!newFrame)
+						break;
+					frame=player->getPositions();
+					}
+				else
+					{
+					frame.resize(numNodes);
+					NetworkViewerProtocol::NVScalar t=NetworkViewerProtocol::NVScalar(updateIndex);
+					for(Index i=0;i<numNodes;++i)
+						frame[i]=basePositions[i]+velocities[i]*t;
+					}
+				
+				/* Encode the simulation update as the server would: */
+				encodeUpdate(networkVersion,frame,update);
+				encodeChunks(networkVersion,updateIndex+1,frame,chunks);
+				
+				/* Decode the simulation update as received over TCP: */
+				{
+				StageTimer timer;
+				decodeUpdate(update,networkVersion,positions);
+				timer.stop(stats[0]);
+				}
+				
+				/* Decode the simulation update as received over TCP one coordinate at a time, for comparison: */
+				{
+				StageTimer timer;
+				decodeUpdatePerElement(update,networkVersion,referencePositions);
+				timer.stop(stats[1]);
+				}
+				
+				/* Decode the simulation update as received in datagrams: */
+				{
+				StageTimer timer;
+				for(std::vector<MessageBody>::iterator cIt=chunks.begin();cIt!=chunks.end();++cIt)
+					decodeChunk(*cIt,networkVersion,assembler,datagramPositions);
+				timer.stop(stats[2]);
+				}
+				
+				/* Lock the new positions as the client does at the beginning of a frame: */
+				positions.lockNewValue();
+				const NVPointList& points=positions.getLockedValue();
+				++positionVersion;
+				
+				/* Prepare the node vertices: */
+				{
+				StageTimer timer;
+				renderData.updateNodeVertices(&network,points,positionVersion,renderingParameters);
+				timer.stop(stats[4]);
+				}
+				
+				/* Update the node hierarchy: */
+				{
+				StageTimer timer;
+				renderData.updateNodeBVH(points,positionVersion,true);
+				timer.stop(stats[5]);
+				}
+				
+				/* Pick nodes with rays from random positions at random nodes: */
+				{
+				std::vector<RaySpherePicker::Ray> rays;
+				for(unsigned int i=0;i<numPicks;++i)
+					{
+					Point origin(Math::randUniformCO(-domainSize,domainSize),Math::randUniformCO(-domainSize,domainSize),domainSize*Scalar(2));
+					Point target(points[(unsigned int)(Math::randUniformCO(0.0,double(numNodes)))]);
+					rays.push_back(RaySpherePicker::Ray(origin,target-origin));
+					}
+				StageTimer timer;
+				const SphereBVH& nodeBVH=renderData.getNodeBVH();
+				for(std::vector<RaySpherePicker::Ray>::iterator rIt=rays.begin();rIt!=rays.end();++rIt)
+					{
+					RaySpherePicker picker(*rIt,Scalar(0.999));
+					nodeBVH.processSpheres(points,renderData.getNodeRadii(),picker);
+					if(picker.havePickedSphere())
+						++numPicked;
+					}
+				timer.stop(stats[6]);
+				}
+				
+				/* Select the labels closest to the viewer: */
+				{
+				StageTimer timer;
+				NodeRenderData::selectClosestNodes(points,labeledNodes,navigation,headPos,Math::Constants<double>::max,maxVisibleLabels,shownLabels);
+				timer.stop(stats[7]);
+				}
+				
+				/* Change the colors of a range of nodes as a selection change would, and update the node vertices: */
+				{
+				Index begin=Index(Math::randUniformCO(0.0,double(numNodes-Math::min(numHighlightedNodes,numNodes)+1)));
+				network.highlightNodes(begin,begin+Math::min(numHighlightedNodes,numNodes));
+				StageTimer timer;
+				renderData.updateNodeVertices(&network,points,positionVersion,renderingParameters);
+				timer.stop(stats[8]);
+				}
+				}
+			
+			/* Print the results: */
+			printf("%u nodes, %u updates, %u of %u picks hit, %u labels shown:\n",(unsigned int)(numNodes),(unsigned int)(positionVersion),numPicked,positionVersion*numPicks,(unsigned int)(shownLabels.size()));
+			printStats(stats);
+			}
+		
+		delete scheduler;
+		delete player;
+		}
+	catch(const std::runtime_error& err)
+		{
+		fprintf(stderr,"ClientPipelineBenchmark: Terminating due to exception %s\n",err.what());
+		return 1;
+		}
+	
+	return 0;
+	}
@@ -22,8 +22,12 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include "CollaborativeNetworkViewer.h"
 
+#include <strings.h>
+#include <stdlib.h>
+#include <stdexcept>
 #include <Misc/FunctionCalls.h>
 #include <Misc/MessageLogger.h>
+#include <Math/Constants.h>
 #include <GL/gl.h>
 #include <GL/GLMaterialTemplates.h>
 #include <GL/GLContextData.h>
@@ -40,12 +44,20 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <SceneGraph/ONTransformNode.h>
 #include <SceneGraph/OGTransformNode.h>
 #include <SceneGraph/ShapeNode.h>
+#include <Vrui/Viewer.h>
 #include <Vrui/SceneGraphManager.h>
 
-#include "Network.h"
+#include "VisualNetwork.h"
+#include "SphereBVH.icpp"
+#include "SphereCenterSnapper.h"
+#include "SimulationScheduler.h"
+#include "Tracer.h"
+#include "NodeRenderData.icpp"
+#include "VisibilityCuller.icpp"
 #include "CreateNodeLabel.h"
 #include "NetworkViewerClientTool.h"
 #include "NetworkViewerClientSelectTool.h"
+#include "NetworkViewerClientRegionSelectTool.h"
 #include "NetworkViewerClientDeselectTool.h"
 #include "NetworkViewerClientToggleSelectTool.h"
 #include "NetworkViewerClientShowLabelTool.h"
@@ -57,7 +69,8 @@ Methods of class CollaborativeNetworkViewer::DataItem:
 
 CollaborativeNetworkViewer::DataItem::DataItem(void)
 	:vertexBuffer(0),indexBuffer(0),
-	 networkVersion(0),vertexVersion(0)
+	 networkVersion(0),vertexVersion(0),
+	 linksCulled(false)
 	{
 	/* Initialize required OpenGL extensions: */
 	GLARBVertexBufferObject::initExtension();
@@ -74,6 +87,69 @@ CollaborativeNetworkViewer::DataItem::~DataItem(void)
 	glDeleteBuffersARB(1,&indexBuffer);
 	}
 
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+VisibilityCuller::View getCurrentView(void) // Returns the view defined by the current OpenGL projection and modelview matrices and viewport
+	{
+	/* Query the current matrices, which are stored in column-major order, and the viewport: */
+	GLdouble projection[16],modelview[16];
+	glGetDoublev(GL_PROJECTION_MATRIX,projection);
+	glGetDoublev(GL_MODELVIEW_MATRIX,modelview);
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT,viewport);
+	
+	/* Combine the matrices into a row-major projection matrix: */
+	double pmv[4][4];
+	for(int i=0;i<4;++i)
+		for(int j=0;j<4;++j)
+			{
+			pmv[i][j]=0.0;
+			for(int k=0;k<4;++k)
+				pmv[i][j]+=projection[k*4+i]*modelview[j*4+k];
+			}
+	
+	return VisibilityCuller::View(pmv,(unsigned int)(viewport[2]),(unsigned int)(viewport[3]));
+	}
+
+}
+
+/***************************************************************
+Methods of class CollaborativeNetworkViewer::CreateNodeLabelJob:
+***************************************************************/
+
+CollaborativeNetworkViewer::CreateNodeLabelJob::CreateNodeLabelJob(CollaborativeNetworkViewer* sApplication,unsigned int sNodeIndex,unsigned int sSerialNumber,JsonMapPointer sNodeMap,unsigned int sNumLinks,SceneGraph::FancyFontStyleNode& sFontStyle)
+	:application(sApplication),nodeIndex(sNodeIndex),serialNumber(sSerialNumber),
+	 nodeMap(sNodeMap),numLinks(sNumLinks),fontStyle(&sFontStyle)
+	{
+	}
+
+void CollaborativeNetworkViewer::CreateNodeLabelJob::operator()(int) const
+	{
+	/* Can't really do anything; this is an API problem that should be fixed: */
+	// ...
+	}
+
+void CollaborativeNetworkViewer::CreateNodeLabelJob::operator()(int)
+	{
+	try
+		{
+		/* Create the label's scene graph: */
+		label=createNodeLabel(nodeMap->getMap(),numLinks,*fontStyle);
+		}
+	catch(const std::runtime_error& err)
+		{
+		/* Show an error message: */
+		Misc::formattedUserError("CollaborativeNetworkViewer::CreateNodeLabelJob: Unable to create label for node %u due to exception %s",nodeIndex,err.what());
+		}
+	
+	/* Hand the job back to the application: */
+	application->labelCreated(this);
+	}
+
 /*******************************************
 Methods of class CollaborativeNetworkViewer:
 *******************************************/
@@ -87,12 +163,30 @@ void CollaborativeNetworkViewer::shutdownClient(void)
 	nvClient=0;
 	}
 
+void CollaborativeNetworkViewer::updateNodeRadii(void)
+	{
+	/* Calculate the radii of all nodes of the visualized network once: */
+	renderData.updateNodeRadii(nvClient!=0?nvClient->network:0,renderingParameters);
+	}
+
+const SphereBVH& CollaborativeNetworkViewer::getNodeBVH(const NVPointList& points)
+	{
+	/* Refit or rebuild the hierarchy if the positions belong to the visualized network: */
+	return renderData.updateNodeBVH(points,positionVersion,nvClient!=0&&networkVersion==networkPositionVersion);
+	}
+
+void CollaborativeNetworkViewer::updateNodeVertices(const NVPointList& points)
+	{
+	/* Prepare vertices if the positions belong to the visualized network: */
+	renderData.updateNodeVertices(nvClient!=0&&networkVersion==networkPositionVersion?nvClient->network:0,points,positionVersion,renderingParameters);
+	}
+
 void CollaborativeNetworkViewer::objectSnapCallback(Vrui::ObjectSnapperToolFactory::SnapRequest& snapRequest)
 	{
-	/* Snap against all particles: */
+	/* Snap against all particles whose hierarchy nodes are close enough to the snap request: */
 	const NVPointList& ps=positions.getLockedValue();
-	for(NVPointList::const_iterator pIt=ps.begin();pIt!=ps.end();++pIt)
-		snapRequest.snapPoint(Vrui::Point(*pIt));
+	SphereCenterSnapper snapper(snapRequest);
+	getNodeBVH(ps).processSpheres(ps,renderData.getNodeRadii(),snapper);
 	}
 
 void CollaborativeNetworkViewer::loadNetworkFileCallback(GLMotif::FileSelectionDialog::OKCallbackData* cbData)
@@ -166,10 +260,13 @@ GLMotif::PopupMenu* CollaborativeNetworkViewer::createMainMenu(void)
 	return mainMenu;
 	}
 
-void CollaborativeNetworkViewer::updateNetwork(Network* newNetwork)
+void CollaborativeNetworkViewer::updateNetwork(VisualNetwork* newNetwork)
 	{
 	/* Mark cached network state as outdated : */
 	++networkVersion;
+	
+	/* Calculate the new network's node radii: */
+	updateNodeRadii();
 	}
 
 void CollaborativeNetworkViewer::updateSimulationParameters(const SimulationParameters& newSimulationParameters)
@@ -185,8 +282,9 @@ void CollaborativeNetworkViewer::clearNodeLabels(void)
 	/* Remove all current node labels: */
 	for(NodeLabelMap::Iterator nlIt=nodeLabels.begin();!nlIt.isFinished();++nlIt)
 		{
-		/* Remove the node label scene graph from Vrui's scene graph: */
-		Vrui::getSceneGraphManager()->removeNavigationalNode(*nlIt->getDest());
+		/* Remove the node label scene graph from Vrui's scene graph if it is shown: */
+		if(nlIt->getDest().visible)
+			Vrui::getSceneGraphManager()->removeNavigationalNode(*nlIt->getDest().root);
 		}
 	
 	/* Clear the node label set: */
@@ -198,18 +296,24 @@ void CollaborativeNetworkViewer::showNodeLabel(unsigned int nodeIndex)
 	/* Check if the node is not yet labeled: */
 	if(!nodeLabels.isEntry(nodeIndex))
 		{
-		/* Access the given node's properties: */
-		const JsonMap::Map& nodeProperties=nvClient->getNetwork().getNodeProperties(nodeIndex);
+		/* Add a placeholder for the node's label to the label set: */
+		NodeLabelState nls;
+		nls.serialNumber=nextLabelSerialNumber++;
+		nls.created=false;
+		nls.visible=false;
+		nls.show=false;
+		nodeLabels.setEntry(NodeLabelMap::Entry(nodeIndex,nls));
 		
 		/* Retrieve the node's number of outgoing links: */
 		size_t numLinks=nvClient->getNetwork().getNodes()[nodeIndex].getLinkedNodes().size();
 		
-		/* Create a label for the node's properties: */
-		SceneGraph::OGTransformNodePointer labelRoot=createNodeLabel(nodeProperties,numLinks,*labelFontStyle);
-		
-		/* Show the node label and add it to the label set: */
-		Vrui::getSceneGraphManager()->addNavigationalNode(*labelRoot);
-		nodeLabels.setEntry(NodeLabelMap::Entry(nodeIndex,labelRoot));
+		/* Start a background job to create a label for the node's properties: */
+		CreateNodeLabelJob* job=new CreateNodeLabelJob(this,nodeIndex,nls.serialNumber,nvClient->getNetwork().getNodePropertyMap(nodeIndex),(unsigned int)(numLinks),*labelFontStyle);
+		{
+		Threads::MutexCond::Lock labelJobsLock(labelJobsCond);
+		++numPendingLabelJobs;
+		}
+		Threads::WorkerPool::submitJob(*job);
 		}
 	}
 
@@ -219,16 +323,110 @@ void CollaborativeNetworkViewer::hideNodeLabel(unsigned int nodeIndex)
 	NodeLabelMap::Iterator nlIt=nodeLabels.findEntry(nodeIndex);
 	if(!nlIt.isFinished())
 		{
-		/* Hide and delete the node's label: */
-		Vrui::getSceneGraphManager()->removeNavigationalNode(*nlIt->getDest());
+		/* Hide and delete the node's label; a label that is still being created will be discarded: */
+		if(nlIt->getDest().visible)
+			Vrui::getSceneGraphManager()->removeNavigationalNode(*nlIt->getDest().root);
 		nodeLabels.removeEntry(nlIt);
 		}
 	}
 
+void CollaborativeNetworkViewer::labelCreated(CollaborativeNetworkViewer::CreateNodeLabelJob* job)
+	{
+	{
+	/* Queue the job for the main thread: */
+	Threads::MutexCond::Lock labelJobsLock(labelJobsCond);
+	job->ref();
+	createdLabelJobs.push_back(job);
+	
+	/* Signal job completion: */
+	--numPendingLabelJobs;
+	labelJobsCond.broadcast();
+	}
+	
+	/* Wake up the main thread: */
+	Vrui::requestUpdate();
+	}
+
+void CollaborativeNetworkViewer::updateNodeLabels(const CollaborativeNetworkViewer::NVPointList& points)
+	{
+	/* Grab the list of completed label creation jobs: */
+	std::vector<CreateNodeLabelJob*> jobs;
+	{
+	Threads::MutexCond::Lock labelJobsLock(labelJobsCond);
+	jobs.swap(createdLabelJobs);
+	}
+	
+	/* Add the created labels to the label set if they are still requested: */
+	for(std::vector<CreateNodeLabelJob*>::iterator jIt=jobs.begin();jIt!=jobs.end();++jIt)
+		{
+		NodeLabelMap::Iterator nlIt=nodeLabels.findEntry((*jIt)->nodeIndex);
+		if(!nlIt.isFinished()&&nlIt->getDest().serialNumber==(*jIt)->serialNumber&&(*jIt)->label.root!=0)
+			{
+			NodeLabelState& nls=nlIt->getDest();
+			static_cast<NodeLabel&>(nls)=(*jIt)->label;
+			nls.created=true;
+			}
+		
+		/* Release the job: */
+		(*jIt)->unref();
+		}
+	
+	/* Bail out if the network and node positions are not in synch: */
+	if(nvClient==0||networkVersion!=networkPositionVersion)
+		return;
+	
+	/* Collect the nodes of all created labels: */
+	std::vector<unsigned int> labeledNodes;
+	for(NodeLabelMap::Iterator nlIt=nodeLabels.begin();!nlIt.isFinished();++nlIt)
+		{
+		nlIt->getDest().show=false;
+		if(nlIt->getDest().created)
+			labeledNodes.push_back(nlIt->getSource());
+		}
+	
+	/* Show the labels closest to the main viewer in physical space, up to the maximum distance and number of labels: */
+	std::vector<NodeRenderData::NodeDistance> candidates;
+	NodeRenderData::selectClosestNodes(points,labeledNodes,Vrui::getNavigationTransformation(),Vrui::getMainViewer()->getHeadPosition(),double(maxLabelDistance),maxVisibleLabels,candidates);
+	
+	/* Get a scale factor to scale the labels back to their physical-space sizes: */
+	SceneGraph::OGTransformNode::OGTransform::Scalar scaling(Vrui::getInverseNavigationTransformation().getScaling());
+	
+	/* Update the positions of all shown node labels: */
+	for(std::vector<NodeRenderData::NodeDistance>::iterator cIt=candidates.begin();cIt!=candidates.end();++cIt)
+		{
+		NodeLabelState& nls=nodeLabels.getEntry(cIt->second).getDest();
+		nls.show=true;
+		
+		/* Update the label root node's transformation: */
+		SceneGraph::OGTransformNode::OGTransform::Vector translation(points[cIt->second]-NVPoint::origin);
+		SceneGraph::OGTransformNode::OGTransform::Rotation rotation;
+		nls.root->setTransform(SceneGraph::OGTransformNode::OGTransform(translation,rotation,scaling));
+		
+		/* Update the label's label transform to place the cached point of the label bubble onto the node's sphere: */
+		SceneGraph::Point bubblePoint=nls.bubblePoint;
+		bubblePoint[1]-=getNodeRadius(cIt->second)/scaling;
+		nls.labelTransform->setTransform(SceneGraph::ONTransformNode::ONTransform::translateToOriginFrom(bubblePoint));
+		}
+	
+	/* Add newly shown labels to and remove newly hidden labels from Vrui's scene graph: */
+	for(NodeLabelMap::Iterator nlIt=nodeLabels.begin();!nlIt.isFinished();++nlIt)
+		{
+		NodeLabelState& nls=nlIt->getDest();
+		if(nls.show&&!nls.visible)
+			Vrui::getSceneGraphManager()->addNavigationalNode(*nls.root);
+		else if(!nls.show&&nls.visible)
+			Vrui::getSceneGraphManager()->removeNavigationalNode(*nls.root);
+		nls.visible=nls.show;
+		}
+	}
+
 void CollaborativeNetworkViewer::updateRenderingParameters(const RenderingParameters& newRenderingParameters)
 	{
 	renderingParameters=newRenderingParameters;
 	
+	/* Recalculate node radii based on the new rendering settings: */
+	updateNodeRadii();
+	
 	/* Update the UI: */
 	renderingDialog->updateVariables();
 	}
@@ -434,20 +632,91 @@ CollaborativeNetworkViewer::CollaborativeNetworkViewer(int& argc,char**& argv)
 	 nvClient(0),
 	 loadNetworkFileHelper(Vrui::getWidgetManager(),"NetworkFile.json",".json"),
 	 mainMenu(0),simulationParametersDialog(0),renderingDialog(0),
-	 startupNetworkFileName(0),networkVersion(1),networkPositionVersion(0),positionVersion(0),
-	 nodeLabels(5)
+	 startupNetworkFileName(0),traceFileName(0),networkVersion(1),networkPositionVersion(0),positionVersion(0),
+	 nodeLabels(5),nextLabelSerialNumber(0),numPendingLabelJobs(0),
+	 maxVisibleLabels(1024),maxLabelDistance(Math::Constants<Scalar>::max),
+	 cullNodes(true),
+	 renderingScheduler(new SimulationScheduler(0)),renderData(renderingScheduler),culler(renderingScheduler)
 	{
 	/* Parse the command line: */
+	const char* sessionName="";
+	bool datagramUpdates=false;
+	bool traceDrags=false;
+	bool compressNetworks=false;
 	for(int argi=1;argi<argc;++argi)
 		{
-		if(startupNetworkFileName==0)
+		if(argv[argi][0]=='-')
+			{
+			if(strcasecmp(argv[argi]+1,"session")==0)
+				{
+				if(argi+1<argc)
+					sessionName=argv[++argi];
+				else
+					Misc::userWarning("CollaborativeNetworkViewer: Ignoring dangling -session option");
+				}
+			else if(strcasecmp(argv[argi]+1,"datagramUpdates")==0)
+				datagramUpdates=true;
+			else if(strcasecmp(argv[argi]+1,"traceDrags")==0)
+				traceDrags=true;
+			else if(strcasecmp(argv[argi]+1,"compressNetworks")==0)
+				compressNetworks=true;
+			else if(strcasecmp(argv[argi]+1,"maxLabels")==0)
+				{
+				if(argi+1<argc)
+					maxVisibleLabels=(unsigned int)(atoi(argv[++argi]));
+				else
+					Misc::userWarning("CollaborativeNetworkViewer: Ignoring dangling -maxLabels option");
+				}
+			else if(strcasecmp(argv[argi]+1,"labelDistance")==0)
+				{
+				if(argi+1<argc)
+					maxLabelDistance=Scalar(atof(argv[++argi]));
+				else
+					Misc::userWarning("CollaborativeNetworkViewer: Ignoring dangling -labelDistance option");
+				}
+			else if(strcasecmp(argv[argi]+1,"noCulling")==0)
+				cullNodes=false;
+			else if(strcasecmp(argv[argi]+1,"lodSizes")==0)
+				{
+				if(argi+2<argc)
+					{
+					Scalar sphereSize=Scalar(atof(argv[argi+1]));
+					Scalar impostorSize=Scalar(atof(argv[argi+2]));
+					culler.setLodSizes(sphereSize,impostorSize);
+					argi+=2;
+					}
+				else
+					Misc::userWarning("CollaborativeNetworkViewer: Ignoring dangling -lodSizes option");
+				}
+			else if(strcasecmp(argv[argi]+1,"trace")==0)
+				{
+				if(argi+1<argc)
+					traceFileName=argv[++argi];
+				else
+					Misc::userWarning("CollaborativeNetworkViewer: Ignoring dangling -trace option");
+				}
+			else
+				Misc::formattedUserWarning("CollaborativeNetworkViewer: Ignoring command line option %s",argv[argi]);
+			}
+		else if(startupNetworkFileName==0)
 			startupNetworkFileName=argv[argi];
 		else
 			Misc::formattedUserWarning("CollaborativeNetworkViewer: Ignoring command line argument %s",argv[argi]);
 		}
 	
+	/* Start recording spans of the client's work if requested: */
+	if(traceFileName!=0)
+		{
+		Tracer::setThreadName("Vrui main");
+		Tracer::start();
+		}
+	
 	/* Register the network viewer client: */
 	nvClient=new Collab::Plugins::NetworkViewerClient(this,&client);
+	nvClient->setSessionName(sessionName);
+	nvClient->setDatagramUpdates(datagramUpdates);
+	nvClient->setTraceDrags(traceDrags);
+	nvClient->setCompressNetworks(compressNetworks);
 	client.addPluginProtocol(nvClient);
 	
 	/* Start the collaboration back end: */
@@ -465,6 +734,7 @@ CollaborativeNetworkViewer::CollaborativeNetworkViewer(int& argc,char**& argv)
 	/* Create the custom tool classes: */
 	Tool::initClass();
 	SelectTool::initClass();
+	RegionSelectTool::initClass();
 	DeselectTool::initClass();
 	ToggleSelectTool::initClass();
 	ShowLabelTool::initClass();
@@ -497,38 +767,62 @@ CollaborativeNetworkViewer::~CollaborativeNetworkViewer(void)
 	delete mainMenu;
 	delete simulationParametersDialog;
 	delete renderingDialog;
+	delete renderingScheduler;
+	
+	/* Wait for all outstanding label creation jobs and release them: */
+	{
+	Threads::MutexCond::Lock labelJobsLock(labelJobsCond);
+	while(numPendingLabelJobs>0)
+		labelJobsCond.wait(labelJobsLock);
+	}
+	for(std::vector<CreateNodeLabelJob*>::iterator jIt=createdLabelJobs.begin();jIt!=createdLabelJobs.end();++jIt)
+		(*jIt)->unref();
+	
+	/* Write the spans recorded since start-up: */
+	if(traceFileName!=0)
+		{
+		Tracer::stop();
+		try
+			{
+			size_t numDropped=Tracer::write(traceFileName);
+			if(numDropped>0)
+				Misc::formattedUserWarning("CollaborativeNetworkViewer: Dropped %u spans from trace file %s",(unsigned int)(numDropped),traceFileName);
+			}
+		catch(const std::runtime_error& err)
+			{
+			Misc::formattedUserError("CollaborativeNetworkViewer: Unable to write trace file %s due to exception %s",traceFileName,err.what());
+			}
+		}
 	}
 
 void CollaborativeNetworkViewer::frame(void)
 	{
+	/* Complete drag latency traces whose results were displayed in the previous frame: */
+	if(nvClient!=0)
+		nvClient->finishDragTraces();
+	
 	/* Call the base class method: */
 	CollaborativeVruiApplication::frame();
 	
 	/* Lock the most recent network node positions: */
 	const NVPointList& positions=lockAndGetPositions();
 	
-	if(nvClient!=0&&networkVersion==networkPositionVersion)
+	/* Prepare the node vertices for all OpenGL contexts once: */
+	{
+	Tracer::Span span("Update node vertices");
+	updateNodeVertices(positions);
+	}
+	
+	/* Update the node hierarchy to cull against the new positions: */
+	if(cullNodes)
 		{
-		/* Get a scale factor to scale the labels back to their physical-space sizes: */
-		SceneGraph::OGTransformNode::OGTransform::Scalar scaling(Vrui::getInverseNavigationTransformation().getScaling());
-		
-		/* Update the positions of all active node labels: */
-		for(NodeLabelMap::Iterator nlIt=nodeLabels.begin();!nlIt.isFinished();++nlIt)
-			{
-			/* Update the label root node's transformation: */
-			SceneGraph::OGTransformNode::OGTransform::Vector translation(positions[nlIt->getSource()]-NVPoint::origin);
-			SceneGraph::OGTransformNode::OGTransform::Rotation rotation;
-			nlIt->getDest()->setTransform(SceneGraph::OGTransformNode::OGTransform(translation,rotation,scaling));
-			
-			/* Update the label's label transform to place the point of the label bubble onto the node's sphere: */
-			SceneGraph::ONTransformNodePointer labelTransform(SceneGraph::GroupNodePointer(nlIt->getDest()->getChildren()[0])->getChildren()[0]);
-			SceneGraph::ShapeNodePointer bubbleShape=(labelTransform->getChildren()[1]);
-			SceneGraph::Box bbox=bubbleShape->calcBoundingBox();
-			SceneGraph::Point bubblePoint(Math::mid(bbox.min[0],bbox.max[0]),bbox.min[1],Math::mid(bbox.min[2],bbox.max[2]));
-			bubblePoint[1]-=getNodeRadius(nlIt->getSource())/scaling;
-			labelTransform->setTransform(SceneGraph::ONTransformNode::ONTransform::translateToOriginFrom(bubblePoint));
-			}
+		Tracer::Span span("Update node hierarchy");
+		getNodeBVH(positions);
 		}
+	
+	/* Add created labels, and show and place the labels closest to the main viewer: */
+	Tracer::Span span("Update node labels");
+	updateNodeLabels(positions);
 	}
 
 void CollaborativeNetworkViewer::display(GLContextData& contextData) const
@@ -536,14 +830,15 @@ void CollaborativeNetworkViewer::display(GLContextData& contextData) const
 	/* Call the base class method: */
 	CollaborativeVruiApplication::display(contextData);
 	
-	/* Check if the network and node positions are in synch: */
-	if(nvClient!=0&&networkVersion==networkPositionVersion)
+	/* Check if the network, node positions, and prepared node vertices are in synch: */
+	const std::vector<DataItem::Vertex>& nodeVertices=renderData.getNodeVertices();
+	if(nvClient!=0&&networkVersion==networkPositionVersion&&nodeVertices.size()==positions.getLockedValue().size())
 		{
 		/* Retrieve the context data item: */
 		DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
 		
 		/* Set up OpenGL state: */
-		glPushAttrib(GL_ENABLE_BIT);
+		glPushAttrib(GL_ENABLE_BIT|GL_POINT_BIT);
 		#if CONFIG_USE_IMPOSTORSPHERES
 		glEnable(GL_LIGHTING);
 		
@@ -563,9 +858,6 @@ void CollaborativeNetworkViewer::display(GLContextData& contextData) const
 		const NVPointList& points=positions.getLockedValue();
 		if(dataItem->networkVersion!=networkVersion)
 			{
-			/* Resize the vertex buffer: */
-			glBufferDataARB(GL_ARRAY_BUFFER_ARB,points.size()*sizeof(DataItem::Vertex),0,GL_DYNAMIC_DRAW_ARB);
-			
 			/* Update the index buffer to render node links: */
 			const Network::LinkList& links=nvClient->network->getLinks();
 			glBufferDataARB(GL_ELEMENT_ARRAY_BUFFER_ARB,links.size()*2*sizeof(GLuint),0,GL_STATIC_DRAW_ARB);
@@ -579,59 +871,101 @@ void CollaborativeNetworkViewer::display(GLContextData& contextData) const
 			dataItem->networkVersion=networkVersion;
 			}
 		
-		if(dataItem->vertexVersion!=positionVersion)
+		unsigned int nodeVerticesVersion=renderData.getNodeVerticesVersion();
+		Index changedBegin=renderData.getNodeVerticesChangedBegin();
+		Index changedEnd=renderData.getNodeVerticesChangedEnd();
+		if(dataItem->vertexVersion+1==nodeVerticesVersion&&changedEnd-changedBegin<Index(nodeVertices.size()))
 			{
-			/* Upload the newest node positions, sizes, and colors: */
-			GLubyte opacity=renderingParameters.linkOpacity<Scalar(1)?GLubyte(Math::floor(renderingParameters.linkOpacity*Scalar(256))):GLubyte(255);
-			Network::ColorList::const_iterator ncIt=nvClient->network->getNodeColors().begin();
-			DataItem::Vertex* vPtr=static_cast<DataItem::Vertex*>(glMapBufferARB(GL_ARRAY_BUFFER_ARB,GL_WRITE_ONLY_ARB));
-			#if CONFIG_USE_IMPOSTORSPHERES
-			if(renderingParameters.useNodeSize)
+			/* Upload only the range of node vertices changed by the most recent update: */
+			if(changedBegin<changedEnd)
+				glBufferSubDataARB(GL_ARRAY_BUFFER_ARB,changedBegin*sizeof(DataItem::Vertex),(changedEnd-changedBegin)*sizeof(DataItem::Vertex),&nodeVertices[changedBegin]);
+			
+			/* Mark the node vertices as up-to-date: */
+			dataItem->vertexVersion=nodeVerticesVersion;
+			}
+		else if(dataItem->vertexVersion!=nodeVerticesVersion)
+			{
+			/* Orphan the vertex buffer and upload the prepared node vertices in one block: */
+			glBufferDataARB(GL_ARRAY_BUFFER_ARB,nodeVertices.size()*sizeof(DataItem::Vertex),nodeVertices.empty()?0:&nodeVertices.front(),GL_STREAM_DRAW_ARB);
+			
+			/* Mark the node vertices as up-to-date: */
+			dataItem->vertexVersion=nodeVerticesVersion;
+			}
+		
+		/* Enable vertex arrays: */
+		GLVertexArrayParts::enable(DataItem::Vertex::getPartsMask());
+		glVertexPointer(static_cast<const DataItem::Vertex*>(0));
+		
+		const SphereBVH& nodeBVH=renderData.getNodeBVH();
+		if(cullNodes&&nodeBVH.getNumSpheres()==points.size())
+			{
+			/* Determine the visible nodes and links and the levels of detail at which to draw them: */
+			const Network::LinkList& links=nvClient->network->getLinks();
+			VisibilityCuller::VisibleSet& vs=dataItem->visibleSet;
+			culler.cull(getCurrentView(),nodeBVH,points,renderData.getNodeRadii(),links,vs);
+			
+			/* Draw nodes of sufficient projected size as spheres using client-side index arrays: */
+			glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,0);
+			if(!vs.sphereNodes.empty())
 				{
-				/* Upload nodes as variable-radius spheres: */
-				Network::NodeList::const_iterator nIt=nvClient->network->getNodes().begin();
-				for(NVPointList::const_iterator pIt=points.begin();pIt!=points.end();++pIt,++nIt,++ncIt,++vPtr)
-					{
-					for(int i=0;i<4;++i)
-						vPtr->color[i]=(*ncIt)[i];
-					vPtr->color[3]=opacity;
-					for(int i=0;i<3;++i)
-						vPtr->position[i]=(*pIt)[i];
-					vPtr->position[3]=GLfloat(getNodeRadius(*nIt));
-					}
+				#if CONFIG_USE_IMPOSTORSPHERES
+				nodeRenderer.enable(GLfloat(Vrui::getNavigationTransformation().getScaling()),contextData);
+				#endif
+				glDrawElements(GL_POINTS,GLsizei(vs.sphereNodes.size()),GL_UNSIGNED_INT,&vs.sphereNodes.front());
+				#if CONFIG_USE_IMPOSTORSPHERES
+				nodeRenderer.disable(contextData);
+				#endif
 				}
-			else
-			#endif
+			
+			/* Draw smaller nodes as single unlit points: */
+			glDisable(GL_LIGHTING);
+			glPointSize(1.0f);
+			if(!vs.dotNodes.empty())
+				glDrawElements(GL_POINTS,GLsizei(vs.dotNodes.size()),GL_UNSIGNED_INT,&vs.dotNodes.front());
+			
+			/* Draw clusters of nodes that are too small to be drawn individually as single points: */
+			glBindBufferARB(GL_ARRAY_BUFFER_ARB,0);
+			if(!vs.impostors.empty())
 				{
-				/* Upload nodes as fixed-radius spheres: */
-				for(NVPointList::const_iterator pIt=points.begin();pIt!=points.end();++pIt,++ncIt,++vPtr)
+				/* Assign each impostor the color of its cluster's representative node: */
+				std::vector<DataItem::Vertex>& ivs=dataItem->impostorVertices;
+				ivs.resize(vs.impostors.size());
+				const VisualNetwork::ColorList& nodeColors=nvClient->network->getNodeColors();
+				std::vector<DataItem::Vertex>::iterator ivIt=ivs.begin();
+				for(std::vector<VisibilityCuller::ClusterImpostor>::const_iterator iIt=vs.impostors.begin();iIt!=vs.impostors.end();++iIt,++ivIt)
 					{
 					for(int i=0;i<4;++i)
-						vPtr->color[i]=(*ncIt)[i];
-					vPtr->color[3]=opacity;
+						ivIt->color[i]=nodeColors[iIt->representative][i];
 					for(int i=0;i<3;++i)
-						vPtr->position[i]=(*pIt)[i];
-					vPtr->position[3]=1.0f;
+						ivIt->position[i]=GLfloat(iIt->center[i]);
+					ivIt->position[3]=1.0f;
 					}
+				
+				glVertexPointer(&ivs.front());
+				glDrawArrays(GL_POINTS,0,GLsizei(ivs.size()));
 				}
-			glUnmapBufferARB(GL_ARRAY_BUFFER_ARB);
 			
-			/* Mark the node positions as up-to-date: */
-			dataItem->vertexVersion=positionVersion;
+			/* Collect the node indices of all visible links for the transparent rendering pass: */
+			dataItem->linkIndices.clear();
+			dataItem->linkIndices.reserve(vs.links.size()*2);
+			for(std::vector<Index>::const_iterator lIt=vs.links.begin();lIt!=vs.links.end();++lIt)
+				for(int i=0;i<2;++i)
+					dataItem->linkIndices.push_back(links[*lIt].getNode(i)->getParticleIndex());
+			dataItem->linksCulled=true;
+			}
+		else
+			{
+			/* Draw all nodes as spheres: */
+			#if CONFIG_USE_IMPOSTORSPHERES
+			nodeRenderer.enable(GLfloat(Vrui::getNavigationTransformation().getScaling()),contextData);
+			#endif
+			glDrawArrays(GL_POINTS,0,GLsizei(nodeVertices.size()));
+			#if CONFIG_USE_IMPOSTORSPHERES
+			nodeRenderer.disable(contextData);
+			#endif
+			
+			dataItem->linksCulled=false;
 			}
-		
-		/* Enable vertex arrays: */
-		GLVertexArrayParts::enable(DataItem::Vertex::getPartsMask());
-		
-		/* Draw all nodes as spheres: */
-		#if CONFIG_USE_IMPOSTORSPHERES
-		nodeRenderer.enable(GLfloat(Vrui::getNavigationTransformation().getScaling()),contextData);
-		#endif
-		glVertexPointer(static_cast<const DataItem::Vertex*>(0));
-		glDrawArrays(GL_POINTS,0,points.size());
-		#if CONFIG_USE_IMPOSTORSPHERES
-		nodeRenderer.disable(contextData);
-		#endif
 		
 		/* Disable vertex arrays: */
 		GLVertexArrayParts::disable(DataItem::Vertex::getPartsMask());
@@ -665,8 +999,9 @@ void CollaborativeNetworkViewer::resetNavigation(void)
 
 void CollaborativeNetworkViewer::glRenderActionTransparent(GLContextData& contextData) const
 	{
-	/* Check if the network and node positions are in synch: */
-	if(nvClient!=0&&networkVersion==networkPositionVersion)
+	/* Check if the network, node positions, and prepared node vertices are in synch: */
+	const std::vector<DataItem::Vertex>& nodeVertices=renderData.getNodeVertices();
+	if(nvClient!=0&&networkVersion==networkPositionVersion&&nodeVertices.size()==positions.getLockedValue().size())
 		{
 		/* Retrieve the context data item: */
 		DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
@@ -694,8 +1029,18 @@ void CollaborativeNetworkViewer::glRenderActionTransparent(GLContextData& contex
 		glInterleavedArrays(GL_C4UB_V3F,sizeof(DataItem::Vertex),0);
 		// glVertexPointer(static_cast<const DataItem::Vertex*>(0));
 		
-		/* Draw all links as lines: */
-		glDrawElements(GL_LINES,nvClient->network->getLinks().size()*2,GL_UNSIGNED_INT,0);
+		if(dataItem->linksCulled)
+			{
+			/* Draw the links found visible during the display pass as lines: */
+			glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,0);
+			if(!dataItem->linkIndices.empty())
+				glDrawElements(GL_LINES,GLsizei(dataItem->linkIndices.size()),GL_UNSIGNED_INT,&dataItem->linkIndices.front());
+			}
+		else
+			{
+			/* Draw all links as lines: */
+			glDrawElements(GL_LINES,nvClient->network->getLinks().size()*2,GL_UNSIGNED_INT,0);
+			}
 		
 		/* Disable vertex arrays: */
 		GLVertexArrayParts::disable(DataItem::Vertex::getPartsMask());
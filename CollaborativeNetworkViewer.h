@@ -27,7 +27,9 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <Misc/StandardHashFunction.h>
 #include <Misc/HashTable.h>
+#include <Threads/MutexCond.h>
 #include <Threads/TripleBuffer.h>
+#include <Threads/WorkerPool.h>
 #include <Math/Math.h>
 #include <GL/gl.h>
 #include <GL/GLObject.h>
@@ -47,9 +49,14 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Collaboration2/CollaborativeVruiApplication.h>
 
 #include "ParticleTypes.h"
-#include "Network.h"
+#include "VisualNetwork.h"
 #include "SimulationParameters.h"
 #include "RenderingParameters.h"
+#include "JsonMap.h"
+#include "SphereBVH.h"
+#include "NodeRenderData.h"
+#include "VisibilityCuller.h"
+#include "CreateNodeLabel.h"
 #include "NetworkViewerClient.h"
 
 /* Forward declarations: */
@@ -57,7 +64,8 @@ namespace GLMotif {
 class PopupMenu;
 class PopupWindow;
 }
-class Network;
+class VisualNetwork;
+class SimulationScheduler;
 
 class CollaborativeNetworkViewer:public Collab::CollaborativeVruiApplication,public Vrui::TransparentObject,public GLObject
 	{
@@ -68,10 +76,45 @@ class CollaborativeNetworkViewer:public Collab::CollaborativeVruiApplication,pub
 	typedef Collab::Plugins::NetworkViewerClient::NVScalar NVScalar;
 	typedef Collab::Plugins::NetworkViewerClient::NVPoint NVPoint;
 	typedef Collab::Plugins::NetworkViewerClient::NVPointList NVPointList;
-	typedef Misc::HashTable<unsigned int,SceneGraph::OGTransformNodePointer> NodeLabelMap; // Type for maps from node IDs to node label scene graphs
+	
+	struct NodeLabelState:public NodeLabel // Structure for labels of nodes in the label set
+		{
+		/* Elements: */
+		public:
+		unsigned int serialNumber; // Serial number of the most recent request to create the label
+		bool created; // Flag whether the label's scene graph has been created
+		bool visible; // Flag whether the label is currently part of Vrui's scene graph
+		bool show; // Flag whether the label was selected to be shown during the current frame
+		};
+	
+	typedef Misc::HashTable<unsigned int,NodeLabelState> NodeLabelMap; // Type for maps from node IDs to node labels
+	
+	class CreateNodeLabelJob:public Threads::WorkerPool::JobFunction // Class to create a node label from a worker thread
+		{
+		/* Elements: */
+		public:
+		CollaborativeNetworkViewer* application; // Pointer to the application object
+		unsigned int nodeIndex; // Index of the labeled node
+		unsigned int serialNumber; // Serial number of the label request
+		JsonMapPointer nodeMap; // Map of the labeled node's properties
+		unsigned int numLinks; // Labeled node's number of links
+		SceneGraph::FancyFontStyleNodePointer fontStyle; // Font style for the label's text
+		NodeLabel label; // The created label
+		
+		/* Constructors and destructors: */
+		public:
+		CreateNodeLabelJob(CollaborativeNetworkViewer* sApplication,unsigned int sNodeIndex,unsigned int sSerialNumber,JsonMapPointer sNodeMap,unsigned int sNumLinks,SceneGraph::FancyFontStyleNode& sFontStyle);
+		
+		/* Methods from class Threads::WorkerPool::JobFunction: */
+		virtual void operator()(int) const;
+		virtual void operator()(int);
+		};
+	
+	friend class CreateNodeLabelJob;
 	
 	class Tool; // Base class for tools working with the NetworkViewerClient application
 	class SelectTool; // Tool class to select individual nodes
+	class RegionSelectTool; // Tool class to select all nodes inside a sphere or ray cone
 	class DeselectTool; // Tool class to deselect individual nodes
 	class ToggleSelectTool; // Tool class to toggle the selection state of individual nodes
 	class ShowLabelTool; // Tool class to show/hide labels displaying a node's properties
@@ -79,6 +122,7 @@ class CollaborativeNetworkViewer:public Collab::CollaborativeVruiApplication,pub
 	
 	friend class Tool;
 	friend class SelectTool;
+	friend class RegionSelectTool;
 	friend class DeselectTool;
 	friend class ToggleSelectTool;
 	friend class ShowLabelTool;
@@ -88,13 +132,17 @@ class CollaborativeNetworkViewer:public Collab::CollaborativeVruiApplication,pub
 		{
 		/* Embedded classes: */
 		public:
-		typedef GLGeometry::Vertex<void,0,GLubyte,4,void,GLfloat,4> Vertex; // Type for vertices held in vertex buffers
+		typedef NodeRenderData::Vertex Vertex; // Type for vertices held in vertex buffers
 		
 		/* Elements: */
 		GLuint vertexBuffer; // Buffer holding node positions and colors
 		GLuint indexBuffer; // Buffer holding indices of linked nodes
 		unsigned int networkVersion; // Version number of the visualized network
-		unsigned int vertexVersion; // Version number of the vertex buffer
+		unsigned int vertexVersion; // Version number of the prepared node vertex array reflected in the vertex buffer
+		VisibilityCuller::VisibleSet visibleSet; // Nodes and links found visible during the most recent display pass
+		std::vector<Vertex> impostorVertices; // Vertices for cluster impostors found during the most recent display pass
+		std::vector<GLuint> linkIndices; // Indices of linked nodes of links found visible during the most recent display pass
+		bool linksCulled; // Flag whether the link index list reflects the most recent display pass
 		
 		/* Constructors and destructors: */
 		DataItem(void);
@@ -109,6 +157,7 @@ class CollaborativeNetworkViewer:public Collab::CollaborativeVruiApplication,pub
 	GLMotif::PopupWindow* simulationParametersDialog;
 	GLMotif::PopupWindow* renderingDialog; // Dialog window to control rendering settings
 	const char* startupNetworkFileName; // Name of a network file to load on application start-up, or 0
+	const char* traceFileName; // Name of a file to which to write a trace of the client's work on shutdown, or 0
 	SimulationParameters simulationParameters; // Current network simulation parameters
 	unsigned int networkVersion; // Version number of the visualized network
 	Threads::TripleBuffer<NVPointList> positions; // Triple buffer of network node positions
@@ -116,7 +165,17 @@ class CollaborativeNetworkViewer:public Collab::CollaborativeVruiApplication,pub
 	unsigned int positionVersion; // Version number of the locked position array
 	SceneGraph::FancyFontStyleNodePointer labelFontStyle; // Font style to use for node labels
 	NodeLabelMap nodeLabels; // Set of currently displayed node labels
+	unsigned int nextLabelSerialNumber; // Serial number to assign to the next label request
+	Threads::MutexCond labelJobsCond; // Condition variable protecting the list of created labels and signaling completion of label creation jobs
+	unsigned int numPendingLabelJobs; // Number of label creation jobs that have not yet completed
+	std::vector<CreateNodeLabelJob*> createdLabelJobs; // List of completed label creation jobs whose labels have not yet been added to the label set
+	unsigned int maxVisibleLabels; // Maximum number of labels shown at the same time; labels closest to the main viewer are shown first
+	Scalar maxLabelDistance; // Maximum distance in physical space from the main viewer at which labels are shown
 	RenderingParameters renderingParameters; // Current set of rendering parameters
+	bool cullNodes; // Flag whether to cull nodes and links against the view frustum and select their levels of detail
+	SimulationScheduler* renderingScheduler; // Thread pool to prepare vertex data and cull nodes and links in parallel
+	NodeRenderData renderData; // Node radii, node sphere hierarchy, and interleaved node vertices prepared once per frame for all OpenGL contexts
+	VisibilityCuller culler; // Culler selecting visible nodes and links and their levels of detail
 	#if CONFIG_USE_IMPOSTORSPHERES
 	GLSphereRenderer nodeRenderer; // Renderer for node spheres
 	#endif
@@ -127,18 +186,11 @@ class CollaborativeNetworkViewer:public Collab::CollaborativeVruiApplication,pub
 	/* Private methods: */
 	Scalar getNodeRadius(unsigned int nodeIndex) const // Returns the radius of the given node based on current rendering settings
 		{
-		if(renderingParameters.useNodeSize)
-			return renderingParameters.nodeRadius*Math::pow(nvClient->getNetwork().getNodes()[nodeIndex].getSize(),renderingParameters.nodeSizeExponent);
-		else
-			return renderingParameters.nodeRadius;
-		}
-	Scalar getNodeRadius(const Node& node) const // Ditto
-		{
-		if(renderingParameters.useNodeSize)
-			return renderingParameters.nodeRadius*Math::pow(node.getSize(),renderingParameters.nodeSizeExponent);
-		else
-			return renderingParameters.nodeRadius;
+		return renderData.getNodeRadius(nodeIndex);
 		}
+	void updateNodeRadii(void); // Recalculates the radii of all nodes after the visualized network or the rendering settings changed
+	const SphereBVH& getNodeBVH(const NVPointList& points); // Returns the node sphere hierarchy updated for the given locked list of node positions
+	void updateNodeVertices(const NVPointList& points); // Prepares the interleaved node vertex array for the given locked list of node positions
 	void objectSnapCallback(Vrui::ObjectSnapperToolFactory::SnapRequest& snapRequest); // Callback called when an object snapper tool issues a snap request
 	void loadNetworkFileCallback(GLMotif::FileSelectionDialog::OKCallbackData* cbData);
 	void changeSelectionCallback(Misc::CallbackData* cbData,const unsigned int& command);
@@ -146,11 +198,13 @@ class CollaborativeNetworkViewer:public Collab::CollaborativeVruiApplication,pub
 	void showRenderingDialogCallback(Misc::CallbackData* cbData);
 	GLMotif::PopupMenu* createSelectionMenu(void);
 	GLMotif::PopupMenu* createMainMenu(void);
-	void updateNetwork(Network* newNetwork); // Notifies the application that a new network has been loaded
+	void updateNetwork(VisualNetwork* newNetwork); // Notifies the application that a new network has been loaded
 	void updateSimulationParameters(const SimulationParameters& newSimulationParameters);
 	void clearNodeLabels(void); // Removes all node labels
 	void showNodeLabel(unsigned int nodeIndex); // Shows a label for the node of the given index
 	void hideNodeLabel(unsigned int nodeIndex); // Hides the label for the node of the given index
+	void labelCreated(CreateNodeLabelJob* job); // Notifies the application that a label creation job completed; called from a worker thread
+	void updateNodeLabels(const NVPointList& points); // Adds created labels to the label set, selects the labels to show, and places them at their nodes
 	void updateRenderingParameters(const RenderingParameters& newRenderingParameters);
 	void simulationParametersChangedCallback(Misc::CallbackData* cbData);
 	GLMotif::PopupWindow* createSimulationParametersDialog(void); // Creates a dialog window to change network simulation settings
@@ -159,7 +213,13 @@ class CollaborativeNetworkViewer:public Collab::CollaborativeVruiApplication,pub
 	const NVPointList& lockAndGetPositions(void) // Returns the most recently updated list of particle positions
 		{
 		/* Check if there is a new positions list: */
-		if(positions.lockNewValue())
+		bool newPositions=positions.lockNewValue();
+		
+		/* Apply dragged node positions that were received ahead of the next simulation update: */
+		if(nvClient!=0&&nvClient->applyDragDeltas(positions.getLockedValue(),newPositions))
+			newPositions=true;
+		
+		if(newPositions)
 			++positionVersion;
 		
 		/* Return the locked positions list: */
@@ -405,8 +405,10 @@ SceneGraph::IndexedFaceSetNodePointer makeBubble(SceneGraph::ShapeNode& textShap
 
 }
 
-SceneGraph::OGTransformNodePointer createNodeLabel(const JsonMap::Map& nodeProperties,unsigned int numLinks,SceneGraph::FancyFontStyleNode& fontStyle)
+NodeLabel createNodeLabel(const JsonMap::Map& nodeProperties,unsigned int numLinks,SceneGraph::FancyFontStyleNode& fontStyle)
 	{
+	NodeLabel result;
+	
 	/* Create the label root node: */
 	SceneGraph::OGTransformNodePointer root=new SceneGraph::OGTransformNode;
 	
@@ -492,10 +494,10 @@ SceneGraph::OGTransformNodePointer createNodeLabel(const JsonMap::Map& nodePrope
 	bubbleShape->update();
 	labelTransform->addChild(*bubbleShape);
 	
-	/* Align the label transform: */
+	/* Align the label transform, and remember the bubble's point so that the bubble's bounding box never needs to be calculated again: */
 	SceneGraph::Box bbox=bubbleShape->calcBoundingBox();
-	SceneGraph::Point bubblePoint(Math::mid(bbox.min[0],bbox.max[0]),bbox.min[1],Math::mid(bbox.min[2],bbox.max[2]));
-	labelTransform->setTransform(SceneGraph::ONTransformNode::ONTransform::translateToOriginFrom(bubblePoint));
+	result.bubblePoint=SceneGraph::Point(Math::mid(bbox.min[0],bbox.max[0]),bbox.min[1],Math::mid(bbox.min[2],bbox.max[2]));
+	labelTransform->setTransform(SceneGraph::ONTransformNode::ONTransform::translateToOriginFrom(result.bubblePoint));
 	
 	labelTransform->update();
 	billboard->addChild(*labelTransform);
@@ -503,5 +505,7 @@ SceneGraph::OGTransformNodePointer createNodeLabel(const JsonMap::Map& nodePrope
 	billboard->update();
 	root->addChild(*billboard);
 	
-	return root;
+	result.root=root;
+	result.labelTransform=labelTransform;
+	return result;
 	}
@@ -23,7 +23,9 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef CREATENODELABEL_INCLUDED
 #define CREATENODELABEL_INCLUDED
 
+#include <SceneGraph/Geometry.h>
 #include <SceneGraph/OGTransformNode.h>
+#include <SceneGraph/ONTransformNode.h>
 
 #include "JsonMap.h"
 
@@ -32,6 +34,15 @@ namespace SceneGraph {
 class FancyFontStyleNode;
 }
 
-SceneGraph::OGTransformNodePointer createNodeLabel(const JsonMap::Map& nodeProperties,unsigned int numLinks,SceneGraph::FancyFontStyleNode& fontStyle);
+struct NodeLabel // Structure for a node label's scene graph and its cached layout
+	{
+	/* Elements: */
+	public:
+	SceneGraph::OGTransformNodePointer root; // Root of the label's scene graph, to be positioned at the labeled node
+	SceneGraph::ONTransformNodePointer labelTransform; // Transformation aligning the label bubble's point with the labeled node
+	SceneGraph::Point bubblePoint; // Position of the label bubble's point in label coordinates
+	};
+
+NodeLabel createNodeLabel(const JsonMap::Map& nodeProperties,unsigned int numLinks,SceneGraph::FancyFontStyleNode& fontStyle); // Creates a label for a node with the given properties and number of links; can be called from a background thread
 
 #endif
@@ -0,0 +1,85 @@
+/***********************************************************************
+DeflateFilter - Class for read-only files that compress the contents of a
+source file with zlib's deflate method while they are being read.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include "DeflateFilter.h"
+
+#include <stdexcept>
+
+/******************************
+Methods of class DeflateFilter:
+******************************/
+
+size_t DeflateFilter::readData(IO::File::Byte* buffer,size_t bufferSize)
+	{
+	/* Compress source data into the given buffer until at least one byte was produced or the compressed stream is complete: */
+	stream.next_out=buffer;
+	stream.avail_out=uInt(bufferSize);
+	while(stream.avail_out==uInt(bufferSize)&&!finished)
+		{
+		/* Read more data from the source file if the previous data was consumed: */
+		if(stream.avail_in==0&&!sourceEof)
+			{
+			size_t numRead=source->readUpTo(sourceBuffer,sourceBufferSize);
+			sourceEof=numRead==0;
+			numSourceBytes+=numRead;
+			stream.next_in=sourceBuffer;
+			stream.avail_in=uInt(numRead);
+			}
+		
+		/* Compress the current source data, and flush the compressed stream at the end of the source file: */
+		int result=deflate(&stream,sourceEof?Z_FINISH:Z_NO_FLUSH);
+		if(result==Z_STREAM_END)
+			finished=true;
+		else if(result!=Z_OK&&result!=Z_BUF_ERROR)
+			throw std::runtime_error("DeflateFilter::readData: Error while compressing source file");
+		}
+	
+	size_t numDeflated=bufferSize-size_t(stream.avail_out);
+	numDeflatedBytes+=numDeflated;
+	return numDeflated;
+	}
+
+DeflateFilter::DeflateFilter(IO::File& sSource,int compressionLevel)
+	:source(&sSource),
+	 sourceBuffer(new Byte[sourceBufferSize]),
+	 sourceEof(false),finished(false),
+	 numSourceBytes(0),numDeflatedBytes(0)
+	{
+	/* Initialize the zlib compression state: */
+	stream.zalloc=Z_NULL;
+	stream.zfree=Z_NULL;
+	stream.opaque=Z_NULL;
+	stream.next_in=Z_NULL;
+	stream.avail_in=0;
+	if(deflateInit(&stream,compressionLevel)!=Z_OK)
+		{
+		delete[] sourceBuffer;
+		throw std::runtime_error("DeflateFilter::DeflateFilter: Unable to initialize compression state");
+		}
+	}
+
+DeflateFilter::~DeflateFilter(void)
+	{
+	/* Release allocated resources: */
+	deflateEnd(&stream);
+	delete[] sourceBuffer;
+	}
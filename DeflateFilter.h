@@ -0,0 +1,65 @@
+/***********************************************************************
+DeflateFilter - Class for read-only files that compress the contents of a
+source file with zlib's deflate method while they are being read.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef DEFLATEFILTER_INCLUDED
+#define DEFLATEFILTER_INCLUDED
+
+#include <zlib.h>
+#include <Misc/Autopointer.h>
+#include <IO/File.h>
+
+class DeflateFilter:public IO::File
+	{
+	/* Elements: */
+	private:
+	static const size_t sourceBufferSize=65536; // Size of the buffer holding uncompressed data read from the source file
+	IO::FilePtr source; // The source file
+	Byte* sourceBuffer; // Buffer holding uncompressed data read from the source file
+	z_stream stream; // zlib compression state
+	bool sourceEof; // Flag whether the end of the source file has been read
+	bool finished; // Flag whether the compressed stream has been completely written
+	size_t numSourceBytes; // Number of uncompressed bytes read from the source file so far
+	size_t numDeflatedBytes; // Number of compressed bytes produced so far
+	
+	/* Protected methods from class IO::File: */
+	protected:
+	virtual size_t readData(Byte* buffer,size_t bufferSize);
+	
+	/* Constructors and destructors: */
+	public:
+	DeflateFilter(IO::File& sSource,int compressionLevel =Z_DEFAULT_COMPRESSION); // Creates a filter compressing the given source file at the given zlib compression level
+	virtual ~DeflateFilter(void);
+	
+	/* Methods: */
+	size_t getNumSourceBytes(void) const // Returns the number of uncompressed bytes read from the source file so far
+		{
+		return numSourceBytes;
+		}
+	size_t getNumDeflatedBytes(void) const // Returns the number of compressed bytes produced so far
+		{
+		return numDeflatedBytes;
+		}
+	};
+
+typedef Misc::Autopointer<DeflateFilter> DeflateFilterPtr; // Type for pointers to deflate filters
+
+#endif
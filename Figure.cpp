@@ -289,8 +289,8 @@ void Figure::glRenderAction(GLContextData& contextData) const
 	glColor3f(1.0f,0.0f,0.0f);
 	for(std::vector<Handle>::const_iterator hIt=handles.begin();hIt!=handles.end();++hIt)
 		{
-		glVertex(particles.getParticlePosition((*hIt)[0]));
-		glVertex(particles.getParticlePosition((*hIt)[1]));
+		glVertex(particles.getRenderPosition((*hIt)[0]));
+		glVertex(particles.getRenderPosition((*hIt)[1]));
 		}
 	glEnd();
 	
@@ -0,0 +1,248 @@
+/***********************************************************************
+GraphGenerator - Class to generate repeatable synthetic random graphs of
+several well-known families as lists of links between node indices.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include "GraphGenerator.h"
+
+#include <string.h>
+#include <stdexcept>
+#include <Math/Math.h>
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+const char* modelNames[GraphGenerator::NumModels]=
+	{
+	"er","ba","sbm","grid","tree"
+	};
+
+}
+
+/*******************************
+Methods of class GraphGenerator:
+*******************************/
+
+void GraphGenerator::generateErdosRenyi(unsigned int numNodes,GraphGenerator::LinkList& links)
+	{
+	/* Link uniformly chosen pairs of distinct nodes until the requested mean degree is reached: */
+	size_t numLinks=size_t(Math::floor(double(numNodes)*meanDegree*0.5+0.5));
+	for(size_t i=0;i<numLinks;++i)
+		{
+		unsigned int node0=randIndex(numNodes);
+		unsigned int node1=randIndex(numNodes-1);
+		if(node1>=node0)
+			++node1;
+		links.push_back(node0);
+		links.push_back(node1);
+		}
+	}
+
+void GraphGenerator::generateBarabasiAlbert(unsigned int numNodes,GraphGenerator::LinkList& links)
+	{
+	/* Calculate the number of links added with each new node: */
+	unsigned int m=(unsigned int)(Math::floor(meanDegree*0.5+0.5));
+	if(m<1)
+		m=1;
+	
+	/* Start with a fully linked core of m+1 nodes: */
+	unsigned int numCoreNodes=numNodes<m+1?numNodes:m+1;
+	size_t firstLink=links.size();
+	for(unsigned int node0=0;node0<numCoreNodes;++node0)
+		for(unsigned int node1=node0+1;node1<numCoreNodes;++node1)
+			{
+			links.push_back(node0);
+			links.push_back(node1);
+			}
+	
+	/* Add each further node linked to m distinct existing nodes chosen with probability proportional to their degrees: */
+	std::vector<unsigned int> targets;
+	for(unsigned int newNode=numCoreNodes;newNode<numNodes;++newNode)
+		{
+		/* Sample link endpoints uniformly, which selects nodes proportionally to their degrees: */
+		targets.clear();
+		size_t numEndpoints=links.size()-firstLink;
+		while(targets.size()<m)
+			{
+			unsigned int target=links[firstLink+size_t(randUnit()*double(numEndpoints))];
+			bool duplicate=false;
+			for(std::vector<unsigned int>::iterator tIt=targets.begin();tIt!=targets.end()&&!duplicate;++tIt)
+				duplicate=*tIt==target;
+			if(!duplicate)
+				targets.push_back(target);
+			}
+		
+		for(std::vector<unsigned int>::iterator tIt=targets.begin();tIt!=targets.end();++tIt)
+			{
+			links.push_back(newNode);
+			links.push_back(*tIt);
+			}
+		}
+	}
+
+void GraphGenerator::generateStochasticBlock(unsigned int numNodes,GraphGenerator::LinkList& links)
+	{
+	/* Assign nodes to contiguous blocks of equal size: */
+	unsigned int nb=numBlocks<numNodes?numBlocks:numNodes;
+	if(nb<1)
+		nb=1;
+	
+	/* Link random nodes to random other nodes in the same block, or in another block with the mixing probability: */
+	size_t numLinks=size_t(Math::floor(double(numNodes)*meanDegree*0.5+0.5));
+	for(size_t i=0;i<numLinks;++i)
+		{
+		unsigned int node0=randIndex(numNodes);
+		unsigned int block0=(unsigned int)((Misc::UInt64(node0)*Misc::UInt64(nb))/Misc::UInt64(numNodes));
+		unsigned int block1=block0;
+		if(nb>1&&randUnit()<mixing)
+			{
+			block1=randIndex(nb-1);
+			if(block1>=block0)
+				++block1;
+			}
+		
+		/* Pick a node in the target block that is distinct from the source node: */
+		unsigned int blockBegin=(unsigned int)((Misc::UInt64(block1)*Misc::UInt64(numNodes)+Misc::UInt64(nb)-1)/Misc::UInt64(nb));
+		unsigned int blockEnd=(unsigned int)((Misc::UInt64(block1+1)*Misc::UInt64(numNodes)+Misc::UInt64(nb)-1)/Misc::UInt64(nb));
+		if(blockEnd-blockBegin<2&&block1==block0)
+			continue;
+		unsigned int node1;
+		do
+			{
+			node1=blockBegin+randIndex(blockEnd-blockBegin);
+			}
+		while(node1==node0);
+		
+		links.push_back(node0);
+		links.push_back(node1);
+		}
+	}
+
+void GraphGenerator::generateGrid3D(unsigned int numNodes,GraphGenerator::LinkList& links)
+	{
+	/* Calculate the side length of the smallest cube holding all nodes: */
+	unsigned int side=(unsigned int)(Math::ceil(Math::pow(double(numNodes),1.0/3.0)));
+	while(side>1&&Misc::UInt64(side-1)*Misc::UInt64(side-1)*Misc::UInt64(side-1)>=Misc::UInt64(numNodes))
+		--side;
+	Misc::UInt64 sideSq=Misc::UInt64(side)*Misc::UInt64(side);
+	
+	/* Fill the cube in row-major order and link each node to its following neighbors along all three axes: */
+	for(unsigned int node=0;node<numNodes;++node)
+		{
+		if((node+1)%side!=0&&node+1<numNodes)
+			{
+			links.push_back(node);
+			links.push_back(node+1);
+			}
+		if((node/side)%side!=side-1&&node+side<numNodes)
+			{
+			links.push_back(node);
+			links.push_back(node+side);
+			}
+		if(Misc::UInt64(node)+sideSq<Misc::UInt64(numNodes))
+			{
+			links.push_back(node);
+			links.push_back(node+(unsigned int)(sideSq));
+			}
+		}
+	}
+
+void GraphGenerator::generateRandomTree(unsigned int numNodes,GraphGenerator::LinkList& links)
+	{
+	/* Link each node to a uniformly chosen earlier node: */
+	for(unsigned int node=1;node<numNodes;++node)
+		{
+		links.push_back(randIndex(node));
+		links.push_back(node);
+		}
+	}
+
+GraphGenerator::GraphGenerator(Misc::UInt64 seed)
+	:state(seed),
+	 meanDegree(4.0),
+	 numBlocks(16),mixing(0.05)
+	{
+	}
+
+const char* GraphGenerator::getModelName(GraphGenerator::Model model)
+	{
+	if(model<0||model>=NumModels)
+		throw std::runtime_error("GraphGenerator::getModelName: Invalid graph model");
+	return modelNames[model];
+	}
+
+bool GraphGenerator::parseModelName(const char* name,GraphGenerator::Model& model)
+	{
+	for(int i=0;i<NumModels;++i)
+		if(strcasecmp(name,modelNames[i])==0)
+			{
+			model=Model(i);
+			return true;
+			}
+	return false;
+	}
+
+void GraphGenerator::setMeanDegree(double newMeanDegree)
+	{
+	meanDegree=newMeanDegree;
+	}
+
+void GraphGenerator::setBlockParameters(unsigned int newNumBlocks,double newMixing)
+	{
+	numBlocks=newNumBlocks;
+	mixing=newMixing;
+	}
+
+void GraphGenerator::generate(GraphGenerator::Model model,unsigned int numNodes,GraphGenerator::LinkList& links)
+	{
+	links.clear();
+	if(numNodes<2)
+		return;
+	
+	/* Generate a graph of the requested family: */
+	switch(model)
+		{
+		case ErdosRenyi:
+			generateErdosRenyi(numNodes,links);
+			break;
+		
+		case BarabasiAlbert:
+			generateBarabasiAlbert(numNodes,links);
+			break;
+		
+		case StochasticBlock:
+			generateStochasticBlock(numNodes,links);
+			break;
+		
+		case Grid3D:
+			generateGrid3D(numNodes,links);
+			break;
+		
+		case RandomTree:
+			generateRandomTree(numNodes,links);
+			break;
+		
+		default:
+			throw std::runtime_error("GraphGenerator::generate: Invalid graph model");
+		}
+	}
@@ -0,0 +1,91 @@
+/***********************************************************************
+GraphGenerator - Class to generate repeatable synthetic random graphs of
+several well-known families as lists of links between node indices.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef GRAPHGENERATOR_INCLUDED
+#define GRAPHGENERATOR_INCLUDED
+
+#include <vector>
+#include <Misc/SizedTypes.h>
+
+class GraphGenerator
+	{
+	/* Embedded classes: */
+	public:
+	enum Model // Enumerated type for graph families
+		{
+		ErdosRenyi, // Uniformly random links between any pairs of nodes
+		BarabasiAlbert, // Scale-free graph grown by preferential attachment
+		StochasticBlock, // Graph of densely linked communities with sparse links between communities
+		Grid3D, // Nodes on a cubic grid linked to their axis-aligned neighbors
+		RandomTree, // Tree where each node is linked to a uniformly chosen earlier node
+		NumModels
+		};
+	
+	typedef std::vector<unsigned int> LinkList; // Type for lists of links as consecutive pairs of node indices
+	
+	/* Elements: */
+	private:
+	Misc::UInt64 state; // State of the pseudo-random number generator
+	double meanDegree; // Average number of links per node for graph families with adjustable density
+	unsigned int numBlocks; // Number of communities in stochastic block model graphs
+	double mixing; // Fraction of links between different communities in stochastic block model graphs
+	
+	/* Private methods: */
+	Misc::UInt64 randNext(void) // Returns the next 64-bit pseudo-random number
+		{
+		/* Advance the state and scramble it using the splitmix64 function: */
+		Misc::UInt64 z=(state+=0x9e3779b97f4a7c15ULL);
+		z=(z^(z>>30))*0xbf58476d1ce4e5b9ULL;
+		z=(z^(z>>27))*0x94d049bb133111ebULL;
+		return z^(z>>31);
+		}
+	unsigned int randIndex(unsigned int n) // Returns a pseudo-random integer in [0, n)
+		{
+		return (unsigned int)(((randNext()>>32)*Misc::UInt64(n))>>32);
+		}
+	double randUnit(void) // Returns a pseudo-random number in [0, 1)
+		{
+		return double(randNext()>>11)*(1.0/9007199254740992.0);
+		}
+	void generateErdosRenyi(unsigned int numNodes,LinkList& links); // Appends the links of an Erdos-Renyi graph to the given list
+	void generateBarabasiAlbert(unsigned int numNodes,LinkList& links); // Appends the links of a Barabasi-Albert graph to the given list
+	void generateStochasticBlock(unsigned int numNodes,LinkList& links); // Appends the links of a stochastic block model graph to the given list
+	void generateGrid3D(unsigned int numNodes,LinkList& links); // Appends the links of a cubic grid graph to the given list
+	void generateRandomTree(unsigned int numNodes,LinkList& links); // Appends the links of a random tree to the given list
+	
+	/* Constructors and destructors: */
+	public:
+	GraphGenerator(Misc::UInt64 seed); // Creates a generator whose graphs are fully determined by the given seed
+	
+	/* Methods: */
+	static const char* getModelName(Model model); // Returns a short name for the given graph family
+	static bool parseModelName(const char* name,Model& model); // Sets the given graph family from its short name; returns false if the name is unknown
+	void setSeed(Misc::UInt64 newSeed) // Restarts the pseudo-random number sequence from the given seed
+		{
+		state=newSeed;
+		}
+	void setMeanDegree(double newMeanDegree); // Sets the average number of links per node for Erdos-Renyi, Barabasi-Albert, and stochastic block model graphs
+	void setBlockParameters(unsigned int newNumBlocks,double newMixing); // Sets the number of communities and the fraction of links between communities for stochastic block model graphs
+	void generate(Model model,unsigned int numNodes,LinkList& links); // Replaces the given link list with the links of a graph of the given family and number of nodes
+	};
+
+#endif
@@ -0,0 +1,101 @@
+/***********************************************************************
+InflateFilter - Class for read-only files that decompress a source file
+compressed with zlib's deflate method while they are being read, or pass
+an uncompressed source file through unchanged, and keep track of the
+amount of data read from the source file.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include "InflateFilter.h"
+
+#include <stdexcept>
+
+/******************************
+Methods of class InflateFilter:
+******************************/
+
+size_t InflateFilter::readData(IO::File::Byte* buffer,size_t bufferSize)
+	{
+	/* Pass uncompressed source data through: */
+	if(!deflated)
+		{
+		size_t numRead=source->readUpTo(buffer,bufferSize);
+		numSourceBytes+=numRead;
+		numInflatedBytes+=numRead;
+		return numRead;
+		}
+	
+	/* Decompress source data into the given buffer until at least one byte was produced or the compressed stream is complete: */
+	stream.next_out=buffer;
+	stream.avail_out=uInt(bufferSize);
+	while(stream.avail_out==uInt(bufferSize)&&!finished)
+		{
+		/* Read more data from the source file if the previous data was consumed: */
+		if(stream.avail_in==0)
+			{
+			size_t numRead=source->readUpTo(sourceBuffer,sourceBufferSize);
+			if(numRead==0)
+				throw std::runtime_error("InflateFilter::readData: Compressed source file is truncated");
+			numSourceBytes+=numRead;
+			stream.next_in=sourceBuffer;
+			stream.avail_in=uInt(numRead);
+			}
+		
+		/* Decompress the current source data: */
+		int result=inflate(&stream,Z_NO_FLUSH);
+		if(result==Z_STREAM_END)
+			finished=true;
+		else if(result!=Z_OK&&result!=Z_BUF_ERROR)
+			throw std::runtime_error("InflateFilter::readData: Compressed source file is corrupted");
+		}
+	
+	size_t numInflated=bufferSize-size_t(stream.avail_out);
+	numInflatedBytes+=numInflated;
+	return numInflated;
+	}
+
+InflateFilter::InflateFilter(IO::File& sSource,bool sDeflated)
+	:source(&sSource),deflated(sDeflated),
+	 sourceBuffer(0),
+	 finished(false),
+	 numSourceBytes(0),numInflatedBytes(0)
+	{
+	if(deflated)
+		{
+		/* Initialize the zlib decompression state: */
+		stream.zalloc=Z_NULL;
+		stream.zfree=Z_NULL;
+		stream.opaque=Z_NULL;
+		stream.next_in=Z_NULL;
+		stream.avail_in=0;
+		if(inflateInit(&stream)!=Z_OK)
+			throw std::runtime_error("InflateFilter::InflateFilter: Unable to initialize decompression state");
+		sourceBuffer=new Byte[sourceBufferSize];
+		}
+	}
+
+InflateFilter::~InflateFilter(void)
+	{
+	/* Release allocated resources: */
+	if(deflated)
+		{
+		inflateEnd(&stream);
+		delete[] sourceBuffer;
+		}
+	}
@@ -0,0 +1,71 @@
+/***********************************************************************
+InflateFilter - Class for read-only files that decompress a source file
+compressed with zlib's deflate method while they are being read, or pass
+an uncompressed source file through unchanged, and keep track of the
+amount of data read from the source file.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef INFLATEFILTER_INCLUDED
+#define INFLATEFILTER_INCLUDED
+
+#include <zlib.h>
+#include <Misc/Autopointer.h>
+#include <IO/File.h>
+
+class InflateFilter:public IO::File
+	{
+	/* Elements: */
+	private:
+	static const size_t sourceBufferSize=65536; // Size of the buffer holding compressed data read from the source file
+	IO::FilePtr source; // The source file
+	bool deflated; // Flag whether the source file is compressed
+	Byte* sourceBuffer; // Buffer holding compressed data read from the source file
+	z_stream stream; // zlib decompression state
+	bool finished; // Flag whether the compressed stream has been completely read
+	size_t numSourceBytes; // Number of bytes read from the source file so far
+	size_t numInflatedBytes; // Number of uncompressed bytes produced so far
+	
+	/* Protected methods from class IO::File: */
+	protected:
+	virtual size_t readData(Byte* buffer,size_t bufferSize);
+	
+	/* Constructors and destructors: */
+	public:
+	InflateFilter(IO::File& sSource,bool sDeflated); // Creates a filter reading from the given source file, which is compressed if the flag is true
+	virtual ~InflateFilter(void);
+	
+	/* Methods: */
+	bool isDeflated(void) const // Returns true if the source file is compressed
+		{
+		return deflated;
+		}
+	size_t getNumSourceBytes(void) const // Returns the number of bytes read from the source file so far
+		{
+		return numSourceBytes;
+		}
+	size_t getNumInflatedBytes(void) const // Returns the number of uncompressed bytes produced so far
+		{
+		return numInflatedBytes;
+		}
+	};
+
+typedef Misc::Autopointer<InflateFilter> InflateFilterPtr; // Type for pointers to inflate filters
+
+#endif
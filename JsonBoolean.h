@@ -50,6 +50,10 @@ class JsonBoolean:public JsonEntity
 		{
 		os<<(value?"true":"false");
 		}
+	virtual size_t getMemorySize(void) const
+		{
+		return sizeof(JsonBoolean);
+		}
 	
 	/* New methods: */
 	bool getBoolean(void) const // Returns the represented boolean value
@@ -40,6 +40,7 @@ class JsonEntity:public Threads::RefCounted
 	virtual EntityType getType(void) const =0; // Returns the entity's type
 	virtual std::string getTypeName(void) const =0; // Returns the entity's type as a string
 	virtual void print(std::ostream& os) const =0; // Prints an entity to the given output stream
+	virtual size_t getMemorySize(void) const =0; // Returns an estimate of the memory used by the entity and its sub-entities in bytes
 	};
 
 typedef Misc::Autopointer<JsonEntity> JsonPointer; // Type for pointers to json entities
@@ -58,6 +58,13 @@ class JsonList:public JsonEntity
 			}
 		os<<']';
 		}
+	virtual size_t getMemorySize(void) const
+		{
+		size_t result=sizeof(JsonList)+list.capacity()*sizeof(JsonPointer);
+		for(List::const_iterator lIt=list.begin();lIt!=list.end();++lIt)
+			result+=(*lIt)->getMemorySize();
+		return result;
+		}
 	
 	/* New methods: */
 	const List& getList(void) const // Returns the represented list
@@ -67,6 +67,14 @@ class JsonMap:public JsonEntity
 			}
 		os<<'}';
 		}
+	virtual size_t getMemorySize(void) const
+		{
+		/* Account for hash table entries and their bucket chain pointers: */
+		size_t result=sizeof(JsonMap)+map.getNumEntries()*(sizeof(Map::Entry)+sizeof(void*));
+		for(Map::ConstIterator mIt=map.begin();!mIt.isFinished();++mIt)
+			result+=mIt->getSource().capacity()+mIt->getDest()->getMemorySize();
+		return result;
+		}
 	
 	/* New methods: */
 	const Map& getMap(void) const // Returns the represented map
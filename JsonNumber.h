@@ -50,6 +50,10 @@ class JsonNumber:public JsonEntity
 		{
 		os<<number;
 		}
+	virtual size_t getMemorySize(void) const
+		{
+		return sizeof(JsonNumber);
+		}
 	
 	/* New methods: */
 	double getNumber(void) const // Returns the represented number
@@ -56,6 +56,10 @@ class JsonString:public JsonEntity
 		{
 		os<<'"'<<string<<'"';
 		}
+	virtual size_t getMemorySize(void) const
+		{
+		return sizeof(JsonString)+string.capacity();
+		}
 	
 	/* New methods: */
 	const std::string& getString(void) const // Returns the represented string
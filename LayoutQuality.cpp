@@ -0,0 +1,475 @@
+/***********************************************************************
+LayoutQuality - Class to measure the quality of a network layout
+represented by the particles of a particle system, using sampled stress,
+the variation of link lengths, the preservation of graph neighborhoods,
+and the number of overlapping nodes.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include "LayoutQuality.h"
+
+#include <algorithm>
+#include <Misc/SizedTypes.h>
+#include <Threads/Spinlock.h>
+#include <Realtime/Time.h>
+#include <Math/Math.h>
+#include <Math/Constants.h>
+#include <Geometry/Point.h>
+
+#include "Network.h"
+#include "ParticleSystem.h"
+#include "ParticleOctree.icpp"
+#include "SimulationScheduler.h"
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+class StressLoop:public SimulationScheduler::ParallelFunction // Loop body comparing graph distances from ranges of source nodes to layout distances
+	{
+	/* Elements: */
+	private:
+	const ParticleSystem& particles; // Particle system defining the layout
+	const Network::NodeList& nodes; // Network nodes
+	const Index* neighborOffsets; // Offsets of each node's list of linked nodes
+	const Index* neighbors; // Concatenated lists of linked nodes
+	Index numSources; // Total number of source nodes
+	Threads::Spinlock sumsMutex; // Mutex serializing access to the accumulated sums
+	public:
+	double sumRatio,sumRatio2; // Sums of ratios between layout and graph distances and of their squares
+	size_t numPairs; // Number of node pairs included in the sums
+	
+	/* Constructors and destructors: */
+	StressLoop(const ParticleSystem& sParticles,const Network::NodeList& sNodes,const Index* sNeighborOffsets,const Index* sNeighbors,Index sNumSources)
+		:particles(sParticles),nodes(sNodes),neighborOffsets(sNeighborOffsets),neighbors(sNeighbors),numSources(sNumSources),
+		 sumRatio(0.0),sumRatio2(0.0),numPairs(0)
+		{
+		}
+	
+	/* Methods from class SimulationScheduler::ParallelFunction: */
+	virtual void operator()(Index begin,Index end)
+		{
+		Index numNodes=Index(nodes.size());
+		std::vector<Index> dists(numNodes);
+		std::vector<Index> queue;
+		queue.reserve(numNodes);
+		double rs=0.0,rs2=0.0;
+		size_t np=0;
+		for(Index sourceIndex=begin;sourceIndex<end;++sourceIndex)
+			{
+			/* Spread the source nodes evenly over the node array so that repeated measurements use the same pairs: */
+			Index source=Index((Misc::UInt64(sourceIndex)*Misc::UInt64(numNodes))/Misc::UInt64(numSources));
+			const Point& sourcePos=particles.getParticlePosition(nodes[source].getParticleIndex());
+			
+			/* Calculate the graph distances from the source node to all reachable nodes by breadth-first search: */
+			std::fill(dists.begin(),dists.end(),~Index(0));
+			dists[source]=0;
+			queue.clear();
+			queue.push_back(source);
+			for(size_t queueHead=0;queueHead<queue.size();++queueHead)
+				{
+				Index node=queue[queueHead];
+				Index dist=dists[node]+1;
+				for(const Index* nPtr=neighbors+neighborOffsets[node];nPtr!=neighbors+neighborOffsets[node+1];++nPtr)
+					if(dists[*nPtr]==~Index(0))
+						{
+						dists[*nPtr]=dist;
+						queue.push_back(*nPtr);
+						
+						/* Compare the layout distance to the graph distance: */
+						double ratio=double(Geometry::dist(sourcePos,particles.getParticlePosition(nodes[*nPtr].getParticleIndex())))/double(dist);
+						rs+=ratio;
+						rs2+=ratio*ratio;
+						++np;
+						}
+				}
+			}
+		
+		/* Add the range's sums to the totals: */
+		Threads::Spinlock::Lock sumsLock(sumsMutex);
+		sumRatio+=rs;
+		sumRatio2+=rs2;
+		numPairs+=np;
+		}
+	};
+
+class LinkLengthLoop:public SimulationScheduler::ParallelFunction // Loop body measuring the layout lengths of ranges of links
+	{
+	/* Elements: */
+	private:
+	const ParticleSystem& particles; // Particle system defining the layout
+	const Network::LinkList& links; // Network links
+	Threads::Spinlock sumsMutex; // Mutex serializing access to the accumulated sums
+	public:
+	double sumLength,sumLength2; // Sums of link lengths and of their squares
+	
+	/* Constructors and destructors: */
+	LinkLengthLoop(const ParticleSystem& sParticles,const Network::LinkList& sLinks)
+		:particles(sParticles),links(sLinks),
+		 sumLength(0.0),sumLength2(0.0)
+		{
+		}
+	
+	/* Methods from class SimulationScheduler::ParallelFunction: */
+	virtual void operator()(Index begin,Index end)
+		{
+		double ls=0.0,ls2=0.0;
+		for(Index linkIndex=begin;linkIndex<end;++linkIndex)
+			{
+			const Link& link=links[linkIndex];
+			double length=double(Geometry::dist(particles.getParticlePosition(link.getNode(0)->getParticleIndex()),particles.getParticlePosition(link.getNode(1)->getParticleIndex())));
+			ls+=length;
+			ls2+=length*length;
+			}
+		
+		/* Add the range's sums to the totals: */
+		Threads::Spinlock::Lock sumsLock(sumsMutex);
+		sumLength+=ls;
+		sumLength2+=ls2;
+		}
+	};
+
+class NearestParticlesFunctor // Particle octree traversal class to find a given number of particles closest to a particle
+	{
+	/* Embedded classes: */
+	public:
+	typedef std::pair<Scalar,Index> Neighbor; // Type for found particles as pairs of squared distance and particle index
+	
+	/* Elements: */
+	private:
+	Index index; // Index of the particle whose neighbors to find
+	Point position; // Position of the particle whose neighbors to find
+	size_t maxNumNeighbors; // Number of neighbors to find
+	Scalar maxDist2; // Squared distance of the farthest found neighbor once enough have been found
+	std::vector<Neighbor>& neighbors; // Max-heap of the closest particles found so far
+	
+	/* Constructors and destructors: */
+	public:
+	NearestParticlesFunctor(Index sIndex,const Point& sPosition,size_t sMaxNumNeighbors,std::vector<Neighbor>& sNeighbors)
+		:index(sIndex),position(sPosition),maxNumNeighbors(sMaxNumNeighbors),
+		 maxDist2(Math::Constants<Scalar>::max),
+		 neighbors(sNeighbors)
+		{
+		neighbors.clear();
+		}
+	
+	/* Methods: */
+	const Point& getCenterPosition(void) const
+		{
+		return position;
+		}
+	Scalar getMaxDist2(void) const
+		{
+		return maxDist2;
+		}
+	void operator()(Index particleIndex,const Point& particlePosition,Scalar dist2)
+		{
+		if(particleIndex==index)
+			return;
+		
+		/* Replace the farthest found neighbor with the new particle once enough have been found: */
+		if(neighbors.size()==maxNumNeighbors)
+			{
+			std::pop_heap(neighbors.begin(),neighbors.end());
+			neighbors.pop_back();
+			}
+		neighbors.push_back(Neighbor(dist2,particleIndex));
+		std::push_heap(neighbors.begin(),neighbors.end());
+		
+		/* Only look for particles closer than the farthest found neighbor from now on: */
+		if(neighbors.size()==maxNumNeighbors)
+			maxDist2=neighbors.front().first;
+		}
+	};
+
+class NeighborhoodLoop:public SimulationScheduler::ParallelFunction // Loop body comparing graph and layout neighborhoods of ranges of sampled nodes
+	{
+	/* Elements: */
+	private:
+	const ParticleSystem& particles; // Particle system defining the layout
+	const Network::NodeList& nodes; // Network nodes
+	const Index* neighborOffsets; // Offsets of each node's list of linked nodes
+	const Index* neighbors; // Concatenated sorted lists of linked nodes
+	const Index* particleNodes; // Map from particle indices to node indices
+	Index numSamples; // Total number of sampled nodes
+	Threads::Spinlock sumsMutex; // Mutex serializing access to the accumulated sums
+	public:
+	double sumSimilarity; // Sum of neighborhood similarities
+	size_t numNodes; // Number of nodes included in the sum
+	
+	/* Constructors and destructors: */
+	NeighborhoodLoop(const ParticleSystem& sParticles,const Network::NodeList& sNodes,const Index* sNeighborOffsets,const Index* sNeighbors,const Index* sParticleNodes,Index sNumSamples)
+		:particles(sParticles),nodes(sNodes),neighborOffsets(sNeighborOffsets),neighbors(sNeighbors),particleNodes(sParticleNodes),numSamples(sNumSamples),
+		 sumSimilarity(0.0),numNodes(0)
+		{
+		}
+	
+	/* Methods from class SimulationScheduler::ParallelFunction: */
+	virtual void operator()(Index begin,Index end)
+		{
+		std::vector<NearestParticlesFunctor::Neighbor> closest;
+		std::vector<Index> closestNodes;
+		double ss=0.0;
+		size_t nn=0;
+		for(Index sampleIndex=begin;sampleIndex<end;++sampleIndex)
+			{
+			/* Spread the sampled nodes evenly over the node array so that repeated measurements use the same nodes: */
+			Index node=Index((Misc::UInt64(sampleIndex)*Misc::UInt64(nodes.size()))/Misc::UInt64(numSamples));
+			const Index* nBegin=neighbors+neighborOffsets[node];
+			const Index* nEnd=neighbors+neighborOffsets[node+1];
+			size_t degree=nEnd-nBegin;
+			if(degree==0)
+				continue;
+			
+			/* Find as many nodes closest to the node in the layout as the node has graph neighbors: */
+			Index particleIndex=nodes[node].getParticleIndex();
+			NearestParticlesFunctor npf(particleIndex,particles.getParticlePosition(particleIndex),degree,closest);
+			particles.processCloseParticles(npf);
+			closestNodes.clear();
+			for(std::vector<NearestParticlesFunctor::Neighbor>::iterator cIt=closest.begin();cIt!=closest.end();++cIt)
+				closestNodes.push_back(particleNodes[cIt->second]);
+			std::sort(closestNodes.begin(),closestNodes.end());
+			
+			/* Calculate the Jaccard similarity between the two sets of neighbors: */
+			size_t numShared=0;
+			std::vector<Index>::iterator cnIt=closestNodes.begin();
+			for(const Index* nPtr=nBegin;nPtr!=nEnd&&cnIt!=closestNodes.end();)
+				{
+				if(*nPtr<*cnIt)
+					++nPtr;
+				else if(*cnIt<*nPtr)
+					++cnIt;
+				else
+					{
+					++numShared;
+					++nPtr;
+					++cnIt;
+					}
+				}
+			ss+=double(numShared)/double(degree+closestNodes.size()-numShared);
+			++nn;
+			}
+		
+		/* Add the range's sums to the totals: */
+		Threads::Spinlock::Lock sumsLock(sumsMutex);
+		sumSimilarity+=ss;
+		numNodes+=nn;
+		}
+	};
+
+class CountOverlapsFunctor // Particle octree traversal class to count particles closer to a particle than a given distance
+	{
+	/* Elements: */
+	private:
+	Index index; // Index of the particle whose overlaps to count
+	Point position; // Position of the particle whose overlaps to count
+	Scalar maxDist2; // Squared overlap distance
+	public:
+	size_t numOverlaps; // Number of overlapping particles of larger index
+	
+	/* Constructors and destructors: */
+	CountOverlapsFunctor(Index sIndex,const Point& sPosition,Scalar sMaxDist2)
+		:index(sIndex),position(sPosition),maxDist2(sMaxDist2),
+		 numOverlaps(0)
+		{
+		}
+	
+	/* Methods: */
+	const Point& getCenterPosition(void) const
+		{
+		return position;
+		}
+	Scalar getMaxDist2(void) const
+		{
+		return maxDist2;
+		}
+	void operator()(Index particleIndex,const Point& particlePosition,Scalar dist2)
+		{
+		/* Count each overlapping pair only once: */
+		if(particleIndex>index)
+			++numOverlaps;
+		}
+	};
+
+class OverlapLoop:public SimulationScheduler::ParallelFunction // Loop body counting overlapping pairs of particles for ranges of particles
+	{
+	/* Elements: */
+	private:
+	const ParticleSystem& particles; // Particle system defining the layout
+	Scalar overlapDist2; // Squared overlap distance
+	Threads::Spinlock sumsMutex; // Mutex serializing access to the accumulated count
+	public:
+	size_t numOverlaps; // Number of overlapping pairs
+	
+	/* Constructors and destructors: */
+	OverlapLoop(const ParticleSystem& sParticles,Scalar sOverlapDist2)
+		:particles(sParticles),overlapDist2(sOverlapDist2),
+		 numOverlaps(0)
+		{
+		}
+	
+	/* Methods from class SimulationScheduler::ParallelFunction: */
+	virtual void operator()(Index begin,Index end)
+		{
+		size_t no=0;
+		for(Index particleIndex=begin;particleIndex<end;++particleIndex)
+			{
+			CountOverlapsFunctor cof(particleIndex,particles.getParticlePosition(particleIndex),overlapDist2);
+			particles.processCloseParticles(cof);
+			no+=cof.numOverlaps;
+			}
+		
+		/* Add the range's count to the total: */
+		Threads::Spinlock::Lock sumsLock(sumsMutex);
+		numOverlaps+=no;
+		}
+	};
+
+/****************
+Helper functions:
+****************/
+
+inline void runLoop(SimulationScheduler* scheduler,Index numItems,SimulationScheduler::ParallelFunction& function,Index minChunkSize =64) // Runs a loop using the given thread pool, or in the calling thread if the pool is null
+	{
+	if(scheduler!=0)
+		scheduler->parallelFor(numItems,function,minChunkSize);
+	else if(numItems>0)
+		function(0,numItems);
+	}
+
+}
+
+/******************************
+Methods of class LayoutQuality:
+******************************/
+
+LayoutQuality::LayoutQuality(const Network& sNetwork)
+	:network(sNetwork),
+	 numStressSources(32),numNeighborhoodSamples(4096),overlapDist(Scalar(0.1))
+	{
+	/* Count the links of each node: */
+	const Network::LinkList& links=network.getLinks();
+	Index numNodes=Index(network.getNodes().size());
+	neighborOffsets.resize(numNodes+1,0);
+	for(Network::LinkList::const_iterator lIt=links.begin();lIt!=links.end();++lIt)
+		if(lIt->getNodeIndex(0)!=lIt->getNodeIndex(1))
+			{
+			++neighborOffsets[lIt->getNodeIndex(0)+1];
+			++neighborOffsets[lIt->getNodeIndex(1)+1];
+			}
+	for(Index nodeIndex=0;nodeIndex<numNodes;++nodeIndex)
+		neighborOffsets[nodeIndex+1]+=neighborOffsets[nodeIndex];
+	
+	/* Collect the linked nodes of each node: */
+	neighbors.resize(neighborOffsets[numNodes]);
+	std::vector<Index> insertIndices(neighborOffsets.begin(),neighborOffsets.end()-1);
+	for(Network::LinkList::const_iterator lIt=links.begin();lIt!=links.end();++lIt)
+		if(lIt->getNodeIndex(0)!=lIt->getNodeIndex(1))
+			{
+			neighbors[insertIndices[lIt->getNodeIndex(0)]++]=lIt->getNodeIndex(1);
+			neighbors[insertIndices[lIt->getNodeIndex(1)]++]=lIt->getNodeIndex(0);
+			}
+	
+	/* Sort each node's list of linked nodes and remove nodes linked more than once: */
+	Index writeIndex=0;
+	for(Index nodeIndex=0;nodeIndex<numNodes;++nodeIndex)
+		{
+		std::vector<Index>::iterator nBegin=neighbors.begin()+neighborOffsets[nodeIndex];
+		std::vector<Index>::iterator nEnd=neighbors.begin()+neighborOffsets[nodeIndex+1];
+		std::sort(nBegin,nEnd);
+		neighborOffsets[nodeIndex]=writeIndex;
+		for(std::vector<Index>::iterator nIt=nBegin;nIt!=nEnd;++nIt)
+			if(writeIndex==neighborOffsets[nodeIndex]||neighbors[writeIndex-1]!=*nIt)
+				neighbors[writeIndex++]=*nIt;
+		}
+	neighborOffsets[numNodes]=writeIndex;
+	neighbors.resize(writeIndex);
+	}
+
+void LayoutQuality::setNumStressSources(Index newNumStressSources)
+	{
+	numStressSources=newNumStressSources;
+	}
+
+void LayoutQuality::setNumNeighborhoodSamples(Index newNumNeighborhoodSamples)
+	{
+	numNeighborhoodSamples=newNumNeighborhoodSamples;
+	}
+
+void LayoutQuality::setOverlapDist(Scalar newOverlapDist)
+	{
+	overlapDist=newOverlapDist;
+	}
+
+void LayoutQuality::calcMetrics(const ParticleSystem& particles,SimulationScheduler* scheduler,LayoutQuality::Metrics& metrics)
+	{
+	Realtime::TimePointMonotonic timer;
+	const Network::NodeList& nodes=network.getNodes();
+	Index numNodes=Index(nodes.size());
+	metrics=Metrics();
+	if(numNodes==0)
+		return;
+	
+	/* Map particle indices back to node indices: */
+	particleNodes.assign(particles.getNumParticles(),0);
+	for(Index nodeIndex=0;nodeIndex<numNodes;++nodeIndex)
+		particleNodes[nodes[nodeIndex].getParticleIndex()]=nodeIndex;
+	
+	/* Calculate stress against graph distances from evenly spaced source nodes, one breadth-first search per loop item: */
+	Index numSources=std::min(numStressSources,numNodes);
+	if(numSources>0)
+		{
+		StressLoop sl(particles,nodes,&neighborOffsets.front(),neighbors.empty()?0:&neighbors.front(),numSources);
+		runLoop(scheduler,numSources,sl,1);
+		
+		/* Normalize stress by the optimal scale between layout and graph distances: */
+		metrics.numStressPairs=sl.numPairs;
+		if(sl.sumRatio2>0.0)
+			metrics.stress=1.0-(sl.sumRatio*sl.sumRatio)/(double(sl.numPairs)*sl.sumRatio2);
+		}
+	
+	/* Calculate the mean and coefficient of variation of link lengths: */
+	const Network::LinkList& links=network.getLinks();
+	if(!links.empty())
+		{
+		LinkLengthLoop lll(particles,links);
+		runLoop(scheduler,Index(links.size()),lll);
+		double numLinks=double(links.size());
+		metrics.meanLinkLength=lll.sumLength/numLinks;
+		if(metrics.meanLinkLength>0.0)
+			metrics.linkLengthCV=Math::sqrt(Math::max(lll.sumLength2/numLinks-Math::sqr(metrics.meanLinkLength),0.0))/metrics.meanLinkLength;
+		}
+	
+	/* Compare graph and layout neighborhoods of evenly spaced sampled nodes: */
+	Index numSamples=numNeighborhoodSamples>0?std::min(numNeighborhoodSamples,numNodes):numNodes;
+	NeighborhoodLoop nl(particles,nodes,&neighborOffsets.front(),neighbors.empty()?0:&neighbors.front(),&particleNodes.front(),numSamples);
+	runLoop(scheduler,numSamples,nl);
+	metrics.numNeighborhoodNodes=nl.numNodes;
+	if(nl.numNodes>0)
+		metrics.neighborhoodPreservation=nl.sumSimilarity/double(nl.numNodes);
+	
+	/* Count overlapping pairs of nodes using the particle octree: */
+	OverlapLoop ol(particles,Math::sqr(overlapDist));
+	runLoop(scheduler,particles.getNumParticles(),ol);
+	metrics.numOverlaps=ol.numOverlaps;
+	
+	metrics.calcTime=double(timer.setAndDiff());
+	}
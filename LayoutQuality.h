@@ -0,0 +1,86 @@
+/***********************************************************************
+LayoutQuality - Class to measure the quality of a network layout
+represented by the particles of a particle system, using sampled stress,
+the variation of link lengths, the preservation of graph neighborhoods,
+and the number of overlapping nodes.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef LAYOUTQUALITY_INCLUDED
+#define LAYOUTQUALITY_INCLUDED
+
+#include <stddef.h>
+#include <vector>
+
+#include "ParticleTypes.h"
+
+/* Forward declarations: */
+class ParticleSystem;
+class Network;
+class SimulationScheduler;
+
+class LayoutQuality
+	{
+	/* Embedded classes: */
+	public:
+	struct Metrics // Structure holding the quality metrics of one layout
+		{
+		/* Elements: */
+		public:
+		double stress; // Scale-normalized stress between layout distances and graph distances over sampled node pairs, in [0, 1]; 0 if all layout distances are proportional to graph distances
+		size_t numStressPairs; // Number of node pairs over which stress was calculated
+		double meanLinkLength; // Average length of all links in the layout
+		double linkLengthCV; // Coefficient of variation of the lengths of all links in the layout
+		double neighborhoodPreservation; // Average Jaccard similarity between sampled nodes' graph neighbors and as many nearest neighbors in the layout, in [0, 1]
+		size_t numNeighborhoodNodes; // Number of nodes over which neighborhood preservation was calculated
+		size_t numOverlaps; // Number of pairs of nodes that are closer to each other than the overlap distance
+		double calcTime; // Time spent calculating the metrics in seconds
+		
+		/* Constructors and destructors: */
+		Metrics(void)
+			:stress(0.0),numStressPairs(0),
+			 meanLinkLength(0.0),linkLengthCV(0.0),
+			 neighborhoodPreservation(0.0),numNeighborhoodNodes(0),
+			 numOverlaps(0),calcTime(0.0)
+			{
+			}
+		};
+	
+	/* Elements: */
+	private:
+	const Network& network; // The network whose layouts are measured
+	std::vector<Index> neighborOffsets; // Offsets of each node's list of linked nodes
+	std::vector<Index> neighbors; // Concatenated sorted lists of distinct nodes linked to each node
+	Index numStressSources; // Number of nodes from which graph distances are calculated for stress
+	Index numNeighborhoodSamples; // Number of nodes whose neighborhoods are compared
+	Scalar overlapDist; // Distance below which two nodes count as overlapping
+	std::vector<Index> particleNodes; // Map from particle indices to node indices, rebuilt for each calculation
+	
+	/* Constructors and destructors: */
+	public:
+	LayoutQuality(const Network& sNetwork); // Prepares to measure layouts of the given network
+	
+	/* Methods: */
+	void setNumStressSources(Index newNumStressSources); // Sets the number of nodes from which graph distances are calculated; stress runs one breadth-first search per source
+	void setNumNeighborhoodSamples(Index newNumNeighborhoodSamples); // Sets the number of nodes whose neighborhoods are compared; 0 compares all nodes
+	void setOverlapDist(Scalar newOverlapDist); // Sets the distance below which two nodes count as overlapping
+	void calcMetrics(const ParticleSystem& particles,SimulationScheduler* scheduler,Metrics& metrics); // Calculates quality metrics of the layout defined by the given particle system, which must have been created from the network, using the given thread pool or the calling thread if the pool is null
+	};
+
+#endif
@@ -1,6 +1,6 @@
 /***********************************************************************
-Network - Class representing a network of nodes and links parsed from a
-json file.
+Network - Class representing the topology of a network of nodes and
+links parsed from a json file, and its set of selected nodes.
 Copyright (c) 2019-2023 Oliver Kreylos
 
 This file is part of the Network Viewer.
@@ -23,16 +23,13 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include "Network.h"
 
 #include <string>
-#include <deque>
-#include <algorithm>
 #include <stdexcept>
+#include <stdlib.h>
+#include <stdio.h>
 #include <Misc/StringHashFunctions.h>
 #include <Misc/MessageLogger.h>
-#include <Misc/ConvertColorComponent.h>
 #include <IO/File.h>
 #include <Math/Math.h>
-#include <Math/Random.h>
-#include <Math/Interval.h>
 
 #include "JsonEntity.h"
 #include "JsonBoolean.h"
@@ -41,6 +38,7 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include "JsonMap.h"
 #include "JsonFile.h"
 #include "ParticleSystem.h"
+#include "SelectionRegion.h"
 
 /************************
 Methods of class Network:
@@ -82,38 +80,8 @@ Network::Network(IO::File& networkFile)
 	// DEBUGGING
 	Misc::formattedLogNote("Network: Parsed %u nodes",(unsigned int)(nodes.size()));
 	
-	/* Initialize the node color mapping: */
-	nodeColors.clear();
-	nodeColors.reserve(nodes.size());
-	for(NodeList::iterator nIt=nodes.begin();nIt!=nodes.end();++nIt)
-		nodeColors.push_back(nIt->getColor());
-	mapNodeColorsFromNode();
-	
-	/* Collect the names of all properties appearing in the network's nodes: */
-	{
-	Misc::HashTable<std::string,void> nodePropertyNameMap(17);
-	for(JsonList::List::iterator nIt=jsonNodes->getList().begin();nIt!=jsonNodes->getList().end();++nIt)
-		{
-		/* Iterate through the node's properties: */
-		const JsonMap::Map& nodeProperties=JsonMapPointer(*nIt)->getMap();
-		for(JsonMap::Map::ConstIterator npIt=nodeProperties.begin();!npIt.isFinished();++npIt)
-			{
-			/* Collect the property's name: */
-			nodePropertyNameMap.setEntry(Misc::HashTable<std::string,void>::Entry(npIt->getSource()));
-			}
-		}
-	
-	/* Put the collected property names into a list: */
-	nodePropertyNames.reserve(nodePropertyNameMap.getNumEntries());
-	for(Misc::HashTable<std::string,void>::Iterator npnIt=nodePropertyNameMap.begin();!npnIt.isFinished();++npnIt)
-		nodePropertyNames.push_back(npnIt->getSource());
-	}
-	
-	/* Sort the list of node property names: */
-	std::sort(nodePropertyNames.begin(),nodePropertyNames.end());
-	
-	/* Find the link list: */
-	jsonLinks=JsonListPointer(jsonRoot->getProperty("links"));
+	/* Find the link list; it is released once the links are parsed: */
+	JsonListPointer jsonLinks(jsonRoot->getProperty("links"));
 	if(jsonLinks==0)
 		throw std::runtime_error("Network::Network: Links entity is not a list");
 	
@@ -141,33 +109,42 @@ Network::Network(IO::File& networkFile)
 	
 	// DEBUGGING
 	Misc::formattedLogNote("Network: Parsed %u links",(unsigned int)(links.size()));
+	}
+
+Network::Network(unsigned int numNodes,const std::vector<unsigned int>& linkNodeIndices)
+	:selection(17)
+	{
+	/* Create the nodes: */
+	nodes.reserve(numNodes);
+	char idBuffer[16];
+	for(unsigned int nodeIndex=0;nodeIndex<numNodes;++nodeIndex)
+		{
+		snprintf(idBuffer,sizeof(idBuffer),"%u",nodeIndex);
+		nodes.push_back(Node(idBuffer,nodeIndex));
+		}
 	
-	/* Create a color map for node distances: */
-	static const GLColorMap::Color sdColors[6]=
+	/* Create the links: */
+	links.reserve(linkNodeIndices.size()/2);
+	for(std::vector<unsigned int>::const_iterator lniIt=linkNodeIndices.begin();lniIt+1<linkNodeIndices.end();lniIt+=2)
 		{
-		GLColorMap::Color(1.0f,0.0f,0.0f),
-		GLColorMap::Color(1.0f,1.0f,0.0f),
-		GLColorMap::Color(0.0f,1.0f,0.0f),
-		GLColorMap::Color(0.0f,1.0f,1.0f),
-		GLColorMap::Color(0.0f,0.0f,1.0f),
-		GLColorMap::Color(1.0f,0.0f,1.0f)
-		};
-	GLdouble sdKeys[6];
-	for(int i=0;i<6;++i)
-		sdKeys[i]=double(i);
-	selectionDistanceMap.setColors(6,sdColors,sdKeys);
+		unsigned int sourceIndex=lniIt[0];
+		unsigned int targetIndex=lniIt[1];
+		if(sourceIndex>=numNodes||targetIndex>=numNodes)
+			throw std::runtime_error("Network::Network: Link refers to non-existing node");
+		links.push_back(Link(&nodes[sourceIndex],sourceIndex,&nodes[targetIndex],targetIndex,Scalar(1)));
+		
+		/* Connect the two linked nodes: */
+		nodes[sourceIndex].addLinkedNode(&nodes[targetIndex]);
+		nodes[targetIndex].addLinkedNode(&nodes[sourceIndex]);
+		}
 	}
 
 Network::~Network(void)
 	{
 	}
 
-void Network::mapNodeColorsFromNode(void)
+void Network::selectionChanged(void)
 	{
-	/* Set all nodes' colors to their color properties' values: */
-	ColorList::iterator ncIt=nodeColors.begin();
-	for(NodeList::iterator nIt=nodes.begin();nIt!=nodes.end();++nIt,++ncIt)
-		*ncIt=nIt->getColor();
 	}
 
 namespace {
@@ -176,175 +153,41 @@ namespace {
 Helper functions:
 ****************/
 
-Node::Color randomColor(void)
-	{
-	typedef Misc::ColorComponentTraits<Node::Color::Scalar> NodeColorTraits;
-	Node::Color result;
-	for(int i=0;i<3;++i)
-		result[i]=Node::Color::Scalar(Math::randUniformCC(NodeColorTraits::zero,NodeColorTraits::one));
-	result[3]=NodeColorTraits::one;
-	return result;
-	}
-
-Node::Color convertColor(const GLColorMap::Color& glColor)
-	{
-	Node::Color result;
-	for(int i=0;i<4;++i)
-		result[i]=Misc::convertColorComponent<Node::Color::Scalar,GLColorMap::Color::Scalar>(glColor[i]);
-	return result;
-	}
-
-}
-
-void Network::mapNodeColorsFromNodeProperty(const std::string& propertyName,GLColorMap& numericalPropertyValueMap)
+template <class ValueParam>
+inline
+bool
+compareValues(
+	const ValueParam& value,
+	int comparison,
+	const ValueParam& reference)
 	{
-	/* Collect the set of values of the given property from all nodes: */
-	Misc::HashTable<bool,Node::Color> booleanValueColors(17);
-	Misc::HashTable<std::string,Node::Color> stringValueColors(17);
-	Math::Interval<double> numberValueRange=Math::Interval<double>::empty;
-	for(JsonList::List::iterator nIt=jsonNodes->getList().begin();nIt!=jsonNodes->getList().end();++nIt)
+	switch(comparison)
 		{
-		/* Get the map of node properties and check if the node has the requested property: */
-		JsonMapPointer nodeMap(*nIt);
-		if(nodeMap->hasProperty(propertyName))
-			{
-			/* Get the property's value and handle it based on its type: */
-			JsonPointer value=nodeMap->getProperty(propertyName);
-			switch(value->getType())
-				{
-				case JsonEntity::BOOLEAN:
-					{
-					bool bValue=getBoolean(value);
-					if(!booleanValueColors.isEntry(bValue))
-						booleanValueColors[bValue]=randomColor();
-					break;
-					}
-				
-				case JsonEntity::NUMBER:
-					numberValueRange.addValue(getNumber(value));
-					break;
-				
-				case JsonEntity::STRING:
-					{
-					const std::string& sValue=getString(value);
-					if(!stringValueColors.isEntry(sValue))
-						stringValueColors[sValue]=randomColor();
-					break;
-					}
-				
-				default:
-					;
-				}
-			}
-		}
-	
-	/* Assign colors to all nodes: */
-	numericalPropertyValueMap.setScalarRange(numberValueRange.getMin(),numberValueRange.getMax());
-	ColorList::iterator ncIt=nodeColors.begin();
-	for(JsonList::List::iterator nIt=jsonNodes->getList().begin();nIt!=jsonNodes->getList().end();++nIt,++ncIt)
-		{
-		/* Get the map of node properties and check if the node has the requested property: */
-		JsonMapPointer nodeMap(*nIt);
-		if(nodeMap->hasProperty(propertyName))
-			{
-			/* Get the property's value and handle it based on its type: */
-			JsonPointer value=nodeMap->getProperty(propertyName);
-			switch(value->getType())
-				{
-				case JsonEntity::BOOLEAN:
-					*ncIt=booleanValueColors[getBoolean(value)].getDest();
-					break;
-				
-				case JsonEntity::NUMBER:
-					*ncIt=convertColor(numericalPropertyValueMap(getNumber(value)));
-					break;
-				
-				case JsonEntity::STRING:
-					*ncIt=stringValueColors[getString(value)].getDest();
-					break;
-				
-				default:
-					/* Color nodes with unsupported property types grey: */
-					*ncIt=Node::Color(128U,128U,128U);
-				}
-			}
-		else
-			{
-			/* Color nodes without the requested property grey: */
-			*ncIt=Node::Color(128U,128U,128U);
-			}
-		}
-	}
-
-void Network::mapNodeColorsFromSelectionDistance(void)
-	{
-	/* Calculate the distance of all nodes from the current selection: */
-	unsigned int numNodes=(unsigned int)(nodes.size());
-	std::vector<unsigned int> nodeDistances;
-	nodeDistances.reserve(numNodes);
-	for(NodeList::iterator nIt=nodes.begin();nIt!=nodes.end();++nIt)
-		nodeDistances.push_back(numNodes);
-	
-	/* Initialize the distance of all selected nodes to zero and add them into the breadth-first queue: */
-	std::deque<unsigned int> queue;
-	for(Selection::Iterator sIt=selection.begin();!sIt.isFinished();++sIt)
-		{
-		nodeDistances[sIt->getSource()]=0;
-		queue.push_back(sIt->getSource());
-		}
-	
-	/* Traverse connected nodes in breadth-first order: */
-	unsigned int maxNodeDistance=0;
-	while(!queue.empty())
-		{
-		/* Grab the next node in the breadth-first queue: */
-		unsigned int nodeIndex=queue.front();
-		queue.pop_front();
-		Node& node=nodes[nodeIndex];
+		case SelectionRegion::Equal:
+			return value==reference;
 		
-		/* Assign distances to all nodes connected to the next node in the queue: */
-		unsigned int nodeDistance=nodeDistances[nodeIndex];
-		for(std::vector<Node*>::const_iterator lnIt=node.getLinkedNodes().begin();lnIt!=node.getLinkedNodes().end();++lnIt)
-			{
-			/* Get the linked node's index: */
-			unsigned int linkedNodeIndex=*lnIt-&nodes.front();
-			
-			/* Check if the linked node has not yet been visited: */
-			if(nodeDistances[linkedNodeIndex]==numNodes)
-				{
-				/* Assign a distance to the linked node and add it into the breadth-first queue: */
-				nodeDistances[linkedNodeIndex]=nodeDistance+1;
-				if(maxNodeDistance<nodeDistance+1)
-					maxNodeDistance=nodeDistance+1;
-				queue.push_back(linkedNodeIndex);
-				}
-			else
-				{
-				/* Check that the linked node does not have a larger distance than as a neighbor of the next node: */
-				if(nodeDistances[linkedNodeIndex]>nodeDistance+1)
-					throw std::runtime_error("NetworkViewer::mapNodeColorsFromSelectionDistance: Took the long way around in network traversal");
-				}
-			}
-		}
-	
-	/* Assign colors to nodes based on their computed distances: */
-	selectionDistanceMap.setScalarRange(0.0,double(maxNodeDistance));
-	std::vector<unsigned int>::iterator ndIt=nodeDistances.begin();
-	for(ColorList::iterator ncIt=nodeColors.begin();ncIt!=nodeColors.end();++ncIt,++ndIt)
-		{
-		if(*ndIt<numNodes)
-			{
-			/* Assign a color based on the distance color map: */
-			*ncIt=convertColor(selectionDistanceMap(double(*ndIt)));
-			}
-		else
-			{
-			/* Color unconnected nodes grey: */
-			*ncIt=Node::Color(128U,128U,128U);
-			}
+		case SelectionRegion::NotEqual:
+			return value!=reference;
+		
+		case SelectionRegion::Less:
+			return value<reference;
+		
+		case SelectionRegion::LessEqual:
+			return value<=reference;
+		
+		case SelectionRegion::Greater:
+			return value>reference;
+		
+		case SelectionRegion::GreaterEqual:
+			return value>=reference;
+		
+		default:
+			return false;
 		}
 	}
 
+}
+
 void Network::createParticles(ParticleSystem& particles,Scalar linkStrength)
 	{
 	/* Calculate an appropriate domain size: */
@@ -367,8 +210,8 @@ void Network::clearSelection(void)
 	/* Clear the selection set: */
 	selection.clear();
 	
-	/* Color nodes from their color property: */
-	mapNodeColorsFromNode();
+	/* Notify derived classes of the change: */
+	selectionChanged();
 	}
 
 void Network::setSelection(unsigned int nodeIndex)
@@ -379,8 +222,8 @@ void Network::setSelection(unsigned int nodeIndex)
 	/* Select the given node: */
 	selection.setEntry(Selection::Entry(nodeIndex));
 	
-	/* Color nodes by distance to the selection: */
-	mapNodeColorsFromSelectionDistance();
+	/* Notify derived classes of the change: */
+	selectionChanged();
 	}
 
 void Network::selectNode(unsigned int nodeIndex)
@@ -388,8 +231,8 @@ void Network::selectNode(unsigned int nodeIndex)
 	/* Select the given node: */
 	selection.setEntry(Selection::Entry(nodeIndex));
 	
-	/* Color nodes by distance to the selection: */
-	mapNodeColorsFromSelectionDistance();
+	/* Notify derived classes of the change: */
+	selectionChanged();
 	}
 
 void Network::deselectNode(unsigned int nodeIndex)
@@ -397,16 +240,8 @@ void Network::deselectNode(unsigned int nodeIndex)
 	/* Deselect the given node: */
 	selection.removeEntry(nodeIndex);
 	
-	if(selection.getNumEntries()!=0)
-		{
-		/* Color nodes by distance to the selection: */
-		mapNodeColorsFromSelectionDistance();
-		}
-	else
-		{
-		/* Color nodes from their color property: */
-		mapNodeColorsFromNode();
-		}
+	/* Notify derived classes of the change: */
+	selectionChanged();
 	}
 
 void Network::growSelection(void)
@@ -432,8 +267,8 @@ void Network::growSelection(void)
 			}
 		}
 	
-	/* Color nodes by distance to the selection: */
-	mapNodeColorsFromSelectionDistance();
+	/* Notify derived classes of the change: */
+	selectionChanged();
 	}
 
 void Network::shrinkSelection(void)
@@ -466,6 +301,108 @@ void Network::shrinkSelection(void)
 		selection.removeEntry(*dnIt);
 		}
 	
-	/* Color nodes by distance to the selection: */
-	mapNodeColorsFromSelectionDistance();
+	/* Notify derived classes of the change: */
+	selectionChanged();
+	}
+
+void Network::selectNodes(const std::vector<unsigned int>& nodeIndices,int mode)
+	{
+	/* Clear the selection set if it is to be replaced: */
+	if(mode==3)
+		selection.clear();
+	
+	/* Change the selection state of all given nodes: */
+	for(std::vector<unsigned int>::const_iterator niIt=nodeIndices.begin();niIt!=nodeIndices.end();++niIt)
+		{
+		switch(mode)
+			{
+			case 0: // Select node
+			case 3: // Replace selection
+				selection.setEntry(Selection::Entry(*niIt));
+				break;
+			
+			case 1: // Deselect node
+				selection.removeEntry(*niIt);
+				break;
+			
+			case 2: // Toggle node's selection state
+				if(selection.isEntry(*niIt))
+					selection.removeEntry(*niIt);
+				else
+					selection.setEntry(Selection::Entry(*niIt));
+				break;
+			}
+		}
+	
+	/* Notify derived classes of the entire change only once: */
+	selectionChanged();
+	}
+
+void Network::findNodesByProperty(const std::string& propertyName,int comparison,const std::string& value,std::vector<unsigned int>& nodeIndices) const
+	{
+	/* Networks that were not parsed from a file have no node properties: */
+	if(jsonNodes==0)
+		return;
+	
+	/* Convert the reference value to the supported property types once: */
+	double numberValue=atof(value.c_str());
+	bool booleanValue=value=="true"||value=="1";
+	
+	/* Test all nodes' properties: */
+	unsigned int nodeIndex=0;
+	for(JsonList::List::iterator nIt=jsonNodes->getList().begin();nIt!=jsonNodes->getList().end();++nIt,++nodeIndex)
+		{
+		/* Get the map of node properties and check if the node has the requested property: */
+		JsonMapPointer nodeMap(*nIt);
+		if(nodeMap->hasProperty(propertyName))
+			{
+			/* Compare the property's value based on its type: */
+			JsonPointer property=nodeMap->getProperty(propertyName);
+			bool match=false;
+			switch(property->getType())
+				{
+				case JsonEntity::BOOLEAN:
+					match=compareValues(getBoolean(property),comparison,booleanValue);
+					break;
+				
+				case JsonEntity::NUMBER:
+					match=compareValues(getNumber(property),comparison,numberValue);
+					break;
+				
+				case JsonEntity::STRING:
+					match=compareValues(getString(property),comparison,value);
+					break;
+				
+				default:
+					;
+				}
+			if(match)
+				nodeIndices.push_back(nodeIndex);
+			}
+		}
+	}
+
+size_t Network::getMemorySize(void) const
+	{
+	/* Add up the network's node and link arrays: */
+	size_t result=sizeof(Network);
+	for(NodeList::const_iterator nIt=nodes.begin();nIt!=nodes.end();++nIt)
+		result+=nIt->getMemorySize();
+	result+=(nodes.capacity()-nodes.size())*sizeof(Node);
+	result+=links.capacity()*sizeof(Link);
+	
+	/* Add the selection set's hash table entries and their bucket chain pointers: */
+	result+=selection.getNumEntries()*(sizeof(Selection::Entry)+sizeof(void*));
+	
+	return result;
+	}
+
+size_t Network::getDomMemorySize(void) const
+	{
+	/* Add up the node list retained from the network file: */
+	size_t result=0;
+	if(jsonNodes!=0)
+		result+=jsonNodes->getMemorySize();
+	
+	return result;
 	}
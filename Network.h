@@ -1,6 +1,6 @@
 /***********************************************************************
-Network - Class representing a network of nodes and links parsed from a
-json file.
+Network - Class representing the topology of a network of nodes and
+links parsed from a json file, and its set of selected nodes.
 Copyright (c) 2019-2023 Oliver Kreylos
 
 This file is part of the Network Viewer.
@@ -27,8 +27,6 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <vector>
 #include <Misc/StandardHashFunction.h>
 #include <Misc/HashTable.h>
-#include <GL/gl.h>
-#include <GL/GLColorMap.h>
 
 #include "ParticleTypes.h"
 #include "JsonList.h"
@@ -40,7 +38,6 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 namespace IO {
 class File;
 }
-class GLColorMap;
 class ParticleSystem;
 
 class Network
@@ -48,48 +45,37 @@ class Network
 	/* Embedded classes: */
 	public:
 	typedef std::vector<Node> NodeList;
-	typedef std::vector<Node::Color> ColorList;
 	typedef std::vector<Link> LinkList;
-	typedef std::vector<std::string> StringList;
 	typedef Misc::HashTable<unsigned int,void> Selection; // Type of hash tables to mark selected nodes
 	
 	/* Elements: */
+	protected:
+	JsonListPointer jsonNodes; // Pointer to the list of node entities parsed from the network json file; retained to query node properties
 	private:
-	JsonListPointer jsonNodes; // Pointer to the list of node entities parsed from the network json file
-	JsonListPointer jsonLinks; // Pointer to the list of link entities parsed from the network json file
 	NodeList nodes; // List of nodes
-	ColorList nodeColors; // Current color values assigned to each node
-	StringList nodePropertyNames; // List of names of all node properties defined in the network json file
 	LinkList links; // List of links
 	Selection selection; // Set of currenty selected nodes
-	GLColorMap selectionDistanceMap; // Color map mapping node distances from the selection to colors
+	
+	/* Protected methods: */
+	protected:
+	virtual void selectionChanged(void); // Called after every change to the set of selected nodes; does nothing in the base class
 	
 	/* Constructors and destructors: */
 	public:
 	Network(IO::File& networkFile); // Parses a network from a json file
+	Network(unsigned int numNodes,const std::vector<unsigned int>& linkNodeIndices); // Creates a network of the given number of nodes named by their indices, linking each consecutive pair of node indices in the given list
 	private:
 	Network(const Network& source); // Prohibit copy constructor
 	Network& operator=(const Network& source); // Prohibit assignment operator
 	public:
-	~Network(void); // Destroys the network
+	virtual ~Network(void); // Destroys the network
 	
 	/* Methods: */
-	void mapNodeColorsFromNode(void); // Retrieves node colors from the nodes' color properties
-	void mapNodeColorsFromNodeProperty(const std::string& propertyName,GLColorMap& numericalPropertyValueMap); // Colors nodes by their values of the given property
-	void mapNodeColorsFromSelectionDistance(void); // Colors nodes by their distance from the current selection
 	void createParticles(ParticleSystem& particles,Scalar linkStrength); // Creates particles representing the network's nodes and distance constraints representing its links
 	const NodeList& getNodes(void) const // Returns the array of nodes
 		{
 		return nodes;
 		}
-	const ColorList& getNodeColors(void) const // Returns the array of node colors
-		{
-		return nodeColors;
-		}
-	const StringList& getNodePropertyNames(void) const // Returns the list of all node property names found in the network json file
-		{
-		return nodePropertyNames;
-		}
 	const LinkList& getLinks(void) const // Returns the array of links
 		{
 		return links;
@@ -98,12 +84,20 @@ class Network
 		{
 		return JsonMapPointer(jsonNodes->getItem(nodeIndex))->getMap();
 		}
+	JsonMapPointer getNodePropertyMap(unsigned int nodeIndex) const // Returns a pointer to the property map of the node of the given index, which keeps the properties alive independently of the network
+		{
+		return JsonMapPointer(jsonNodes->getItem(nodeIndex));
+		}
 	void clearSelection(void); // De-selects all selected nodes
 	void setSelection(unsigned int nodeIndex); // Selects only the node of the given index
 	void selectNode(unsigned int nodeIndex); // Adds the node of the given index to the selection
 	void deselectNode(unsigned int nodeIndex); // Removes the node of the given index from the selection
 	void growSelection(void); // Selects all nodes that are directly linked to already selected nodes
 	void shrinkSelection(void); // De-selects all nodes that are linked to nodes that are not currently selected
+	void selectNodes(const std::vector<unsigned int>& nodeIndices,int mode); // Changes the selection state of a set of nodes and recolors nodes only once; mode 0: select, 1: deselect, 2: toggle, 3: replace selection
+	void findNodesByProperty(const std::string& propertyName,int comparison,const std::string& value,std::vector<unsigned int>& nodeIndices) const; // Appends the indices of all nodes whose given property compares to the given value in increasing order; comparison is a SelectionRegion::Comparison
+	size_t getMemorySize(void) const; // Returns an estimate of the memory used by the network's node, link, and selection structures in bytes
+	size_t getDomMemorySize(void) const; // Returns an estimate of the memory used by the json node entities retained from the network file in bytes
 	const Selection& getSelection(void) const // Returns the set of currently selected nodes
 		{
 		return selection;
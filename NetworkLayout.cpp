@@ -0,0 +1,336 @@
+/***********************************************************************
+NetworkLayout - Headless utility to calculate the layout of a network by
+running the network simulation without a display until it converges or
+reaches a step limit, and to write the resulting node positions to a
+binary or json file.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <Misc/Endianness.h>
+#include <IO/File.h>
+#include <IO/OpenFile.h>
+#include <Threads/Spinlock.h>
+#include <Threads/FunctionCalls.h>
+#include <Realtime/Time.h>
+#include <Math/Math.h>
+#include <Math/Constants.h>
+
+#include "ParticleTypes.h"
+#include "ParticleSystem.h"
+#include "Node.h"
+#include "Network.h"
+#include "SimulationParameters.h"
+#include "SimulationScheduler.h"
+#include "NetworkSimulator.h"
+#include "Tracer.h"
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+class LayoutMonitor // Class to track the progress of a layout from the simulation thread and to decide when it is finished
+	{
+	/* Elements: */
+	private:
+	Scalar tolerance; // Root-mean-square distance by which nodes move during a step below which the layout is considered converged
+	unsigned long maxNumSteps; // Maximum number of simulation steps to run
+	std::vector<Point> positions; // Node positions as of the most recent simulation update
+	Threads::Spinlock progressMutex; // Mutex serializing access to the progress state
+	unsigned long numSteps; // Number of simulation updates received so far
+	Scalar displacement; // Root-mean-square distance by which nodes moved during the most recent step
+	bool converged; // Flag whether the layout converged before reaching the step limit
+	volatile bool finished; // Flag whether the layout is finished; no more updates will be processed once set
+	
+	/* Constructors and destructors: */
+	public:
+	LayoutMonitor(Scalar sTolerance,unsigned long sMaxNumSteps)
+		:tolerance(sTolerance),maxNumSteps(sMaxNumSteps),
+		 numSteps(0),displacement(Math::Constants<Scalar>::max),converged(false),finished(false)
+		{
+		}
+	
+	/* Methods: */
+	void simulationUpdateCallback(const ParticleSystem& particles) // Called from the simulation thread after every simulation step
+		{
+		/* Ignore updates after the layout is finished: */
+		if(finished)
+			return;
+		
+		/* Calculate the distance by which all nodes moved since the previous update and copy their new positions: */
+		Index numParticles=particles.getNumParticles();
+		Scalar newDisplacement=Math::Constants<Scalar>::max;
+		if(positions.size()==numParticles&&numParticles>0)
+			{
+			Scalar sumDist2(0);
+			for(Index i=0;i<numParticles;++i)
+				{
+				const Point& p=particles.getParticlePosition(i);
+				sumDist2+=Geometry::sqrDist(positions[i],p);
+				positions[i]=p;
+				}
+			newDisplacement=Math::sqrt(sumDist2/Scalar(numParticles));
+			}
+		else if(numParticles>0)
+			positions.assign(&particles.getParticlePosition(0),&particles.getParticlePosition(0)+numParticles);
+		
+		/* Update the progress state and check whether the layout is finished: */
+		Threads::Spinlock::Lock progressLock(progressMutex);
+		++numSteps;
+		displacement=newDisplacement;
+		converged=displacement<tolerance;
+		if(converged||numSteps>=maxNumSteps)
+			finished=true;
+		}
+	bool isFinished(void) const // Returns true if the layout is finished
+		{
+		return finished;
+		}
+	void getProgress(unsigned long& resultNumSteps,Scalar& resultDisplacement,bool& resultConverged) // Returns the current progress state
+		{
+		Threads::Spinlock::Lock progressLock(progressMutex);
+		resultNumSteps=numSteps;
+		resultDisplacement=displacement;
+		resultConverged=converged;
+		}
+	const std::vector<Point>& getPositions(void) const // Returns the final node positions; must only be called after the simulation was suspended
+		{
+		return positions;
+		}
+	};
+
+/****************
+Helper functions:
+****************/
+
+const char layoutFileTag[32]="Network Viewer Layout 1.0\n"; // Tag at the beginning of a binary layout file
+
+void writeBinaryLayout(const char* fileName,const std::vector<Point>& positions) // Writes the given node positions to a binary file
+	{
+	IO::FilePtr file=IO::openFile(fileName,IO::File::WriteOnly);
+	file->setEndianness(Misc::LittleEndian);
+	
+	/* Write the file header followed by all node positions in network file order: */
+	file->write(layoutFileTag,sizeof(layoutFileTag));
+	file->write(Misc::UInt32(positions.size()));
+	for(std::vector<Point>::const_iterator pIt=positions.begin();pIt!=positions.end();++pIt)
+		for(int i=0;i<3;++i)
+			file->write(Misc::Float64((*pIt)[i]));
+	}
+
+void writeJsonString(FILE* file,const std::string& string) // Writes the given string to the given file as a quoted json string
+	{
+	fputc('\"',file);
+	for(std::string::const_iterator sIt=string.begin();sIt!=string.end();++sIt)
+		{
+		if(*sIt=='\"'||*sIt=='\\')
+			fprintf(file,"\\%c",*sIt);
+		else if((unsigned char)(*sIt)<0x20U)
+			fprintf(file,"\\u%04x",(unsigned int)(*sIt));
+		else
+			fputc(*sIt,file);
+		}
+	fputc('\"',file);
+	}
+
+void writeJsonLayout(const char* fileName,const Network& network,const std::vector<Point>& positions) // Writes the given node positions and the IDs of the given network's nodes to a json file
+	{
+	FILE* file=fopen(fileName,"w");
+	if(file==0)
+		throw std::runtime_error(std::string("writeJsonLayout: Unable to create file ")+fileName);
+	
+	/* Write one entry per node: */
+	fprintf(file,"{\n  \"nodes\": [");
+	const Network::NodeList& nodes=network.getNodes();
+	for(size_t i=0;i<nodes.size()&&i<positions.size();++i)
+		{
+		fprintf(file,i>0?",\n    { \"id\": ":"\n    { \"id\": ");
+		writeJsonString(file,nodes[i].getId());
+		const Point& p=positions[i];
+		fprintf(file,", \"position\": [%.9g, %.9g, %.9g] }",double(p[0]),double(p[1]),double(p[2]));
+		}
+	fprintf(file,"\n  ]\n}\n");
+	
+	bool ok=ferror(file)==0;
+	if(fclose(file)!=0||!ok)
+		throw std::runtime_error(std::string("writeJsonLayout: Unable to write file ")+fileName);
+	}
+
+bool hasExtension(const char* fileName,const char* extension) // Returns true if the given file name ends with the given extension
+	{
+	size_t fileNameLen=strlen(fileName);
+	size_t extensionLen=strlen(extension);
+	return fileNameLen>=extensionLen&&strcasecmp(fileName+(fileNameLen-extensionLen),extension)==0;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	const char* networkFileName=0;
+	const char* outputFileName=0;
+	const char* traceFileName=0;
+	unsigned int numThreads=0;
+	unsigned long maxNumSteps=10000;
+	Scalar tolerance(1.0e-4);
+	double reportInterval=1.0;
+	SimulationParameters simulationParameters;
+	for(int argi=1;argi<argc;++argi)
+		{
+		if(argv[argi][0]=='-')
+			{
+			if(strcasecmp(argv[argi]+1,"output")==0&&argi+1<argc)
+				outputFileName=argv[++argi];
+			else if(strcasecmp(argv[argi]+1,"threads")==0&&argi+1<argc)
+				numThreads=(unsigned int)(atoi(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"steps")==0&&argi+1<argc)
+				maxNumSteps=strtoul(argv[++argi],0,10);
+			else if(strcasecmp(argv[argi]+1,"tolerance")==0&&argi+1<argc)
+				tolerance=Scalar(atof(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"report")==0&&argi+1<argc)
+				reportInterval=atof(argv[++argi]);
+			else if(strcasecmp(argv[argi]+1,"attenuation")==0&&argi+1<argc)
+				simulationParameters.attenuation=Scalar(atof(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"centralForce")==0&&argi+1<argc)
+				simulationParameters.centralForce=Scalar(atof(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"repellingForce")==0&&argi+1<argc)
+				simulationParameters.repellingForce=Scalar(atof(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"quadratic")==0)
+				simulationParameters.repellingForceMode=SimulationParameters::Quadratic;
+			else if(strcasecmp(argv[argi]+1,"theta")==0&&argi+1<argc)
+				simulationParameters.repellingForceTheta=Scalar(atof(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"linkStrength")==0&&argi+1<argc)
+				simulationParameters.linkStrength=Scalar(atof(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"relaxationIterations")==0&&argi+1<argc)
+				simulationParameters.numRelaxationIterations=Misc::UInt8(atoi(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"trace")==0&&argi+1<argc)
+				traceFileName=argv[++argi];
+			else
+				fprintf(stderr,"NetworkLayout: Ignoring command line option %s\n",argv[argi]);
+			}
+		else if(networkFileName==0)
+			networkFileName=argv[argi];
+		else
+			fprintf(stderr,"NetworkLayout: Ignoring command line argument %s\n",argv[argi]);
+		}
+	if(networkFileName==0||outputFileName==0||maxNumSteps==0)
+		{
+		fprintf(stderr,"Usage: %s <network file name> -output <layout file name (.json for json, binary otherwise)> [-threads <number of threads>] [-steps <maximum number of steps>] [-tolerance <RMS node movement per step>] [-report <report interval in seconds>] [-attenuation <factor>] [-centralForce <strength>] [-repellingForce <strength>] [-quadratic] [-theta <Barnes-Hut threshold>] [-linkStrength <strength>] [-relaxationIterations <number>] [-trace <trace file name>]\n",argv[0]);
+		return 1;
+		}
+	
+	try
+		{
+		/* Load the network: */
+		Realtime::TimePointMonotonic timer;
+		Network network(*IO::openFile(networkFileName));
+		double loadTime=double(timer.setAndDiff());
+		printf("Loaded network %s with %u nodes and %u links in %.3f s\n",networkFileName,(unsigned int)(network.getNodes().size()),(unsigned int)(network.getLinks().size()),loadTime);
+		fflush(stdout);
+		
+		/* Start recording spans of the simulation's work if requested: */
+		if(traceFileName!=0)
+			{
+			Tracer::setThreadName("Main");
+			Tracer::start();
+			}
+		
+		/* Create the thread pool and the simulator, which starts running immediately and reports back after every step: */
+		SimulationScheduler scheduler(numThreads);
+		LayoutMonitor monitor(tolerance,maxNumSteps);
+		timer.set();
+		NetworkSimulator simulator(network,simulationParameters,*Threads::createFunctionCall(&monitor,&LayoutMonitor::simulationUpdateCallback),scheduler);
+		simulator.setUpdateInterval(0.0);
+		printf("Created particle system in %.3f s; simulating with %u threads\n",double(timer.setAndDiff()),scheduler.getNumThreads());
+		printf("   Steps   Steps/s   Move ms  Center ms   Repel ms  Constr. ms  Octree ms  Update ms  RMS movement\n");
+		fflush(stdout);
+		
+		/* Report progress periodically until the layout is finished: */
+		Realtime::TimePointMonotonic startTime;
+		Realtime::TimePointMonotonic reportTime=startTime;
+		NetworkSimulator::Statistics lastStats;
+		while(!monitor.isFinished())
+			{
+			usleep(10000);
+			
+			Realtime::TimePointMonotonic now;
+			double reportPeriod=double(now-reportTime);
+			if(reportPeriod>=reportInterval)
+				{
+				/* Calculate per-step phase times from the most recently posted performance counters: */
+				NetworkSimulator::Statistics stats=simulator.getStatistics();
+				double numPeriodSteps=double(stats.numSteps-lastStats.numSteps);
+				double stepScale=numPeriodSteps>0.0?1000.0/numPeriodSteps:0.0;
+				unsigned long numSteps;
+				Scalar displacement;
+				bool converged;
+				monitor.getProgress(numSteps,displacement,converged);
+				printf("%8lu  %8.1f  %8.3f  %9.3f  %9.3f  %10.3f  %9.3f  %9.3f  %12.6g\n",numSteps,double(numSteps)/double(now-startTime),(stats.moveTime-lastStats.moveTime)*stepScale,(stats.centralForceTime-lastStats.centralForceTime)*stepScale,(stats.repellingForceTime-lastStats.repellingForceTime)*stepScale,(stats.constraintTime-lastStats.constraintTime)*stepScale,(stats.octreeTime-lastStats.octreeTime)*stepScale,(stats.updateTime-lastStats.updateTime)*stepScale,displacement<Math::Constants<Scalar>::max?double(displacement):0.0);
+				fflush(stdout);
+				lastStats=stats;
+				reportTime=now;
+				}
+			}
+		
+		/* Stop the simulation and wait for the current step to finish: */
+		simulator.suspend();
+		double simulationTime=double(Realtime::TimePointMonotonic()-startTime);
+		unsigned long numSteps;
+		Scalar displacement;
+		bool converged;
+		monitor.getProgress(numSteps,displacement,converged);
+		if(converged)
+			printf("Layout converged after %lu steps in %.3f s (%.1f steps/s)\n",numSteps,simulationTime,double(numSteps)/simulationTime);
+		else
+			printf("Layout reached step limit of %lu steps in %.3f s (%.1f steps/s); RMS movement per step %g\n",numSteps,simulationTime,double(numSteps)/simulationTime,double(displacement));
+		
+		/* Write the recorded spans: */
+		if(traceFileName!=0)
+			{
+			Tracer::stop();
+			size_t numDropped=Tracer::write(traceFileName);
+			printf("Wrote trace to %s; %u spans were dropped\n",traceFileName,(unsigned int)(numDropped));
+			}
+		
+		/* Write the node positions: */
+		timer.set();
+		if(hasExtension(outputFileName,".json"))
+			writeJsonLayout(outputFileName,network,monitor.getPositions());
+		else
+			writeBinaryLayout(outputFileName,monitor.getPositions());
+		printf("Wrote %u node positions to %s in %.3f s\n",(unsigned int)(monitor.getPositions().size()),outputFileName,double(timer.setAndDiff()));
+		}
+	catch(const std::runtime_error& err)
+		{
+		fprintf(stderr,"NetworkLayout: Terminating due to exception %s\n",err.what());
+		return 1;
+		}
+	
+	return 0;
+	}
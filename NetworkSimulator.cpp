@@ -1,6 +1,6 @@
 /***********************************************************************
 NetworkSimulator - Class to encapsulate a network layout simulator
-running in its own thread.
+running as a task on a shared simulation scheduler.
 Copyright (c) 2020-2023 Oliver Kreylos
 
 This file is part of the Network Viewer.
@@ -22,19 +22,14 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include "NetworkSimulator.h"
 
+#include <algorithm>
 #include <Threads/FunctionCalls.h>
 #include <Math/Math.h>
 
 #include "Network.h"
 #include "ParticleOctree.icpp"
 #include "ForceFunctors.h"
-
-#define BENCHMARK_SIMULATION 0
-
-#if BENCHMARK_SIMULATION
-#include <iostream>
-#include <Realtime/Time.h>
-#endif
+#include "Tracer.h"
 
 /****************************************************
 Methods of class NetworkSimulator::SimulationCommand:
@@ -103,6 +98,71 @@ void NetworkSimulator::ChangeSelectionCommand::execute(NetworkSimulator& simulat
 		}
 	}
 
+/******************************************************
+Methods of class NetworkSimulator::SelectRegionCommand:
+******************************************************/
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+class RegionCollector // Functor class to collect the indices of all particles inside a selection region during octree traversal
+	{
+	/* Elements: */
+	private:
+	const SelectionRegion& region; // The region to be resolved
+	NetworkSimulator::NodeIndexList& indices; // List of collected particle indices
+	
+	/* Constructors and destructors: */
+	public:
+	RegionCollector(const SelectionRegion& sRegion,NetworkSimulator::NodeIndexList& sIndices)
+		:region(sRegion),indices(sIndices)
+		{
+		}
+	
+	/* Methods: */
+	bool overlapsBox(const Point& min,const Point& max) const
+		{
+		return region.overlapsBox(min,max);
+		}
+	void operator()(Index particleIndex,const Point& particlePosition)
+		{
+		if(region.contains(particlePosition))
+			indices.push_back(particleIndex);
+		}
+	};
+
+}
+
+void NetworkSimulator::SelectRegionCommand::execute(NetworkSimulator& simulator)
+	{
+	Network& network=simulator.network;
+	
+	/* Resolve the region into a sorted list of node indices: */
+	NodeIndexList nodeIndices;
+	if(region.isSpatial())
+		{
+		/* Collect all particles inside the region by traversing the particle system's octree; particle indices are node indices: */
+		RegionCollector rc(region,nodeIndices);
+		simulator.particles.getOctree().processRegionParticles(rc);
+		std::sort(nodeIndices.begin(),nodeIndices.end());
+		}
+	else
+		{
+		/* Test the property predicate against all nodes: */
+		network.findNodesByProperty(region.propertyName,region.comparison,region.propertyValue,nodeIndices);
+		}
+	
+	/* Change the selection state of all found nodes at once: */
+	network.selectNodes(nodeIndices,mode);
+	
+	/* Notify the caller: */
+	if(callback!=0)
+		(*callback)(nodeIndices);
+	}
+
 /***************************************************
 Methods of class NetworkSimulator::DragStartCommand:
 ***************************************************/
@@ -158,6 +218,12 @@ void NetworkSimulator::DragStartCommand::execute(NetworkSimulator& simulator)
 		/* Remove the active drag state from the set again: */
 		activeDrags.removeEntry(ClientDragID(clientId,dragId));
 		}
+	else
+		{
+		/* Publish the list of dragged particles to calculate their positions from the front end: */
+		Threads::Spinlock::Lock interactiveDragsLock(simulator.interactiveDragsMutex);
+		simulator.interactiveDrags[ClientDragID(clientId,dragId)].getDest()=ad.draggedParticles;
+		}
 	}
 
 /**********************************************
@@ -175,6 +241,16 @@ void NetworkSimulator::DragCommand::execute(NetworkSimulator& simulator)
 		/* Update the drag state's drag transform: */
 		adIt->getDest().dragTransform=dragTransform;;
 		}
+	
+	/* Record the time at which the drag request was applied if it is being traced: */
+	if(traceId!=0)
+		{
+		DragTrace dt; // Default constructor sets all time points, including the apply time, to the current time
+		dt.clientId=clientId;
+		dt.traceId=traceId;
+		dt.receiveTime=queueTime;
+		simulator.appliedDragTraces.push_back(dt);
+		}
 	}
 
 /**************************************************
@@ -205,6 +281,10 @@ void NetworkSimulator::DragStopCommand::execute(NetworkSimulator& simulator)
 		
 		/* Remove the active drag state from the set: */
 		activeDrags.removeEntry(adIt);
+		
+		/* Stop calculating the dragged particles' positions from the front end: */
+		Threads::Spinlock::Lock interactiveDragsLock(simulator.interactiveDragsMutex);
+		simulator.interactiveDrags.removeEntry(ClientDragID(clientId,dragId));
 		}
 	}
 
@@ -241,51 +321,143 @@ applyForceFunctor(
 		}
 	}
 
+/**************
+Helper classes:
+**************/
+
+class MoveParticlesLoop:public SimulationScheduler::ParallelFunction // Loop body advancing ranges of particles
+	{
+	/* Elements: */
+	private:
+	ParticleSystem& particles;
+	Scalar dt;
+	
+	/* Constructors and destructors: */
+	public:
+	MoveParticlesLoop(ParticleSystem& sParticles,Scalar sDt)
+		:particles(sParticles),dt(sDt)
+		{
+		}
+	
+	/* Methods from class SimulationScheduler::ParallelFunction: */
+	virtual void operator()(Index begin,Index end)
+		{
+		particles.moveParticles(dt,begin,end);
+		}
+	};
+
+class CentralForceLoop:public SimulationScheduler::ParallelFunction // Loop body pulling ranges of particles towards a center point
+	{
+	/* Elements: */
+	private:
+	ParticleSystem& particles;
+	Point center;
+	Scalar forceFactor;
+	
+	/* Constructors and destructors: */
+	public:
+	CentralForceLoop(ParticleSystem& sParticles,const Point& sCenter,Scalar sForceFactor)
+		:particles(sParticles),center(sCenter),forceFactor(sForceFactor)
+		{
+		}
+	
+	/* Methods from class SimulationScheduler::ParallelFunction: */
+	virtual void operator()(Index begin,Index end)
+		{
+		for(Index index=begin;index<end;++index)
+			{
+			const Point& pos=particles.getParticlePosition(index);
+			Vector d=center-pos;
+			particles.forceParticle(index,d,forceFactor);
+			}
+		}
+	};
+
+template <void (ParticleSystem::*methodParam)(Index,Index)>
+class ParticleRangeLoop:public SimulationScheduler::ParallelFunction // Loop body calling a particle system method on ranges of particles
+	{
+	/* Elements: */
+	private:
+	ParticleSystem& particles;
+	
+	/* Constructors and destructors: */
+	public:
+	ParticleRangeLoop(ParticleSystem& sParticles)
+		:particles(sParticles)
+		{
+		}
+	
+	/* Methods from class SimulationScheduler::ParallelFunction: */
+	virtual void operator()(Index begin,Index end)
+		{
+		(particles.*methodParam)(begin,end);
+		}
+	};
+
+template <class ForceFunctorParam>
+class RepellingForceLoop:public SimulationScheduler::ParallelFunction // Loop body applying a repelling n-body force to ranges of particles
+	{
+	/* Elements: */
+	private:
+	ParticleSystem& particles;
+	const SimulationParameters& simulationParameters;
+	Scalar forceFactor;
+	
+	/* Constructors and destructors: */
+	public:
+	RepellingForceLoop(ParticleSystem& sParticles,const SimulationParameters& sSimulationParameters,Scalar sForceFactor)
+		:particles(sParticles),simulationParameters(sSimulationParameters),forceFactor(sForceFactor)
+		{
+		}
+	
+	/* Methods from class SimulationScheduler::ParallelFunction: */
+	virtual void operator()(Index begin,Index end)
+		{
+		applyForceFunctor<ForceFunctorParam>(particles,simulationParameters,forceFactor,begin,end);
+		}
+	};
+
 }
 
-void NetworkSimulator::innerUpdateLoopIteration(Scalar dt,unsigned int threadIndex)
+void NetworkSimulator::innerUpdateLoopIteration(Scalar dt)
 	{
-	#if BENCHMARK_SIMULATION
+	/* Start timing the simulation phases: */
 	Realtime::TimePointMonotonic timer;
-	#endif
 	
 	/* Access the current simulation parameters: */
 	const SimulationParameters& sp=simulationParameters.getLockedValue();
 	Scalar dt2=Math::sqr(dt);
 	
-	/* Advance the particle system's state: */
-	particles.moveParticles(dt,threadIndex);
-	
-	#if BENCHMARK_SIMULATION
-	double time1=double(timer.setAndDiff())*1000.0;
-	#endif
+	/* Advance the particle system's state, sharing the work with idle scheduler threads: */
+	Index numParticles=particles.getNumParticles();
+	{
+	Tracer::Span span("Move particles");
+	MoveParticlesLoop mpl(particles,dt);
+	scheduler.parallelFor(numParticles,mpl);
+	}
 	
-	/* Calculate the range of particles that will be updated by this thread: */
-	Index iBegin=(threadIndex*particles.getNumParticles())/particles.getNumThreads();
-	Index iEnd=((threadIndex+1)*particles.getNumParticles())/particles.getNumThreads();
+	double time1=double(timer.setAndDiff());
 	
-	/* Pull all particles towards the network's center of gravity: */
-	const ParticleOctree& octree=particles.getOctree();
-	Point center=Point::origin; // octree.getCenterOfGravity(); // Pull towards the coordinate system's origin for now
-	Scalar cff=sp.centralForce*dt2;
-	for(Index index=iBegin;index<iEnd;++index)
-		{
-		const Point& pos=particles.getParticlePosition(index);
-		Vector d=center-pos;
-		particles.forceParticle(index,d,cff);
-		}
+	/* Pull all particles towards the network's center of gravity or the coordinate system's origin: */
+	{
+	Tracer::Span span("Central force");
+	Point center=centerOfGravityAttraction?particles.getOctree().getCenterOfGravity():Point::origin;
+	CentralForceLoop cfl(particles,center,sp.centralForce*dt2);
+	scheduler.parallelFor(numParticles,cfl);
+	}
 	
-	#if BENCHMARK_SIMULATION
-	double time2=double(timer.setAndDiff())*1000.0;
-	#endif
+	double time2=double(timer.setAndDiff());
 	
-	/* Apply a repelling n-body force to all particles: */
+	/* Apply a repelling n-body force to all particles, sharing the work with idle scheduler threads: */
+	{
+	Tracer::Span span("Repelling force");
 	switch(sp.repellingForceMode)
 		{
 		case SimulationParameters::Linear:
 			{
 			/* Apply an inverse linear law force function: */
-			applyForceFunctor<GlobalRepulsiveForceFunctorLinear>(particles,sp,sp.repellingForce*dt2,iBegin,iEnd);
+			RepellingForceLoop<GlobalRepulsiveForceFunctorLinear> rfl(particles,sp,sp.repellingForce*dt2);
+			scheduler.parallelFor(numParticles,rfl);
 			
 			break;
 			}
@@ -293,119 +465,174 @@ void NetworkSimulator::innerUpdateLoopIteration(Scalar dt,unsigned int threadInd
 		case SimulationParameters::Quadratic:
 			{
 			/* Apply an inverse square law force function: */
-			applyForceFunctor<GlobalRepulsiveForceFunctorQuadratic>(particles,sp,sp.repellingForce*dt2,iBegin,iEnd);
+			RepellingForceLoop<GlobalRepulsiveForceFunctorQuadratic> rfl(particles,sp,sp.repellingForce*dt2);
+			scheduler.parallelFor(numParticles,rfl);
 			
 			break;
 			}
 		}
+	}
 	
-	#if BENCHMARK_SIMULATION
-	double time3=double(timer.setAndDiff())*1000.0;
-	#endif
-	
-	/* Finish the particle system's update step: */
-	particles.enforceConstraints(dt,threadIndex);
+	double time3=double(timer.setAndDiff());
 	
-	#if BENCHMARK_SIMULATION
-	double time4=double(timer.setAndDiff())*1000.0;
-	if(threadIndex==0)
-		std::cout<<"Simulation times: "<<time1<<", "<<time2<<", "<<time3<<", "<<time4<<std::endl;
-	#endif
-	}
-
-void* NetworkSimulator::simulationWorkerThreadMethod(unsigned int threadIndex)
+	/* Finish the particle system's update step, running the per-particle constraint phases on idle scheduler threads: */
 	{
-	/* Run the inner simulation loop until told to stop: */
-	while(keepSimulationThreadRunning)
+	Tracer::Span span("Enforce constraints");
+	particles.startConstraints(dt);
+	ParticleRangeLoop<&ParticleSystem::enforceBoundaryConstraints> bcl(particles);
+	scheduler.parallelFor(numParticles,bcl);
+	ParticleRangeLoop<&ParticleSystem::calcRelaxationDeltas> crdl(particles);
+	ParticleRangeLoop<&ParticleSystem::applyRelaxationDeltas> ardl(particles);
+	for(unsigned int iteration=0;iteration<particles.getNumRelaxationIterations();++iteration)
 		{
-		/* Synchronize with the other worker threads: */
-		barrier.synchronize();
-		
-		/* Run one iteration of the inner update loop: */
-		Scalar dt(1.0/60.0); // Use a fixed time step for now
-		innerUpdateLoopIteration(dt,threadIndex);
+		scheduler.parallelFor(numParticles,crdl);
+		scheduler.parallelFor(numParticles,ardl);
 		}
+	particles.finishConstraints();
+	}
 	
-	return 0;
+	double time4=double(timer.setAndDiff());
+	
+	/* Accumulate phase times: */
+	currentStatistics.moveTime+=time1;
+	currentStatistics.centralForceTime+=time2;
+	currentStatistics.repellingForceTime+=time3;
+	double octreeTime=particles.getOctreeUpdateTime();
+	currentStatistics.constraintTime+=time4-octreeTime;
+	currentStatistics.octreeTime+=octreeTime;
 	}
 
-void* NetworkSimulator::simulationThreadMethod(void)
+void NetworkSimulator::step(void)
 	{
-	/* Start a timer to enforce a maximum update rate: */
-	Realtime::TimePointMonotonic nextUpdateTime;
+	Tracer::Span stepSpan("Simulation step");
 	
-	/* Run the simulation until told to stop: */
-	while(keepSimulationThreadRunning)
-		{
-		/* Check if the simulation thread should be paused: */
+	/* Lock the most recent simulation parameters: */
+	if(simulationParameters.lockNewValue())
 		{
-		Threads::MutexCond::Lock pauseSimulationThreadLock(pauseSimulationThreadCond);
-		while(pauseSimulationThread)
-			pauseSimulationThreadCond.wait(pauseSimulationThreadLock);
+		/* Update the particle system's state: */
+		const SimulationParameters& sp=simulationParameters.getLockedValue();
+		if(particles.getAttenuation()!=sp.attenuation)
+			particles.setAttenuation(sp.attenuation);
+		if(particles.getDistConstraintScale()!=sp.linkStrength)
+			particles.setDistConstraintScale(sp.linkStrength);
 		}
-		
-		/* Lock the most recent simulation parameters: */
-		if(simulationParameters.lockNewValue())
-			{
-			/* Update the particle system's state: */
-			const SimulationParameters& sp=simulationParameters.getLockedValue();
-			if(particles.getAttenuation()!=sp.attenuation)
-				particles.setAttenuation(sp.attenuation);
-			if(particles.getDistConstraintScale()!=sp.linkStrength)
-				particles.setDistConstraintScale(sp.linkStrength);
-			}
-		
-		/* Execute all queued simulation commands: */
+	
+	/* Execute all queued simulation commands: */
+	Realtime::TimePointMonotonic stepTimer;
+	{
+	Tracer::Span span("Simulation commands");
+	SimulationCommandList scs;
+	{
+	Threads::Spinlock::Lock simulationCommandsLock(simulationCommandsMutex);
+	std::swap(simulationCommands,scs);
+	}
+	if(currentStatistics.maxCommandQueueDepth<scs.size())
+		currentStatistics.maxCommandQueueDepth=scs.size();
+	for(SimulationCommandList::iterator scIt=scs.begin();scIt!=scs.end();++scIt)
 		{
-		SimulationCommandList scs;
+		/* Measure the command's latency: */
+		double latency=double(stepTimer-(*scIt)->queueTime);
+		currentStatistics.commandLatency+=latency;
+		if(currentStatistics.maxCommandLatency<latency)
+			currentStatistics.maxCommandLatency=latency;
+		++currentStatistics.numCommands;
+		
+		/* Execute the command object and delete it: */
+		(*scIt)->execute(*this);
+		delete *scIt;
+		}
+	}
+	
+	/* Apply all active drag operations: */
+	for(ActiveDragSet::Iterator adIt=activeDrags.begin();!adIt.isFinished();++adIt)
 		{
-		Threads::Spinlock::Lock simulationCommandsLock(simulationCommandsMutex);
-		std::swap(simulationCommands,scs);
+		ActiveDrag& ad=adIt->getDest();
+		for(ActiveDrag::DraggedParticleList::iterator dpIt=ad.draggedParticles.begin();dpIt!=ad.draggedParticles.end();++dpIt)
+			particles.setParticlePosition(dpIt->index,ad.dragTransform.transform(dpIt->dragPos));
 		}
-		for(SimulationCommandList::iterator scIt=scs.begin();scIt!=scs.end();++scIt)
+	
+	currentStatistics.commandTime+=double(stepTimer.setAndDiff());
+	
+	/* Run one iteration of the inner update loop: */
+	Scalar dt(1.0/60.0); // Use a fixed time step for now
+	innerUpdateLoopIteration(dt);
+	++currentStatistics.numSteps;
+	
+	/* Mark all drag requests applied in this step as reflected in the simulation state: */
+	if(!appliedDragTraces.empty())
+		{
+		Realtime::TimePointMonotonic stepDoneTime;
+		for(DragTraceList::iterator dtIt=appliedDragTraces.begin();dtIt!=appliedDragTraces.end();++dtIt)
 			{
-			/* Execute the command object and delete it: */
-			(*scIt)->execute(*this);
-			delete *scIt;
+			dtIt->stepTime=stepDoneTime;
+			steppedDragTraces.push_back(*dtIt);
 			}
+		appliedDragTraces.clear();
 		}
-		
-		/* Apply all active drag operations: */
-		for(ActiveDragSet::Iterator adIt=activeDrags.begin();!adIt.isFinished();++adIt)
+	
+	/* Check if it's time to send a simulation update: */
+	Realtime::TimePointMonotonic currentTime;
+	if(currentTime>=nextUpdateTime)
+		{
+		/* Hand the traces of all drag requests reflected in this update to the front end: */
+		if(!steppedDragTraces.empty())
 			{
-			ActiveDrag& ad=adIt->getDest();
-			for(ActiveDrag::DraggedParticleList::iterator dpIt=ad.draggedParticles.begin();dpIt!=ad.draggedParticles.end();++dpIt)
-				particles.setParticlePosition(dpIt->index,ad.dragTransform.transform(dpIt->dragPos));
+			Threads::Spinlock::Lock dragTracesLock(dragTracesMutex);
+			for(DragTraceList::iterator dtIt=steppedDragTraces.begin();dtIt!=steppedDragTraces.end();++dtIt)
+				{
+				dtIt->updateTime=currentTime;
+				dragTraces.push_back(*dtIt);
+				}
+			steppedDragTraces.clear();
 			}
 		
-		/* Synchronize with the worker threads: */
-		if(numWorkerThreads>0)
-			barrier.synchronize();
+		/* Call the simulation update callback: */
+		{
+		Tracer::Span span("Simulation update");
+		(*simulationUpdateCallback)(particles);
+		}
+		currentStatistics.updateTime+=double(Realtime::TimePointMonotonic()-currentTime);
 		
-		/* Run one iteration of the inner update loop: */
-		Scalar dt(1.0/60.0); // Use a fixed time step for now
-		innerUpdateLoopIteration(dt,0);
+		/* Advance the update timer: */
+		nextUpdateTime+=Realtime::TimeVector(updateInterval);
 		
-		/* Check if it's time to send a simulation update: */
-		Realtime::TimePointMonotonic currentTime;
+		/* Check if we missed a time step: */
 		if(currentTime>=nextUpdateTime)
 			{
-			/* Call the simulation update callback: */
-			(*simulationUpdateCallback)(particles);
-			
-			/* Advance the update timer: */
-			nextUpdateTime+=Realtime::TimeVector(updateInterval);
-			
-			/* Check if we missed a time step: */
-			if(currentTime>=nextUpdateTime)
-				{
-				/* Restart the update timer: */
-				nextUpdateTime=currentTime;
-				}
+			/* Restart the update timer: */
+			nextUpdateTime=currentTime;
 			}
 		}
 	
-	return 0;
+	/* Check if it's time to measure layout quality: */
+	double qi=qualityInterval;
+	if(qi>0.0&&currentTime>=nextQualityTime)
+		{
+		/* Measure the current layout using the scheduler's thread pool: */
+		if(layoutQuality==0)
+			layoutQuality=new LayoutQuality(network);
+		Tracer::Span span("Layout quality");
+		layoutQuality->calcMetrics(particles,&scheduler,currentStatistics.quality);
+		currentStatistics.qualityStep=currentStatistics.numSteps;
+		
+		nextQualityTime=currentTime;
+		nextQualityTime+=Realtime::TimeVector(qi);
+		}
+	
+	/* Check if it's time to post performance counters: */
+	if(currentTime>=nextStatisticsTime)
+		{
+		/* Sample the current sizes of the octree and data structures: */
+		sampleStatistics();
+		
+		/* Post the counters and reset the per-period maxima: */
+		statistics.postNewValue(currentStatistics);
+		currentStatistics.maxCommandLatency=0.0;
+		currentStatistics.maxCommandQueueDepth=0;
+		
+		nextStatisticsTime=currentTime;
+		nextStatisticsTime+=Realtime::TimeVector(1.0);
+		}
 	}
 
 void NetworkSimulator::queueCommand(NetworkSimulator::SimulationCommand* command)
@@ -415,12 +642,22 @@ void NetworkSimulator::queueCommand(NetworkSimulator::SimulationCommand* command
 	simulationCommands.push_back(command);
 	}
 
-NetworkSimulator::NetworkSimulator(Network& sNetwork,const SimulationParameters& sSimulationParameters,SimulationUpdateCallback& sSimulationUpdateCallback,unsigned int sNumWorkerThreads)
+void NetworkSimulator::sampleStatistics(void)
+	{
+	/* Query the particle octree's shape and the sizes of the network and particle system: */
+	particles.getOctree().getStatistics(currentStatistics.octreeDepth,currentStatistics.numOctreeNodes,currentStatistics.numOctreeLeaves);
+	currentStatistics.networkMemorySize=network.getMemorySize();
+	currentStatistics.particleSystemMemorySize=particles.getMemorySize();
+	}
+
+NetworkSimulator::NetworkSimulator(Network& sNetwork,const SimulationParameters& sSimulationParameters,SimulationUpdateCallback& sSimulationUpdateCallback,SimulationScheduler& sScheduler)
 	:network(sNetwork),
-	 keepSimulationThreadRunning(true),pauseSimulationThread(false),
-	 numWorkerThreads(sNumWorkerThreads),workerThreads(0),
-	 activeDrags(17),nodeDrags(new bool[network.getNodes().size()]),
-	 updateInterval(1.0/30.0),simulationUpdateCallback(&sSimulationUpdateCallback)
+	 scheduler(sScheduler),
+	 activeDrags(17),nodeDrags(new bool[network.getNodes().size()]),interactiveDrags(17),
+	 centerOfGravityAttraction(false),
+	 updateInterval(1.0/30.0),
+	 qualityInterval(0.0),layoutQuality(0),
+	 simulationUpdateCallback(&sSimulationUpdateCallback)
 	{
 	/* Initialize the particle system: */
 	particles.setGravity(Vector::zero);
@@ -439,48 +676,17 @@ NetworkSimulator::NetworkSimulator(Network& sNetwork,const SimulationParameters&
 	/* Post initial simulation parameters: */
 	simulationParameters.postNewValue(sSimulationParameters);
 	
-	/* Start the optional addition worker threads: */
-	if(numWorkerThreads>0)
-		{
-		/* Set the number of threads synchronizing on the barrier: */
-		barrier.setNumSynchronizingThreads(1+numWorkerThreads);
-		
-		/* Enable parallelism in the particle system: */
-		particles.setNumThreads(1+numWorkerThreads,barrier);
-		
-		workerThreads=new Threads::Thread[numWorkerThreads];
-		
-		for(unsigned int ti=0;ti<numWorkerThreads;++ti)
-			workerThreads[ti].start(this,&NetworkSimulator::simulationWorkerThreadMethod,ti+1);
-		}
+	/* Calculate the size of the network file's json entities, which do not change: */
+	currentStatistics.domMemorySize=network.getDomMemorySize();
 	
-	/* Start the main simulation thread: */
-	simulationThread.start(this,&NetworkSimulator::simulationThreadMethod);
+	/* Start running simulation steps: */
+	scheduler.activate(*this);
 	}
 
 NetworkSimulator::~NetworkSimulator(void)
 	{
-	/* Tell the simulation thread to stop: */
-	keepSimulationThreadRunning=false;
-	
-	/* Wake up the simulation thread in case it was paused: */
-	{
-	Threads::MutexCond::Lock pauseSimulationThreadLock(pauseSimulationThreadCond);
-	pauseSimulationThread=false;
-	pauseSimulationThreadCond.signal();
-	}
-	
-	/* Wait for the simulation thread to terminate: */
-	simulationThread.join();
-	
-	/* Wait for the optional additional worker threads to terminate: */
-	if(numWorkerThreads>0)
-		{
-		for(unsigned int ti=0;ti<numWorkerThreads;++ti)
-			workerThreads[ti].join();
-		
-		delete[] workerThreads;
-		}
+	/* Remove the simulator from the scheduler and wait for a running simulation step to finish: */
+	scheduler.remove(*this);
 	
 	/* Delete all pending simulation commands: */
 	for(SimulationCommandList::iterator scIt=simulationCommands.begin();scIt!=simulationCommands.end();++scIt)
@@ -488,6 +694,13 @@ NetworkSimulator::~NetworkSimulator(void)
 	
 	/* Clean up: */
 	delete[] nodeDrags;
+	delete layoutQuality;
+	}
+
+void NetworkSimulator::setCenterOfGravityAttraction(bool newCenterOfGravityAttraction)
+	{
+	/* Set the attraction flag; background thread will grab it when needed: */
+	centerOfGravityAttraction=newCenterOfGravityAttraction;
 	}
 
 void NetworkSimulator::setUpdateInterval(double newUpdateInterval)
@@ -496,16 +709,58 @@ void NetworkSimulator::setUpdateInterval(double newUpdateInterval)
 	updateInterval=newUpdateInterval;
 	}
 
+void NetworkSimulator::setQualityInterval(double newQualityInterval)
+	{
+	/* Set the quality interval; background thread will grab it when needed: */
+	qualityInterval=newQualityInterval;
+	}
+
+bool NetworkSimulator::getDraggedPositions(unsigned int clientId,unsigned int dragId,const NetworkSimulator::DragTransform& dragTransform,NetworkSimulator::DraggedPositionList& positions)
+	{
+	positions.clear();
+	
+	/* Find the dragging operation's particle list: */
+	Threads::Spinlock::Lock interactiveDragsLock(interactiveDragsMutex);
+	InteractiveDragMap::Iterator idIt=interactiveDrags.findEntry(ClientDragID(clientId,dragId));
+	if(idIt.isFinished())
+		return false;
+	
+	/* Calculate the positions of all dragged particles exactly as the simulation thread will: */
+	const ActiveDrag::DraggedParticleList& dps=idIt->getDest();
+	positions.reserve(dps.size());
+	for(ActiveDrag::DraggedParticleList::const_iterator dpIt=dps.begin();dpIt!=dps.end();++dpIt)
+		{
+		DraggedPosition dp;
+		dp.index=dpIt->index;
+		dp.position=dragTransform.transform(dpIt->dragPos);
+		positions.push_back(dp);
+		}
+	
+	return true;
+	}
+
+void NetworkSimulator::takeDragTraces(NetworkSimulator::DragTraceList& traces)
+	{
+	/* Hand all completed drag traces to the caller: */
+	Threads::Spinlock::Lock dragTracesLock(dragTracesMutex);
+	traces.insert(traces.end(),dragTraces.begin(),dragTraces.end());
+	dragTraces.clear();
+	}
+
 void NetworkSimulator::pause(void)
 	{
-	/* Tell the simulation thread to pause: */
-	pauseSimulationThread=true;
+	/* Stop scheduling simulation steps; a running step will finish: */
+	scheduler.deactivate(*this);
+	}
+
+void NetworkSimulator::suspend(void)
+	{
+	/* Take the simulator out of the scheduler and wait for a running step to finish: */
+	scheduler.remove(*this);
 	}
 
 void NetworkSimulator::resume(void)
 	{
-	/* Reset the pause flag and wake up the simulation thread: */
-	Threads::MutexCond::Lock pauseSimulationThreadLock(pauseSimulationThreadCond);
-	pauseSimulationThread=false;
-	pauseSimulationThreadCond.signal();
+	/* Put the simulator back into the scheduler's run queue: */
+	scheduler.activate(*this);
 	}
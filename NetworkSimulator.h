@@ -1,6 +1,6 @@
 /***********************************************************************
 NetworkSimulator - Class to encapsulate a network layout simulator
-running in its own thread.
+running as a task on a shared simulation scheduler.
 Copyright (c) 2023 Oliver Kreylos
 
 This file is part of the Network Viewer.
@@ -29,15 +29,15 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Misc/HashTable.h>
 #include <Realtime/Time.h>
 #include <Threads/Spinlock.h>
-#include <Threads/MutexCond.h>
-#include <Threads/Thread.h>
-#include <Threads/Barrier.h>
 #include <Threads/TripleBuffer.h>
 #include <Geometry/OrthonormalTransformation.h>
 
 #include "ParticleTypes.h"
 #include "ParticleSystem.h"
 #include "SimulationParameters.h"
+#include "SelectionRegion.h"
+#include "SimulationScheduler.h"
+#include "LayoutQuality.h"
 
 /* Forward declarations: */
 namespace Threads {
@@ -46,14 +46,76 @@ class FunctionCall;
 }
 class Network;
 
-class NetworkSimulator
+class NetworkSimulator:public SimulationScheduler::Task
 	{
 	/* Embedded classes: */
 	public:
 	typedef Threads::FunctionCall<const ParticleSystem&> SimulationUpdateCallback; // Type for functions called from simulation thread when a simulation update is available
+	typedef std::vector<Index> NodeIndexList; // Type for sorted lists of node indices
+	typedef Threads::FunctionCall<const NodeIndexList&> SelectRegionCallback; // Type for functions called from simulation thread when a region selection has been resolved
 	
 	typedef Geometry::OrthonormalTransformation<Scalar,3> DragTransform; // Type for dragging transformations
 	
+	struct Statistics // Structure holding performance counters of the simulation thread
+		{
+		/* Elements: */
+		public:
+		unsigned long numSteps; // Total number of executed simulation steps
+		double commandTime; // Total time spent executing simulation commands and applying drags in seconds
+		double moveTime; // Total time spent moving particles in seconds
+		double centralForceTime; // Total time spent applying the central force in seconds
+		double repellingForceTime; // Total time spent applying the repelling n-body force in seconds
+		double constraintTime; // Total time spent enforcing constraints, excluding the particle octree update, in seconds
+		double octreeTime; // Total time spent updating the particle octree in seconds
+		double updateTime; // Total time spent in the simulation update callback in seconds
+		unsigned long numCommands; // Total number of executed simulation commands
+		double commandLatency; // Total time between queueing and executing all executed simulation commands in seconds
+		double maxCommandLatency; // Maximum time between queueing and executing a simulation command since the statistics were last posted in seconds
+		size_t maxCommandQueueDepth; // Maximum number of simulation commands executed in a single step since the statistics were last posted
+		unsigned int octreeDepth; // Maximum leaf depth of the particle octree
+		size_t numOctreeNodes,numOctreeLeaves; // Numbers of nodes and leaf nodes in the particle octree
+		size_t networkMemorySize; // Estimated memory used by the network's node, link, and selection structures in bytes
+		size_t domMemorySize; // Estimated memory used by the network file's json entities in bytes
+		size_t particleSystemMemorySize; // Estimated memory used by the particle system and its octree in bytes
+		unsigned long qualityStep; // Number of the simulation step after which layout quality was last measured, or 0 if it was never measured
+		LayoutQuality::Metrics quality; // Most recently measured layout quality metrics
+		
+		/* Constructors and destructors: */
+		Statistics(void)
+			:numSteps(0),
+			 commandTime(0.0),moveTime(0.0),centralForceTime(0.0),repellingForceTime(0.0),constraintTime(0.0),octreeTime(0.0),updateTime(0.0),
+			 numCommands(0),commandLatency(0.0),maxCommandLatency(0.0),maxCommandQueueDepth(0),
+			 octreeDepth(0),numOctreeNodes(0),numOctreeLeaves(0),
+			 networkMemorySize(0),domMemorySize(0),particleSystemMemorySize(0),
+			 qualityStep(0)
+			{
+			}
+		};
+	
+	struct DragTrace // Structure recording the progress of a traced drag request through the simulation thread
+		{
+		/* Elements: */
+		public:
+		unsigned int clientId; // ID of the client that issued the drag request
+		unsigned int traceId; // Client-assigned ID of the traced drag request
+		Realtime::TimePointMonotonic receiveTime; // Time at which the drag request was queued for the simulation thread
+		Realtime::TimePointMonotonic applyTime; // Time at which the simulation thread applied the drag request
+		Realtime::TimePointMonotonic stepTime; // Time at which the simulation step reflecting the drag request was completed
+		Realtime::TimePointMonotonic updateTime; // Time at which the first simulation update reflecting the drag request was handed to the simulation update callback
+		};
+	
+	typedef std::vector<DragTrace> DragTraceList; // Type for lists of drag request traces
+	
+	struct DraggedPosition // Structure for the position of a dragged particle calculated outside of the simulation thread
+		{
+		/* Elements: */
+		public:
+		Index index; // Particle's index
+		Point position; // Particle's position under the current drag transformation
+		};
+	
+	typedef std::vector<DraggedPosition> DraggedPositionList; // Type for lists of dragged particle positions
+	
 	private:
 	struct ActiveDrag // Structure representing an active dragging operation
 		{
@@ -77,11 +139,15 @@ class NetworkSimulator
 	
 	typedef Misc::OrderedTuple<unsigned int,2> ClientDragID; // Server-wide unique drag operation ID consisting of a client ID and a drag ID
 	typedef Misc::HashTable<ClientDragID,ActiveDrag> ActiveDragSet; // Map from drag operation IDs to active dragging operation states
+	typedef Misc::HashTable<ClientDragID,ActiveDrag::DraggedParticleList> InteractiveDragMap; // Map from drag operation IDs to copies of the lists of particles affected by them
 	
 	class SimulationCommand // Base class for commands issued to the simulation thread from the main thread
 		{
-		/* Constructors and destructors: */
+		/* Elements: */
 		public:
+		Realtime::TimePointMonotonic queueTime; // Time at which the command was created and queued
+		
+		/* Constructors and destructors: */
 		virtual ~SimulationCommand(void);
 		
 		/* Methods: */
@@ -123,6 +189,25 @@ class NetworkSimulator
 		virtual void execute(NetworkSimulator& simulator);
 		};
 	
+	class SelectRegionCommand:public SimulationCommand // Class to change the selection state of all nodes inside a region
+		{
+		/* Elements: */
+		private:
+		SelectionRegion region; // The region to be resolved
+		int mode; // Change mode: 0: select nodes; 1: deselect nodes; 2: toggle nodes' selection states; 3: replace selection
+		Misc::Autopointer<SelectRegionCallback> callback; // Function called with the sorted list of nodes inside the region, or null
+		
+		/* Constructors and destructors: */
+		public:
+		SelectRegionCommand(const SelectionRegion& sRegion,int sMode,SelectRegionCallback* sCallback)
+			:region(sRegion),mode(sMode),callback(sCallback)
+			{
+			}
+		
+		/* Methods from class SimulationCommand: */
+		virtual void execute(NetworkSimulator& simulator);
+		};
+	
 	class DragStartCommand:public SimulationCommand // Class to start dragging operations
 		{
 		/* Elements: */
@@ -153,11 +238,12 @@ class NetworkSimulator
 		unsigned int clientId;
 		unsigned int dragId;
 		DragTransform dragTransform;
+		unsigned int traceId; // ID under which to trace the drag request, or 0
 		
 		/* Constructors and destructors: */
 		public:
-		DragCommand(unsigned int sClientId,unsigned int sDragId,const DragTransform& sDragTransform)
-			:clientId(sClientId),dragId(sDragId),dragTransform(sDragTransform)
+		DragCommand(unsigned int sClientId,unsigned int sDragId,const DragTransform& sDragTransform,unsigned int sTraceId)
+			:clientId(sClientId),dragId(sDragId),dragTransform(sDragTransform),traceId(sTraceId)
 			{
 			}
 		
@@ -184,6 +270,7 @@ class NetworkSimulator
 		};
 	
 	friend class SelectNodeCommand;
+	friend class SelectRegionCommand;
 	friend class DragStartCommand;
 	friend class DragCommand;
 	friend class DragStopCommand;
@@ -194,30 +281,40 @@ class NetworkSimulator
 	Network& network; // The visualized network
 	ParticleSystem particles; // Particle system to simulate network node and link interactions
 	Threads::TripleBuffer<SimulationParameters> simulationParameters; // Triple buffer of particle system simulation parameters
-	volatile bool keepSimulationThreadRunning; // Flag to shut down the simulation thread
-	volatile bool pauseSimulationThread; // Flag to pause the simulation thread while no clients are connected
-	Threads::MutexCond pauseSimulationThreadCond; // Condition variable to wake up the simulation thread from being paused
-	Threads::Thread simulationThread; // Background thread simulating the network
-	unsigned int numWorkerThreads; // Number of additional worker threads cooperating with the background simulation thread
-	Threads::Thread* workerThreads; // Array of additional threads cooperating with the background simulation thread
-	Threads::Barrier barrier; // Barrier synchronizing between the background simulation thread and the worker threads
+	SimulationScheduler& scheduler; // Scheduler running the simulation's steps on its thread pool
 	ActiveDragSet activeDrags; // Map of active drag operations
 	bool* nodeDrags; // Array of flags indicating whether each particle is being dragged
+	Threads::Spinlock interactiveDragsMutex; // Mutex serializing access to the interactive drag map
+	InteractiveDragMap interactiveDrags; // Copies of the particle lists of active drag operations, to calculate dragged particle positions from the front end independently of simulation steps
+	volatile bool centerOfGravityAttraction; // Flag whether the central force pulls particles towards the network's center of gravity instead of the coordinate system's origin
 	volatile double updateInterval; // Time between network updates sent to clients
+	Realtime::TimePointMonotonic nextUpdateTime; // Time at which to send the next simulation update, to enforce a maximum update rate
+	Realtime::TimePointMonotonic nextStatisticsTime; // Time at which to post the next set of performance counters
+	volatile double qualityInterval; // Time between layout quality measurements, or 0 to disable measurements
+	Realtime::TimePointMonotonic nextQualityTime; // Time at which to measure layout quality next
+	LayoutQuality* layoutQuality; // Layout quality metrics calculator, created by the simulation thread on the first measurement
 	Misc::Autopointer<SimulationUpdateCallback> simulationUpdateCallback; // Function called from simulation thread when a new update is available
 	Threads::Spinlock simulationCommandsMutex; // Mutex serializing access to the simulation command list
 	SimulationCommandList simulationCommands; // List holding commands from the front-end to the simulation thread
+	Statistics currentStatistics; // Performance counters accumulated by the simulation thread
+	Threads::TripleBuffer<Statistics> statistics; // Triple buffer of performance counters posted periodically by the simulation thread
+	DragTraceList appliedDragTraces; // Traces of drag requests applied during the current simulation step
+	DragTraceList steppedDragTraces; // Traces of drag requests reflected in the simulation state that have not yet been handed to the simulation update callback
+	Threads::Spinlock dragTracesMutex; // Mutex serializing access to the list of completed drag traces
+	DragTraceList dragTraces; // Traces of drag requests reflected in a simulation update that have not yet been retrieved
 	
 	/* Private methods: */
-	void innerUpdateLoopIteration(Scalar dt,unsigned int threadIndex); // Runs one iteration of the network simulation update loop from a number of worker threads in parallel
-	void* simulationWorkerThreadMethod(unsigned int threadIndex); // Method implementing a worker thread cooperating with the background simulation thread
-	void* simulationThreadMethod(void); // Method implementing the background simulation thread
+	void innerUpdateLoopIteration(Scalar dt); // Runs one iteration of the network simulation update loop, using idle scheduler threads for all per-particle phases
 	void queueCommand(SimulationCommand* command); // Puts a new command into the simulation thread's queue
+	void sampleStatistics(void); // Samples the current sizes of the particle octree and data structures into the current performance counters
 	
 	/* Constructors and destructors: */
 	public:
-	NetworkSimulator(Network& sNetwork,const SimulationParameters& sSimulationParameters,SimulationUpdateCallback& sSimulationUpdateCallback,unsigned int sNumWorkerThreads =0); // Creates a simulator for the given network; takes ownership of callback object
-	~NetworkSimulator(void);
+	NetworkSimulator(Network& sNetwork,const SimulationParameters& sSimulationParameters,SimulationUpdateCallback& sSimulationUpdateCallback,SimulationScheduler& sScheduler); // Creates a simulator for the given network and starts running it on the given scheduler; takes ownership of callback object
+	virtual ~NetworkSimulator(void);
+	
+	/* Methods from class SimulationScheduler::Task: */
+	virtual void step(void);
 	
 	/* Methods: */
 	void setSimulationParameters(const SimulationParameters& newSimulationParameters) // Sets the simulation parameters
@@ -225,9 +322,28 @@ class NetworkSimulator
 		/* Put the new set of parameters into the triple buffer: */
 		simulationParameters.postNewValue(newSimulationParameters);
 		}
+	void setCenterOfGravityAttraction(bool newCenterOfGravityAttraction); // Sets whether the central force pulls particles towards the network's center of gravity or towards the coordinate system's origin
 	void setUpdateInterval(double newUpdateInterval); // Sets the time interval at which simulation updates are pushed to clients in seconds
-	void pause(void); // Pauses the simulation thread
-	void resume(void); // Resumes the simulation thread
+	void setQualityInterval(double newQualityInterval); // Sets the time interval at which layout quality metrics are measured into the performance counters in seconds; 0 disables measurements
+	const Statistics& getStatistics(void) // Returns the most recently posted performance counters of the simulation thread
+		{
+		/* Lock the most recent set of counters: */
+		statistics.lockNewValue();
+		return statistics.getLockedValue();
+		}
+	const Statistics& getSuspendedStatistics(void) // Returns the performance counters accumulated up to now; must only be called while the simulator is suspended
+		{
+		sampleStatistics();
+		return currentStatistics;
+		}
+	const ParticleSystem& getSuspendedParticles(void) const // Returns the simulated particle system; must only be called while the simulator is suspended
+		{
+		return particles;
+		}
+	void takeDragTraces(DragTraceList& traces); // Appends the traces of all drag requests reflected in simulation updates since the last call to the given list
+	void pause(void); // Stops scheduling simulation steps
+	void suspend(void); // Stops scheduling simulation steps and waits until a running step has finished
+	void resume(void); // Resumes scheduling simulation steps
 	
 	void selectNode(Index nodeIndex,int mode) // Changes a node's selection state
 		{
@@ -239,16 +355,22 @@ class NetworkSimulator
 		/* Queue a simulation command: */
 		queueCommand(new ChangeSelectionCommand(command));
 		}
+	void selectRegion(const SelectionRegion& region,int mode,SelectRegionCallback* callback =0) // Changes the selection state of all nodes inside the given region; calls optional callback from simulation thread with the resolved set of nodes; takes ownership of callback object
+		{
+		/* Queue a simulation command: */
+		queueCommand(new SelectRegionCommand(region,mode,callback));
+		}
 	void dragStart(unsigned int clientId,unsigned int dragId,Index pickedNodeIndex,const DragTransform& initialTransform) // Starts a dragging operation
 		{
 		/* Queue a new simulation command: */
 		queueCommand(new DragStartCommand(clientId,dragId,pickedNodeIndex,initialTransform));
 		}
-	void drag(unsigned int clientId,unsigned int dragId,const DragTransform& dragTransform) // Continues a dragging operation
+	void drag(unsigned int clientId,unsigned int dragId,const DragTransform& dragTransform,unsigned int traceId =0) // Continues a dragging operation; traces the request's progress if the given trace ID is not 0
 		{
 		/* Queue a new simulation command: */
-		queueCommand(new DragCommand(clientId,dragId,dragTransform));
+		queueCommand(new DragCommand(clientId,dragId,dragTransform,traceId));
 		}
+	bool getDraggedPositions(unsigned int clientId,unsigned int dragId,const DragTransform& dragTransform,DraggedPositionList& positions); // Replaces the given list with the positions of all particles affected by the given dragging operation under the given drag transformation; returns false if the simulation thread has not yet started the dragging operation
 	void dragStop(unsigned int clientId,unsigned int dragId) // Finishes a dragging operation
 		{
 		/* Queue a new simulation command: */
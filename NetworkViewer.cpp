@@ -23,20 +23,22 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include "NetworkViewer.h"
 
 #include <string.h>
+#include <strings.h>
+#include <stdlib.h>
 #include <deque>
 #include <Misc/FunctionCalls.h>
-#include <Realtime/Time.h>
+#include <Threads/FunctionCalls.h>
 #include <IO/OpenFile.h>
 #include <Math/Math.h>
 #include <Math/Constants.h>
 #include <Geometry/Box.h>
-#include <Geometry/Random.h>
 #include <GL/GLColorTemplates.h>
 #include <GL/GLMaterialTemplates.h>
 #include <GL/GLContextData.h>
 #include <GL/GLModels.h>
 #include <GL/GLGeometryWrappers.h>
 #include <GL/GLTransformationWrappers.h>
+#include <GL/GLVertexArrayParts.h>
 #include <GLMotif/StyleSheet.h>
 #include <GLMotif/PopupWindow.h>
 #include <GLMotif/PopupMenu.h>
@@ -47,8 +49,13 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Vrui/Vrui.h>
 #include <Vrui/DisplayState.h>
 
-#include "Network.h"
-#include "ParticleSystem.icpp"
+#include "VisualNetwork.h"
+#include "ParticleSystem.h"
+#include "SphereBVH.icpp"
+#include "SphereCenterSnapper.h"
+#include "SimulationScheduler.h"
+#include "NetworkSimulator.h"
+#include "VisibilityCuller.icpp"
 #include "JsonEntity.h"
 #include "JsonBoolean.h"
 #include "JsonNumber.h"
@@ -60,12 +67,6 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include "SubtractSelectTool.h"
 #include "ShowPropertiesTool.h"
 
-#define TIMING 1
-#if TIMING
-#include <iostream>
-#include <Realtime/Time.h>
-#endif
-
 /*
 To do:
 
@@ -80,7 +81,8 @@ Methods of class NetworkViewer::DataItem:
 ****************************************/
 
 NetworkViewer::DataItem::DataItem(void)
-	:sphereDisplayList(glGenLists(1))
+	:sphereDisplayList(glGenLists(1)),
+	 linksCulled(false)
 	{
 	}
 
@@ -89,6 +91,88 @@ NetworkViewer::DataItem::~DataItem(void)
 	glDeleteLists(sphereDisplayList,1);
 	}
 
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+VisibilityCuller::View getCurrentView(void) // Returns the view defined by the current OpenGL projection and modelview matrices and viewport
+	{
+	/* Query the current matrices, which are stored in column-major order, and the viewport: */
+	GLdouble projection[16],modelview[16];
+	glGetDoublev(GL_PROJECTION_MATRIX,projection);
+	glGetDoublev(GL_MODELVIEW_MATRIX,modelview);
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT,viewport);
+	
+	/* Combine the matrices into a row-major projection matrix: */
+	double pmv[4][4];
+	for(int i=0;i<4;++i)
+		for(int j=0;j<4;++j)
+			{
+			pmv[i][j]=0.0;
+			for(int k=0;k<4;++k)
+				pmv[i][j]+=projection[k*4+i]*modelview[j*4+k];
+			}
+	
+	return VisibilityCuller::View(pmv,(unsigned int)(viewport[2]),(unsigned int)(viewport[3]));
+	}
+
+/**************
+Helper classes:
+**************/
+
+template <class VertexParam>
+class LinkVertexLoop:public SimulationScheduler::ParallelFunction // Loop body writing pairs of line segment vertices for ranges of links
+	{
+	/* Elements: */
+	private:
+	const Network::LinkList& links; // Network links
+	const VisualNetwork::ColorList& nodeColors; // Node colors
+	const std::vector<Point>& positions; // Node positions
+	VertexParam* vertices; // Vertex array to write
+	
+	/* Constructors and destructors: */
+	public:
+	LinkVertexLoop(const Network::LinkList& sLinks,const VisualNetwork::ColorList& sNodeColors,const std::vector<Point>& sPositions,VertexParam* sVertices)
+		:links(sLinks),nodeColors(sNodeColors),positions(sPositions),vertices(sVertices)
+		{
+		}
+	
+	/* Methods from class SimulationScheduler::ParallelFunction: */
+	virtual void operator()(Index begin,Index end)
+		{
+		VertexParam* vPtr=vertices+begin*2;
+		for(Index linkIndex=begin;linkIndex<end;++linkIndex)
+			{
+			/* Calculate the link's opacity from its value: */
+			const Link& link=links[linkIndex];
+			GLubyte linkAlpha;
+			if(link.getValue()<=Scalar(0))
+				linkAlpha=GLubyte(0U);
+			else if(link.getValue()>=Scalar(1))
+				linkAlpha=GLubyte(255U);
+			else
+				linkAlpha=GLubyte(Math::floor(link.getValue()*256.0));
+			
+			/* Write the link's two vertices: */
+			for(int i=0;i<2;++i,++vPtr)
+				{
+				const Node::Color& nc=nodeColors[link.getNodeIndex(i)];
+				for(int j=0;j<3;++j)
+					vPtr->color[j]=nc[j];
+				vPtr->color[3]=linkAlpha;
+				const Point& pos=positions[link.getNodeIndex(i)];
+				for(int j=0;j<3;++j)
+					vPtr->position[j]=GLfloat(pos[j]);
+				}
+			}
+		}
+	};
+
+}
+
 /******************************
 Methods of class NetworkViewer:
 ******************************/
@@ -179,38 +263,70 @@ void NetworkViewer::unlockSelection(void)
 	selectionLocked=false;
 	}
 
-void NetworkViewer::objectSnapCallback(Vrui::ObjectSnapperToolFactory::SnapRequest& snapRequest)
+void NetworkViewer::updateNodeRadii(void)
 	{
-	/* Snap against all particles: */
-	for(Index index=0;index<particles.getNumParticles();++index)
-		snapRequest.snapPoint(Vrui::Point(particles.getParticlePosition(index)));
+	/* Check if the rendering settings changed since the radii were last calculated: */
+	const Network::NodeList& nodes=network->getNodes();
+	if(nodeRadii.size()!=nodes.size()||nodeRadiiRadius!=nodeRadius||nodeRadiiExponent!=nodeSizeExponent)
+		{
+		/* Calculate the radii of all nodes once: */
+		network->calcNodeRadii(nodeRadius,useNodeSize,nodeSizeExponent,nodeRadii);
+		nodeRadiiRadius=nodeRadius;
+		nodeRadiiExponent=nodeSizeExponent;
+		
+		/* Mark the node hierarchy as outdated: */
+		nodeBVHOutdated=true;
+		}
 	}
 
-void NetworkViewer::attenuationValueChangedCallback(GLMotif::TextFieldSlider::ValueChangedCallbackData* cbData)
+const SphereBVH& NetworkViewer::getNodeBVH(void)
 	{
-	particles.setAttenuation(Scalar(cbData->value));
+	/* Refit or rebuild the node hierarchy if particles moved or nodes changed size since it was last updated: */
+	if(nodeBVHOutdated)
+		{
+		const NodePositionList& positions=getNodePositions();
+		nodeBVH.update(positions,nodeRadii,Index(positions.size()));
+		nodeBVHOutdated=false;
+		}
+	
+	return nodeBVH;
 	}
 
-void NetworkViewer::repellingForceModeValueChangedCallback(GLMotif::DropdownBox::ValueChangedCallbackData* cbData)
+void NetworkViewer::updateLinkVertices(void)
 	{
-	switch(cbData->newSelectedItem)
-		{
-		case 0:
-			repellingForceMode=Linear;
-			break;
-		
-		case 1:
-			repellingForceMode=Quadratic;
-			break;
-		}
+	/* Write two vertices for each link in parallel: */
+	const Network::LinkList& links=network->getLinks();
+	linkVertices.resize(links.size()*2);
+	LinkVertexLoop<LinkVertex> lvl(links,network->getNodeColors(),getNodePositions(),linkVertices.empty()?0:&linkVertices.front());
+	scheduler->parallelFor(Index(links.size()),lvl);
 	}
 
-void NetworkViewer::linkStrengthValueChangedCallback(GLMotif::TextFieldSlider::ValueChangedCallbackData* cbData)
+void NetworkViewer::simulationUpdateCallback(const ParticleSystem& particles)
 	{
-	linkStrength=Scalar(cbData->value);
+	/* Copy the particle positions, which are indexed by node index, into a new slot of the position triple buffer: */
+	NodePositionList& newPositions=positions.startNewValue();
+	Index numParticles=particles.getNumParticles();
+	if(numParticles>0)
+		newPositions.assign(&particles.getParticlePosition(0),&particles.getParticlePosition(0)+numParticles);
+	else
+		newPositions.clear();
+	positions.postNewValue();
 	
-	/* Set the overall distance constraint scale in the particle system: */
-	particles.setDistConstraintScale(linkStrength);
+	/* Wake up the main thread: */
+	Vrui::requestUpdate();
+	}
+
+void NetworkViewer::objectSnapCallback(Vrui::ObjectSnapperToolFactory::SnapRequest& snapRequest)
+	{
+	/* Snap against all nodes whose hierarchy nodes are close enough to the snap request: */
+	SphereCenterSnapper snapper(snapRequest);
+	getNodeBVH().processSpheres(getNodePositions(),std::vector<Scalar>(),snapper);
+	}
+
+void NetworkViewer::simulationParametersChangedCallback(Misc::CallbackData* cbData)
+	{
+	/* Hand the new simulation parameters to the network simulator: */
+	simulator->setSimulationParameters(simulationParameters);
 	}
 
 GLMotif::PopupWindow* NetworkViewer::createParametersDialog(void)
@@ -238,8 +354,8 @@ GLMotif::PopupWindow* NetworkViewer::createParametersDialog(void)
 	attenuationSlider->getTextField()->setFloatFormat(GLMotif::TextField::SMART);
 	attenuationSlider->setValueRange(0.0,1.0,0.001);
 	attenuationSlider->setGammaExponent(0.5,0.9);
-	attenuationSlider->setValue(particles.getAttenuation());
-	attenuationSlider->getValueChangedCallbacks().add(this,&NetworkViewer::attenuationValueChangedCallback);
+	attenuationSlider->track(simulationParameters.attenuation);
+	attenuationSlider->getValueChangedCallbacks().add(this,&NetworkViewer::simulationParametersChangedCallback);
 	
 	new GLMotif::Label("CentralForceLabel",parameters,"Central Force Strength");
 	
@@ -249,24 +365,16 @@ GLMotif::PopupWindow* NetworkViewer::createParametersDialog(void)
 	centralForceSlider->getTextField()->setPrecision(2);
 	centralForceSlider->getTextField()->setFloatFormat(GLMotif::TextField::FIXED);
 	centralForceSlider->setValueRange(0.0,50.0,0.01);
-	centralForceSlider->track(centralForce);
+	centralForceSlider->track(simulationParameters.centralForce);
+	centralForceSlider->getValueChangedCallbacks().add(this,&NetworkViewer::simulationParametersChangedCallback);
 	
 	new GLMotif::Label("RepellingForceModeLabel",parameters,"Repelling Force Mode");
 	
 	GLMotif::DropdownBox* repellingForceModeBox=new GLMotif::DropdownBox("RepellingForceModeBox",parameters);
 	repellingForceModeBox->addItem("Linear");
 	repellingForceModeBox->addItem("Quadratic");
-	switch(repellingForceMode)
-		{
-		case Linear:
-			repellingForceModeBox->setSelectedItem(0);
-			break;
-		
-		case Quadratic:
-			repellingForceModeBox->setSelectedItem(1);
-			break;
-		}
-	repellingForceModeBox->getValueChangedCallbacks().add(this,&NetworkViewer::repellingForceModeValueChangedCallback);
+	repellingForceModeBox->track(simulationParameters.repellingForceMode);
+	repellingForceModeBox->getValueChangedCallbacks().add(this,&NetworkViewer::simulationParametersChangedCallback);
 	
 	new GLMotif::Label("RepellingForceLabel",parameters,"Repelling Force Strength");
 	
@@ -276,7 +384,8 @@ GLMotif::PopupWindow* NetworkViewer::createParametersDialog(void)
 	repellingForceSlider->getTextField()->setPrecision(2);
 	repellingForceSlider->getTextField()->setFloatFormat(GLMotif::TextField::FIXED);
 	repellingForceSlider->setValueRange(0.0,50.0,0.01);
-	repellingForceSlider->track(repellingForce);
+	repellingForceSlider->track(simulationParameters.repellingForce);
+	repellingForceSlider->getValueChangedCallbacks().add(this,&NetworkViewer::simulationParametersChangedCallback);
 	
 	new GLMotif::Label("RepellingForceThetaLabel",parameters,"Repelling Force Theta");
 	
@@ -288,7 +397,8 @@ GLMotif::PopupWindow* NetworkViewer::createParametersDialog(void)
 	repellingForceThetaSlider->getTextField()->setFloatFormat(GLMotif::TextField::SMART);
 	repellingForceThetaSlider->setValueRange(0.0,1.0,0.001);
 	repellingForceThetaSlider->setGammaExponent(0.5,0.25);
-	repellingForceThetaSlider->track(repellingForceTheta);
+	repellingForceThetaSlider->track(simulationParameters.repellingForceTheta);
+	repellingForceThetaSlider->getValueChangedCallbacks().add(this,&NetworkViewer::simulationParametersChangedCallback);
 	
 	new GLMotif::Label("RepellingForceCutoffLabel",parameters,"Repelling Force Cutoff");
 	
@@ -298,7 +408,8 @@ GLMotif::PopupWindow* NetworkViewer::createParametersDialog(void)
 	repellingForceCutoffSlider->getTextField()->setPrecision(3);
 	repellingForceCutoffSlider->getTextField()->setFloatFormat(GLMotif::TextField::FIXED);
 	repellingForceCutoffSlider->setValueRange(0.0,1.0,0.001);
-	repellingForceCutoffSlider->track(repellingForceCutoff);
+	repellingForceCutoffSlider->track(simulationParameters.repellingForceCutoff);
+	repellingForceCutoffSlider->getValueChangedCallbacks().add(this,&NetworkViewer::simulationParametersChangedCallback);
 	
 	new GLMotif::Label("LinkStrengthLabel",parameters,"Link Strength");
 	
@@ -310,8 +421,8 @@ GLMotif::PopupWindow* NetworkViewer::createParametersDialog(void)
 	linkStrengthSlider->getTextField()->setFloatFormat(GLMotif::TextField::SMART);
 	linkStrengthSlider->setValueRange(0.0,1.0,0.001);
 	linkStrengthSlider->setGammaExponent(0.5,0.1);
-	linkStrengthSlider->setValue(linkStrength);
-	linkStrengthSlider->getValueChangedCallbacks().add(this,&NetworkViewer::linkStrengthValueChangedCallback);
+	linkStrengthSlider->track(simulationParameters.linkStrength);
+	linkStrengthSlider->getValueChangedCallbacks().add(this,&NetworkViewer::simulationParametersChangedCallback);
 	
 	parameters->manageChild();
 	
@@ -435,8 +546,8 @@ GLMotif::PopupMenu* NetworkViewer::createColorMappingMenu(void)
 	GLMotif::PopupMenu* colorMappingMenu=new GLMotif::PopupMenu("ColorMappingMenu",Vrui::getWidgetManager());
 	
 	/* Add buttons for all defined node properties: */
-	const Network::StringList& names=network->getNodePropertyNames();
-	for(Network::StringList::const_iterator nIt=names.begin();nIt!=names.end();++nIt)
+	const VisualNetwork::StringList& names=network->getNodePropertyNames();
+	for(VisualNetwork::StringList::const_iterator nIt=names.begin();nIt!=names.end();++nIt)
 		{
 		GLMotif::Button* button=colorMappingMenu->addEntry(nIt->c_str());
 		button->getSelectCallbacks().add(this,&NetworkViewer::colorMapPropertySelectedCallback);
@@ -484,9 +595,11 @@ GLMotif::PopupMenu* NetworkViewer::createMainMenu(void)
 NetworkViewer::NetworkViewer(int& argc,char**& argv)
 	:Vrui::Application(argc,argv),
 	 network(0),
-	 centralForce(5),
-	 repellingForceMode(Linear),repellingForce(2),repellingForceTheta(0.25),repellingForceCutoff(0.01),
-	 linkStrength(0.01),
+	 scheduler(new SimulationScheduler(0)),simulator(0),
+	 resetNavigationPending(false),nextDragId(0),
+	 nodeRadiiRadius(0),nodeRadiiExponent(0),
+	 nodeBVHOutdated(true),
+	 cullNodes(true),linkVerticesOutdated(true),linkVerticesColorVersion(0),culler(scheduler),
 	 nodeRadius(0.05),useNodeSize(true),nodeSizeExponent(0.0),
 	 selectionLocked(false),
 	 parametersDialog(0),renderingDialog(0),mainMenu(0),
@@ -496,15 +609,36 @@ NetworkViewer::NetworkViewer(int& argc,char**& argv)
 		throw std::runtime_error("NetworkViewer: No mineral network file name provided");
 	
 	/* Load the mineral network json file given on the command line: */
-	network=new Network(*IO::openFile(argv[1]));
+	network=new VisualNetwork(*IO::openFile(argv[1]));
 	
-	/* Initialize the particle system: */
-	particles.setGravity(Vector::zero);
-	particles.setAttenuation(Scalar(0.1));
-	particles.setDistConstraintScale(linkStrength);
-	particles.setNumRelaxationIterations(20);
-	network->createParticles(particles,Scalar(1));
-	particles.finishUpdate();
+	/* Initialize the simulation parameters: */
+	simulationParameters.attenuation=Scalar(0.1);
+	simulationParameters.linkStrength=Scalar(0.01);
+	double updateInterval=1.0/60.0;
+	
+	/* Parse the remaining command line: */
+	for(int argi=2;argi<argc;++argi)
+		{
+		if(argv[argi][0]=='-')
+			{
+			if(strcasecmp(argv[argi]+1,"noCulling")==0)
+				cullNodes=false;
+			else if(strcasecmp(argv[argi]+1,"lodSizes")==0&&argi+2<argc)
+				{
+				Scalar sphereSize=Scalar(atof(argv[argi+1]));
+				Scalar impostorSize=Scalar(atof(argv[argi+2]));
+				culler.setLodSizes(sphereSize,impostorSize);
+				argi+=2;
+				}
+			else if(strcasecmp(argv[argi]+1,"updateInterval")==0&&argi+1<argc)
+				updateInterval=atof(argv[++argi]);
+			}
+		}
+	
+	/* Start laying out the network on the scheduler's threads: */
+	simulator=new NetworkSimulator(*network,simulationParameters,*Threads::createFunctionCall(this,&NetworkViewer::simulationUpdateCallback),*scheduler);
+	simulator->setCenterOfGravityAttraction(true);
+	simulator->setUpdateInterval(updateInterval);
 	
 	/* Initialize the tool classes: */
 	Tool::initClass();
@@ -555,286 +689,68 @@ NetworkViewer::NetworkViewer(int& argc,char**& argv)
 
 NetworkViewer::~NetworkViewer(void)
 	{
+	/* Shut down the network simulator before deleting the network and the scheduler: */
+	delete simulator;
 	delete network;
 	
 	delete parametersDialog;
 	delete renderingDialog;
 	delete mainMenu;
 	delete nodeCallout;
+	delete scheduler;
 	}
 
-class LocalRepulsiveForceFunctor
-	{
-	/* Elements: */
-	private:
-	ParticleSystem& particles; // Reference to particle system
-	Index index; // Index of source particle
-	const Point& position; // Source particle's position
-	Scalar dt2; // Squared time step
-	
-	/* Constructors and destructors: */
-	public:
-	LocalRepulsiveForceFunctor(ParticleSystem& sParticles,Index sIndex,Scalar sDt2)
-		:particles(sParticles),
-		 index(sIndex),position(particles.getParticlePosition(index)),
-		 dt2(sDt2)
-		{
-		}
-	
-	/* Methods: */
-	const Point& getCenterPosition(void) const
-		{
-		return position;
-		}
-	Scalar getMaxDist2(void) const
-		{
-		return Scalar(4); // Two times link length, squared
-		}
-	void operator()(Index particleIndex,const Point& particlePosition,Scalar dist2)
-		{
-		if(index<particleIndex)
-			{
-			/* Calculate the force: */
-			if(dist2>Scalar(0))
-				{
-				/* Calculate force vector: */
-				Vector force=(particles.getParticlePosition(particleIndex)-position)*((Scalar(10)-Scalar(5)*Math::sqrt(dist2))/dist2);
-				
-				/* Apply the force vector to both particles: */
-				particles.forceParticle(index,-force,dt2);
-				particles.forceParticle(particleIndex,force,dt2);
-				}
-			else
-				{
-				/* Do something clever... */
-				}
-			}
-		}
-	};
-
-class GlobalRepulsiveForceFunctor // Base class for n-body force functors
+void NetworkViewer::frame(void)
 	{
-	/* Elements: */
-	protected:
-	Scalar theta; // Barnes-Hut approximation threshold
-	Scalar minDist,minDist2; // Squared minimum particle distance for inverse force law
-	Index particleIndex; // Index of particle for which forces are accumulated
-	Point particlePosition; // Position of particle for which forces are accumulated
-	Vector force; // Accumulated force
-	
-	/* Constructors and destructors: */
-	public:
-	GlobalRepulsiveForceFunctor(Scalar sTheta,Scalar sMinDist)
-		:theta(sTheta),minDist(sMinDist),minDist2(Math::sqr(minDist))
+	/* Lock the most recent node positions published by the network simulator: */
+	if(positions.lockNewValue())
 		{
-		}
-	
-	/* Methods: */
-	void prepareParticle(Index newParticleIndex,const Point& newParticlePosition) // Prepares to accumulate force for a new particle
-		{
-		/* Remember the new particle: */
-		particleIndex=newParticleIndex;
-		particlePosition=newParticlePosition;
+		/* Mark the node hierarchy and link vertices as outdated: */
+		nodeBVHOutdated=true;
+		linkVerticesOutdated=true;
 		
-		/* Reset the force accumulator: */
-		force=Vector::zero;
-		}
-	Index getParticleIndex(void) const
-		{
-		return particleIndex;
-		}
-	const Point& getParticlePosition(void) const
-		{
-		return particlePosition;
-		}
-	Scalar getTheta(void) const
-		{
-		return theta;
-		}
-	const Vector& getForce(void) const // Returns the accumulated force
-		{
-		return force;
-		}
-	};
-
-class GlobalRepulsiveForceFunctorLinear:public GlobalRepulsiveForceFunctor // Functor for inverse linear n-body force
-	{
-	/* Constructors and destructors: */
-	public:
-	GlobalRepulsiveForceFunctorLinear(Scalar sTheta,Scalar sMinDist)
-		:GlobalRepulsiveForceFunctor(sTheta,sMinDist)
-		{
-		}
-	
-	/* Methods: */
-	void operator()(const Vector& dist,Scalar distLen2,Scalar mass)
-		{
-		/* Check the distance against the inverse force law cutoff: */
-		if(distLen2>=minDist2)
-			{
-			/* Use inverse force law: */
-			force-=dist*(mass/distLen2);
-			}
-		else if(distLen2>Scalar(0))
-			{
-			/* Use cut-off inverse force law: */
-			force-=dist*(mass/Math::sqrt(minDist2*distLen2));
-			}
-		else
-			{
-			/* Use a random distance vector: */
-			Vector d=Geometry::randVectorUniform<Scalar,3>(minDist);
-			force-=d*(mass/minDist2);
-			}
-		}
-	};
-
-class GlobalRepulsiveForceFunctorQuadratic:public GlobalRepulsiveForceFunctor // Functor for inverse quadratic n-body force
-	{
-	/* Constructors and destructors: */
-	public:
-	GlobalRepulsiveForceFunctorQuadratic(Scalar sTheta,Scalar sMinDist)
-		:GlobalRepulsiveForceFunctor(sTheta,sMinDist)
-		{
+		/* Center the network in the display if the navigation transformation was reset before any positions arrived: */
+		if(resetNavigationPending)
+			resetNavigation();
 		}
 	
-	/* Methods: */
-	void operator()(const Vector& dist,Scalar distLen2,Scalar mass)
+	/* Check if node positions are available: */
+	if(getNodePositions().size()==network->getNodes().size())
 		{
-		/* Check the distance against the inverse force law cutoff: */
-		if(distLen2>=minDist2)
-			{
-			/* Use inverse force law: */
-			force-=dist*(mass/(distLen2*Math::sqrt(distLen2)));
-			}
-		else if(distLen2>Scalar(0))
-			{
-			/* Use cut-off inverse force law: */
-			force-=dist*(mass/(minDist2*Math::sqrt(distLen2)));
-			}
-		else
-			{
-			/* Use a random distance vector: */
-			Vector d=Geometry::randVectorUniform<Scalar,3>(minDist);
-			force-=d*(mass/(minDist2*minDist));
-			}
-		}
-	};
-
-void NetworkViewer::frame(void)
-	{
-	/* Advance the particle system's state: */
-	Scalar dt(1.0/60.0); // Vrui::getFrameTime());
-	if(dt>Scalar(0))
-		{
-		#if TIMING
-		Realtime::TimePointMonotonic timer0;
-		#endif
-		Scalar dt2=Math::sqr(dt);
-		particles.moveParticles(dt);
-		#if TIMING
-		std::cout<<double(timer0.setAndDiff())*1000.0<<"ms";
-		#endif
-		
-		/* Pull all particles towards the network's center of gravity: */
-		#if TIMING
-		Realtime::TimePointMonotonic timer1;
-		#endif
-		const ParticleOctree& octree=particles.getOctree();
-		Point center=octree.getCenterOfGravity();
-		// center=Point::origin;
-		for(Index index=0;index<particles.getNumParticles();++index)
-			{
-			const Point& pos=particles.getParticlePosition(index);
-			Vector d=center-pos;
-			particles.forceParticle(index,d,dt2*centralForce);
-			}
-		#if TIMING
-		std::cout<<", "<<double(timer1.setAndDiff())*1000.0<<"ms";
-		#endif
-		
-		/* Apply a repelling n-body force to all particles: */
-		#if TIMING
-		Realtime::TimePointMonotonic timer2;
-		#endif
-		switch(repellingForceMode)
+		/* Prepare the link vertices for all OpenGL contexts once if nodes moved or changed color: */
+		if(linkVerticesOutdated||linkVerticesColorVersion!=network->getColorVersion())
 			{
-			case Linear:
-				{
-				GlobalRepulsiveForceFunctorLinear grff(repellingForceTheta,repellingForceCutoff);
-				for(Index index=0;index<particles.getNumParticles();++index)
-					{
-					grff.prepareParticle(index,particles.getParticlePosition(index));
-					octree.calcForce(grff);
-					particles.forceParticle(index,grff.getForce(),dt2*repellingForce);
-					}
-				
-				break;
-				}
-			
-			case Quadratic:
-				{
-				GlobalRepulsiveForceFunctorQuadratic grff(repellingForceTheta,repellingForceCutoff);
-				for(Index index=0;index<particles.getNumParticles();++index)
-					{
-					grff.prepareParticle(index,particles.getParticlePosition(index));
-					octree.calcForce(grff);
-					particles.forceParticle(index,grff.getForce(),dt2*repellingForce);
-					}
-				
-				break;
-				}
+			updateLinkVertices();
+			linkVerticesOutdated=false;
+			linkVerticesColorVersion=network->getColorVersion();
 			}
-		#if TIMING
-		std::cout<<", "<<double(timer2.setAndDiff())*1000.0<<"ms";
-		#endif
 		
-		#if 0
-		/* Calculate interaction forces between linked particles: */
-		for(std::vector<Link>::iterator lIt=links.begin();lIt!=links.end();++lIt)
-			{
-			/* Calculate force vector: */
-			Index i0=lIt->getNode(0)->getParticleIndex();
-			Index i1=lIt->getNode(1)->getParticleIndex();
-			Vector d=particles.getParticlePosition(i1)-particles.getParticlePosition(i0);
-			Scalar dLen2=d.sqr();
-			d*=Scalar(0.5)*(Scalar(1)-Scalar(1)/d.mag())*linkStrength;
-			
-			/* Apply the force vector to both particles: */
-			particles.forceParticle(i0,d,Scalar(1));
-			particles.forceParticle(i1,d,Scalar(-1));
-			}
-		#endif
+		/* Update the node radii if the rendering settings changed: */
+		updateNodeRadii();
 		
-		#if 0
-		/* Calculate interactions between all pairs of near particles: */
-		for(Index index=0;index<particles.getNumParticles();++index)
-			{
-			LocalRepulsiveForceFunctor lrff(particles,index,dt2);
-			particles.processCloseParticles(lrff);
-			}
-		#endif
-		
-		/* Finish the particle system's update step: */
-		#if TIMING
-		Realtime::TimePointMonotonic timer3;
-		#endif
-		particles.enforceConstraints(dt);
-		#if TIMING
-		std::cout<<", "<<double(timer3.setAndDiff())*1000.0<<"ms"<<std::endl;
-		#endif
+		/* Update the node hierarchy to cull against the new node positions and radii: */
+		if(cullNodes)
+			getNodeBVH();
 		}
-	
-	/* Request another frame: */
-	Vrui::scheduleUpdate(Vrui::getNextAnimationTime());
 	}
 
 void NetworkViewer::display(GLContextData& contextData) const
 	{
-	#if 0 // Not currently needed
 	/* Retrieve the context data item: */
 	DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
-	#endif
+	
+	/* Bail out if the network simulator has not yet published node positions: */
+	const Network::NodeList& nodes=network->getNodes();
+	const NodePositionList& positions=getNodePositions();
+	if(positions.size()!=nodes.size()||nodeRadii.size()!=nodes.size())
+		return;
+	
+	/* Cull nodes and links against the view frustum if the node hierarchy is current: */
+	bool culled=cullNodes&&!nodeBVHOutdated&&nodeBVH.getNumSpheres()==nodes.size();
+	const VisibilityCuller::VisibleSet& vs=dataItem->visibleSet;
+	if(culled)
+		culler.cull(getCurrentView(),nodeBVH,positions,nodeRadii,network->getLinks(),dataItem->visibleSet);
+	dataItem->linksCulled=culled;
 	
 	/* Set up OpenGL state: */
 	glPushAttrib(GL_ENABLE_BIT|GL_POINT_BIT);
@@ -858,16 +774,29 @@ void NetworkViewer::display(GLContextData& contextData) const
 	
 	/* Draw all nodes: */
 	glBegin(GL_POINTS);
-	Network::ColorList::const_iterator ncIt=network->getNodeColors().begin();
-	const Network::NodeList& nodes=network->getNodes();
-	if(useNodeSize)
+	const VisualNetwork::ColorList& nodeColors=network->getNodeColors();
+	VisualNetwork::ColorList::const_iterator ncIt=nodeColors.begin();
+	if(culled)
+		{
+		/* Draw only visible nodes of sufficient projected size as spheres: */
+		for(std::vector<Index>::const_iterator snIt=vs.sphereNodes.begin();snIt!=vs.sphereNodes.end();++snIt)
+			{
+			glColor<4>(nodeColors[*snIt].getComponents());
+			const Point& pos=positions[*snIt];
+			if(useNodeSize)
+				glVertex4f(pos[0],pos[1],pos[2],nodeRadii[*snIt]);
+			else
+				glVertex(pos);
+			}
+		}
+	else if(useNodeSize)
 		{
 		for(Network::NodeList::const_iterator nIt=nodes.begin();nIt!=nodes.end();++nIt,++ncIt)
 			{
 			/* Draw the node: */
 			glColor<4>(ncIt->getComponents());
-			const Point& pos=particles.getParticlePosition(nIt->getParticleIndex());
-			glVertex4f(pos[0],pos[1],pos[2],nodeRadius*Math::pow(nIt->getSize(),nodeSizeExponent));
+			const Point& pos=positions[nIt-nodes.begin()];
+			glVertex4f(pos[0],pos[1],pos[2],nodeRadii[nIt-nodes.begin()]);
 			}
 		}
 	else
@@ -876,7 +805,7 @@ void NetworkViewer::display(GLContextData& contextData) const
 			{
 			/* Draw the node: */
 			glColor<4>(ncIt->getComponents());
-			glVertex(particles.getParticlePosition(nIt->getParticleIndex()));
+			glVertex(positions[nIt-nodes.begin()]);
 			}
 		}
 	glEnd();
@@ -888,16 +817,40 @@ void NetworkViewer::display(GLContextData& contextData) const
 	
 	#endif
 	
+	if(culled)
+		{
+		/* Draw smaller nodes, and clusters of nodes too small to be drawn individually, as single unlit points: */
+		glDisable(GL_LIGHTING);
+		glPointSize(1.0f);
+		glBegin(GL_POINTS);
+		for(std::vector<Index>::const_iterator dnIt=vs.dotNodes.begin();dnIt!=vs.dotNodes.end();++dnIt)
+			{
+			glColor<4>(nodeColors[*dnIt].getComponents());
+			glVertex(positions[*dnIt]);
+			}
+		for(std::vector<VisibilityCuller::ClusterImpostor>::const_iterator iIt=vs.impostors.begin();iIt!=vs.impostors.end();++iIt)
+			{
+			glColor<4>(nodeColors[iIt->representative].getComponents());
+			glVertex(iIt->center);
+			}
+		glEnd();
+		}
+	
 	glPopAttrib();
 	}
 
 void NetworkViewer::resetNavigation(void)
 	{
+	/* Postpone resetting the navigation transformation until the network simulator publishes node positions: */
+	const NodePositionList& positions=getNodePositions();
+	resetNavigationPending=positions.empty();
+	if(resetNavigationPending)
+		return;
+	
 	/* Calculate the network graph's bounding box: */
 	Geometry::Box<Scalar,3> bbox=Geometry::Box<Scalar,3>::empty;
-	const Network::NodeList& nodes=network->getNodes();
-	for(Network::NodeList::const_iterator nIt=nodes.begin();nIt!=nodes.end();++nIt)
-		bbox.addPoint(particles.getParticlePosition(nIt->getParticleIndex()));
+	for(NodePositionList::const_iterator pIt=positions.begin();pIt!=positions.end();++pIt)
+		bbox.addPoint(*pIt);
 	
 	/* Center and scale the network graph: */
 	Vrui::Point center(Geometry::mid(bbox.min,bbox.max));
@@ -907,6 +860,9 @@ void NetworkViewer::resetNavigation(void)
 
 void NetworkViewer::glRenderActionTransparent(GLContextData& contextData) const
 	{
+	/* Retrieve the context data item: */
+	DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
+	
 	/* Set up OpenGL state: */
 	glPushAttrib(GL_ENABLE_BIT|GL_LINE_BIT);
 	glDisable(GL_LIGHTING);
@@ -919,28 +875,28 @@ void NetworkViewer::glRenderActionTransparent(GLContextData& contextData) const
 	/* Go to navigational space: */
 	Vrui::goToNavigationalSpace(contextData);
 	
-	/* Draw all links: */
-	glBegin(GL_LINES);
-	const Network::ColorList& nodeColors=network->getNodeColors();
-	const Network::LinkList& links=network->getLinks();
-	for(Network::LinkList::const_iterator lIt=links.begin();lIt!=links.end();++lIt)
+	/* Draw the prepared link vertices from a client-side vertex array: */
+	GLVertexArrayParts::enable(LinkVertex::getPartsMask());
+	if(!linkVertices.empty())
+		glVertexPointer(&linkVertices.front());
+	if(dataItem->linksCulled)
 		{
-		GLubyte linkAlpha;
-		if(lIt->getValue()<=Scalar(0))
-			linkAlpha=GLubyte(0U);
-		else if(lIt->getValue()>=Scalar(1))
-			linkAlpha=GLubyte(255U);
-		else
-			linkAlpha=GLubyte(Math::floor(lIt->getValue()*256.0));
-		// linkAlpha=51U;
-		for(int i=0;i<2;++i)
-			{
-			const Node::Color& nc=nodeColors[lIt->getNodeIndex(i)];
-			glColor4ub(nc[0],nc[1],nc[2],linkAlpha);
-			glVertex(particles.getParticlePosition(lIt->getNode(i)->getParticleIndex()));
-			}
+		/* Draw only the links found visible during the display pass: */
+		std::vector<GLuint>& lis=dataItem->linkIndices;
+		lis.clear();
+		lis.reserve(dataItem->visibleSet.links.size()*2);
+		for(std::vector<Index>::const_iterator lIt=dataItem->visibleSet.links.begin();lIt!=dataItem->visibleSet.links.end();++lIt)
+			for(int i=0;i<2;++i)
+				lis.push_back(GLuint(*lIt)*2U+GLuint(i));
+		if(!lis.empty())
+			glDrawElements(GL_LINES,GLsizei(lis.size()),GL_UNSIGNED_INT,&lis.front());
 		}
-	glEnd();
+	else
+		{
+		/* Draw all links: */
+		glDrawArrays(GL_LINES,0,GLsizei(linkVertices.size()));
+		}
+	GLVertexArrayParts::disable(LinkVertex::getPartsMask());
 
 	/* Return to physical space: */
 	glPopMatrix();
@@ -26,9 +26,11 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include "Config.h"
 
 #include <vector>
+#include <Threads/TripleBuffer.h>
 #include <GL/gl.h>
 #include <GL/GLObject.h>
 #include <GL/GLColorMap.h>
+#include <GL/GLGeometryVertex.icpp>
 #if CONFIG_USE_IMPOSTORSPHERES
 #include <GL/GLSphereRenderer.h>
 #endif
@@ -41,25 +43,24 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Vrui/ObjectSnapperTool.h>
 
 #include "ParticleTypes.h"
-#include "ParticleSystem.h"
+#include "SimulationParameters.h"
+#include "VisualNetwork.h"
+#include "SphereBVH.h"
+#include "VisibilityCuller.h"
 
 /* Forward declarations: */
 namespace GLMotif {
 class PopupWindow;
 class PopupMenu;
 }
-class Network;
+class ParticleSystem;
+class SimulationScheduler;
+class NetworkSimulator;
 
 class NetworkViewer:public Vrui::Application,public Vrui::TransparentObject,public GLObject
 	{
 	/* Embedded classes: */
 	private:
-	enum ForceMode // Enumerated type for n-body repelling force formulas
-		{
-		Linear, // Inverse linear force law
-		Quadratic // Inverse quadratic force law
-		};
-	
 	class Tool; // Base class for tools working with the NetworkViewer application
 	friend class Tool;
 	
@@ -72,6 +73,10 @@ class NetworkViewer:public Vrui::Application,public Vrui::TransparentObject,publ
 	friend class SubtractSelectTool;
 	friend class ShowPropertiesTool;
 	
+	typedef std::vector<Point> NodePositionList; // Type for lists of node positions indexed by node index
+	
+	typedef GLGeometry::Vertex<void,0,GLubyte,4,void,GLfloat,3> LinkVertex; // Type for vertices of link line segments
+	
 	struct DataItem:public GLObject::DataItem
 		{
 		/* Elements: */
@@ -79,6 +84,9 @@ class NetworkViewer:public Vrui::Application,public Vrui::TransparentObject,publ
 		GLuint vertexBuffer; // Buffer holding node positions and colors
 		GLuint indexBuffer; // Buffer holding indices of linked nodes
 		GLenum sphereDisplayList; // ID of a display list to render a small sphere
+		VisibilityCuller::VisibleSet visibleSet; // Nodes and links found visible during the most recent display pass
+		bool linksCulled; // Flag whether the visible set's link list reflects the most recent display pass
+		std::vector<GLuint> linkIndices; // Indices of link vertices of links found visible during the most recent display pass
 		
 		/* Constructors and destructors: */
 		DataItem(void);
@@ -86,14 +94,22 @@ class NetworkViewer:public Vrui::Application,public Vrui::TransparentObject,publ
 		};
 	
 	/* Elements: */
-	Network* network; // The visualized network
-	ParticleSystem particles; // Particle system simulating the interaction between linked nodes
-	Scalar centralForce; // Coefficient of central force pulling particles towards the center of the display
-	ForceMode repellingForceMode; // Repelling force calculation mode
-	Scalar repellingForce; // Coefficient of repelling n-body force
-	Scalar repellingForceTheta; // Approximation threshold for Barnes-Hut n-body force calculation
-	Scalar repellingForceCutoff; // Cutoff distance for inverse repelling force law
-	Scalar linkStrength; // Strength parameter for node links
+	VisualNetwork* network; // The visualized network
+	SimulationScheduler* scheduler; // Thread pool running the network simulation, and preparing vertex data and culling nodes and links in parallel
+	SimulationParameters simulationParameters; // Current set of simulation parameters
+	NetworkSimulator* simulator; // Simulator laying out the network on the scheduler's threads
+	Threads::TripleBuffer<NodePositionList> positions; // Triple buffer of node positions published by the network simulator
+	bool resetNavigationPending; // Flag whether the navigation transformation needs to be reset once the first node positions arrive
+	unsigned int nextDragId; // ID to assign to the next dragging operation sent to the network simulator
+	std::vector<Scalar> nodeRadii; // Radii of all nodes based on current rendering settings
+	Scalar nodeRadiiRadius,nodeRadiiExponent; // Rendering settings reflected in the node radius array
+	SphereBVH nodeBVH; // Bounding volume hierarchy of node spheres to accelerate picking, snapping, and culling
+	bool nodeBVHOutdated; // Flag whether the node hierarchy needs to be updated because particles moved
+	bool cullNodes; // Flag whether to cull nodes and links against the view frustum and select their levels of detail
+	std::vector<LinkVertex> linkVertices; // Expanded array of link line segment vertices prepared once per simulation step for all OpenGL contexts
+	bool linkVerticesOutdated; // Flag whether the link vertex array needs to be updated because nodes moved
+	unsigned int linkVerticesColorVersion; // Version number of the network's node color array reflected in the link vertex array
+	VisibilityCuller culler; // Culler selecting visible nodes and links and their levels of detail
 	Scalar nodeRadius; // Radius factor for node spheres
 	bool useNodeSize; // Flag to scale node spheres by their size fields
 	Scalar nodeSizeExponent; // Exponent to calculate node sphere radius from node size field
@@ -114,10 +130,16 @@ class NetworkViewer:public Vrui::Application,public Vrui::TransparentObject,publ
 	void showNodeProperties(unsigned int nodeIndex); // Displays the given node's property values
 	bool lockSelection(void); // Locks the selection; returns true if the selection was not already locked
 	void unlockSelection(void); // Unlocks the selection; assumes that caller successfully locked it before
+	const NodePositionList& getNodePositions(void) const // Returns the most recently locked node positions, which are empty until the network simulator publishes its first update
+		{
+		return positions.getLockedValue();
+		}
+	void simulationUpdateCallback(const ParticleSystem& particles); // Callback called from the network simulator when new node positions are available
+	void updateNodeRadii(void); // Recalculates the radii of all nodes if the rendering settings changed
+	const SphereBVH& getNodeBVH(void); // Returns the node hierarchy updated for the current particle positions and node radii
+	void updateLinkVertices(void); // Prepares the expanded link vertex array for the current particle positions and node colors
 	void objectSnapCallback(Vrui::ObjectSnapperToolFactory::SnapRequest& snapRequest); // Callback called when an object snapper tool issues a snap request
-	void attenuationValueChangedCallback(GLMotif::TextFieldSlider::ValueChangedCallbackData* cbData);
-	void repellingForceModeValueChangedCallback(GLMotif::DropdownBox::ValueChangedCallbackData* cbData);
-	void linkStrengthValueChangedCallback(GLMotif::TextFieldSlider::ValueChangedCallbackData* cbData);
+	void simulationParametersChangedCallback(Misc::CallbackData* cbData);
 	GLMotif::PopupWindow* createParametersDialog(void); // Creates a dialog window to change simulation parameters
 	GLMotif::PopupWindow* createRenderingDialog(void); // Creates a dialog window to change rendering settings
 	void clearSelectionCallback(Misc::CallbackData* cbData);
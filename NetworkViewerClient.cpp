@@ -21,6 +21,7 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include "NetworkViewerClient.h"
 
+#include <algorithm>
 #include <Misc/Autopointer.h>
 #include <Misc/MessageLogger.h>
 #include <Threads/FunctionCalls.h>
@@ -30,7 +31,9 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Collaboration2/MessageWriter.h>
 #include <Collaboration2/MessageContinuation.h>
 
-#include "Network.h"
+#include "DeflateFilter.h"
+#include "VisualNetwork.h"
+#include "Tracer.h"
 #include "CollaborativeNetworkViewer.h"
 
 namespace Collab {
@@ -41,8 +44,8 @@ namespace Plugins {
 Methods of class NetworkViewerClient::ReadNetworkJob:
 ****************************************************/
 
-NetworkViewerClient::ReadNetworkJob::ReadNetworkJob(unsigned int sNetworkVersion,const std::string& sNetworkName,IO::File& sNetworkFile,Client* sClient,unsigned int sServerMessageBase)
-	:networkVersion(sNetworkVersion),networkName(sNetworkName),networkFile(&sNetworkFile),
+NetworkViewerClient::ReadNetworkJob::ReadNetworkJob(unsigned int sNetworkVersion,const std::string& sNetworkName,IO::File& sNetworkFile,bool sDeflated,Client* sClient,unsigned int sServerMessageBase)
+	:networkVersion(sNetworkVersion),networkName(sNetworkName),networkFile(new InflateFilter(sNetworkFile,sDeflated)),
 	 network(0),
 	 client(sClient),serverMessageBase(sServerMessageBase)
 	{
@@ -65,7 +68,10 @@ void NetworkViewerClient::ReadNetworkJob::operator()(int)
 	try
 		{
 		/* Parse the network file into a network object: */
-		network=new Network(*networkFile);
+		network=new VisualNetwork(*networkFile);
+		
+		/* Report the network file's transfer size and time: */
+		Misc::formattedLogNote("NetworkViewer: Transferred network %s as %.1f MB %s (%.1f MB json) in %.3f s",networkName.c_str(),double(networkFile->getNumSourceBytes())/(1024.0*1024.0),networkFile->isDeflated()?"deflated":"raw",double(networkFile->getNumInflatedBytes())/(1024.0*1024.0),double(Realtime::TimePointMonotonic()-startTime));
 		}
 	catch(const std::runtime_error& err)
 		{
@@ -140,6 +146,7 @@ void NetworkViewerClient::loadNetworkNotificationCallback(unsigned int messageId
 	std::string newNetworkName;
 	charBufferToString(message,LoadNetworkMsg::networkNameLen,newNetworkName);
 	MetadosisProtocol::StreamID streamId=message.read<MetadosisProtocol::StreamID>();
+	Misc::UInt8 fileEncoding=message.read<Misc::UInt8>();
 	
 	/* Set the version of the currently downloading network: */
 	downloadingVersion=newNetworkVersion;
@@ -157,7 +164,7 @@ void NetworkViewerClient::loadNetworkNotificationCallback(unsigned int messageId
 	Misc::formattedUserNote("NetworkViewer: Loading new network %s",newNetworkName.c_str());
 	
 	/* Start a background job to read the incoming network file: */
-	ReadNetworkJob* job=new ReadNetworkJob(newNetworkVersion,newNetworkName,*metadosis->acceptInStream(streamId),client,serverMessageBase);
+	ReadNetworkJob* job=new ReadNetworkJob(newNetworkVersion,newNetworkName,*metadosis->acceptInStream(streamId),fileEncoding==DeflatedNetworkFile,client,serverMessageBase);
 	Threads::WorkerPool::submitJob(*job);
 	}
 
@@ -321,6 +328,24 @@ void NetworkViewerClient::displayLabelNotificationCallback(unsigned int messageI
 		}
 	}
 
+void NetworkViewerClient::selectRegionNotificationCallback(unsigned int messageId,MessageReader& message)
+	{
+	/* Read the message: */
+	Version msgNetworkVersion=message.read<Version>();
+	Misc::UInt8 mode=message.read<Misc::UInt8>();
+	Misc::UInt8 encoding=message.read<Misc::UInt8>();
+	Misc::UInt32 payloadSize=message.read<Misc::UInt32>();
+	
+	/* Check if the network version matches: */
+	if(msgNetworkVersion==networkVersion)
+		{
+		/* Decode the node set and change the selection state of all its nodes at once: */
+		std::vector<NodeID> nodes;
+		readNodeSet(message,encoding,payloadSize,nodes);
+		network->selectNodes(nodes,mode);
+		}
+	}
+
 MessageContinuation* NetworkViewerClient::simulationUpdateCallback(unsigned int messageId,MessageContinuation* continuation)
 	{
 	/* Embedded classes: */
@@ -330,15 +355,16 @@ MessageContinuation* NetworkViewerClient::simulationUpdateCallback(unsigned int
 		public:
 		Version networkVersion; // Version number of the network to which this update applies
 		size_t numParticles; // Number of unread particle positions in the message
-		NVPointList& points; // Point array into which particle positions are being read
+		NVPoint* nextPoint; // Pointer to the next particle position to be read in the point positions triple buffer
 		
 		/* Constructors and destructors: */
-		Cont(Version sNetworkVersion,size_t sNumParticles,NVPointList& sPoints)
-			:networkVersion(sNetworkVersion),numParticles(sNumParticles),points(sPoints)
+		Cont(Version sNetworkVersion,size_t sNumParticles,NVPoint* sNextPoint)
+			:networkVersion(sNetworkVersion),numParticles(sNumParticles),nextPoint(sNextPoint)
 			{
 			}
 		};
 	
+	Tracer::Span span("Receive simulation update");
 	NonBlockSocket& socket=client->getSocket();
 	
 	/* Check if this is the start of a new message: */
@@ -351,26 +377,21 @@ MessageContinuation* NetworkViewerClient::simulationUpdateCallback(unsigned int
 		/* Read the number of particle positions contained in the message: */
 		size_t numParticles=socket.read<Misc::UInt32>();
 		
-		/* Start a new value in the point positions triple buffer: */
+		/* Start a new value in the point positions triple buffer; the buffer slot retains its storage from earlier updates of the same size: */
 		NVPointList& points=application->positions.startNewValue();
-		points.clear();
-		points.reserve(numParticles);
+		points.resize(numParticles);
 		
 		/* Create a continuation object: */
-		cont=new Cont(networkVersion,numParticles,points);
+		cont=new Cont(networkVersion,numParticles,numParticles>0?&points.front():0);
 		}
 	
-	/* Read as many particle positions as are available: */
+	/* Read as many particle positions as are available directly into the triple buffer slot in a single block: */
 	size_t readParticles=Misc::min(cont->numParticles,socket.getUnread()/pointSize);
-	cont->numParticles-=readParticles;
-	while(readParticles>0)
+	if(readParticles>0)
 		{
-		/* Read a particle position: */
-		Point ppos;
-		for(int i=0;i<3;++i)
-			ppos[i]=Scalar(socket.read<NVScalar>());
-		cont->points.push_back(ppos);
-		--readParticles;
+		socket.read(cont->nextPoint->getComponents(),readParticles*3);
+		cont->nextPoint+=readParticles;
+		cont->numParticles-=readParticles;
 		}
 	
 	/* Check if the update is complete: */
@@ -393,12 +414,162 @@ MessageContinuation* NetworkViewerClient::simulationUpdateCallback(unsigned int
 	return cont;
 	}
 
+void NetworkViewerClient::datagramUpdatesNotificationCallback(unsigned int messageId,MessageReader& message)
+	{
+	/* Read the message: */
+	bool enabled=message.read<Misc::UInt8>()!=0;
+	
+	/* Notify the user if the requested delivery mode could not be used: */
+	if(datagramUpdates&&!enabled)
+		Misc::userWarning("NetworkViewer: Simulation updates are not arriving as datagrams; falling back to TCP");
+	datagramUpdates=enabled;
+	}
+
+void NetworkViewerClient::postDatagramPositions(void)
+	{
+	/* Post a copy of the assembled particle positions: */
+	Tracer::Span span("Post simulation update");
+	NVPointList& points=application->positions.startNewValue();
+	points=datagramAssembler.getPositions();
+	application->positions.postNewValue();
+	application->networkPositionVersion=application->networkVersion;
+	Vrui::requestUpdate();
+	
+	datagramAssembler.posted();
+	}
+
+void NetworkViewerClient::simulationUpdateChunkCallback(unsigned int messageId,MessageReader& message)
+	{
+	Tracer::Span span("Receive simulation update chunk");
+	
+	/* Read the chunk header: */
+	Version msgNetworkVersion=message.read<Version>();
+	Misc::UInt32 sequenceNumber=message.read<Misc::UInt32>();
+	size_t numParticles=message.read<Misc::UInt32>();
+	size_t firstParticle=message.read<Misc::UInt32>();
+	size_t numChunkParticles=message.read<Misc::UInt16>();
+	
+	/* Process the chunk header: */
+	int actions=datagramAssembler.startChunk(networkVersion,msgNetworkVersion,sequenceNumber,numParticles,firstParticle,numChunkParticles,message.getUnread());
+	
+	/* Post the previous update's partially received positions; chunks lost from it keep their most recent data: */
+	if(actions&SimulationUpdateAssembler::PostPrevious)
+		postDatagramPositions();
+	
+	/* Periodically acknowledge received updates to the server: */
+	if((actions&SimulationUpdateAssembler::NewUpdate)&&(lastAckedSequence==0||sequenceNumber-lastAckedSequence>=ackInterval))
+		{
+		MessageWriter datagramUpdateAck(DatagramUpdateAckMsg::createMessage(clientMessageBase));
+		datagramUpdateAck.write(sequenceNumber);
+		client->queueServerMessage(datagramUpdateAck.getBuffer());
+		lastAckedSequence=sequenceNumber;
+		}
+	
+	/* Apply the chunk if it is newer than the data already received for the same chunk: */
+	if(actions&SimulationUpdateAssembler::ReadChunk)
+		{
+		/* Read the chunk's particle positions in a single block: */
+		if(numChunkParticles>0)
+			message.read(datagramAssembler.getChunkPositions(firstParticle)->getComponents(),numChunkParticles*3);
+		
+		/* Post the assembled positions immediately if this was the last chunk of the current update: */
+		if(datagramAssembler.finishChunk(firstParticle,sequenceNumber))
+			postDatagramPositions();
+		}
+	}
+
+void NetworkViewerClient::dragTraceNotificationCallback(unsigned int messageId,MessageReader& message)
+	{
+	/* Read the message: */
+	Misc::UInt32 traceId=message.read<Misc::UInt32>();
+	double serverLatencies[3];
+	for(int i=0;i<3;++i)
+		serverLatencies[i]=double(message.read<Misc::Float32>());
+	
+	/* Discard traced drag requests sent before the reported one, which were dropped by the server: */
+	while(!pendingDragTraces.empty()&&Misc::SInt32(pendingDragTraces.front().traceId-traceId)<0)
+		pendingDragTraces.pop_front();
+	if(pendingDragTraces.empty()||pendingDragTraces.front().traceId!=traceId)
+		return;
+	
+	/* Split the round-trip time into network transit time and the server-side phases: */
+	ReceivedDragTrace rdt; // Default constructor sets the receive time to the current time
+	rdt.sendTime=pendingDragTraces.front().sendTime;
+	pendingDragTraces.pop_front();
+	double roundTrip=double(rdt.receiveTime-rdt.sendTime);
+	rdt.latencies[NetworkPhase]=roundTrip-serverLatencies[0]-serverLatencies[1]-serverLatencies[2];
+	rdt.latencies[QueuePhase]=serverLatencies[0];
+	rdt.latencies[StepPhase]=serverLatencies[1];
+	rdt.latencies[EncodePhase]=serverLatencies[2];
+	
+	/* Finish the trace after the frame displaying the simulation update has been rendered: */
+	receivedDragTraces.push_back(rdt);
+	Vrui::requestUpdate();
+	}
+
+void NetworkViewerClient::dragDeltaNotificationCallback(unsigned int messageId,MessageReader& message)
+	{
+	/* Read the message header: */
+	Version msgNetworkVersion=message.read<Version>();
+	Misc::UInt64 dragKey=message.read<Misc::UInt64>();
+	size_t numNodes=message.read<Misc::UInt32>();
+	
+	if(numNodes>0)
+		{
+		/* Replace the drag operation's dragged node positions: */
+		DragDelta& dd=dragDeltas[dragKey].getDest();
+		dd.networkVersion=msgNetworkVersion;
+		dd.nodes.clear();
+		dd.nodes.reserve(numNodes);
+		dd.positions.clear();
+		dd.positions.reserve(numNodes);
+		for(size_t i=0;i<numNodes;++i)
+			{
+			dd.nodes.push_back(message.read<NodeID>());
+			NVPoint pos;
+			for(int j=0;j<3;++j)
+				pos[j]=message.read<NVScalar>();
+			dd.positions.push_back(pos);
+			}
+		dd.released=false;
+		
+		dragDeltasChanged=true;
+		Vrui::requestUpdate();
+		}
+	else
+		{
+		/* Keep the dragged nodes at their final positions until the next simulation update arrives: */
+		DragDeltaMap::Iterator ddIt=dragDeltas.findEntry(dragKey);
+		if(!ddIt.isFinished())
+			ddIt->getDest().released=true;
+		}
+	}
+
+void NetworkViewerClient::reportDragLatencies(void)
+	{
+	static const char* phaseNames[NumDragLatencyPhases]={"network","queue","step","encode","render","total"};
+	
+	/* Write the percentiles of all phases: */
+	Misc::formattedLogNote("NetworkViewer: Drag latency over %u traced drag requests (ms, p50 / p90 / p99 / max):",(unsigned int)(dragLatencies[TotalPhase].size()));
+	for(int phase=0;phase<NumDragLatencyPhases;++phase)
+		{
+		std::vector<double>& samples=dragLatencies[phase];
+		std::sort(samples.begin(),samples.end());
+		size_t last=samples.size()-1;
+		Misc::formattedLogNote("NetworkViewer:   %-8s %8.3f %8.3f %8.3f %8.3f",phaseNames[phase],samples[(last*50)/100]*1000.0,samples[(last*90)/100]*1000.0,samples[(last*99)/100]*1000.0,samples[last]*1000.0);
+		samples.clear();
+		}
+	}
+
 NetworkViewerClient::NetworkViewerClient(CollaborativeNetworkViewer* sApplication,Client* sClient)
 	:PluginClient(sClient),
 	 application(sApplication),
 	 metadosis(MetadosisClient::requestClient(client)),
-	 networkVersion(0),network(0),downloadingVersion(0),selectionSet(0),labelSet(0),
-	 lastDragId(0),activeDrags(5)
+	 networkVersion(0),network(0),compressNetworks(false),downloadingVersion(0),selectionSet(0),labelSet(0),
+	 lastDragId(0),activeDrags(5),
+	 datagramUpdates(false),lastAckedSequence(0),
+	 traceDrags(false),lastTraceId(0),
+	 dragDeltas(5),dragDeltasChanged(false)
 	{
 	}
 
@@ -445,11 +616,32 @@ void NetworkViewerClient::setMessageBases(unsigned int newClientMessageBase,unsi
 	client->setMessageForwarder(serverMessageBase+SelectNodeNotification,Client::wrapMethod<NetworkViewerClient,&NetworkViewerClient::selectNodeNotificationCallback>,this,SelectNodeMsg::size);
 	client->setMessageForwarder(serverMessageBase+ChangeSelectionNotification,Client::wrapMethod<NetworkViewerClient,&NetworkViewerClient::changeSelectionNotificationCallback>,this,ChangeSelectionMsg::size);
 	client->setMessageForwarder(serverMessageBase+DisplayLabelNotification,Client::wrapMethod<NetworkViewerClient,&NetworkViewerClient::displayLabelNotificationCallback>,this,DisplayLabelMsg::size);
+	client->setVariableSizeMessageForwarder(serverMessageBase+SelectRegionNotification,Client::wrapMethod<NetworkViewerClient,&NetworkViewerClient::selectRegionNotificationCallback>,this,SelectRegionNotificationMsg::size,Client::UInt32,1);
+	client->setMessageForwarder(serverMessageBase+DatagramUpdatesNotification,Client::wrapMethod<NetworkViewerClient,&NetworkViewerClient::datagramUpdatesNotificationCallback>,this,DatagramUpdatesMsg::size);
 	client->setTCPMessageHandler(serverMessageBase+SimulationUpdate,Client::wrapMethod<NetworkViewerClient,&NetworkViewerClient::simulationUpdateCallback>,this,SimulationUpdateMsg::size);
+	client->setUDPMessageHandler(serverMessageBase+SimulationUpdateChunk,Client::wrapMethod<NetworkViewerClient,&NetworkViewerClient::simulationUpdateChunkCallback>,this,SimulationUpdateChunkMsg::size);
+	client->setVariableSizeMessageForwarder(serverMessageBase+DragDeltaNotification,Client::wrapMethod<NetworkViewerClient,&NetworkViewerClient::dragDeltaNotificationCallback>,this,DragDeltaNotificationMsg::size,Client::UInt32,DragDeltaNotificationMsg::nodeSize);
+	client->setMessageForwarder(serverMessageBase+DragTraceNotification,Client::wrapMethod<NetworkViewerClient,&NetworkViewerClient::dragTraceNotificationCallback>,this,DragTraceNotificationMsg::size);
 	}
 
 void NetworkViewerClient::start(void)
 	{
+	/* Request to join a session other than the server's default session: */
+	if(!sessionName.empty())
+		{
+		MessageWriter joinSessionRequest(JoinSessionRequestMsg::createMessage(clientMessageBase));
+		stringToCharBuffer(sessionName,joinSessionRequest,JoinSessionRequestMsg::sessionNameLen);
+		client->queueServerMessage(joinSessionRequest.getBuffer());
+		}
+	
+	/* Request simulation updates as datagrams if enabled: */
+	if(datagramUpdates)
+		{
+		MessageWriter datagramUpdatesRequest(DatagramUpdatesMsg::createMessage(clientMessageBase+DatagramUpdatesRequest));
+		datagramUpdatesRequest.write(Misc::UInt8(1));
+		client->queueServerMessage(datagramUpdatesRequest.getBuffer());
+		}
+	
 	#if 0
 	if(loadNetworkFileName!=0)
 		{
@@ -501,6 +693,83 @@ void NetworkViewerClient::start(void)
 	#endif
 	}
 
+void NetworkViewerClient::setSessionName(const char* newSessionName)
+	{
+	/* Remember the requested session, to be joined when the client starts: */
+	sessionName=newSessionName;
+	}
+
+void NetworkViewerClient::setDatagramUpdates(bool newDatagramUpdates)
+	{
+	/* Remember the requested delivery mode, to be requested from the server when the client starts: */
+	datagramUpdates=newDatagramUpdates;
+	}
+
+void NetworkViewerClient::setTraceDrags(bool newTraceDrags)
+	{
+	traceDrags=newTraceDrags;
+	}
+
+void NetworkViewerClient::setCompressNetworks(bool newCompressNetworks)
+	{
+	compressNetworks=newCompressNetworks;
+	}
+
+bool NetworkViewerClient::applyDragDeltas(NVPointList& positions,bool newPositions)
+	{
+	/* Remove the positions of released drag operations once a new simulation update has reconciled them: */
+	if(newPositions)
+		{
+		std::vector<Misc::UInt64> releasedDragKeys;
+		for(DragDeltaMap::Iterator ddIt=dragDeltas.begin();!ddIt.isFinished();++ddIt)
+			if(ddIt->getDest().released)
+				releasedDragKeys.push_back(ddIt->getSource());
+		for(std::vector<Misc::UInt64>::iterator rdkIt=releasedDragKeys.begin();rdkIt!=releasedDragKeys.end();++rdkIt)
+			dragDeltas.removeEntry(*rdkIt);
+		}
+	
+	/* Bail out if the positions don't need to be changed: */
+	if(dragDeltas.getNumEntries()==0||!(newPositions||dragDeltasChanged))
+		return false;
+	
+	/* Override the positions of all dragged nodes: */
+	for(DragDeltaMap::Iterator ddIt=dragDeltas.begin();!ddIt.isFinished();++ddIt)
+		{
+		const DragDelta& dd=ddIt->getDest();
+		if(dd.networkVersion==networkVersion)
+			{
+			NVPointList::const_iterator pIt=dd.positions.begin();
+			for(std::vector<NodeID>::const_iterator nIt=dd.nodes.begin();nIt!=dd.nodes.end();++nIt,++pIt)
+				if(*nIt<positions.size())
+					positions[*nIt]=*pIt;
+			}
+		}
+	dragDeltasChanged=false;
+	
+	return true;
+	}
+
+void NetworkViewerClient::finishDragTraces(void)
+	{
+	if(!receivedDragTraces.empty())
+		{
+		/* Complete all traces whose results were displayed in the previous frame: */
+		Realtime::TimePointMonotonic now;
+		for(std::vector<ReceivedDragTrace>::iterator rdtIt=receivedDragTraces.begin();rdtIt!=receivedDragTraces.end();++rdtIt)
+			{
+			for(int phase=0;phase<RenderPhase;++phase)
+				dragLatencies[phase].push_back(rdtIt->latencies[phase]);
+			dragLatencies[RenderPhase].push_back(double(now-rdtIt->receiveTime));
+			dragLatencies[TotalPhase].push_back(double(now-rdtIt->sendTime));
+			}
+		receivedDragTraces.clear();
+		
+		/* Write an intermediate report during long drag operations: */
+		if(dragLatencies[TotalPhase].size()>=maxDragLatencySamples)
+			reportDragLatencies();
+		}
+	}
+
 void NetworkViewerClient::loadNetwork(const char* networkFileName)
 	{
 	/* Get the network's name: */
@@ -513,6 +782,14 @@ void NetworkViewerClient::loadNetwork(const char* networkFileName)
 	/* Open the requested file: */
 	IO::FilePtr networkFile=IO::openFile(networkFileName);
 	
+	/* Compress the file while it is being read if requested: */
+	Misc::UInt8 fileEncoding=RawNetworkFile;
+	if(compressNetworks)
+		{
+		networkFile=new DeflateFilter(*networkFile);
+		fileEncoding=DeflatedNetworkFile;
+		}
+	
 	/* Wrap the file in a forwarding filter to upload it to the server while it is being read: */
 	MetadosisClient::ForwardingFilterPtr forwardingFilter=metadosis->forwardFile(*networkFile);
 	
@@ -522,6 +799,7 @@ void NetworkViewerClient::loadNetwork(const char* networkFileName)
 	loadNetworkRequest.write(networkVersion);
 	stringToCharBuffer(newNetworkName,loadNetworkRequest,LoadNetworkMsg::networkNameLen);
 	loadNetworkRequest.write(forwardingFilter->getStreamId());
+	loadNetworkRequest.write(fileEncoding);
 	client->queueServerMessage(loadNetworkRequest.getBuffer());
 	}
 	
@@ -542,7 +820,7 @@ void NetworkViewerClient::loadNetwork(const char* networkFileName)
 	downloadingVersion=networkVersion;
 	delete selectionSet;
 	selectionSet=0;
-	ReadNetworkJob* job=new ReadNetworkJob(networkVersion,newNetworkName,*forwardingFilter,client,serverMessageBase);
+	ReadNetworkJob* job=new ReadNetworkJob(networkVersion,newNetworkName,*forwardingFilter,compressNetworks,client,serverMessageBase);
 	Threads::WorkerPool::submitJob(*job);
 	}
 
@@ -564,6 +842,18 @@ void NetworkViewerClient::selectNode(unsigned int pickedNodeIndex,unsigned int m
 	client->queueServerMessage(selectNodeRequest.getBuffer());
 	}
 
+void NetworkViewerClient::selectRegion(const SelectionRegion& region,unsigned int mode)
+	{
+	/* Send a select region request to the server: */
+	MessageWriter selectRegionRequest(SelectRegionRequestMsg::createMessage(clientMessageBase));
+	selectRegionRequest.write(networkVersion);
+	selectRegionRequest.write(Misc::UInt8(mode));
+	region.write(selectRegionRequest);
+	stringToCharBuffer(region.propertyName,selectRegionRequest,SelectRegionRequestMsg::stringLen);
+	stringToCharBuffer(region.propertyValue,selectRegionRequest,SelectRegionRequestMsg::stringLen);
+	client->queueServerMessage(selectRegionRequest.getBuffer());
+	}
+
 void NetworkViewerClient::changeSelection(unsigned int command)
 	{
 	/* Send a change selection request to the server: */
@@ -614,6 +904,21 @@ void NetworkViewerClient::drag(unsigned int dragId)
 	MessageWriter dragRequest(DragRequestMsg::createMessage(clientMessageBase));
 	dragRequest.write(networkVersion);
 	dragRequest.write(DragID(dragId));
+	if(traceDrags)
+		{
+		/* Assign the next non-zero trace ID to the request and remember when it was sent: */
+		do
+			{
+			++lastTraceId;
+			}
+		while(lastTraceId==0);
+		PendingDragTrace pdt;
+		pdt.traceId=lastTraceId;
+		pendingDragTraces.push_back(pdt);
+		dragRequest.write(lastTraceId);
+		}
+	else
+		dragRequest.write(Misc::UInt32(0));
 	client->queueServerMessage(dragRequest.getBuffer());
 	}
 
@@ -633,6 +938,10 @@ void NetworkViewerClient::stopDrag(unsigned int dragId)
 		
 		/* Mark the drag ID as inactive: */
 		activeDrags.removeEntry(adIt);
+		
+		/* Report the latencies of the drag requests traced since the last report: */
+		if(!dragLatencies[TotalPhase].empty())
+			reportDragLatencies();
 		}
 	}
 
@@ -24,14 +24,18 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <string>
 #include <vector>
+#include <deque>
 #include <Misc/StandardHashFunction.h>
 #include <Misc/HashTable.h>
 #include <Threads/WorkerPool.h>
+#include <Realtime/Time.h>
 #include <IO/File.h>
 #include <Collaboration2/PluginClient.h>
 #include <Collaboration2/Plugins/MetadosisClient.h>
 
+#include "InflateFilter.h"
 #include "NetworkViewerProtocol.h"
+#include "SimulationUpdateAssembler.h"
 
 /* Forward declarations: */
 namespace Collab {
@@ -40,7 +44,7 @@ class MessageContinuation;
 class NonBlockSocket;
 class Client;
 }
-class Network;
+class VisualNetwork;
 class SimulationParameters;
 class RenderingParameters;
 class CollaborativeNetworkViewer;
@@ -64,14 +68,15 @@ class NetworkViewerClient:public PluginClient,public NetworkViewerProtocol
 		public:
 		unsigned int networkVersion; // The version number of the network being read
 		std::string networkName; // The name of the network being read
-		IO::FilePtr networkFile; // The file from which to parse the network
-		Network* network; // Pointer to the network object parsed from the network file
+		InflateFilterPtr networkFile; // The file from which to parse the network, decompressed on the fly if necessary
+		Realtime::TimePointMonotonic startTime; // Time at which the network file started transferring
+		VisualNetwork* network; // Pointer to the network object parsed from the network file
 		Client* client; // Pointer to the collaboration client
 		unsigned int serverMessageBase; // Base index for NetworkViewerProtocol server messages
 		
 		/* Constructors and destructors: */
 		public:
-		ReadNetworkJob(unsigned int sNetworkVersion,const std::string& sNetworkName,IO::File& sNetworkFile,Client* sClient,unsigned int sServerMessageBase); // Creates a job to load a network of the given name from the given Metadosis stream
+		ReadNetworkJob(unsigned int sNetworkVersion,const std::string& sNetworkName,IO::File& sNetworkFile,bool sDeflated,Client* sClient,unsigned int sServerMessageBase); // Creates a job to load a network of the given name from the given Metadosis stream, which is compressed if the flag is true
 		virtual ~ReadNetworkJob(void);
 		
 		/* Methods from class Threads::WorkerPool::JobFunction: */
@@ -81,17 +86,71 @@ class NetworkViewerClient:public PluginClient,public NetworkViewerProtocol
 	
 	typedef Misc::HashTable<unsigned int,void> ActiveDragSet; // Hash table holding the IDs of currently active drag operations
 	
+	struct PendingDragTrace // Structure for traced drag requests awaiting the server's latency breakdown
+		{
+		/* Elements: */
+		public:
+		Misc::UInt32 traceId; // ID of the traced drag request
+		Realtime::TimePointMonotonic sendTime; // Time at which the drag request was sent to the server
+		};
+	
+	enum DragLatencyPhase // Enumerated type for phases of a drag request's round trip
+		{
+		NetworkPhase=0, // Time spent in transit to and from the server
+		QueuePhase, // Time spent in the server's simulation command queue
+		StepPhase, // Time between applying the request and starting the first simulation update reflecting it
+		EncodePhase, // Time spent encoding the simulation update and handing it to the server's front end
+		RenderPhase, // Time between receiving the simulation update and finishing the frame displaying it
+		TotalPhase, // Total time from sending the drag request to displaying its result
+		NumDragLatencyPhases
+		};
+	
+	struct ReceivedDragTrace // Structure for traced drag requests whose results have been received, but not yet displayed
+		{
+		/* Elements: */
+		public:
+		double latencies[RenderPhase]; // Latencies of the phases up to receiving the simulation update in seconds
+		Realtime::TimePointMonotonic sendTime; // Time at which the drag request was sent to the server
+		Realtime::TimePointMonotonic receiveTime; // Time at which the server's latency breakdown was received
+		};
+	
+	struct DragDelta // Structure holding the most recent positions of nodes dragged by one drag operation
+		{
+		/* Elements: */
+		public:
+		Version networkVersion; // Version number of the network to which the positions apply
+		std::vector<NodeID> nodes; // IDs of the dragged nodes
+		NVPointList positions; // Positions of the dragged nodes
+		bool released; // Flag whether the drag operation ended and the next simulation update will reconcile the dragged nodes' positions
+		};
+	
+	typedef Misc::HashTable<Misc::UInt64,DragDelta> DragDeltaMap; // Hash table mapping server-wide drag keys to dragged node positions
+	
 	/* Elements: */
+	static const Misc::UInt32 ackInterval=8; // Number of simulation updates between acknowledgments of datagram updates
+	static const size_t maxDragLatencySamples=1000; // Number of traced drag requests after which a latency report is written even if the drag operation continues
 	CollaborativeNetworkViewer* application; // Pointer to the collaborative network viewer application object
 	MetadosisClient* metadosis; // Pointer to the Metadosis protocol's client plug-in
+	std::string sessionName; // Name of the server session to join when the client starts; empty for the server's default session
 	Version networkVersion; // Version number of the visualized network
 	std::string networkName; // The name of the visualized network
-	Network* network; // The visualized network
+	VisualNetwork* network; // The visualized network
+	bool compressNetworks; // Flag whether to compress network files uploaded to the server
 	Version downloadingVersion; // Version number of the most recent network downloaded from the server
 	std::vector<NodeID>* selectionSet; // Selection set to apply to the currently downloading network when it's done processing
 	std::vector<NodeID>* labelSet; // Label set to apply to the currently downloading network when it's done processing
 	DragID lastDragId; // Drag ID assigned to the most recent drag operation
 	ActiveDragSet activeDrags; // Set of currently active drag IDs
+	bool datagramUpdates; // Flag whether to request simulation updates as unreliable datagrams
+	SimulationUpdateAssembler datagramAssembler; // Assembler for particle positions received as simulation update chunks
+	Misc::UInt32 lastAckedSequence; // Sequence number most recently acknowledged to the server
+	bool traceDrags; // Flag whether to trace the round-trip latency of drag requests
+	Misc::UInt32 lastTraceId; // Trace ID assigned to the most recent traced drag request
+	std::deque<PendingDragTrace> pendingDragTraces; // Queue of traced drag requests in the order in which they were sent
+	std::vector<ReceivedDragTrace> receivedDragTraces; // List of traced drag requests whose results are being displayed in the current frame
+	std::vector<double> dragLatencies[NumDragLatencyPhases]; // Latency samples of traced drag requests per round-trip phase in seconds
+	DragDeltaMap dragDeltas; // Map of dragged node positions received ahead of simulation updates, by drag key
+	bool dragDeltasChanged; // Flag whether dragged node positions were received since they were last applied
 	
 	/* Private methods: */
 	void loadNetworkCompleteNotificationCallback(unsigned int messageId,MessageReader& message);
@@ -103,7 +162,14 @@ class NetworkViewerClient:public PluginClient,public NetworkViewerProtocol
 	void selectNodeNotificationCallback(unsigned int messageId,MessageReader& message);
 	void changeSelectionNotificationCallback(unsigned int messageId,MessageReader& message);
 	void displayLabelNotificationCallback(unsigned int messageId,MessageReader& message);
+	void selectRegionNotificationCallback(unsigned int messageId,MessageReader& message);
 	MessageContinuation* simulationUpdateCallback(unsigned int messageId,MessageContinuation* continuation);
+	void datagramUpdatesNotificationCallback(unsigned int messageId,MessageReader& message);
+	void postDatagramPositions(void); // Posts the particle positions assembled from simulation update chunks to the application
+	void simulationUpdateChunkCallback(unsigned int messageId,MessageReader& message);
+	void dragTraceNotificationCallback(unsigned int messageId,MessageReader& message);
+	void dragDeltaNotificationCallback(unsigned int messageId,MessageReader& message);
+	void reportDragLatencies(void); // Writes percentiles of the collected drag latency samples to the log and clears the samples
 	
 	/* Constructors and destructors: */
 	public:
@@ -119,13 +185,20 @@ class NetworkViewerClient:public PluginClient,public NetworkViewerProtocol
 	virtual void start(void);
 	
 	/* New methods: */
+	void setSessionName(const char* newSessionName); // Sets the name of the server session to join when the client starts
+	void setDatagramUpdates(bool newDatagramUpdates); // Requests to receive simulation updates as unreliable datagrams instead of over TCP; server falls back to TCP if datagrams do not arrive
+	void setTraceDrags(bool newTraceDrags); // Enables or disables tracing the round-trip latency of drag requests; latency percentiles are written to the log at the end of each drag operation
+	void setCompressNetworks(bool newCompressNetworks); // Enables or disables compressing network files while they are uploaded to the server; the server forwards them to other clients in the same encoding
+	bool applyDragDeltas(NVPointList& positions,bool newPositions); // Overrides the given node positions with dragged node positions received ahead of simulation updates; flag indicates that the positions came from a new simulation update; returns true if any positions were changed
+	void finishDragTraces(void); // Completes drag traces whose results were displayed in the previous frame; must be called at the beginning of each frame
 	void loadNetwork(const char* networkFileName); // Loads a network from a file of the given name and shares it with the server
-	const Network& getNetwork(void) const // Returns the visualized network
+	const VisualNetwork& getNetwork(void) const // Returns the visualized network
 		{
 		return *network;
 		}
 	void updateSimulationParameters(const SimulationParameters& simulationParameters);
 	void selectNode(unsigned int pickedNodeIndex,unsigned int mode); // Selects/deselects/toggles the given node
+	void selectRegion(const SelectionRegion& region,unsigned int mode); // Selects/deselects/toggles all nodes inside the given region, or replaces the selection set with them
 	void changeSelection(unsigned int command); // Makes a global change to the selection set, 0: clear selection, 1: grow selection, 2: shrink selection
 	void displayLabel(unsigned int nodeIndex,unsigned int command); // Sends a display label request to the server
 	unsigned int startDrag(unsigned int inputDeviceId,unsigned int pickedNodeIndex); // Starts a new drag operation and returns its drag ID
@@ -0,0 +1,108 @@
+/***********************************************************************
+NetworkViewerClientRegionSelectTool - Tool class to select all nodes
+inside a sphere or a ray cone.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include "NetworkViewerClientRegionSelectTool.h"
+
+#include <Math/Math.h>
+#include <Geometry/OrthogonalTransformation.h>
+#include <Vrui/Vrui.h>
+#include <Vrui/ToolManager.h>
+
+#include "SelectionRegion.h"
+
+/*********************************************************************
+Static elements of class CollaborativeNetworkViewer::RegionSelectTool:
+*********************************************************************/
+
+CollaborativeNetworkViewer::RegionSelectTool::Factory* CollaborativeNetworkViewer::RegionSelectTool::factory=0;
+
+/*************************************************************
+Methods of class CollaborativeNetworkViewer::RegionSelectTool:
+*************************************************************/
+
+void CollaborativeNetworkViewer::RegionSelectTool::initClass(void)
+	{
+	/* Create a factory object for the custom tool class: */
+	factory=new Factory("RegionSelectTool","Select Nodes in Region",Tool::factory,*Vrui::getToolManager());
+	
+	/* Set the tool class's input layout: */
+	factory->setNumButtons(1);
+	factory->setButtonFunction(0,"Select Region");
+	
+	/* Register the tool class with Vrui's tool manager: */
+	Vrui::getToolManager()->addClass(factory,Vrui::ToolManager::defaultToolFactoryDestructor);
+	}
+
+CollaborativeNetworkViewer::RegionSelectTool::RegionSelectTool(const Vrui::ToolFactory* factory,const Vrui::ToolInputAssignment& inputAssignment)
+	:Tool(factory,inputAssignment),
+	 active(false)
+	{
+	}
+
+const Vrui::ToolFactory* CollaborativeNetworkViewer::RegionSelectTool::getFactory(void) const
+	{
+	return factory;
+	}
+
+void CollaborativeNetworkViewer::RegionSelectTool::buttonCallback(int buttonSlotIndex,Vrui::InputDevice::ButtonCallbackData* cbData)
+	{
+	/* Bail out if there is no collaboration client: */
+	if(application->nvClient==0)
+		return;
+	
+	/* Check whether the tool is position-based or ray-based: */
+	if(getButtonDevice(buttonSlotIndex)->is6DOFDevice())
+		{
+		/* Get the device's current position in navigational space: */
+		Point devicePos(Vrui::getInverseNavigationTransformation().transform(getButtonDevicePosition(buttonSlotIndex)));
+		
+		if(cbData->newButtonState) // Button has just been pressed
+			{
+			/* Start dragging out a selection sphere: */
+			center=devicePos;
+			active=true;
+			}
+		else if(active) // Button has just been released
+			{
+			/* Select all nodes inside the dragged-out sphere, but at least inside the point picking distance: */
+			SelectionRegion region;
+			region.type=SelectionRegion::Sphere;
+			region.center=center;
+			region.radius=Math::max(Geometry::dist(center,devicePos),Scalar(Vrui::getPointPickDistance()));
+			application->nvClient->selectRegion(region,0);
+			
+			active=false;
+			}
+		}
+	else if(cbData->newButtonState) // Button has just been pressed
+		{
+		/* Select all nodes inside the cone around the device's ray in navigational space: */
+		pickRay=getButtonDeviceRay(buttonSlotIndex);
+		pickRay.transform(Vrui::getInverseNavigationTransformation());
+		SelectionRegion region;
+		region.type=SelectionRegion::RayCone;
+		region.center=Point(pickRay.getOrigin());
+		region.axis=Vector(pickRay.getDirection());
+		region.cosAngle=Scalar(Vrui::getRayPickCosine());
+		application->nvClient->selectRegion(region,0);
+		}
+	}
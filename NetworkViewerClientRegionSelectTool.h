@@ -0,0 +1,57 @@
+/***********************************************************************
+NetworkViewerClientRegionSelectTool - Tool class to select all nodes
+inside a sphere or a ray cone.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef NETWORKVIEWERCLIENTREGIONSELECTTOOL_INCLUDED
+#define NETWORKVIEWERCLIENTREGIONSELECTTOOL_INCLUDED
+
+#include <Vrui/GenericToolFactory.h>
+
+#include "NetworkViewerClientTool.h"
+
+/*****************************************************************
+Declaration of class CollaborativeNetworkViewer::RegionSelectTool:
+*****************************************************************/
+
+class CollaborativeNetworkViewer::RegionSelectTool:public CollaborativeNetworkViewer::Tool
+	{
+	/* Embedded classes: */
+	private:
+	typedef Vrui::GenericToolFactory<RegionSelectTool> Factory; // Factory class for this tool class
+	friend class Vrui::GenericToolFactory<RegionSelectTool>;
+	
+	/* Elements: */
+	private:
+	static Factory* factory; // Pointer to the factory object for this class
+	bool active; // Flag whether the tool is currently dragging out a selection sphere
+	Point center; // Center of the selection sphere in navigational space
+	
+	/* Constructors and destructors: */
+	public:
+	static void initClass(void); // Initializes the tool's factory class
+	RegionSelectTool(const Vrui::ToolFactory* factory,const Vrui::ToolInputAssignment& inputAssignment);
+	
+	/* Methods from class Vrui::Tool: */
+	virtual const Vrui::ToolFactory* getFactory(void) const;
+	virtual void buttonCallback(int buttonSlotIndex,Vrui::InputDevice::ButtonCallbackData* cbData);
+	};
+
+#endif
@@ -27,6 +27,7 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Vrui/ToolManager.h>
 
 #include "Network.h"
+#include "SphereBVH.icpp"
 #include "PointSpherePicker.h"
 #include "RaySpherePicker.h"
 
@@ -44,10 +45,9 @@ unsigned int CollaborativeNetworkViewer::Tool::pickNode(int buttonSlotIndex)
 	{
 	unsigned int result=~0x0U;
 	
-	/* Get the network nodes and their most recent positions: */
-	const Network::NodeList& nodes=application->nvClient->getNetwork().getNodes();
+	/* Get the most recent node positions and the node sphere hierarchy: */
 	const NVPointList& points=application->lockAndGetPositions();
-	NVPointList::const_iterator pIt=points.begin();
+	const SphereBVH& nodeBVH=application->getNodeBVH(points);
 	
 	/* Check whether the tool is position-based or ray-based: */
 	if(getButtonDevice(buttonSlotIndex)->is6DOFDevice())
@@ -57,9 +57,8 @@ unsigned int CollaborativeNetworkViewer::Tool::pickNode(int buttonSlotIndex)
 		Scalar pickDist(Vrui::getPointPickDistance());
 		PointSpherePicker picker(pickPoint,pickDist);
 		
-		/* Pick using node radii based on current rendering settings: */
-		for(Network::NodeList::const_iterator nIt=nodes.begin();nIt!=nodes.end();++nIt,++pIt)
-			picker(*pIt,application->getNodeRadius(*nIt));
+		/* Pick using node radii based on current rendering settings, skipping hierarchy nodes that are too far away: */
+		nodeBVH.processSpheres(points,application->renderData.getNodeRadii(),picker);
 		
 		/* Check if a node was picked: */
 		if(picker.havePickedSphere())
@@ -76,9 +75,8 @@ unsigned int CollaborativeNetworkViewer::Tool::pickNode(int buttonSlotIndex)
 		Scalar maxPickCos(Vrui::getRayPickCosine());
 		RaySpherePicker picker(pickRay,maxPickCos);
 		
-		/* Pick using node radii based on current rendering settings: */
-		for(Network::NodeList::const_iterator nIt=nodes.begin();nIt!=nodes.end();++nIt,++pIt)
-			picker(*pIt,application->getNodeRadius(*nIt));
+		/* Pick using node radii based on current rendering settings, skipping hierarchy nodes that are too far away: */
+		nodeBVH.processSpheres(points,application->renderData.getNodeRadii(),picker);
 		
 		/* Check if a node was picked: */
 		if(picker.havePickedSphere())
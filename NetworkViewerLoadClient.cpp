@@ -0,0 +1,535 @@
+/***********************************************************************
+NetworkViewerLoadClient - Headless client for network viewer plug-in
+protocol generating synthetic interaction traffic and measuring the
+delivery of simulation updates.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include "NetworkViewerLoadClient.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <Misc/Utility.h>
+#include <Misc/MessageLogger.h>
+#include <Math/Math.h>
+#include <Math/Constants.h>
+#include <Math/Random.h>
+#include <IO/OpenFile.h>
+#include <Collaboration2/MessageReader.h>
+#include <Collaboration2/MessageWriter.h>
+#include <Collaboration2/MessageContinuation.h>
+#include <Collaboration2/NonBlockSocket.h>
+#include <Collaboration2/Client.h>
+
+namespace Collab {
+
+namespace Plugins {
+
+/********************************************************
+Methods of class NetworkViewerLoadClient::DrainNetworkJob:
+********************************************************/
+
+NetworkViewerLoadClient::DrainNetworkJob::DrainNetworkJob(NetworkViewerProtocol::Version sNetworkVersion,IO::File& sNetworkFile,Client* sClient,unsigned int sServerMessageBase)
+	:networkVersion(sNetworkVersion),networkFile(&sNetworkFile),
+	 client(sClient),serverMessageBase(sServerMessageBase)
+	{
+	}
+
+NetworkViewerLoadClient::DrainNetworkJob::~DrainNetworkJob(void)
+	{
+	}
+
+void NetworkViewerLoadClient::DrainNetworkJob::operator()(int) const
+	{
+	/* Can't really do anything; this is an API problem that should be fixed: */
+	// ...
+	}
+
+void NetworkViewerLoadClient::DrainNetworkJob::operator()(int)
+	{
+	try
+		{
+		/* Receive the entire network file and discard it: */
+		char buffer[4096];
+		while(networkFile->readUpTo(buffer,sizeof(buffer))>0)
+			;
+		}
+	catch(const std::runtime_error& err)
+		{
+		/* Show an error message: */
+		Misc::formattedUserError("NetworkViewerLoadClient::DrainNetworkJob: Unable to receive network due to exception %s",err.what());
+		}
+	
+	/* Send a completion message to the frontend: */
+	{
+	MessageWriter loadNetworkCompleteNotification(MessageBuffer::create(serverMessageBase+LoadNetworkCompleteNotification,sizeof(Version)));
+	loadNetworkCompleteNotification.write(networkVersion);
+	client->queueFrontendMessage(loadNetworkCompleteNotification.getBuffer());
+	}
+	}
+
+/****************************************
+Methods of class NetworkViewerLoadClient:
+****************************************/
+
+void NetworkViewerLoadClient::updateReceived(size_t newNumParticles)
+	{
+	/* Record the time since the previous simulation update: */
+	Realtime::TimePointMonotonic now;
+	if(haveUpdate)
+		statistics.updateIntervals.push_back(double(now-lastUpdateTime));
+	lastUpdateTime=now;
+	haveUpdate=true;
+	
+	++statistics.numUpdates;
+	numParticles=newNumParticles;
+	}
+
+void NetworkViewerLoadClient::loadNetworkCompleteNotificationCallback(unsigned int messageId,MessageReader& message)
+	{
+	/* Start generating traffic for the new network if it is still the most recent one: */
+	Version newNetworkVersion=message.read<Version>();
+	if(newNetworkVersion==downloadingVersion)
+		{
+		networkVersion=newNetworkVersion;
+		
+		/* Abandon a drag operation on the previous network: */
+		dragId=0;
+		pendingDragTraces.clear();
+		}
+	}
+
+void NetworkViewerLoadClient::loadNetworkNotificationCallback(unsigned int messageId,MessageReader& message)
+	{
+	/* Read the new network's version number and the stream ID of the new network file: */
+	Version newNetworkVersion=message.read<Version>();
+	std::string newNetworkName;
+	charBufferToString(message,LoadNetworkMsg::networkNameLen,newNetworkName);
+	MetadosisProtocol::StreamID streamId=message.read<MetadosisProtocol::StreamID>();
+	message.read<Misc::UInt8>(); // The network file's encoding does not matter as the file is not parsed
+	
+	/* Set the version of the currently downloading network: */
+	downloadingVersion=newNetworkVersion;
+	
+	/* Start a background job to receive the incoming network file, to put the same load on the server as a real client: */
+	DrainNetworkJob* job=new DrainNetworkJob(newNetworkVersion,*metadosis->acceptInStream(streamId),client,serverMessageBase);
+	Threads::WorkerPool::submitJob(*job);
+	}
+
+void NetworkViewerLoadClient::notificationCallback(unsigned int messageId,MessageReader& message)
+	{
+	/* Count the notification and otherwise ignore it: */
+	Threads::Mutex::Lock statisticsLock(statisticsMutex);
+	++statistics.numNotifications;
+	}
+
+MessageContinuation* NetworkViewerLoadClient::simulationUpdateCallback(unsigned int messageId,MessageContinuation* continuation)
+	{
+	/* Embedded classes: */
+	class Cont:public MessageContinuation
+		{
+		/* Elements: */
+		public:
+		size_t numParticles; // Total number of particle positions in the message
+		size_t numUnread; // Number of unread particle positions in the message
+		
+		/* Constructors and destructors: */
+		Cont(size_t sNumParticles)
+			:numParticles(sNumParticles),numUnread(sNumParticles)
+			{
+			}
+		};
+	
+	NonBlockSocket& socket=client->getSocket();
+	
+	/* Check if this is the start of a new message: */
+	Cont* cont=static_cast<Cont*>(continuation);
+	if(cont==0)
+		{
+		/* Read the network version number and the number of particle positions contained in the message: */
+		socket.read<Version>();
+		size_t numParticles=socket.read<Misc::UInt32>();
+		
+		/* Create a continuation object: */
+		cont=new Cont(numParticles);
+		}
+	
+	/* Read and discard as many particle positions as are available: */
+	size_t readParticles=Misc::min(cont->numUnread,socket.getUnread()/pointSize);
+	cont->numUnread-=readParticles;
+	for(size_t i=0;i<readParticles*3;++i)
+		socket.read<NVScalar>();
+	
+	{
+	Threads::Mutex::Lock statisticsLock(statisticsMutex);
+	statistics.updateBytes+=readParticles*pointSize;
+	
+	/* Check if the update is complete: */
+	if(cont->numUnread==0)
+		updateReceived(cont->numParticles);
+	}
+	
+	if(cont->numUnread==0)
+		{
+		/* Done with the message: */
+		delete cont;
+		cont=0;
+		}
+	
+	return cont;
+	}
+
+void NetworkViewerLoadClient::simulationUpdateChunkCallback(unsigned int messageId,MessageReader& message)
+	{
+	/* Read the chunk header: */
+	message.read<Version>();
+	Misc::UInt32 sequenceNumber=message.read<Misc::UInt32>();
+	size_t numParticles=message.read<Misc::UInt32>();
+	size_t firstParticle=message.read<Misc::UInt32>();
+	size_t numChunkParticles=message.read<Misc::UInt16>();
+	
+	Threads::Mutex::Lock statisticsLock(statisticsMutex);
+	statistics.updateBytes+=numChunkParticles*pointSize;
+	
+	/* Check if this chunk starts a newer simulation update: */
+	if(datagramSequence==0||Misc::SInt32(sequenceNumber-datagramSequence)>0)
+		{
+		datagramSequence=sequenceNumber;
+		numDatagramParticles=0;
+		
+		/* Periodically acknowledge received updates to the server: */
+		if(lastAckedSequence==0||sequenceNumber-lastAckedSequence>=ackInterval)
+			{
+			MessageWriter datagramUpdateAck(DatagramUpdateAckMsg::createMessage(clientMessageBase));
+			datagramUpdateAck.write(sequenceNumber);
+			client->queueServerMessage(datagramUpdateAck.getBuffer());
+			lastAckedSequence=sequenceNumber;
+			}
+		}
+	
+	/* Count the newest update as received once all of its chunks have arrived: */
+	if(sequenceNumber==datagramSequence&&firstParticle+numChunkParticles<=numParticles)
+		{
+		numDatagramParticles+=numChunkParticles;
+		if(numDatagramParticles==numParticles)
+			updateReceived(numParticles);
+		}
+	}
+
+void NetworkViewerLoadClient::dragTraceNotificationCallback(unsigned int messageId,MessageReader& message)
+	{
+	/* Read the message's trace ID; the server-side latency breakdown is not needed: */
+	Misc::UInt32 traceId=message.read<Misc::UInt32>();
+	
+	/* Discard traced drag requests sent before the reported one, which were dropped by the server: */
+	while(!pendingDragTraces.empty()&&Misc::SInt32(pendingDragTraces.front().traceId-traceId)<0)
+		pendingDragTraces.pop_front();
+	if(pendingDragTraces.empty()||pendingDragTraces.front().traceId!=traceId)
+		return;
+	
+	/* Record the drag request's round-trip time: */
+	Realtime::TimePointMonotonic now;
+	double roundTrip=double(now-pendingDragTraces.front().sendTime);
+	pendingDragTraces.pop_front();
+	{
+	Threads::Mutex::Lock statisticsLock(statisticsMutex);
+	++statistics.numNotifications;
+	statistics.dragLatencies.push_back(roundTrip);
+	}
+	}
+
+void NetworkViewerLoadClient::writeNavDragTransform(MessageWriter& writer) const
+	{
+	/* Move the dragged node along a circle in the x-y plane, without rotating it: */
+	double angle=dragTime*2.0*Math::Constants<double>::pi/trafficParameters.dragDuration;
+	writer.write(NVScalar(Math::cos(angle)*trafficParameters.dragRadius));
+	writer.write(NVScalar(Math::sin(angle)*trafficParameters.dragRadius));
+	writer.write(NVScalar(0));
+	for(int i=0;i<3;++i)
+		writer.write(NVScalar(0));
+	writer.write(NVScalar(1));
+	}
+
+NetworkViewerLoadClient::NetworkViewerLoadClient(Client* sClient)
+	:PluginClient(sClient),
+	 metadosis(MetadosisClient::requestClient(client)),
+	 datagramUpdates(false),
+	 networkVersion(0),downloadingVersion(0),
+	 lastDragId(0),dragId(0),dragTime(0.0),lastTraceId(0),
+	 numParticles(0),haveUpdate(false),datagramSequence(0),numDatagramParticles(0),lastAckedSequence(0)
+	{
+	}
+
+NetworkViewerLoadClient::~NetworkViewerLoadClient(void)
+	{
+	}
+
+const char* NetworkViewerLoadClient::getName(void) const
+	{
+	return protocolName;
+	}
+
+unsigned int NetworkViewerLoadClient::getVersion(void) const
+	{
+	return protocolVersion;
+	}
+
+unsigned int NetworkViewerLoadClient::getNumClientMessages(void) const
+	{
+	return NumClientMessages;
+	}
+
+unsigned int NetworkViewerLoadClient::getNumServerMessages(void) const
+	{
+	return NumServerMessages;
+	}
+
+void NetworkViewerLoadClient::setMessageBases(unsigned int newClientMessageBase,unsigned int newServerMessageBase)
+	{
+	/* Call the base class method: */
+	PluginClient::setMessageBases(newClientMessageBase,newServerMessageBase);
+	
+	/* Register message handlers; notifications that only affect a real client's display are counted and ignored: */
+	client->setMessageForwarder(serverMessageBase+LoadNetworkNotification,Client::wrapMethod<NetworkViewerLoadClient,&NetworkViewerLoadClient::loadNetworkNotificationCallback>,this,LoadNetworkMsg::size);
+	client->setFrontendMessageHandler(serverMessageBase+LoadNetworkCompleteNotification,Client::wrapMethod<NetworkViewerLoadClient,&NetworkViewerLoadClient::loadNetworkCompleteNotificationCallback>,this);
+	client->setVariableSizeMessageForwarder(serverMessageBase+SelectionSetNotification,Client::wrapMethod<NetworkViewerLoadClient,&NetworkViewerLoadClient::notificationCallback>,this,NodeSetMsg::size,Client::UInt32,sizeof(NodeID));
+	client->setVariableSizeMessageForwarder(serverMessageBase+LabelSetNotification,Client::wrapMethod<NetworkViewerLoadClient,&NetworkViewerLoadClient::notificationCallback>,this,NodeSetMsg::size,Client::UInt32,sizeof(NodeID));
+	client->setMessageForwarder(serverMessageBase+SetSimulationParametersNotification,Client::wrapMethod<NetworkViewerLoadClient,&NetworkViewerLoadClient::notificationCallback>,this,SetSimulationParametersMsg::size);
+	client->setMessageForwarder(serverMessageBase+SetRenderingParametersNotification,Client::wrapMethod<NetworkViewerLoadClient,&NetworkViewerLoadClient::notificationCallback>,this,SetRenderingParametersMsg::size);
+	client->setMessageForwarder(serverMessageBase+SelectNodeNotification,Client::wrapMethod<NetworkViewerLoadClient,&NetworkViewerLoadClient::notificationCallback>,this,SelectNodeMsg::size);
+	client->setMessageForwarder(serverMessageBase+ChangeSelectionNotification,Client::wrapMethod<NetworkViewerLoadClient,&NetworkViewerLoadClient::notificationCallback>,this,ChangeSelectionMsg::size);
+	client->setMessageForwarder(serverMessageBase+DisplayLabelNotification,Client::wrapMethod<NetworkViewerLoadClient,&NetworkViewerLoadClient::notificationCallback>,this,DisplayLabelMsg::size);
+	client->setVariableSizeMessageForwarder(serverMessageBase+SelectRegionNotification,Client::wrapMethod<NetworkViewerLoadClient,&NetworkViewerLoadClient::notificationCallback>,this,SelectRegionNotificationMsg::size,Client::UInt32,1);
+	client->setMessageForwarder(serverMessageBase+DatagramUpdatesNotification,Client::wrapMethod<NetworkViewerLoadClient,&NetworkViewerLoadClient::notificationCallback>,this,DatagramUpdatesMsg::size);
+	client->setTCPMessageHandler(serverMessageBase+SimulationUpdate,Client::wrapMethod<NetworkViewerLoadClient,&NetworkViewerLoadClient::simulationUpdateCallback>,this,SimulationUpdateMsg::size);
+	client->setUDPMessageHandler(serverMessageBase+SimulationUpdateChunk,Client::wrapMethod<NetworkViewerLoadClient,&NetworkViewerLoadClient::simulationUpdateChunkCallback>,this,SimulationUpdateChunkMsg::size);
+	client->setVariableSizeMessageForwarder(serverMessageBase+DragDeltaNotification,Client::wrapMethod<NetworkViewerLoadClient,&NetworkViewerLoadClient::notificationCallback>,this,DragDeltaNotificationMsg::size,Client::UInt32,DragDeltaNotificationMsg::nodeSize);
+	client->setMessageForwarder(serverMessageBase+DragTraceNotification,Client::wrapMethod<NetworkViewerLoadClient,&NetworkViewerLoadClient::dragTraceNotificationCallback>,this,DragTraceNotificationMsg::size);
+	}
+
+void NetworkViewerLoadClient::start(void)
+	{
+	/* Request to join a session other than the server's default session: */
+	if(!sessionName.empty())
+		{
+		MessageWriter joinSessionRequest(JoinSessionRequestMsg::createMessage(clientMessageBase));
+		stringToCharBuffer(sessionName,joinSessionRequest,JoinSessionRequestMsg::sessionNameLen);
+		client->queueServerMessage(joinSessionRequest.getBuffer());
+		}
+	
+	/* Request simulation updates as datagrams if enabled: */
+	if(datagramUpdates)
+		{
+		MessageWriter datagramUpdatesRequest(DatagramUpdatesMsg::createMessage(clientMessageBase+DatagramUpdatesRequest));
+		datagramUpdatesRequest.write(Misc::UInt8(1));
+		client->queueServerMessage(datagramUpdatesRequest.getBuffer());
+		}
+	
+	/* Upload a network file if requested: */
+	if(!uploadNetworkFileName.empty())
+		{
+		try
+			{
+			loadNetwork(uploadNetworkFileName.c_str());
+			}
+		catch(const std::runtime_error& err)
+			{
+			Misc::formattedUserError("NetworkViewerLoadClient::start: Unable to upload network %s due to exception %s",uploadNetworkFileName.c_str(),err.what());
+			}
+		}
+	}
+
+void NetworkViewerLoadClient::setSessionName(const char* newSessionName)
+	{
+	/* Remember the requested session, to be joined when the client starts: */
+	sessionName=newSessionName;
+	}
+
+void NetworkViewerLoadClient::setDatagramUpdates(bool newDatagramUpdates)
+	{
+	/* Remember the requested delivery mode, to be requested from the server when the client starts: */
+	datagramUpdates=newDatagramUpdates;
+	}
+
+void NetworkViewerLoadClient::setUploadNetworkFileName(const char* newUploadNetworkFileName)
+	{
+	/* Remember the network file name, to be uploaded when the client starts: */
+	uploadNetworkFileName=newUploadNetworkFileName;
+	}
+
+void NetworkViewerLoadClient::setTrafficParameters(const NetworkViewerLoadClient::TrafficParameters& newTrafficParameters)
+	{
+	trafficParameters=newTrafficParameters;
+	}
+
+void NetworkViewerLoadClient::loadNetwork(const char* networkFileName)
+	{
+	/* Get the network's name: */
+	const char* networkNameBegin=networkFileName;
+	for(const char* nfnPtr=networkFileName;*nfnPtr!='\0';++nfnPtr)
+		if(*nfnPtr=='/')
+			networkNameBegin=nfnPtr+1;
+	std::string newNetworkName(networkNameBegin);
+	
+	/* Open the requested file: */
+	IO::FilePtr networkFile=IO::openFile(networkFileName);
+	
+	/* Wrap the file in a forwarding filter to upload it to the server while it is being read: */
+	MetadosisClient::ForwardingFilterPtr forwardingFilter=metadosis->forwardFile(*networkFile);
+	
+	/* Send a load network request to the server: */
+	{
+	MessageWriter loadNetworkRequest(LoadNetworkMsg::createMessage(clientMessageBase+LoadNetworkRequest));
+	loadNetworkRequest.write(networkVersion);
+	stringToCharBuffer(newNetworkName,loadNetworkRequest,LoadNetworkMsg::networkNameLen);
+	loadNetworkRequest.write(forwardingFilter->getStreamId());
+	loadNetworkRequest.write(Misc::UInt8(RawNetworkFile));
+	client->queueServerMessage(loadNetworkRequest.getBuffer());
+	}
+	
+	/* Get a new network version number: */
+	downloadingVersion=networkVersion;
+	do
+		{
+		++downloadingVersion;
+		}
+	while(downloadingVersion==0);
+	
+	/* Start a background job to upload the network file by reading it: */
+	DrainNetworkJob* job=new DrainNetworkJob(downloadingVersion,*forwardingFilter,client,serverMessageBase);
+	Threads::WorkerPool::submitJob(*job);
+	}
+
+bool NetworkViewerLoadClient::isReady(void)
+	{
+	Threads::Mutex::Lock statisticsLock(statisticsMutex);
+	return networkVersion!=0&&numParticles!=0;
+	}
+
+void NetworkViewerLoadClient::frame(double timeStep)
+	{
+	/* Get the number of nodes in the current network: */
+	size_t numNodes;
+	{
+	Threads::Mutex::Lock statisticsLock(statisticsMutex);
+	numNodes=numParticles;
+	}
+	
+	/* Don't generate traffic until the network has been received: */
+	if(networkVersion==0||numNodes==0)
+		return;
+	
+	size_t numRequests=0;
+	if(dragId!=0)
+		{
+		/* Advance the current drag operation: */
+		dragTime+=timeStep;
+		if(dragTime<trafficParameters.dragDuration)
+			{
+			/* Assign the next non-zero trace ID to the request and remember when it was sent: */
+			do
+				{
+				++lastTraceId;
+				}
+			while(lastTraceId==0);
+			PendingDragTrace pdt;
+			pdt.traceId=lastTraceId;
+			pendingDragTraces.push_back(pdt);
+			
+			/* Send a traced drag request, as a real client does once per frame: */
+			MessageWriter navDragRequest(NavDragRequestMsg::createMessage(clientMessageBase));
+			navDragRequest.write(networkVersion);
+			navDragRequest.write(dragId);
+			navDragRequest.write(lastTraceId);
+			writeNavDragTransform(navDragRequest);
+			client->queueServerMessage(navDragRequest.getBuffer());
+			++numRequests;
+			}
+		else
+			{
+			/* Send a drag stop request: */
+			MessageWriter dragStopRequest(DragStopRequestMsg::createMessage(clientMessageBase));
+			dragStopRequest.write(networkVersion);
+			dragStopRequest.write(dragId);
+			client->queueServerMessage(dragStopRequest.getBuffer());
+			++numRequests;
+			
+			dragId=0;
+			}
+		}
+	else if(Math::randUniformCO(0.0,1.0)<trafficParameters.dragRate*timeStep)
+		{
+		/* Start a new drag operation on a random node: */
+		do
+			{
+			++lastDragId;
+			}
+		while(lastDragId==0);
+		dragId=lastDragId;
+		dragTime=0.0;
+		
+		MessageWriter navDragStartRequest(NavDragStartRequestMsg::createMessage(clientMessageBase));
+		navDragStartRequest.write(networkVersion);
+		navDragStartRequest.write(dragId);
+		navDragStartRequest.write(NodeID(Math::randUniformCO(0.0,double(numNodes))));
+		writeNavDragTransform(navDragStartRequest);
+		client->queueServerMessage(navDragStartRequest.getBuffer());
+		++numRequests;
+		}
+	
+	/* Toggle the selection state of a random node: */
+	if(Math::randUniformCO(0.0,1.0)<trafficParameters.selectRate*timeStep)
+		{
+		MessageWriter selectNodeRequest(SelectNodeMsg::createMessage(clientMessageBase+SelectNodeRequest));
+		selectNodeRequest.write(networkVersion);
+		selectNodeRequest.write(NodeID(Math::randUniformCO(0.0,double(numNodes))));
+		selectNodeRequest.write(Misc::UInt8(2));
+		client->queueServerMessage(selectNodeRequest.getBuffer());
+		++numRequests;
+		}
+	
+	/* Show or hide the label of a random node: */
+	if(Math::randUniformCO(0.0,1.0)<trafficParameters.labelRate*timeStep)
+		{
+		MessageWriter displayLabelRequest(DisplayLabelMsg::createMessage(clientMessageBase+DisplayLabelRequest));
+		displayLabelRequest.write(networkVersion);
+		displayLabelRequest.write(NodeID(Math::randUniformCO(0.0,double(numNodes))));
+		displayLabelRequest.write(Misc::UInt8(Math::randUniformCO(0.0,1.0)<0.5?1:2));
+		client->queueServerMessage(displayLabelRequest.getBuffer());
+		++numRequests;
+		}
+	
+	if(numRequests>0)
+		{
+		Threads::Mutex::Lock statisticsLock(statisticsMutex);
+		statistics.numRequests+=numRequests;
+		}
+	}
+
+void NetworkViewerLoadClient::getStatistics(NetworkViewerLoadClient::Statistics& result)
+	{
+	/* Hand the collected measurements to the caller and start a new reporting period: */
+	result.clear();
+	Threads::Mutex::Lock statisticsLock(statisticsMutex);
+	std::swap(result,statistics);
+	}
+
+}
+
+}
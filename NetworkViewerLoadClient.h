@@ -0,0 +1,193 @@
+/***********************************************************************
+NetworkViewerLoadClient - Headless client for network viewer plug-in
+protocol generating synthetic interaction traffic and measuring the
+delivery of simulation updates.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef NETWORKVIEWERLOADCLIENT_INCLUDED
+#define NETWORKVIEWERLOADCLIENT_INCLUDED
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <Threads/Mutex.h>
+#include <Threads/WorkerPool.h>
+#include <Realtime/Time.h>
+#include <IO/File.h>
+#include <Collaboration2/PluginClient.h>
+#include <Collaboration2/Plugins/MetadosisClient.h>
+
+#include "NetworkViewerProtocol.h"
+
+/* Forward declarations: */
+namespace Collab {
+class MessageReader;
+class MessageWriter;
+class MessageContinuation;
+class Client;
+}
+
+namespace Collab {
+
+namespace Plugins {
+
+class NetworkViewerLoadClient:public PluginClient,public NetworkViewerProtocol
+	{
+	/* Embedded classes: */
+	public:
+	struct TrafficParameters // Structure defining the synthetic interaction traffic generated by a load client
+		{
+		/* Elements: */
+		public:
+		double dragRate; // Average number of drag operations started per second while not dragging
+		double dragDuration; // Duration of each drag operation in seconds
+		double dragRadius; // Radius of the circle along which dragged nodes are moved in navigational space
+		double selectRate; // Average number of select node requests per second
+		double labelRate; // Average number of display label requests per second
+		
+		/* Constructors and destructors: */
+		TrafficParameters(void) // Creates default traffic parameters modeled on a user exploring a network
+			:dragRate(0.5),dragDuration(2.0),dragRadius(5.0),
+			 selectRate(0.5),labelRate(0.2)
+			{
+			}
+		};
+	
+	struct Statistics // Structure holding a load client's measurements over a reporting period
+		{
+		/* Elements: */
+		public:
+		size_t numUpdates; // Number of completely received simulation updates
+		size_t updateBytes; // Number of received simulation update bytes, including partial updates
+		std::vector<double> updateIntervals; // Times between consecutive completely received simulation updates in seconds
+		size_t numNotifications; // Number of received notifications other than simulation updates
+		size_t numRequests; // Number of sent requests
+		std::vector<double> dragLatencies; // Round-trip times of traced drag requests in seconds
+		
+		/* Constructors and destructors: */
+		Statistics(void)
+			:numUpdates(0),updateBytes(0),numNotifications(0),numRequests(0)
+			{
+			}
+		
+		/* Methods: */
+		void clear(void) // Resets all measurements
+			{
+			numUpdates=0;
+			updateBytes=0;
+			updateIntervals.clear();
+			numNotifications=0;
+			numRequests=0;
+			dragLatencies.clear();
+			}
+		};
+	
+	private:
+	class DrainNetworkJob:public Threads::WorkerPool::JobFunction // Class to receive and discard a network file from a worker thread
+		{
+		/* Elements: */
+		public:
+		Version networkVersion; // The version number of the network being received
+		IO::FilePtr networkFile; // The file from which to receive the network
+		Client* client; // Pointer to the collaboration client
+		unsigned int serverMessageBase; // Base index for NetworkViewerProtocol server messages
+		
+		/* Constructors and destructors: */
+		public:
+		DrainNetworkJob(Version sNetworkVersion,IO::File& sNetworkFile,Client* sClient,unsigned int sServerMessageBase);
+		virtual ~DrainNetworkJob(void);
+		
+		/* Methods from class Threads::WorkerPool::JobFunction: */
+		virtual void operator()(int) const;
+		virtual void operator()(int);
+		};
+	
+	struct PendingDragTrace // Structure for traced drag requests awaiting the server's latency breakdown
+		{
+		/* Elements: */
+		public:
+		Misc::UInt32 traceId; // ID of the traced drag request
+		Realtime::TimePointMonotonic sendTime; // Time at which the drag request was sent to the server
+		};
+	
+	/* Elements: */
+	static const Misc::UInt32 ackInterval=8; // Number of simulation updates between acknowledgments of datagram updates
+	MetadosisClient* metadosis; // Pointer to the Metadosis protocol's client plug-in
+	std::string sessionName; // Name of the server session to join when the client starts; empty for the server's default session
+	bool datagramUpdates; // Flag whether to request simulation updates as unreliable datagrams
+	std::string uploadNetworkFileName; // Name of a network file to upload to the server when the client starts, or empty
+	TrafficParameters trafficParameters; // Parameters of the generated interaction traffic
+	Version networkVersion; // Version number of the most recent completely received network
+	Version downloadingVersion; // Version number of the most recent network announced by the server
+	DragID lastDragId; // Drag ID assigned to the most recent drag operation
+	DragID dragId; // ID of the current drag operation, or 0 if not dragging
+	double dragTime; // Time since the start of the current drag operation in seconds
+	Misc::UInt32 lastTraceId; // Trace ID assigned to the most recent traced drag request
+	std::deque<PendingDragTrace> pendingDragTraces; // Queue of traced drag requests in the order in which they were sent
+	
+	/* State shared with the client's communication thread: */
+	Threads::Mutex statisticsMutex; // Mutex serializing access to the shared state below
+	size_t numParticles; // Number of particles in the most recent simulation update
+	Realtime::TimePointMonotonic lastUpdateTime; // Time at which the most recent simulation update was completely received
+	bool haveUpdate; // Flag whether any simulation update has been completely received
+	Misc::UInt32 datagramSequence; // Sequence number of the newest simulation update from which any chunk was received
+	size_t numDatagramParticles; // Number of particles received in chunks of the newest simulation update
+	Misc::UInt32 lastAckedSequence; // Sequence number most recently acknowledged to the server
+	Statistics statistics; // Measurements collected since the last report
+	
+	/* Private methods: */
+	void updateReceived(size_t newNumParticles); // Records the complete reception of a simulation update; must be called with the statistics mutex locked
+	void loadNetworkCompleteNotificationCallback(unsigned int messageId,MessageReader& message);
+	void loadNetworkNotificationCallback(unsigned int messageId,MessageReader& message);
+	void notificationCallback(unsigned int messageId,MessageReader& message);
+	MessageContinuation* simulationUpdateCallback(unsigned int messageId,MessageContinuation* continuation);
+	void simulationUpdateChunkCallback(unsigned int messageId,MessageReader& message);
+	void dragTraceNotificationCallback(unsigned int messageId,MessageReader& message);
+	void writeNavDragTransform(MessageWriter& writer) const; // Writes the current drag transformation in navigational space to the given drag request message
+	
+	/* Constructors and destructors: */
+	public:
+	NetworkViewerLoadClient(Client* sClient);
+	virtual ~NetworkViewerLoadClient(void);
+	
+	/* Methods from class PluginClient: */
+	virtual const char* getName(void) const;
+	virtual unsigned int getVersion(void) const;
+	virtual unsigned int getNumClientMessages(void) const;
+	virtual unsigned int getNumServerMessages(void) const;
+	virtual void setMessageBases(unsigned int newClientMessageBase,unsigned int newServerMessageBase);
+	virtual void start(void);
+	
+	/* New methods: */
+	void setSessionName(const char* newSessionName); // Sets the name of the server session to join when the client starts
+	void setDatagramUpdates(bool newDatagramUpdates); // Requests to receive simulation updates as unreliable datagrams instead of over TCP
+	void setUploadNetworkFileName(const char* newUploadNetworkFileName); // Sets the name of a network file to upload to the server when the client starts
+	void setTrafficParameters(const TrafficParameters& newTrafficParameters); // Sets the parameters of the generated interaction traffic
+	void loadNetwork(const char* networkFileName); // Uploads the network file of the given name to the server; must be called after the client has started
+	bool isReady(void); // Returns true if the client has received a network and its first simulation update
+	void frame(double timeStep); // Generates interaction traffic for a frame of the given duration in seconds; must be called from the thread dispatching the client's frontend messages
+	void getStatistics(Statistics& result); // Moves the measurements collected since the last call into the given structure
+	};
+
+}
+
+}
+
+#endif
@@ -0,0 +1,287 @@
+/***********************************************************************
+NetworkViewerLoadTest - Headless load generator connecting any number of
+synthetic clients to a network viewer server to measure how simulation
+update delivery scales with the number of clients.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <Misc/Utility.h>
+#include <Realtime/Time.h>
+#include <Collaboration2/Client.h>
+
+#include "NetworkViewerLoadClient.h"
+
+typedef Collab::Plugins::NetworkViewerLoadClient LoadClient;
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+double percentile(std::vector<double>& samples,unsigned int percent) // Returns the given percentile of the given list of samples, which is sorted in the process
+	{
+	if(samples.empty())
+		return 0.0;
+	std::sort(samples.begin(),samples.end());
+	return samples[((samples.size()-1)*percent)/100];
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	const char* serverHostName="localhost";
+	int serverPort=26000;
+	unsigned int numClients=1;
+	unsigned int rampStep=0;
+	double rampInterval=10.0;
+	double duration=30.0;
+	double frameRate=60.0;
+	const char* networkFileName=0;
+	const char* sessionName="";
+	bool datagramUpdates=false;
+	LoadClient::TrafficParameters trafficParameters;
+	double degradationThreshold=0.9;
+	double readyTimeout=30.0;
+	for(int argi=1;argi<argc;++argi)
+		{
+		if(argv[argi][0]=='-')
+			{
+			if(strcasecmp(argv[argi]+1,"server")==0&&argi+1<argc)
+				{
+				/* Split the argument into host name and optional port: */
+				++argi;
+				const char* colon=strrchr(argv[argi],':');
+				if(colon!=0)
+					{
+					static std::string hostName;
+					hostName=std::string(argv[argi],colon);
+					serverHostName=hostName.c_str();
+					serverPort=atoi(colon+1);
+					}
+				else
+					serverHostName=argv[argi];
+				}
+			else if(strcasecmp(argv[argi]+1,"clients")==0&&argi+1<argc)
+				numClients=(unsigned int)(atoi(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"ramp")==0&&argi+2<argc)
+				{
+				rampStep=(unsigned int)(atoi(argv[++argi]));
+				rampInterval=atof(argv[++argi]);
+				}
+			else if(strcasecmp(argv[argi]+1,"duration")==0&&argi+1<argc)
+				duration=atof(argv[++argi]);
+			else if(strcasecmp(argv[argi]+1,"frameRate")==0&&argi+1<argc)
+				frameRate=atof(argv[++argi]);
+			else if(strcasecmp(argv[argi]+1,"network")==0&&argi+1<argc)
+				networkFileName=argv[++argi];
+			else if(strcasecmp(argv[argi]+1,"session")==0&&argi+1<argc)
+				sessionName=argv[++argi];
+			else if(strcasecmp(argv[argi]+1,"datagramUpdates")==0)
+				datagramUpdates=true;
+			else if(strcasecmp(argv[argi]+1,"dragRate")==0&&argi+1<argc)
+				trafficParameters.dragRate=atof(argv[++argi]);
+			else if(strcasecmp(argv[argi]+1,"selectRate")==0&&argi+1<argc)
+				trafficParameters.selectRate=atof(argv[++argi]);
+			else if(strcasecmp(argv[argi]+1,"labelRate")==0&&argi+1<argc)
+				trafficParameters.labelRate=atof(argv[++argi]);
+			else if(strcasecmp(argv[argi]+1,"threshold")==0&&argi+1<argc)
+				degradationThreshold=atof(argv[++argi]);
+			else if(strcasecmp(argv[argi]+1,"readyTimeout")==0&&argi+1<argc)
+				readyTimeout=atof(argv[++argi]);
+			else
+				fprintf(stderr,"NetworkViewerLoadTest: Ignoring command line option %s\n",argv[argi]);
+			}
+		else
+			fprintf(stderr,"NetworkViewerLoadTest: Ignoring command line argument %s\n",argv[argi]);
+		}
+	if(numClients==0||frameRate<=0.0||readyTimeout<=0.0)
+		{
+		fprintf(stderr,"Usage: %s [-server <host name>[:<port>]] [-clients <number of clients>] [-ramp <clients per stage> <stage duration>] [-duration <run time>] [-frameRate <rate>] [-network <network file name>] [-session <session name>] [-datagramUpdates] [-dragRate <rate>] [-selectRate <rate>] [-labelRate <rate>] [-threshold <fraction>] [-readyTimeout <time>]\n",argv[0]);
+		return 1;
+		}
+	
+	/* Without a ramp, start all clients at once and report at regular intervals for the requested duration: */
+	double stageDuration=rampInterval;
+	double reportInterval=rampInterval;
+	if(rampStep==0||rampStep>=numClients)
+		{
+		rampStep=numClients;
+		stageDuration=duration;
+		reportInterval=Misc::min(duration,5.0);
+		}
+	
+	/* Run the load test: */
+	std::vector<Collab::Client*> clients;
+	std::vector<LoadClient*> loadClients;
+	double frameInterval=1.0/frameRate;
+	Realtime::TimePointMonotonic startTime;
+	double nextFrameTime=0.0;
+	bool connectNextStage=true;
+	bool stageReady=false;
+	double stageConnectTime=0.0;
+	double stageStartTime=0.0;
+	double reportStartTime=0.0;
+	double baselineUpdateRate=0.0;
+	unsigned int degradedNumClients=0;
+	bool keepRunning=true;
+	int result=0;
+	try
+		{
+		printf("Clients  Updates/s/client (mean, min)  MB/s  Update interval ms (p50, p99, max)  Requests/s  Drag RTT ms (p50, p99)\n");
+		while(keepRunning)
+			{
+			if(connectNextStage)
+				{
+				/* Connect the next stage of clients: */
+				unsigned int stageEnd=Misc::min(numClients,(unsigned int)(clients.size())+rampStep);
+				while(clients.size()<stageEnd)
+					{
+					Collab::Client* client=new Collab::Client;
+					LoadClient* loadClient=new LoadClient(client);
+					loadClient->setSessionName(sessionName);
+					loadClient->setDatagramUpdates(datagramUpdates);
+					loadClient->setTrafficParameters(trafficParameters);
+					
+					/* Let the very first client upload the network file if one was given: */
+					if(clients.empty()&&networkFileName!=0)
+						loadClient->setUploadNetworkFileName(networkFileName);
+					
+					client->addPluginProtocol(loadClient);
+					client->start(serverHostName,serverPort);
+					clients.push_back(client);
+					loadClients.push_back(loadClient);
+					}
+				connectNextStage=false;
+				stageReady=false;
+				stageConnectTime=double(Realtime::TimePointMonotonic()-startTime);
+				}
+			
+			/* Process received messages and generate traffic for all clients: */
+			bool allReady=true;
+			for(size_t i=0;i<clients.size();++i)
+				{
+				clients[i]->dispatchFrontendMessages();
+				loadClients[i]->frame(frameInterval);
+				allReady=allReady&&loadClients[i]->isReady();
+				}
+			double now=double(Realtime::TimePointMonotonic()-startTime);
+			
+			if(!stageReady&&allReady)
+				{
+				/* Discard the measurements taken while the stage's clients were joining: */
+				LoadClient::Statistics stats;
+				for(std::vector<LoadClient*>::iterator lcIt=loadClients.begin();lcIt!=loadClients.end();++lcIt)
+					(*lcIt)->getStatistics(stats);
+				stageReady=true;
+				stageStartTime=now;
+				reportStartTime=now;
+				}
+			
+			/* Give up if the stage's clients do not connect and receive a network and simulation update in time: */
+			if(!stageReady&&now-stageConnectTime>=readyTimeout)
+				{
+				char message[128];
+				snprintf(message,sizeof(message),"Clients did not become ready within %g seconds",readyTimeout);
+				throw std::runtime_error(message);
+				}
+			
+			/* Write a report at the end of each reporting period: */
+			double reportPeriod=now-reportStartTime;
+			if(stageReady&&reportPeriod>=reportInterval)
+				{
+				/* Combine the measurements of all clients: */
+				size_t totalUpdates=0;
+				size_t totalBytes=0;
+				size_t totalRequests=0;
+				double minUpdateRate=0.0;
+				std::vector<double> updateIntervals,dragLatencies;
+				for(size_t i=0;i<loadClients.size();++i)
+					{
+					LoadClient::Statistics stats;
+					loadClients[i]->getStatistics(stats);
+					totalUpdates+=stats.numUpdates;
+					totalBytes+=stats.updateBytes;
+					totalRequests+=stats.numRequests;
+					double updateRate=double(stats.numUpdates)/reportPeriod;
+					if(i==0||minUpdateRate>updateRate)
+						minUpdateRate=updateRate;
+					updateIntervals.insert(updateIntervals.end(),stats.updateIntervals.begin(),stats.updateIntervals.end());
+					dragLatencies.insert(dragLatencies.end(),stats.dragLatencies.begin(),stats.dragLatencies.end());
+					}
+				double meanUpdateRate=double(totalUpdates)/(reportPeriod*double(loadClients.size()));
+				
+				/* Compare the update rate against the rate measured with the first stage of clients: */
+				if(baselineUpdateRate==0.0)
+					baselineUpdateRate=meanUpdateRate;
+				bool degraded=meanUpdateRate<baselineUpdateRate*degradationThreshold;
+				if(degraded&&degradedNumClients==0)
+					degradedNumClients=(unsigned int)(clients.size());
+				
+				printf("%7u  %14.2f %14.2f  %6.2f  %11.2f %8.2f %8.2f  %10.1f  %10.2f %8.2f%s\n",(unsigned int)(clients.size()),meanUpdateRate,minUpdateRate,double(totalBytes)/(reportPeriod*1024.0*1024.0),percentile(updateIntervals,50)*1000.0,percentile(updateIntervals,99)*1000.0,percentile(updateIntervals,100)*1000.0,double(totalRequests)/reportPeriod,percentile(dragLatencies,50)*1000.0,percentile(dragLatencies,99)*1000.0,degraded?"  degraded":"");
+				fflush(stdout);
+				reportStartTime=now;
+				
+				/* Move on to the next stage, or stop after the last one: */
+				if(now-stageStartTime>=stageDuration)
+					{
+					if(clients.size()<numClients)
+						connectNextStage=true;
+					else
+						keepRunning=false;
+					}
+				}
+			
+			/* Wait for the next frame: */
+			nextFrameTime+=frameInterval;
+			double sleepTime=nextFrameTime-double(Realtime::TimePointMonotonic()-startTime);
+			if(sleepTime>0.0)
+				usleep(useconds_t(sleepTime*1.0e6+0.5));
+			else
+				nextFrameTime-=sleepTime;
+			}
+		}
+	catch(const std::runtime_error& err)
+		{
+		fprintf(stderr,"NetworkViewerLoadTest: Terminating due to exception %s\n",err.what());
+		result=1;
+		}
+	
+	/* Summarize the run: */
+	if(degradedNumClients!=0)
+		printf("Update delivery degraded below %.0f%% of the baseline rate at %u clients\n",degradationThreshold*100.0,degradedNumClients);
+	else if(baselineUpdateRate!=0.0)
+		printf("Update delivery did not degrade with up to %u clients\n",(unsigned int)(clients.size()));
+	
+	/* Disconnect all clients: */
+	for(std::vector<Collab::Client*>::iterator cIt=clients.begin();cIt!=clients.end();++cIt)
+		delete *cIt;
+	
+	return result;
+	}
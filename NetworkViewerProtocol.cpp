@@ -37,6 +37,122 @@ Static elements of class NetworkViewerProtocol:
 
 const char* NetworkViewerProtocol::protocolName="NetworkViewer";
 
+/**************************************
+Methods of class NetworkViewerProtocol:
+**************************************/
+
+Misc::UInt8 NetworkViewerProtocol::chooseNodeSetEncoding(const std::vector<NodeID>& nodes,size_t& payloadSize)
+	{
+	/* Encode empty sets as empty range lists: */
+	if(nodes.empty())
+		{
+		payloadSize=0;
+		return SelectRegionNotificationMsg::Ranges;
+		}
+	
+	/* Count the number of runs of consecutive node IDs: */
+	size_t numRanges=1;
+	for(std::vector<NodeID>::const_iterator nIt=nodes.begin()+1;nIt!=nodes.end();++nIt)
+		if(*nIt!=nIt[-1]+1)
+			++numRanges;
+	size_t rangesSize=numRanges*(sizeof(NodeID)+sizeof(Misc::UInt32));
+	
+	/* Calculate the size of a bitmap spanning the set's node ID range: */
+	size_t bitmapSize=sizeof(NodeID)+size_t(nodes.back()-nodes.front())/8+1;
+	
+	/* Return the smaller encoding: */
+	if(rangesSize<=bitmapSize)
+		{
+		payloadSize=rangesSize;
+		return SelectRegionNotificationMsg::Ranges;
+		}
+	else
+		{
+		payloadSize=bitmapSize;
+		return SelectRegionNotificationMsg::Bitmap;
+		}
+	}
+
+void NetworkViewerProtocol::writeNodeSet(const std::vector<NodeID>& nodes,Misc::UInt8 encoding,MessageWriter& writer)
+	{
+	if(nodes.empty())
+		return;
+	
+	if(encoding==SelectRegionNotificationMsg::Ranges)
+		{
+		/* Write runs of consecutive node IDs: */
+		std::vector<NodeID>::const_iterator rangeBegin=nodes.begin();
+		while(rangeBegin!=nodes.end())
+			{
+			/* Find the end of the current run: */
+			std::vector<NodeID>::const_iterator rangeEnd=rangeBegin+1;
+			while(rangeEnd!=nodes.end()&&*rangeEnd==rangeEnd[-1]+1)
+				++rangeEnd;
+			
+			/* Write the run: */
+			writer.write(*rangeBegin);
+			writer.write(Misc::UInt32(rangeEnd-rangeBegin));
+			
+			rangeBegin=rangeEnd;
+			}
+		}
+	else
+		{
+		/* Write the first node ID: */
+		NodeID first=nodes.front();
+		writer.write(first);
+		
+		/* Write a bitmap of all node IDs starting at the first node ID: */
+		size_t byteIndex=0;
+		Misc::UInt8 byte=0U;
+		for(std::vector<NodeID>::const_iterator nIt=nodes.begin();nIt!=nodes.end();++nIt)
+			{
+			/* Flush all bytes preceding the current node ID's byte: */
+			size_t bit=size_t(*nIt-first);
+			for(;byteIndex<bit/8;++byteIndex)
+				{
+				writer.write(byte);
+				byte=0U;
+				}
+			
+			/* Set the current node ID's bit: */
+			byte|=Misc::UInt8(1U<<(bit%8));
+			}
+		writer.write(byte);
+		}
+	}
+
+void NetworkViewerProtocol::readNodeSet(MessageReader& reader,Misc::UInt8 encoding,size_t payloadSize,std::vector<NodeID>& nodes)
+	{
+	if(encoding==SelectRegionNotificationMsg::Ranges)
+		{
+		/* Read runs of consecutive node IDs: */
+		size_t numRanges=payloadSize/(sizeof(NodeID)+sizeof(Misc::UInt32));
+		for(size_t i=0;i<numRanges;++i)
+			{
+			NodeID first=reader.read<NodeID>();
+			Misc::UInt32 numNodes=reader.read<Misc::UInt32>();
+			for(Misc::UInt32 j=0;j<numNodes;++j)
+				nodes.push_back(first+j);
+			}
+		}
+	else if(payloadSize>=sizeof(NodeID))
+		{
+		/* Read the first node ID: */
+		NodeID first=reader.read<NodeID>();
+		
+		/* Read the bitmap: */
+		size_t numBytes=payloadSize-sizeof(NodeID);
+		for(size_t byteIndex=0;byteIndex<numBytes;++byteIndex)
+			{
+			Misc::UInt8 byte=reader.read<Misc::UInt8>();
+			for(unsigned int bit=0;byte!=0U;++bit,byte>>=1)
+				if(byte&0x1U)
+					nodes.push_back(first+NodeID(byteIndex*8+bit));
+			}
+		}
+	}
+
 }
 
 }
@@ -24,6 +24,7 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #define NETWORKVIEWERPROTOCOL_INCLUDED
 
 #include <string>
+#include <vector>
 #include <Misc/SizedTypes.h>
 #include <Geometry/Point.h>
 #include <Collaboration2/Protocol.h>
@@ -34,9 +35,14 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include "ParticleTypes.h"
 #include "SimulationParameters.h"
 #include "RenderingParameters.h"
+#include "SelectionRegion.h"
 
 namespace Collab {
 
+/* Forward declarations: */
+class MessageReader;
+class MessageWriter;
+
 namespace Plugins {
 
 class NetworkViewerProtocol
@@ -56,6 +62,12 @@ class NetworkViewerProtocol
 		DragStartRequest,
 		DragRequest,
 		DragStopRequest,
+		SelectRegionRequest,
+		DatagramUpdatesRequest,
+		DatagramUpdateAck,
+		JoinSessionRequest,
+		NavDragStartRequest,
+		NavDragRequest,
 		NumClientMessages
 		};
 	
@@ -71,6 +83,11 @@ class NetworkViewerProtocol
 		ChangeSelectionNotification,
 		DisplayLabelNotification,
 		SimulationUpdate,
+		SelectRegionNotification,
+		DatagramUpdatesNotification,
+		SimulationUpdateChunk,
+		DragTraceNotification,
+		DragDeltaNotification,
 		NumServerMessages
 		};
 	
@@ -84,6 +101,13 @@ class NetworkViewerProtocol
 	typedef Misc::UInt32 NodeID; // Type to identify network nodes
 	typedef Misc::UInt16 DragID; // Type to identify drag sequences
 	
+	enum NetworkFileEncoding // Enumerated type for encodings of network files transferred between clients and the server
+		{
+		RawNetworkFile=0, // The network's json file as read from disk
+		DeflatedNetworkFile, // The network's json file compressed with zlib's deflate method
+		NumNetworkFileEncodings
+		};
+	
 	/* Protocol message data structure declarations: */
 	protected:
 	struct LoadNetworkMsg
@@ -91,10 +115,11 @@ class NetworkViewerProtocol
 		/* Elements: */
 		public:
 		static const size_t networkNameLen=256; // Maximum length of network names
-		static const size_t size=sizeof(Version)+networkNameLen*sizeof(Char)+sizeof(MetadosisProtocol::StreamID);
+		static const size_t size=sizeof(Version)+networkNameLen*sizeof(Char)+sizeof(MetadosisProtocol::StreamID)+sizeof(Misc::UInt8);
 		Version networkVersion; // Version number for the new network
 		Char networkName[networkNameLen]; // Name of the new network
 		MetadosisProtocol::StreamID streamId; // Stream ID of the Metadosis stream from which the new network file can be read
+		Misc::UInt8 fileEncoding; // Encoding of the network file in the Metadosis stream, one of NetworkFileEncoding
 		
 		/* Methods: */
 		static MessageBuffer* createMessage(unsigned int messageId) // Returns a message buffer for a load network request or notification message
@@ -213,9 +238,10 @@ class NetworkViewerProtocol
 		{
 		/* Elements: */
 		public:
-		static const size_t size=sizeof(Version)+sizeof(DragID);
+		static const size_t size=sizeof(Version)+sizeof(DragID)+sizeof(Misc::UInt32);
 		Version networkVersion; // Version number of the network to which the message applies
 		DragID dragId; // ID of this drag operation
+		Misc::UInt32 traceId; // ID under which the server reports the request's latency breakdown to the client, or 0 if the request is not traced
 		
 		/* Methods: */
 		static MessageBuffer* createMessage(unsigned int messageBase) // Returns a message buffer for a drag request message
@@ -255,9 +281,196 @@ class NetworkViewerProtocol
 			}
 		};
 	
+	struct SelectRegionRequestMsg
+		{
+		/* Elements: */
+		public:
+		static const size_t stringLen=64; // Maximum length of property names and values
+		static const size_t size=sizeof(Version)+sizeof(Misc::UInt8)+SelectionRegion::size+2*stringLen*sizeof(Char);
+		Version networkVersion; // Version number of the network to which the message applies
+		Misc::UInt8 mode; // Selection mode: 0: add to selection; 1: remove from selection; 2: toggle selection state; 3: replace selection
+		// SelectionRegion region; // Type, geometric parameters, and comparison operator of the selection region
+		Char propertyName[stringLen]; // Name of the node property tested by a property region
+		Char propertyValue[stringLen]; // Value against which a property region compares node properties
+		
+		/* Methods: */
+		static MessageBuffer* createMessage(unsigned int messageBase) // Returns a message buffer for a select region request message
+			{
+			return MessageBuffer::create(messageBase+SelectRegionRequest,size);
+			}
+		};
+	
+	struct SelectRegionNotificationMsg
+		{
+		/* Embedded classes: */
+		public:
+		enum Encoding // Enumerated type for compact node set encodings
+			{
+			Ranges=0, // List of (first node ID, number of nodes) pairs of consecutive node IDs
+			Bitmap // First node ID, followed by a bit per node ID starting at the first node ID, least-significant bit first
+			};
+		
+		/* Elements: */
+		static const size_t size=sizeof(Version)+2*sizeof(Misc::UInt8)+sizeof(Misc::UInt32); // Size of fixed portion of message
+		Version networkVersion; // Version number of the network to which the message applies
+		Misc::UInt8 mode; // Selection mode: 0: add to selection; 1: remove from selection; 2: toggle selection state; 3: replace selection
+		Misc::UInt8 encoding; // Encoding of the node set
+		Misc::UInt32 payloadSize; // Size of the encoded node set in bytes
+		// Misc::UInt8 payload[payloadSize]; // Encoded node set
+		
+		/* Methods: */
+		static MessageBuffer* createMessage(unsigned int messageBase,size_t payloadSize) // Returns a message buffer for a select region notification message with an encoded node set of the given size
+			{
+			return MessageBuffer::create(messageBase+SelectRegionNotification,size+payloadSize);
+			}
+		};
+	
+	struct DatagramUpdatesMsg
+		{
+		/* Elements: */
+		public:
+		static const size_t size=sizeof(Misc::UInt8);
+		Misc::UInt8 enable; // Flag whether simulation updates are to be / are being sent as unreliable datagrams
+		
+		/* Methods: */
+		static MessageBuffer* createMessage(unsigned int messageId) // Returns a message buffer for a datagram updates request or notification message
+			{
+			return MessageBuffer::create(messageId,size);
+			}
+		};
+	
+	struct DatagramUpdateAckMsg
+		{
+		/* Elements: */
+		public:
+		static const size_t size=sizeof(Misc::UInt32);
+		Misc::UInt32 sequenceNumber; // Sequence number of the most recent simulation update from which the client received a chunk
+		
+		/* Methods: */
+		static MessageBuffer* createMessage(unsigned int messageBase) // Returns a message buffer for a datagram update acknowledgment message
+			{
+			return MessageBuffer::create(messageBase+DatagramUpdateAck,size);
+			}
+		};
+	
+	struct SimulationUpdateChunkMsg
+		{
+		/* Elements: */
+		public:
+		static const size_t maxChunkParticles=100; // Maximum number of particle positions per chunk, to keep datagrams below typical path MTUs
+		static const size_t size=sizeof(Version)+3*sizeof(Misc::UInt32)+sizeof(Misc::UInt16); // Size up to and including number of particle positions in the chunk
+		Version networkVersion; // Version number of the network to which the chunk applies
+		Misc::UInt32 sequenceNumber; // Sequence number of the simulation update of which this chunk is a part; never zero
+		Misc::UInt32 numParticles; // Total number of particles in the simulation update
+		Misc::UInt32 firstParticle; // Index of the first particle whose position is contained in this chunk; always a multiple of maxChunkParticles
+		Misc::UInt16 numChunkParticles; // Number of particles whose positions are contained in this chunk
+		// Point particlePositions[numChunkParticles]; // Array of particle positions
+		
+		/* Methods: */
+		static MessageBuffer* createMessage(unsigned int messageBase,size_t numChunkParticles) // Returns a message buffer for a simulation update chunk message containing the given number of particle positions
+			{
+			return MessageBuffer::create(messageBase+SimulationUpdateChunk,size+numChunkParticles*pointSize);
+			}
+		};
+	
+	struct DragTraceNotificationMsg
+		{
+		/* Elements: */
+		public:
+		static const size_t size=sizeof(Misc::UInt32)+3*sizeof(Misc::Float32);
+		Misc::UInt32 traceId; // ID of the traced drag request
+		Misc::Float32 queueTime; // Time between the server receiving the drag request and the simulation thread applying it in seconds
+		Misc::Float32 stepTime; // Time between applying the drag request and starting the first simulation update reflecting it in seconds
+		Misc::Float32 encodeTime; // Time between starting the simulation update and queueing it for the client in seconds
+		
+		/* Methods: */
+		static MessageBuffer* createMessage(unsigned int messageBase) // Returns a message buffer for a drag trace notification message
+			{
+			return MessageBuffer::create(messageBase+DragTraceNotification,size);
+			}
+		};
+	
+	struct DragDeltaNotificationMsg
+		{
+		/* Elements: */
+		public:
+		static const size_t size=sizeof(Version)+sizeof(Misc::UInt64)+sizeof(Misc::UInt32); // Size up to and including number of dragged nodes in the message
+		static const size_t nodeSize=sizeof(NodeID)+pointSize; // Wire size of a dragged node's ID and position
+		Version networkVersion; // Version number of the network to which the message applies
+		Misc::UInt64 dragKey; // Server-wide unique key of the drag operation, combining the dragging client's ID and its drag ID
+		Misc::UInt32 numNodes; // Number of dragged nodes whose positions are contained in this message; 0 if the drag operation ended
+		// { NodeID node; Point position; } nodes[numNodes]; // Array of dragged node IDs and positions
+		
+		/* Methods: */
+		static MessageBuffer* createMessage(unsigned int messageBase,size_t numNodes) // Returns a message buffer for a drag delta notification containing the given number of dragged nodes
+			{
+			return MessageBuffer::create(messageBase+DragDeltaNotification,size+numNodes*nodeSize);
+			}
+		static Misc::UInt64 getDragKey(unsigned int clientId,unsigned int dragId) // Returns the server-wide unique key of a drag operation
+			{
+			return (Misc::UInt64(clientId)<<32)|Misc::UInt64(dragId);
+			}
+		};
+	
+	struct JoinSessionRequestMsg
+		{
+		/* Elements: */
+		public:
+		static const size_t sessionNameLen=64; // Maximum length of session names
+		static const size_t size=sessionNameLen*sizeof(Char);
+		Char sessionName[sessionNameLen]; // Name of the session to join; empty name selects the server's default session
+		
+		/* Methods: */
+		static MessageBuffer* createMessage(unsigned int messageBase) // Returns a message buffer for a join session request message
+			{
+			return MessageBuffer::create(messageBase+JoinSessionRequest,size);
+			}
+		};
+	
+	struct NavDragStartRequestMsg
+		{
+		/* Elements: */
+		public:
+		static const size_t size=sizeof(Version)+sizeof(DragID)+sizeof(NodeID)+7*scalarSize;
+		Version networkVersion; // Version number of the network to which the message applies
+		DragID newDragId; // ID of this drag operation
+		NodeID pickedNode; // The node picked by the dragger
+		// NVScalar translation[3]; // Translation vector of the initial drag transformation in navigational space
+		// NVScalar rotation[4]; // Rotation quaternion of the initial drag transformation in navigational space
+		
+		/* Methods: */
+		static MessageBuffer* createMessage(unsigned int messageBase) // Returns a message buffer for a navigational-space drag start request message
+			{
+			return MessageBuffer::create(messageBase+NavDragStartRequest,size);
+			}
+		};
+	
+	struct NavDragRequestMsg
+		{
+		/* Elements: */
+		public:
+		static const size_t size=sizeof(Version)+sizeof(DragID)+sizeof(Misc::UInt32)+7*scalarSize;
+		Version networkVersion; // Version number of the network to which the message applies
+		DragID dragId; // ID of this drag operation
+		Misc::UInt32 traceId; // ID under which the server reports the request's latency breakdown to the client, or 0 if the request is not traced
+		// NVScalar translation[3]; // Translation vector of the drag transformation in navigational space
+		// NVScalar rotation[4]; // Rotation quaternion of the drag transformation in navigational space
+		
+		/* Methods: */
+		static MessageBuffer* createMessage(unsigned int messageBase) // Returns a message buffer for a navigational-space drag request message
+			{
+			return MessageBuffer::create(messageBase+NavDragRequest,size);
+			}
+		};
+	
+	/* Protected methods: */
+	static Misc::UInt8 chooseNodeSetEncoding(const std::vector<NodeID>& nodes,size_t& payloadSize); // Returns the more compact encoding for the given sorted set of nodes, and the size of the encoded set
+	static void writeNodeSet(const std::vector<NodeID>& nodes,Misc::UInt8 encoding,MessageWriter& writer); // Writes the given sorted set of nodes in the given encoding
+	static void readNodeSet(MessageReader& reader,Misc::UInt8 encoding,size_t payloadSize,std::vector<NodeID>& nodes); // Appends the nodes contained in an encoded node set of the given size to the given list in increasing order
+	
 	/* Elements: */
 	static const char* protocolName;
-	static const unsigned int protocolVersion=4U<<16;
+	static const unsigned int protocolVersion=5U<<16;
 	};
 
 }
@@ -21,7 +21,12 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include "NetworkViewerServer.h"
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <strings.h>
+#include <ctype.h>
 #include <stdexcept>
+#include <algorithm>
 #include <Misc/Utility.h>
 #include <Misc/Autopointer.h>
 #include <Misc/MessageLogger.h>
@@ -35,9 +40,11 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Collaboration2/Server.h>
 #include <Collaboration2/Plugins/VruiCoreServer.h>
 
+#include "InflateFilter.h"
 #include "Network.h"
 #include "ParticleSystem.h"
 #include "NetworkSimulator.h"
+#include "Tracer.h"
 
 namespace Collab {
 
@@ -48,15 +55,42 @@ Methods of class NetworkViewerServer::Client:
 ********************************************/
 
 NetworkViewerServer::Client::Client(void)
-	:networkVersion(0),
-	 activeDrags(5)
+	:session(0),networkVersion(0),
+	 activeDrags(5),
+	 datagramUpdates(false),lastAckedSequence(0),
+	 updateBytes(0)
 	{
+	for(int i=0;i<NumMetricsReports;++i)
+		reportedUpdateBytes[i]=0;
 	}
 
 NetworkViewerServer::Client::~Client(void)
 	{
 	}
 
+/*********************************************
+Methods of class NetworkViewerServer::Session:
+*********************************************/
+
+NetworkViewerServer::Session::Session(const std::string& sName)
+	:name(sName),
+	 networkVersion(0),networkFileEncoding(RawNetworkFile),network(0),labeledNodes(17),
+	 simulator(0),
+	 updateSequence(0),numDatagramClients(0),
+	 recorder(0),recording(false),
+	 player(0),replayTime(0.0),replaySpeed(1.0),nextReplayEvent(0)
+	{
+	}
+
+NetworkViewerServer::Session::~Session(void)
+	{
+	/* Finish the recording, close the replayed recording, shut down the simulator, and delete the network: */
+	delete recorder;
+	delete player;
+	delete simulator;
+	delete network;
+	}
+
 /************************************
 Methods of class NetworkViewerServer:
 ************************************/
@@ -71,20 +105,25 @@ class ReadNetworkJob:public Threads::WorkerPool::JobFunction // Class to read an
 	{
 	/* Elements: */
 	public:
+	void* session; // Opaque pointer to the session into which the network is being read
+	NetworkViewerProtocol::Version networkVersion; // Version number the session assigned to the network being read
 	std::string networkName; // The name of the network being read
 	MetadosisProtocol::InStreamPtr networkFile; // The file from which to parse the network
+	Misc::UInt8 networkFileEncoding; // Encoding of the network file
+	Realtime::TimePointMonotonic startTime; // Time at which the network file started arriving
 	Network* network; // Pointer to the network object parsed from the network file
-	const SimulationParameters& simulationParameters; // Reference to the current simulation parameters
+	SimulationParameters simulationParameters; // Simulation parameters at the time the job was created
 	Misc::Autopointer<NetworkSimulator::SimulationUpdateCallback> simulationUpdateCallback; // Callback that will be called when the network simulator has a new state update
-	unsigned int numWorkerThreads; // Number of additional worker threads to be used by the network simulator
+	SimulationScheduler& scheduler; // Scheduler on which to run the network simulator
 	NetworkSimulator* simulator; // Pointer to a simulator for the parsed network
 	
 	/* Constructors and destructors: */
 	public:
-	ReadNetworkJob(const std::string& sNetworkName,MetadosisProtocol::InStream& sNetworkFile,const SimulationParameters& sSimulationParameters,NetworkSimulator::SimulationUpdateCallback& sSimulationUpdateCallback,unsigned int sNumWorkerThreads) // Creates a job to load a network of the given name from the given Metadosis stream
-		:networkName(sNetworkName),networkFile(&sNetworkFile),
+	ReadNetworkJob(void* sSession,NetworkViewerProtocol::Version sNetworkVersion,const std::string& sNetworkName,MetadosisProtocol::InStream& sNetworkFile,Misc::UInt8 sNetworkFileEncoding,const SimulationParameters& sSimulationParameters,NetworkSimulator::SimulationUpdateCallback& sSimulationUpdateCallback,SimulationScheduler& sScheduler) // Creates a job to load a network of the given name from the given Metadosis stream in the given encoding
+		:session(sSession),networkVersion(sNetworkVersion),
+		 networkName(sNetworkName),networkFile(&sNetworkFile),networkFileEncoding(sNetworkFileEncoding),
 		 network(0),
-		 simulationParameters(sSimulationParameters),simulationUpdateCallback(&sSimulationUpdateCallback),numWorkerThreads(sNumWorkerThreads),
+		 simulationParameters(sSimulationParameters),simulationUpdateCallback(&sSimulationUpdateCallback),scheduler(sScheduler),
 		 simulator(0)
 		{
 		}
@@ -105,11 +144,15 @@ class ReadNetworkJob:public Threads::WorkerPool::JobFunction // Class to read an
 		{
 		try
 			{
-			/* Parse the network file into a network object: */
-			network=new Network(*networkFile);
+			/* Parse the network file into a network object, decompressing it on the fly if necessary: */
+			InflateFilterPtr decoder(new InflateFilter(*networkFile,networkFileEncoding==NetworkViewerProtocol::DeflatedNetworkFile));
+			network=new Network(*decoder);
+			
+			/* Report the network file's transfer size and time: */
+			Misc::formattedLogNote("NetworkViewer: Received network %s as %.1f MB %s (%.1f MB json) in %.3f s",networkName.c_str(),double(decoder->getNumSourceBytes())/(1024.0*1024.0),decoder->isDeflated()?"deflated":"raw",double(decoder->getNumInflatedBytes())/(1024.0*1024.0),double(Realtime::TimePointMonotonic()-startTime));
 			
 			/* Create a network simulator: */
-			simulator=new NetworkSimulator(*network,simulationParameters,*simulationUpdateCallback,numWorkerThreads);
+			simulator=new NetworkSimulator(*network,simulationParameters,*simulationUpdateCallback,scheduler);
 			}
 		catch(const std::runtime_error& err)
 			{
@@ -121,57 +164,228 @@ class ReadNetworkJob:public Threads::WorkerPool::JobFunction // Class to read an
 
 }
 
+NetworkViewerServer::Session* NetworkViewerServer::findSession(const std::string& name)
+	{
+	/* Find an existing session of the given name: */
+	for(SessionList::iterator sIt=sessions.begin();sIt!=sessions.end();++sIt)
+		if((*sIt)->name==name)
+			return *sIt;
+	
+	return 0;
+	}
+
+NetworkViewerServer::Session* NetworkViewerServer::getSession(const std::string& name)
+	{
+	/* Find an existing session of the given name: */
+	Session* session=findSession(name);
+	if(session!=0)
+		return session;
+	
+	/* Create a new session: */
+	Misc::formattedLogNote("NetworkViewer: Creating session %s",name.c_str());
+	Session* newSession=new Session(name);
+	sessions.push_back(newSession);
+	
+	return newSession;
+	}
+
+void NetworkViewerServer::broadcastToSession(NetworkViewerServer::Session* session,unsigned int exceptClientId,MessageBuffer* message)
+	{
+	/* Queue the message for all clients in the session except the excluded one: */
+	for(ClientIDList::iterator cIt=session->clients.begin();cIt!=session->clients.end();++cIt)
+		if(*cIt!=exceptClientId)
+			server->getClient(*cIt)->queueMessage(message);
+	}
+
+void NetworkViewerServer::joinSession(unsigned int clientId,NetworkViewerServer::Client* nvClient,NetworkViewerServer::Session* session)
+	{
+	/* Unpause the session's simulator if there is one, it is not suspended for a replay, and this is the first client to join: */
+	if(session->simulator!=0&&session->player==0&&session->clients.empty())
+		{
+		Misc::formattedLogNote("NetworkViewer: Unpausing simulation of session \"%s\"",session->name.c_str());
+		session->simulator->resume();
+		}
+	
+	/* Add the client to the session: */
+	session->clients.push_back(clientId);
+	nvClient->session=session;
+	nvClient->networkVersion=0;
+	nvClient->lastAckedSequence=0;
+	if(nvClient->datagramUpdates)
+		++session->numDatagramClients;
+	
+	/* Send the session's current simulation and rendering parameters to the client: */
+	Server::Client* client=server->getClient(clientId);
+	{
+	MessageWriter setSimulationParametersNotification(SetSimulationParametersMsg::createMessage(serverMessageBase+SetSimulationParametersNotification));
+	session->simulationParameters.write(setSimulationParametersNotification);
+	client->queueMessage(setSimulationParametersNotification.getBuffer());
+	}
+	{
+	MessageWriter setRenderingParametersNotification(SetRenderingParametersMsg::createMessage(serverMessageBase+SetRenderingParametersNotification));
+	session->renderingParameters.write(setRenderingParametersNotification);
+	client->queueMessage(setRenderingParametersNotification.getBuffer());
+	}
+	
+	/* Check if the session has a network file: */
+	if(session->networkFile!=0)
+		{
+		/* Forward the network file to the client: */
+		MessageWriter loadNetworkNotification(LoadNetworkMsg::createMessage(serverMessageBase+LoadNetworkNotification));
+		loadNetworkNotification.write(session->networkVersion);
+		stringToCharBuffer(session->networkName,loadNetworkNotification,LoadNetworkMsg::networkNameLen);
+		loadNetworkNotification.write(metadosis->forwardInStream(clientId,*session->networkFile,Threads::createFunctionCall(this,&NetworkViewerServer::forwardNetworkCompleteCallback,ForwardNetworkCompleteCallbackData(clientId,session,session->networkVersion))));
+		loadNetworkNotification.write(session->networkFileEncoding);
+		client->queueMessage(loadNetworkNotification.getBuffer());
+		}
+	}
+
+void NetworkViewerServer::leaveSession(unsigned int clientId,NetworkViewerServer::Client* nvClient)
+	{
+	Session* session=nvClient->session;
+	
+	/* Check if the session has a simulator: */
+	if(session->simulator!=0)
+		{
+		/* Remove the client's potentially remaining active drags: */
+		draggedPositions.clear();
+		for(Client::ActiveDragMap::Iterator adIt=nvClient->activeDrags.begin();!adIt.isFinished();++adIt)
+			{
+			session->simulator->dragStop(clientId,adIt->getSource());
+			sendDragDelta(session,clientId,clientId,adIt->getSource(),draggedPositions);
+			}
+		}
+	nvClient->activeDrags.clear();
+	
+	/* Stop splitting the session's simulation updates for the client: */
+	if(nvClient->datagramUpdates)
+		--session->numDatagramClients;
+	
+	/* Remove the client from the session: */
+	for(ClientIDList::iterator cIt=session->clients.begin();cIt!=session->clients.end();++cIt)
+		if(*cIt==clientId)
+			{
+			*cIt=session->clients.back();
+			session->clients.pop_back();
+			break;
+			}
+	nvClient->session=0;
+	
+	/* Check if this was the last client to leave: */
+	if(session->clients.empty())
+		{
+		if(session!=sessions.front())
+			{
+			/* Release the abandoned session's resources: */
+			releaseSession(session);
+			}
+		else if(session->simulator!=0)
+			{
+			/* Pause the default session's simulator: */
+			Misc::formattedLogNote("NetworkViewer: Pausing simulation of session \"%s\"",session->name.c_str());
+			session->simulator->pause();
+			}
+		}
+	}
+
+void NetworkViewerServer::releaseSession(NetworkViewerServer::Session* session)
+	{
+	Misc::formattedLogNote("NetworkViewer: Releasing network and simulator of session \"%s\"",session->name.c_str());
+	
+	/* Stop recording the session or replaying a recording: */
+	stopRecording(session);
+	stopReplay(session);
+	
+	/* Invalidate a network that might still be loading, and delete the session's simulator and network: */
+	do
+		{
+		++session->networkVersion;
+		}
+	while(session->networkVersion==0);
+	delete session->simulator;
+	session->simulator=0;
+	delete session->network;
+	session->network=0;
+	session->networkFile=0;
+	session->networkName.clear();
+	session->labeledNodes.clear();
+	}
+
 void NetworkViewerServer::readNetworkJobCompleteCallback(Threads::EventDispatcher::SignalEvent& event)
 	{
-	/* Access the job object: */
+	/* Access the job object and the session into which the network was read: */
 	ReadNetworkJob* job=static_cast<ReadNetworkJob*>(event.getSignalData());
+	Session* session=static_cast<Session*>(job->session);
 	
-	/* Complete the read network request: */
-	networkName=job->networkName;
-	networkFile=job->networkFile;
-	network=job->network;
-	job->network=0;
-	simulator=job->simulator;
-	job->simulator=0;
+	/* Complete the read network request unless another network was requested in the meantime: */
+	if(job->networkVersion==session->networkVersion)
+		{
+		session->networkName=job->networkName;
+		session->networkFile=job->networkFile;
+		session->networkFileEncoding=job->networkFileEncoding;
+		session->network=job->network;
+		job->network=0;
+		session->simulator=job->simulator;
+		job->simulator=0;
+		
+		/* Measure the new simulator's layout quality if requested: */
+		if(session->simulator!=0&&qualityInterval>0.0)
+			session->simulator->setQualityInterval(qualityInterval);
+		
+		/* Pause the new simulator if the session has no clients: */
+		if(session->simulator!=0&&session->clients.empty())
+			session->simulator->pause();
+		}
 	
 	/* Release the job object: */
 	job->unref();
 	}
 
+void NetworkViewerServer::sendNodeSets(NetworkViewerServer::Session* session,Server::Client* client)
+	{
+	/* Send the set of selected nodes to the client: */
+	{
+	const Network::Selection& selection=session->network->getSelection();
+	Misc::UInt32 numSelectedNodes(selection.getNumEntries());
+	MessageWriter selectionSetNotification(NodeSetMsg::createMessage(serverMessageBase+SelectionSetNotification,numSelectedNodes));
+	selectionSetNotification.write(session->networkVersion);
+	selectionSetNotification.write(numSelectedNodes);
+	for(Network::Selection::ConstIterator sIt=selection.begin();!sIt.isFinished();++sIt)
+		selectionSetNotification.write(NodeID(sIt->getSource()));
+	client->queueMessage(selectionSetNotification.getBuffer());
+	}
+	
+	/* Send the set of labeled nodes to the client: */
+	{
+	Misc::UInt32 numLabeledNodes(session->labeledNodes.getNumEntries());
+	MessageWriter labelSetNotification(NodeSetMsg::createMessage(serverMessageBase+LabelSetNotification,numLabeledNodes));
+	labelSetNotification.write(session->networkVersion);
+	labelSetNotification.write(numLabeledNodes);
+	for(NodeSet::Iterator lnIt=session->labeledNodes.begin();!lnIt.isFinished();++lnIt)
+		labelSetNotification.write(NodeID(lnIt->getSource()));
+	client->queueMessage(labelSetNotification.getBuffer());
+	}
+	}
+
 void NetworkViewerServer::forwardNetworkCompleteCallback(MetadosisProtocol::StreamID streamId,NetworkViewerServer::ForwardNetworkCompleteCallbackData cbData)
 	{
 	/* Access the base client state object and the network viewer client state object: */
 	Server::Client* client=server->getClient(cbData.clientId);
 	Client* nvClient=client->getPlugin<Client>(pluginIndex);
 	
+	/* Ignore the forwarded network file if the client left the session in the meantime: */
+	Session* session=cbData.session;
+	if(nvClient->session!=session)
+		return;
+	
 	/* Mark the affected client as having the current network file: */
 	nvClient->networkVersion=cbData.networkVersion;
 	
 	/* Check if the network is done loading; if not, there surely won't be any selected or labeled nodes: */
-	if(network!=0)
-		{
-		/* Send the set of selected nodes to the client: */
-		{
-		const Network::Selection& selection=network->getSelection();
-		Misc::UInt32 numSelectedNodes(selection.getNumEntries());
-		MessageWriter selectionSetNotification(NodeSetMsg::createMessage(serverMessageBase+SelectionSetNotification,numSelectedNodes));
-		selectionSetNotification.write(networkVersion);
-		selectionSetNotification.write(numSelectedNodes);
-		for(Network::Selection::ConstIterator sIt=selection.begin();!sIt.isFinished();++sIt)
-			selectionSetNotification.write(NodeID(sIt->getSource()));
-		client->queueMessage(selectionSetNotification.getBuffer());
-		}
-		
-		/* Send the set of labeled nodes to the client: */
+	if(session->network!=0)
 		{
-		Misc::UInt32 numLabeledNodes(labeledNodes.getNumEntries());
-		MessageWriter labelSetNotification(NodeSetMsg::createMessage(serverMessageBase+LabelSetNotification,numLabeledNodes));
-		labelSetNotification.write(networkVersion);
-		labelSetNotification.write(numLabeledNodes);
-		for(NodeSet::Iterator lnIt=labeledNodes.begin();!lnIt.isFinished();++lnIt)
-			labelSetNotification.write(NodeID(lnIt->getSource()));
-		client->queueMessage(labelSetNotification.getBuffer());
-		}
+		/* Send the sets of selected and labeled nodes to the client: */
+		sendNodeSets(session,client);
 		}
 	}
 
@@ -181,43 +395,49 @@ MessageContinuation* NetworkViewerServer::loadNetworkRequestCallback(unsigned in
 	Server::Client* client=server->getClient(clientId);
 	NonBlockSocket& socket=client->getSocket();
 	Client* nvClient=client->getPlugin<Client>(pluginIndex);
+	Session* session=nvClient->session;
 	
-	/* Read the new network version and name and the incoming network file stream ID: */
+	/* Read the new network version and name and the incoming network file stream ID and encoding: */
 	Version newNetworkVersion=socket.read<Version>();
 	std::string newNetworkName;
 	charBufferToString(socket,LoadNetworkMsg::networkNameLen,newNetworkName);
 	MetadosisProtocol::StreamID newStreamId=socket.read<MetadosisProtocol::StreamID>();
+	Misc::UInt8 newFileEncoding=socket.read<Misc::UInt8>();
 	
-	/* Check that the request's network version matches the current network version: */
-	if(newNetworkVersion==networkVersion)
+	/* Check that the request's network version matches the session's current network version and that the network file's encoding is supported: */
+	if(newNetworkVersion==session->networkVersion&&newFileEncoding<NumNetworkFileEncodings)
 		{
-		/* Cancel all clients' active drag operations: */
-		for(ClientIDList::iterator cIt=clients.begin();cIt!=clients.end();++cIt)
+		/* Cancel the active drag operations of all clients in the session: */
+		for(ClientIDList::iterator cIt=session->clients.begin();cIt!=session->clients.end();++cIt)
 			server->getPlugin<Client>(*cIt,pluginIndex)->activeDrags.clear();
 		
+		/* Stop recording the session or replaying a recording, as neither applies to the new network: */
+		stopRecording(session);
+		stopReplay(session);
+		
 		/* Start loading a new network: */
 		do
 			{
-			++networkVersion;
+			++session->networkVersion;
 			}
-		while(networkVersion==0);
-		delete simulator;
-		simulator=0;
-		delete network;
-		network=0;
-		networkFile=0;
-		networkName.clear();
+		while(session->networkVersion==0);
+		delete session->simulator;
+		session->simulator=0;
+		delete session->network;
+		session->network=0;
+		session->networkFile=0;
+		session->networkName.clear();
 		
 		/* Start a background job to read the incoming network file: */
 		MetadosisProtocol::InStreamPtr newNetworkFile=metadosis->acceptInStream(clientId,newStreamId);
-		ReadNetworkJob* job=new ReadNetworkJob(newNetworkName,*newNetworkFile,simulationParameters,*Threads::createFunctionCall(this,&NetworkViewerServer::simulationUpdateCallback),numWorkerThreads);
+		ReadNetworkJob* job=new ReadNetworkJob(session,session->networkVersion,newNetworkName,*newNetworkFile,newFileEncoding,session->simulationParameters,*Threads::createFunctionCall(this,&NetworkViewerServer::simulationUpdateCallback,session),scheduler);
 		Threads::WorkerPool::submitJob(*job,server->getDispatcher(),readNetworkJobCompleteSignalKey);
 		
 		/* Remember that the requesting client already has the new network file: */
-		nvClient->networkVersion=networkVersion;
+		nvClient->networkVersion=session->networkVersion;
 		
-		/* Forward the new network file to all other clients whose metadosis protocols are already initialized: */
-		for(ClientIDList::iterator cIt=clients.begin();cIt!=clients.end();++cIt)
+		/* Forward the new network file to all other clients in the session: */
+		for(ClientIDList::iterator cIt=session->clients.begin();cIt!=session->clients.end();++cIt)
 			if(*cIt!=clientId)
 				{
 				/* Access the other client's base client state object: */
@@ -226,9 +446,10 @@ MessageContinuation* NetworkViewerServer::loadNetworkRequestCallback(unsigned in
 				/* Send a load network notification with the new network file's stream ID to the other client: */
 				{
 				MessageWriter loadNetworkNotification(LoadNetworkMsg::createMessage(serverMessageBase+LoadNetworkNotification));
-				loadNetworkNotification.write(networkVersion);
+				loadNetworkNotification.write(session->networkVersion);
 				stringToCharBuffer(newNetworkName,loadNetworkNotification,LoadNetworkMsg::networkNameLen);
-				loadNetworkNotification.write(metadosis->forwardInStream(*cIt,*newNetworkFile,Threads::createFunctionCall(this,&NetworkViewerServer::forwardNetworkCompleteCallback,ForwardNetworkCompleteCallbackData(*cIt,networkVersion))));
+				loadNetworkNotification.write(metadosis->forwardInStream(*cIt,*newNetworkFile,Threads::createFunctionCall(this,&NetworkViewerServer::forwardNetworkCompleteCallback,ForwardNetworkCompleteCallbackData(*cIt,session,session->networkVersion))));
+				loadNetworkNotification.write(newFileEncoding);
 				otherClient->queueMessage(loadNetworkNotification.getBuffer());
 				}
 				}
@@ -247,22 +468,23 @@ MessageContinuation* NetworkViewerServer::loadNetworkRequestCallback(unsigned in
 
 MessageContinuation* NetworkViewerServer::setSimulationParametersRequestCallback(unsigned int messageId,unsigned int clientId,MessageContinuation* continuation)
 	{
-	/* Access the base client state object and its TCP socket: */
+	/* Access the base client state object, its TCP socket, and the network viewer client state object's session: */
 	Server::Client* client=server->getClient(clientId);
 	NonBlockSocket& socket=client->getSocket();
+	Session* session=client->getPlugin<Client>(pluginIndex)->session;
 	
 	/* Read the new simulation parameters: */
-	simulationParameters.read(socket);
+	session->simulationParameters.read(socket);
 	
-	/* Forward the new simulation parameters to the simulator: */
-	if(simulator!=0)
-		simulator->setSimulationParameters(simulationParameters);
+	/* Forward the new simulation parameters to the session's simulator: */
+	if(session->simulator!=0)
+		session->simulator->setSimulationParameters(session->simulationParameters);
 	
-	/* Send the new simulation parameters to all other connected clients: */
+	/* Send the new simulation parameters to all other clients in the session: */
 	{
 	MessageWriter setSimulationParametersNotification(SetSimulationParametersMsg::createMessage(serverMessageBase+SetSimulationParametersNotification));
-	simulationParameters.write(setSimulationParametersNotification);
-	broadcastMessage(clientId,setSimulationParametersNotification.getBuffer());
+	session->simulationParameters.write(setSimulationParametersNotification);
+	broadcastToSession(session,clientId,setSimulationParametersNotification.getBuffer());
 	}
 	
 	/* Done with the message: */
@@ -271,18 +493,19 @@ MessageContinuation* NetworkViewerServer::setSimulationParametersRequestCallback
 
 MessageContinuation* NetworkViewerServer::setRenderingParametersRequestCallback(unsigned int messageId,unsigned int clientId,MessageContinuation* continuation)
 	{
-	/* Access the base client state object and its TCP socket: */
+	/* Access the base client state object, its TCP socket, and the network viewer client state object's session: */
 	Server::Client* client=server->getClient(clientId);
 	NonBlockSocket& socket=client->getSocket();
+	Session* session=client->getPlugin<Client>(pluginIndex)->session;
 	
 	/* Read the new rendering parameters: */
-	renderingParameters.read(socket);
+	session->renderingParameters.read(socket);
 	
-	/* Send the new rendering parameters to all other connected clients: */
+	/* Send the new rendering parameters to all other clients in the session: */
 	{
 	MessageWriter setRenderingParametersNotification(SetRenderingParametersMsg::createMessage(serverMessageBase+SetRenderingParametersNotification));
-	renderingParameters.write(setRenderingParametersNotification);
-	broadcastMessage(clientId,setRenderingParametersNotification.getBuffer());
+	session->renderingParameters.write(setRenderingParametersNotification);
+	broadcastToSession(session,clientId,setRenderingParametersNotification.getBuffer());
 	}
 	
 	/* Done with the message: */
@@ -291,29 +514,34 @@ MessageContinuation* NetworkViewerServer::setRenderingParametersRequestCallback(
 
 MessageContinuation* NetworkViewerServer::selectNodeRequestCallback(unsigned int messageId,unsigned int clientId,MessageContinuation* continuation)
 	{
-	/* Access the base client state object and its TCP socket: */
+	/* Access the base client state object, its TCP socket, and the network viewer client state object's session: */
 	Server::Client* client=server->getClient(clientId);
 	NonBlockSocket& socket=client->getSocket();
+	Session* session=client->getPlugin<Client>(pluginIndex)->session;
 	
 	/* Read the message: */
 	Version version=socket.read<Version>();
 	NodeID nodeIndex=socket.read<NodeID>();
 	Misc::UInt8 mode=socket.read<Misc::UInt8>();
 	
-	/* Only process requests applying to the current valid network: */
-	if(version==networkVersion&&simulator!=0)
+	/* Only process requests applying to the session's current valid network: */
+	if(version==session->networkVersion&&session->simulator!=0&&session->player==0)
 		{
 		/* Forward the request to the simulator: */
-		simulator->selectNode(nodeIndex,mode);
+		session->simulator->selectNode(nodeIndex,mode);
 		
-		/* Notify all clients of the change, including the one that requested it: */
+		/* Notify all clients in the session of the change, including the one that requested it: */
 		{
 		MessageWriter selectNodeNotification(SelectNodeMsg::createMessage(serverMessageBase+SelectNodeNotification));
 		selectNodeNotification.write(version);
 		selectNodeNotification.write(nodeIndex);
 		selectNodeNotification.write(mode);
-		broadcastMessage(0,selectNodeNotification.getBuffer());
+		broadcastToSession(session,0,selectNodeNotification.getBuffer());
 		}
+		
+		/* Record the change: */
+		if(session->recorder!=0)
+			session->recorder->recordSelectNode(nodeIndex,mode);
 		}
 	
 	/* Done with the message: */
@@ -322,27 +550,32 @@ MessageContinuation* NetworkViewerServer::selectNodeRequestCallback(unsigned int
 
 MessageContinuation* NetworkViewerServer::changeSelectionRequestCallback(unsigned int messageId,unsigned int clientId,MessageContinuation* continuation)
 	{
-	/* Access the base client state object and its TCP socket: */
+	/* Access the base client state object, its TCP socket, and the network viewer client state object's session: */
 	Server::Client* client=server->getClient(clientId);
 	NonBlockSocket& socket=client->getSocket();
+	Session* session=client->getPlugin<Client>(pluginIndex)->session;
 	
 	/* Read the message: */
 	Version version=socket.read<Version>();
 	Misc::UInt8 command=socket.read<Misc::UInt8>();
 	
-	/* Only process requests applying to the current valid network: */
-	if(version==networkVersion&&simulator!=0)
+	/* Only process requests applying to the session's current valid network: */
+	if(version==session->networkVersion&&session->simulator!=0&&session->player==0)
 		{
 		/* Forward the request to the simulator: */
-		simulator->changeSelection(command);
+		session->simulator->changeSelection(command);
 		
-		/* Notify all clients of the change, including the one that requested it: */
+		/* Notify all clients in the session of the change, including the one that requested it: */
 		{
 		MessageWriter changeSelectionNotification(ChangeSelectionMsg::createMessage(serverMessageBase+ChangeSelectionNotification));
 		changeSelectionNotification.write(version);
 		changeSelectionNotification.write(command);
-		broadcastMessage(0,changeSelectionNotification.getBuffer());
+		broadcastToSession(session,0,changeSelectionNotification.getBuffer());
 		}
+		
+		/* Record the change: */
+		if(session->recorder!=0)
+			session->recorder->recordChangeSelection(command);
 		}
 	
 	/* Done with the message: */
@@ -351,42 +584,47 @@ MessageContinuation* NetworkViewerServer::changeSelectionRequestCallback(unsigne
 
 MessageContinuation* NetworkViewerServer::displayLabelRequestCallback(unsigned int messageId,unsigned int clientId,MessageContinuation* continuation)
 	{
-	/* Access the base client state object and its TCP socket: */
+	/* Access the base client state object, its TCP socket, and the network viewer client state object's session: */
 	Server::Client* client=server->getClient(clientId);
 	NonBlockSocket& socket=client->getSocket();
+	Session* session=client->getPlugin<Client>(pluginIndex)->session;
 	
 	/* Read the message: */
 	Version version=socket.read<Version>();
 	NodeID nodeId=socket.read<NodeID>();
 	Misc::UInt8 command=socket.read<Misc::UInt8>();
 	
-	/* Only process requests applying to the current valid network: */
-	if(version==networkVersion&&simulator!=0)
+	/* Only process requests applying to the session's current valid network: */
+	if(version==session->networkVersion&&session->simulator!=0&&session->player==0)
 		{
 		/* Execute the request: */
 		switch(command)
 			{
 			case 0: // Clear label set
-				labeledNodes.clear();
+				session->labeledNodes.clear();
 				break;
 			
 			case 1: // Show node label
-				labeledNodes.setEntry(NodeSet::Entry(nodeId));
+				session->labeledNodes.setEntry(NodeSet::Entry(nodeId));
 				break;
 			
 			case 2: // Hide node label
-				labeledNodes.removeEntry(nodeId);
+				session->labeledNodes.removeEntry(nodeId);
 				break;
 			}
 		
-		/* Notify all other clients of the change: */
+		/* Notify all other clients in the session of the change: */
 		{
 		MessageWriter displayLabelNotification(DisplayLabelMsg::createMessage(serverMessageBase+DisplayLabelNotification));
 		displayLabelNotification.write(version);
 		displayLabelNotification.write(nodeId);
 		displayLabelNotification.write(command);
-		broadcastMessage(clientId,displayLabelNotification.getBuffer());
+		broadcastToSession(session,clientId,displayLabelNotification.getBuffer());
 		}
+		
+		/* Record the change: */
+		if(session->recorder!=0)
+			session->recorder->recordDisplayLabel(nodeId,command);
 		}
 	
 	/* Done with the message: */
@@ -399,6 +637,7 @@ MessageContinuation* NetworkViewerServer::dragStartRequestCallback(unsigned int
 	Server::Client* client=server->getClient(clientId);
 	NonBlockSocket& socket=client->getSocket();
 	Client* nvClient=client->getPlugin<Client>(pluginIndex);
+	Session* session=nvClient->session;
 	VruiCoreServer::Client* vcClient=vruiCore->getClient(clientId);
 	
 	/* Read the message: */
@@ -407,8 +646,8 @@ MessageContinuation* NetworkViewerServer::dragStartRequestCallback(unsigned int
 	VruiCoreProtocol::InputDeviceID inputDeviceId=socket.read<VruiCoreProtocol::InputDeviceID>();
 	NodeID nodeIndex=socket.read<NodeID>();
 	
-	/* Only process requests applying to the current valid network: */
-	if(version==networkVersion&&simulator!=0)
+	/* Only process requests applying to the session's current valid network: */
+	if(version==session->networkVersion&&session->simulator!=0&&session->player==0)
 		{
 		/* Access the input device's Vrui Core state: */
 		const VruiCoreProtocol::ClientInputDeviceState& deviceState=vcClient->getDevice(inputDeviceId);
@@ -423,7 +662,7 @@ MessageContinuation* NetworkViewerServer::dragStartRequestCallback(unsigned int
 		NetworkSimulator::DragTransform initialTransform(clientNav.getTranslation(),clientNav.getRotation());
 		
 		/* Forward the request to the simulator: */
-		simulator->dragStart(clientId,dragId,nodeIndex,initialTransform);
+		session->simulator->dragStart(clientId,dragId,nodeIndex,initialTransform);
 		}
 	
 	/* Done with the message: */
@@ -436,191 +675,1375 @@ MessageContinuation* NetworkViewerServer::dragRequestCallback(unsigned int messa
 	Server::Client* client=server->getClient(clientId);
 	NonBlockSocket& socket=client->getSocket();
 	Client* nvClient=client->getPlugin<Client>(pluginIndex);
+	Session* session=nvClient->session;
 	VruiCoreServer::Client* vcClient=vruiCore->getClient(clientId);
 	
 	/* Read the message: */
 	Version version=socket.read<Version>();
 	DragID dragId=socket.read<DragID>();
+	Misc::UInt32 traceId=socket.read<Misc::UInt32>();
 	
-	/* Only process requests applying to the current valid network: */
-	if(version==networkVersion&&simulator!=0)
+	/* Only process requests applying to the session's current valid network and an active drag operation attached to an input device: */
+	Client::ActiveDragMap::Iterator adIt=nvClient->activeDrags.findEntry(dragId);
+	if(version==session->networkVersion&&session->simulator!=0&&session->player==0&&!adIt.isFinished()&&adIt->getDest().deviceState!=0)
 		{
-		/* Access the requesting client's active drag state: */
-		Client::ActiveDrag& ad=nvClient->activeDrags.getEntry(dragId).getDest();
-		
 		/* Calculate the drag transformation in navigational space: */
 		VruiCoreProtocol::NavTransform clientNav=vcClient->getNavTransform();
 		clientNav.doInvert();
-		clientNav*=ad.deviceState->transform;
+		clientNav*=adIt->getDest().deviceState->transform;
 		NetworkSimulator::DragTransform dragTransform(clientNav.getTranslation(),clientNav.getRotation());
 		
 		/* Forward the request to the simulator: */
-		simulator->drag(clientId,dragId,dragTransform);
+		session->simulator->drag(clientId,dragId,dragTransform,traceId);
+		
+		/* Send the dragged nodes' new positions to all clients in the session ahead of the next simulation update: */
+		if(session->simulator->getDraggedPositions(clientId,dragId,dragTransform,draggedPositions))
+			sendDragDelta(session,0,clientId,dragId,draggedPositions);
 		}
 
 	/* Done with the message: */
 	return 0;
 	}
 
-MessageContinuation* NetworkViewerServer::dragStopRequestCallback(unsigned int messageId,unsigned int clientId,MessageContinuation* continuation)
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+NetworkSimulator::DragTransform readNavDragTransform(NonBlockSocket& socket) // Reads a drag transformation in navigational space from a navigational-space drag request
+	{
+	typedef NetworkSimulator::DragTransform DT;
+	
+	/* Read the translation vector and rotation quaternion: */
+	DT::Vector translation;
+	for(int i=0;i<3;++i)
+		translation[i]=DT::Scalar(socket.read<NetworkViewerProtocol::NVScalar>());
+	DT::Scalar quaternion[4];
+	for(int i=0;i<4;++i)
+		quaternion[i]=DT::Scalar(socket.read<NetworkViewerProtocol::NVScalar>());
+	
+	return DT(translation,DT::Rotation::fromQuaternion(quaternion));
+	}
+
+}
+
+MessageContinuation* NetworkViewerServer::navDragStartRequestCallback(unsigned int messageId,unsigned int clientId,MessageContinuation* continuation)
 	{
 	/* Access the base client state object, its TCP socket, and the network viewer client state object: */
 	Server::Client* client=server->getClient(clientId);
 	NonBlockSocket& socket=client->getSocket();
 	Client* nvClient=client->getPlugin<Client>(pluginIndex);
+	Session* session=nvClient->session;
 	
 	/* Read the message: */
 	Version version=socket.read<Version>();
 	DragID dragId=socket.read<DragID>();
+	NodeID nodeIndex=socket.read<NodeID>();
+	NetworkSimulator::DragTransform initialTransform=readNavDragTransform(socket);
 	
-	/* Only process requests applying to the current valid network: */
-	if(version==networkVersion&&simulator!=0)
+	/* Only process requests applying to the session's current valid network: */
+	if(version==session->networkVersion&&session->simulator!=0&&session->player==0)
 		{
-		/* Remove the active drag state from the requesting client: */
-		nvClient->activeDrags.removeEntry(dragId);
+		/* Create a new active drag state without an associated input device for the requesting client: */
+		nvClient->activeDrags.setEntry(Client::ActiveDragMap::Entry(dragId,Client::ActiveDrag(0,0)));
 		
 		/* Forward the request to the simulator: */
-		simulator->dragStop(clientId,dragId);
+		session->simulator->dragStart(clientId,dragId,nodeIndex,initialTransform);
 		}
 	
 	/* Done with the message: */
 	return 0;
 	}
 
-void NetworkViewerServer::simulationUpdateCallback(const ParticleSystem& particles)
+MessageContinuation* NetworkViewerServer::navDragRequestCallback(unsigned int messageId,unsigned int clientId,MessageContinuation* continuation)
 	{
-	/* Create a simulation update message: */
-	Index numParticles=particles.getNumParticles();
-	MessageWriter simulationUpdate(SimulationUpdateMsg::createMessage(serverMessageBase,numParticles));
-	simulationUpdate.write(networkVersion);
-	simulationUpdate.write(Misc::UInt32(numParticles));
-	for(Index i=0;i<numParticles;++i)
+	/* Access the base client state object, its TCP socket, and the network viewer client state object: */
+	Server::Client* client=server->getClient(clientId);
+	NonBlockSocket& socket=client->getSocket();
+	Client* nvClient=client->getPlugin<Client>(pluginIndex);
+	Session* session=nvClient->session;
+	
+	/* Read the message: */
+	Version version=socket.read<Version>();
+	DragID dragId=socket.read<DragID>();
+	Misc::UInt32 traceId=socket.read<Misc::UInt32>();
+	NetworkSimulator::DragTransform dragTransform=readNavDragTransform(socket);
+	
+	/* Only process requests applying to the session's current valid network and an active drag operation without an input device: */
+	Client::ActiveDragMap::Iterator adIt=nvClient->activeDrags.findEntry(dragId);
+	if(version==session->networkVersion&&session->simulator!=0&&session->player==0&&!adIt.isFinished()&&adIt->getDest().deviceState==0)
+		{
+		/* Forward the request to the simulator: */
+		session->simulator->drag(clientId,dragId,dragTransform,traceId);
+		
+		/* Send the dragged nodes' new positions to all clients in the session ahead of the next simulation update: */
+		if(session->simulator->getDraggedPositions(clientId,dragId,dragTransform,draggedPositions))
+			sendDragDelta(session,0,clientId,dragId,draggedPositions);
+		}
+	
+	/* Done with the message: */
+	return 0;
+	}
+
+void NetworkViewerServer::sendDragDelta(NetworkViewerServer::Session* session,unsigned int exceptClientId,unsigned int clientId,unsigned int dragId,const NetworkSimulator::DraggedPositionList& positions)
+	{
+	/* Create a drag delta notification message: */
+	MessageWriter dragDeltaNotification(DragDeltaNotificationMsg::createMessage(serverMessageBase,positions.size()));
+	dragDeltaNotification.write(session->networkVersion);
+	dragDeltaNotification.write(DragDeltaNotificationMsg::getDragKey(clientId,dragId));
+	dragDeltaNotification.write(Misc::UInt32(positions.size()));
+	for(NetworkSimulator::DraggedPositionList::const_iterator pIt=positions.begin();pIt!=positions.end();++pIt)
 		{
-		const Point& pos=particles.getParticlePosition(i);
+		dragDeltaNotification.write(NodeID(pIt->index));
 		for(int i=0;i<3;++i)
-			simulationUpdate.write(NVScalar(pos[i]));
+			dragDeltaNotification.write(NVScalar(pIt->position[i]));
 		}
 	
-	/* Hand the update message to the main thread to broadcast it to all clients: */
-	server->getDispatcher().signal(simulationUpdateSignalKey,simulationUpdate.getBuffer()->ref());
+	/* Send the message to all clients in the session: */
+	broadcastToSession(session,exceptClientId,dragDeltaNotification.getBuffer());
 	}
 
-void NetworkViewerServer::sendSimulationUpdateCallback(Threads::EventDispatcher::SignalEvent& event)
+MessageContinuation* NetworkViewerServer::dragStopRequestCallback(unsigned int messageId,unsigned int clientId,MessageContinuation* continuation)
 	{
-	/* Retrieve the simulation update message: */
-	MessageBuffer* message=static_cast<MessageBuffer*>(event.getSignalData());
+	/* Access the base client state object, its TCP socket, and the network viewer client state object: */
+	Server::Client* client=server->getClient(clientId);
+	NonBlockSocket& socket=client->getSocket();
+	Client* nvClient=client->getPlugin<Client>(pluginIndex);
+	Session* session=nvClient->session;
 	
-	/* Broadcast the message to all connected clients that have received the current network file: */
-	for(ClientIDList::iterator cIt=clients.begin();cIt!=clients.end();++cIt)
+	/* Read the message: */
+	Version version=socket.read<Version>();
+	DragID dragId=socket.read<DragID>();
+	
+	/* Only process requests applying to the session's current valid network: */
+	if(version==session->networkVersion&&session->simulator!=0&&session->player==0)
 		{
-		/* Access the client's base client state object and its network viewer state object, and check whether it has received the current network file: */
-		Server::Client* client=server->getClient(*cIt);
-		if(client->getPlugin<Client>(pluginIndex)->networkVersion==networkVersion)
-			client->queueMessage(message);
+		/* Remove the active drag state from the requesting client: */
+		nvClient->activeDrags.removeEntry(dragId);
+		
+		/* Forward the request to the simulator: */
+		session->simulator->dragStop(clientId,dragId);
+		
+		/* Tell all clients in the session to let the next simulation update reconcile the dragged nodes' positions: */
+		draggedPositions.clear();
+		sendDragDelta(session,0,clientId,dragId,draggedPositions);
 		}
 	
-	/* Release the message buffer: */
-	message->unref();
+	/* Done with the message: */
+	return 0;
 	}
 
-void NetworkViewerServer::loadNetworkCommandCallback(const char* argumentBegin,const char* argumentEnd)
+MessageContinuation* NetworkViewerServer::selectRegionRequestCallback(unsigned int messageId,unsigned int clientId,MessageContinuation* continuation)
 	{
-	#if 0
-	/* Check that there is no pending network request: */
-	if(uploadingNetworkClientId==0)
+	/* Access the base client state object, its TCP socket, and the network viewer client state object's session: */
+	Server::Client* client=server->getClient(clientId);
+	NonBlockSocket& socket=client->getSocket();
+	Session* session=client->getPlugin<Client>(pluginIndex)->session;
+	
+	/* Read the message: */
+	Version version=socket.read<Version>();
+	Misc::UInt8 mode=socket.read<Misc::UInt8>();
+	SelectionRegion region;
+	region.read(socket);
+	charBufferToString(socket,SelectRegionRequestMsg::stringLen,region.propertyName);
+	charBufferToString(socket,SelectRegionRequestMsg::stringLen,region.propertyValue);
+	
+	/* Only process requests applying to the session's current valid network: */
+	if(version==session->networkVersion&&session->simulator!=0&&session->player==0)
 		{
-		/* Get the network's name and full path: */
-		const char* networkNameBegin;
-		for(networkNameBegin=argumentEnd;networkNameBegin!=argumentBegin&&networkName[-1]!='/';--networkNameBegin)
-			;
-		std::string newNetworkName(networkNameBegin,argumentEnd);
-		std::string networkPath(argumentBegin,argumentEnd);
-		try
-			{
-			/* Open the requested network file: */
-			IO::FilePtr file=IO::openFile(networkPath.c_str());
-			
-			/* Cancel all clients' active drag operations: */
-			for(ClientIDList::iterator cIt=clients.begin();cIt!=clients.end();++cIt)
-				server->getPlugin<Client>(*cIt,pluginIndex)->activeDrags.clear();
-			
-			/* Start loading a new network: */
-			uploadingNetworkClientId=-1U;
-			do
-				{
-				++networkVersion;
-				}
-			while(networkVersion==0);
-			delete simulator;
-			simulator=0;
-			delete network;
-			network=0;
-			networkFile=0;
-			networkName.clear();
-			
-			/* Start a background job to read the incoming network file: */
-			ReadNetworkJob* job=new ReadNetworkJob(newNetworkName,*file,simulationParameters,*Threads::createFunctionCall(this,&NetworkViewerServer::simulationUpdateCallback),numWorkerThreads);
-			Threads::WorkerPool::submitJob(*job,server->getDispatcher(),readNetworkJobCompleteSignalKey);
-			
-			/* Forward the new network file to all clients whose metadosis protocols are already initialized: */
-			for(ClientIDList::iterator cIt=clients.begin();cIt!=clients.end();++cIt)
-				{
-				/* Access the other client's base client state object and its network viewer state object, and check whether its metadosis protocol is initialized: */
-				Server::Client* client=server->getClient(*cIt);
-				Client* nvClient=client->getPlugin<Client>(pluginIndex);
-				if(nvClient->hasMetadosis)
-					{
-					/* Send a load network notification with the new network file's stream ID to the client: */
-					MessageWriter loadNetworkNotification(LoadNetworkMsg::createMessage(serverMessageBase+LoadNetworkNotification));
-					loadNetworkNotification.write(networkVersion);
-					stringToCharBuffer(networkName,loadNetworkNotification,LoadNetworkMsg::networkNameLen);
-					loadNetworkNotification.write(metadosis->forwardInStream(*cIt,*networkFile,Threads::createFunctionCall(this,&NetworkViewerServer::forwardNetworkCompleteCallback,ForwardNetworkCompleteCallbackData(*cIt,networkVersion))));
-					client->queueMessage(loadNetworkNotification.getBuffer());
-					}
-				}
-			}
-		catch(const std::runtime_error& err)
-			{
-			/* Print an error message: */
-			Misc::formattedUserError("NetworkViewerServer: Cannot load network %s due to exception %s",networkPath.c_str(),err.what());
-			}
+		/* Forward the request to the simulator, which will resolve the region against the current node positions and notify all clients in the session: */
+		session->simulator->selectRegion(region,mode,Threads::createFunctionCall(this,&NetworkViewerServer::selectRegionCompleteCallback,SelectRegionCallbackData(session,version,mode)));
 		}
-	else
+	
+	/* Done with the message: */
+	return 0;
+	}
+
+void NetworkViewerServer::selectRegionCompleteCallback(const std::vector<Index>& nodeIndices,NetworkViewerServer::SelectRegionCallbackData cbData)
+	{
+	/* Create a select region notification message containing the resolved node set in its most compact encoding: */
+	size_t payloadSize;
+	Misc::UInt8 encoding=chooseNodeSetEncoding(nodeIndices,payloadSize);
+	MessageWriter selectRegionNotification(SelectRegionNotificationMsg::createMessage(serverMessageBase,payloadSize));
+	selectRegionNotification.write(cbData.networkVersion);
+	selectRegionNotification.write(cbData.mode);
+	selectRegionNotification.write(encoding);
+	selectRegionNotification.write(Misc::UInt32(payloadSize));
+	writeNodeSet(nodeIndices,encoding,selectRegionNotification);
+	
+	/* Hand the notification message to the main thread to broadcast it to all clients in the session, with the resolved node set if the session is being recorded: */
+	SessionMessage* sm=new SessionMessage(cbData.session,selectRegionNotification.getBuffer()->ref());
+	if(cbData.session->recording)
 		{
-		/* Print an error message: */
-		Misc::userError("NetworkViewerServer: Cannot load network because there is already a pending load network request");
+		sm->record=true;
+		sm->nodes=nodeIndices;
+		sm->mode=cbData.mode;
 		}
-	#endif
+	server->getDispatcher().signal(selectRegionSignalKey,sm);
 	}
 
-NetworkViewerServer::NetworkViewerServer(Server* sServer)
-	:PluginServer(sServer),
-	 metadosis(MetadosisServer::requestServer(server)),
-	 vruiCore(VruiCoreServer::requestServer(server)),
-	 networkVersion(0),network(0),labeledNodes(17),
-	 numWorkerThreads(3),simulator(0)
+void NetworkViewerServer::sendSelectRegionNotificationCallback(Threads::EventDispatcher::SignalEvent& event)
 	{
-	/* Register dependencies with the service protocol plug-ins: */
-	metadosis->addDependentPlugin(this);
-	vruiCore->addDependentPlugin(this);
+	/* Retrieve the select region notification message: */
+	SessionMessage* sm=static_cast<SessionMessage*>(event.getSignalData());
 	
-	/* Register signals with the server's event dispatcher: */
-	readNetworkJobCompleteSignalKey=server->getDispatcher().addSignalListener(Threads::EventDispatcher::wrapMethod<NetworkViewerServer,&NetworkViewerServer::readNetworkJobCompleteCallback>,this);
-	simulationUpdateSignalKey=server->getDispatcher().addSignalListener(Threads::EventDispatcher::wrapMethod<NetworkViewerServer,&NetworkViewerServer::sendSimulationUpdateCallback>,this);
+	/* Notify all clients in the session of the change, including the one that requested it: */
+	broadcastToSession(sm->session,0,sm->message);
 	
-	/* Register pipe commands: */
-	server->getCommandDispatcher().addCommandCallback("NetworkViewer::loadNetwork",Misc::CommandDispatcher::wrapMethod<NetworkViewerServer,&NetworkViewerServer::loadNetworkCommandCallback>,this,"<network file name>","Loads the network file of the given name");
+	/* Record the change: */
+	if(sm->record&&sm->session->recorder!=0)
+		sm->session->recorder->recordSelectNodes(sm->nodes,sm->mode);
+	
+	/* Release the message: */
+	delete sm;
 	}
 
-NetworkViewerServer::~NetworkViewerServer(void)
+MessageContinuation* NetworkViewerServer::datagramUpdatesRequestCallback(unsigned int messageId,unsigned int clientId,MessageContinuation* continuation)
 	{
-	/* Shut down the simulator and delete the network: */
-	delete simulator;
-	delete network;
+	/* Access the base client state object, its TCP socket, and the network viewer client state object: */
+	Server::Client* client=server->getClient(clientId);
+	NonBlockSocket& socket=client->getSocket();
+	Client* nvClient=client->getPlugin<Client>(pluginIndex);
 	
-	/* Remove event dispatcher signals: */
-	server->getDispatcher().removeSignalListener(readNetworkJobCompleteSignalKey);
+	/* Read the message: */
+	bool enable=socket.read<Misc::UInt8>()!=0;
+	
+	/* Change the client's update delivery mode: */
+	if(nvClient->datagramUpdates!=enable)
+		{
+		nvClient->datagramUpdates=enable;
+		nvClient->lastAckedSequence=0;
+		if(enable)
+			++nvClient->session->numDatagramClients;
+		else
+			--nvClient->session->numDatagramClients;
+		}
+	
+	/* Confirm the client's update delivery mode: */
+	{
+	MessageWriter datagramUpdatesNotification(DatagramUpdatesMsg::createMessage(serverMessageBase+DatagramUpdatesNotification));
+	datagramUpdatesNotification.write(Misc::UInt8(enable?1:0));
+	client->queueMessage(datagramUpdatesNotification.getBuffer());
+	}
+	
+	/* Done with the message: */
+	return 0;
+	}
+
+MessageContinuation* NetworkViewerServer::datagramUpdateAckCallback(unsigned int messageId,unsigned int clientId,MessageContinuation* continuation)
+	{
+	/* Access the base client state object, its TCP socket, and the network viewer client state object: */
+	Server::Client* client=server->getClient(clientId);
+	NonBlockSocket& socket=client->getSocket();
+	Client* nvClient=client->getPlugin<Client>(pluginIndex);
+	
+	/* Read the message: */
+	Misc::UInt32 sequenceNumber=socket.read<Misc::UInt32>();
+	
+	/* Remember the acknowledged sequence number if it is newer than the previous one: */
+	if(nvClient->lastAckedSequence==0||Misc::SInt32(sequenceNumber-nvClient->lastAckedSequence)>0)
+		nvClient->lastAckedSequence=sequenceNumber;
+	
+	/* Done with the message: */
+	return 0;
+	}
+
+MessageContinuation* NetworkViewerServer::joinSessionRequestCallback(unsigned int messageId,unsigned int clientId,MessageContinuation* continuation)
+	{
+	/* Access the base client state object, its TCP socket, and the network viewer client state object: */
+	Server::Client* client=server->getClient(clientId);
+	NonBlockSocket& socket=client->getSocket();
+	Client* nvClient=client->getPlugin<Client>(pluginIndex);
+	
+	/* Read the message: */
+	std::string sessionName;
+	charBufferToString(socket,JoinSessionRequestMsg::sessionNameLen,sessionName);
+	
+	/* Move the client to the requested session unless it is already participating in it: */
+	Session* session=getSession(sessionName);
+	if(nvClient->session!=session)
+		{
+		Misc::formattedLogNote("NetworkViewer: Client %u joining session \"%s\"",clientId,sessionName.c_str());
+		leaveSession(clientId,nvClient);
+		joinSession(clientId,nvClient,session);
+		}
+	
+	/* Done with the message: */
+	return 0;
+	}
+
+template <class PointParam>
+inline
+NetworkViewerServer::SimulationUpdate*
+NetworkViewerServer::createSimulationUpdate(
+	NetworkViewerServer::Session* session,
+	Index numParticles,
+	const PointParam* positions)
+	{
+	/* Assign the next non-zero sequence number to the simulation update: */
+	do
+		{
+		++session->updateSequence;
+		}
+	while(session->updateSequence==0);
+	
+	/* Create a simulation update message: */
+	MessageWriter simulationUpdate(SimulationUpdateMsg::createMessage(serverMessageBase,numParticles));
+	simulationUpdate.write(session->networkVersion);
+	simulationUpdate.write(Misc::UInt32(numParticles));
+	for(Index i=0;i<numParticles;++i)
+		{
+		const PointParam& pos=positions[i];
+		for(int i=0;i<3;++i)
+			simulationUpdate.write(NVScalar(pos[i]));
+		}
+	
+	/* Wrap the message into a simulation update structure: */
+	SimulationUpdate* update=new SimulationUpdate(session,session->updateSequence,simulationUpdate.getBuffer()->ref(),SimulationUpdateMsg::size+numParticles*pointSize);
+	
+	/* Check if any clients in the session receive simulation updates as datagrams: */
+	if(session->numDatagramClients!=0)
+		{
+		/* Split the simulation update into independently decodable chunks: */
+		for(Index firstParticle=0;firstParticle<numParticles;firstParticle+=SimulationUpdateChunkMsg::maxChunkParticles)
+			{
+			Index numChunkParticles=Misc::min(numParticles-firstParticle,Index(SimulationUpdateChunkMsg::maxChunkParticles));
+			MessageWriter simulationUpdateChunk(SimulationUpdateChunkMsg::createMessage(serverMessageBase,numChunkParticles));
+			simulationUpdateChunk.write(session->networkVersion);
+			simulationUpdateChunk.write(session->updateSequence);
+			simulationUpdateChunk.write(Misc::UInt32(numParticles));
+			simulationUpdateChunk.write(Misc::UInt32(firstParticle));
+			simulationUpdateChunk.write(Misc::UInt16(numChunkParticles));
+			for(Index i=firstParticle;i<firstParticle+numChunkParticles;++i)
+				{
+				const PointParam& pos=positions[i];
+				for(int j=0;j<3;++j)
+					simulationUpdateChunk.write(NVScalar(pos[j]));
+				}
+			update->chunks.push_back(simulationUpdateChunk.getBuffer()->ref());
+			update->chunksSize+=SimulationUpdateChunkMsg::size+numChunkParticles*pointSize;
+			}
+		}
+	
+	return update;
+	}
+
+void NetworkViewerServer::simulationUpdateCallback(const ParticleSystem& particles,NetworkViewerServer::Session* session)
+	{
+	Tracer::Span span("Encode simulation update");
+	
+	/* Create the simulation update messages: */
+	Index numParticles=particles.getNumParticles();
+	SimulationUpdate* update=createSimulationUpdate(session,numParticles,numParticles>0?&particles.getParticlePosition(0):static_cast<const Point*>(0));
+	
+	/* Copy the particle positions for the session's recorder: */
+	if(session->recording)
+		{
+		update->positions.reserve(numParticles);
+		for(Index i=0;i<numParticles;++i)
+			update->positions.push_back(SessionRecorder::RPoint(particles.getParticlePosition(i)));
+		}
+	
+	/* Hand the update messages to the main thread to send them to all clients in the session: */
+	server->getDispatcher().signal(simulationUpdateSignalKey,update);
+	}
+
+void NetworkViewerServer::sendSimulationUpdate(NetworkViewerServer::SimulationUpdate* update)
+	{
+	Session* session=update->session;
+	
+	/* Send the update to all clients in the session that have received the session's current network file: */
+	for(ClientIDList::iterator cIt=session->clients.begin();cIt!=session->clients.end();++cIt)
+		{
+		/* Access the client's base client state object and its network viewer state object, and check whether it has received the current network file: */
+		Server::Client* client=server->getClient(*cIt);
+		Client* nvClient=client->getPlugin<Client>(pluginIndex);
+		if(nvClient->networkVersion!=session->networkVersion)
+			continue;
+		
+		/* Check if the client receives updates as datagrams and the update was split into chunks: */
+		if(nvClient->datagramUpdates&&!update->chunks.empty())
+			{
+			/* Start counting from the first update sent as datagrams: */
+			if(nvClient->lastAckedSequence==0)
+				nvClient->lastAckedSequence=update->sequenceNumber;
+			
+			/* Check if the client has stopped acknowledging datagram updates: */
+			if(Misc::SInt32(update->sequenceNumber-nvClient->lastAckedSequence)>Misc::SInt32(maxUnackedUpdates))
+				{
+				/* Fall back to sending updates over TCP: */
+				Misc::formattedLogNote("NetworkViewer: Client %u stopped acknowledging datagram updates; falling back to TCP",*cIt);
+				nvClient->datagramUpdates=false;
+				--session->numDatagramClients;
+				
+				/* Notify the client of the change: */
+				MessageWriter datagramUpdatesNotification(DatagramUpdatesMsg::createMessage(serverMessageBase+DatagramUpdatesNotification));
+				datagramUpdatesNotification.write(Misc::UInt8(0));
+				client->queueMessage(datagramUpdatesNotification.getBuffer());
+				}
+			else
+				{
+				/* Send all chunks as datagrams: */
+				for(std::vector<MessageBuffer*>::iterator chIt=update->chunks.begin();chIt!=update->chunks.end();++chIt)
+					client->queueUDPMessage(*chIt);
+				nvClient->updateBytes+=update->chunksSize;
+				continue;
+				}
+			}
+		
+		/* Send the complete update over TCP: */
+		client->queueMessage(update->message);
+		nvClient->updateBytes+=update->messageSize;
+		}
+	
+	/* Report the server-side latency breakdown of all traced drag requests reflected in this update to their clients: */
+	NetworkSimulator::DragTraceList dragTraces;
+	if(session->simulator!=0)
+		session->simulator->takeDragTraces(dragTraces);
+	if(!dragTraces.empty())
+		{
+		Realtime::TimePointMonotonic sendTime;
+		for(NetworkSimulator::DragTraceList::iterator dtIt=dragTraces.begin();dtIt!=dragTraces.end();++dtIt)
+			{
+			/* Check if the client that issued the drag request is still in the session: */
+			ClientIDList::iterator cIt;
+			for(cIt=session->clients.begin();cIt!=session->clients.end()&&*cIt!=dtIt->clientId;++cIt)
+				;
+			if(cIt!=session->clients.end())
+				{
+				MessageWriter dragTraceNotification(DragTraceNotificationMsg::createMessage(serverMessageBase));
+				dragTraceNotification.write(Misc::UInt32(dtIt->traceId));
+				dragTraceNotification.write(Misc::Float32(double(dtIt->applyTime-dtIt->receiveTime)));
+				dragTraceNotification.write(Misc::Float32(double(dtIt->updateTime-dtIt->applyTime)));
+				dragTraceNotification.write(Misc::Float32(double(sendTime-dtIt->updateTime)));
+				server->getClient(dtIt->clientId)->queueMessage(dragTraceNotification.getBuffer());
+				}
+			}
+		}
+	
+	/* Release the simulation update: */
+	delete update;
+	}
+
+void NetworkViewerServer::sendSimulationUpdateCallback(Threads::EventDispatcher::SignalEvent& event)
+	{
+	/* Retrieve the simulation update messages: */
+	SimulationUpdate* update=static_cast<SimulationUpdate*>(event.getSignalData());
+	Session* session=update->session;
+	
+	/* Discard a live update that was still in flight when the session started replaying a recording: */
+	if(session->player!=0)
+		{
+		delete update;
+		return;
+		}
+	
+	/* Record the update: */
+	if(session->recorder!=0&&!update->positions.empty())
+		session->recorder->recordFrame(update->positions);
+	
+	/* Send the update to the session's clients: */
+	Tracer::Span span("Broadcast simulation update");
+	sendSimulationUpdate(update);
+	}
+
+void NetworkViewerServer::loadNetworkCommandCallback(const char* argumentBegin,const char* argumentEnd)
+	{
+	#if 0
+	/* Check that there is no pending network request: */
+	if(uploadingNetworkClientId==0)
+		{
+		/* Get the network's name and full path: */
+		const char* networkNameBegin;
+		for(networkNameBegin=argumentEnd;networkNameBegin!=argumentBegin&&networkName[-1]!='/';--networkNameBegin)
+			;
+		std::string newNetworkName(networkNameBegin,argumentEnd);
+		std::string networkPath(argumentBegin,argumentEnd);
+		try
+			{
+			/* Open the requested network file: */
+			IO::FilePtr file=IO::openFile(networkPath.c_str());
+			
+			/* Cancel all clients' active drag operations: */
+			for(ClientIDList::iterator cIt=clients.begin();cIt!=clients.end();++cIt)
+				server->getPlugin<Client>(*cIt,pluginIndex)->activeDrags.clear();
+			
+			/* Start loading a new network: */
+			uploadingNetworkClientId=-1U;
+			do
+				{
+				++networkVersion;
+				}
+			while(networkVersion==0);
+			delete simulator;
+			simulator=0;
+			delete network;
+			network=0;
+			networkFile=0;
+			networkName.clear();
+			
+			/* Start a background job to read the incoming network file: */
+			ReadNetworkJob* job=new ReadNetworkJob(newNetworkName,*file,simulationParameters,*Threads::createFunctionCall(this,&NetworkViewerServer::simulationUpdateCallback),numWorkerThreads);
+			Threads::WorkerPool::submitJob(*job,server->getDispatcher(),readNetworkJobCompleteSignalKey);
+			
+			/* Forward the new network file to all clients whose metadosis protocols are already initialized: */
+			for(ClientIDList::iterator cIt=clients.begin();cIt!=clients.end();++cIt)
+				{
+				/* Access the other client's base client state object and its network viewer state object, and check whether its metadosis protocol is initialized: */
+				Server::Client* client=server->getClient(*cIt);
+				Client* nvClient=client->getPlugin<Client>(pluginIndex);
+				if(nvClient->hasMetadosis)
+					{
+					/* Send a load network notification with the new network file's stream ID to the client: */
+					MessageWriter loadNetworkNotification(LoadNetworkMsg::createMessage(serverMessageBase+LoadNetworkNotification));
+					loadNetworkNotification.write(networkVersion);
+					stringToCharBuffer(networkName,loadNetworkNotification,LoadNetworkMsg::networkNameLen);
+					loadNetworkNotification.write(metadosis->forwardInStream(*cIt,*networkFile,Threads::createFunctionCall(this,&NetworkViewerServer::forwardNetworkCompleteCallback,ForwardNetworkCompleteCallbackData(*cIt,networkVersion))));
+					client->queueMessage(loadNetworkNotification.getBuffer());
+					}
+				}
+			}
+		catch(const std::runtime_error& err)
+			{
+			/* Print an error message: */
+			Misc::formattedUserError("NetworkViewerServer: Cannot load network %s due to exception %s",networkPath.c_str(),err.what());
+			}
+		}
+	else
+		{
+		/* Print an error message: */
+		Misc::userError("NetworkViewerServer: Cannot load network because there is already a pending load network request");
+		}
+	#endif
+	}
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+std::string escapeMetricsLabel(const std::string& value) // Returns the given string escaped for use as a label value in the metrics text format
+	{
+	std::string result;
+	result.reserve(value.size());
+	for(std::string::const_iterator vIt=value.begin();vIt!=value.end();++vIt)
+		{
+		switch(*vIt)
+			{
+			case '\\':
+				result.append("\\\\");
+				break;
+			
+			case '\"':
+				result.append("\\\"");
+				break;
+			
+			case '\n':
+				result.append("\\n");
+				break;
+			
+			default:
+				result.push_back(*vIt);
+			}
+		}
+	
+	return result;
+	}
+
+/**************
+Helper classes:
+**************/
+
+struct SessionMetrics // Structure holding a session's simulator metrics over a reporting period
+	{
+	/* Elements: */
+	public:
+	const char* sessionName; // Name of the session
+	std::string sessionLabel; // Name of the session escaped as a metrics label value
+	NetworkSimulator::Statistics stats; // Session simulator's most recent performance counters
+	unsigned long numSteps; // Number of simulation steps during the reporting period
+	double stepsPerSecond; // Simulation rate during the reporting period
+	double commandTime,moveTime,centralForceTime,repellingForceTime,constraintTime,octreeTime,updateTime; // Average times per simulation step in ms
+	unsigned long numCommands; // Number of executed simulation commands during the reporting period
+	double meanCommandLatency; // Average simulation command latency in ms
+	};
+
+}
+
+void NetworkViewerServer::reportMetrics(NetworkViewerServer::MetricsReport report,bool writeLog,const char* fileName)
+	{
+	/* Calculate the length of the reporting period since the previous report of the same kind: */
+	Realtime::TimePointMonotonic now;
+	double period=double(now-lastMetricsTimes[report]);
+	lastMetricsTimes[report]=now;
+	if(period<=0.0)
+		period=1.0;
+	
+	/* Calculate the simulator metrics of all sessions: */
+	std::vector<SessionMetrics> sessionMetrics;
+	for(SessionList::iterator sIt=sessions.begin();sIt!=sessions.end();++sIt)
+		{
+		Session* session=*sIt;
+		SessionMetrics sm;
+		sm.sessionName=session->name.c_str();
+		sm.sessionLabel=escapeMetricsLabel(session->name);
+		
+		/* Retrieve the session simulator's most recent performance counters: */
+		if(session->simulator!=0)
+			sm.stats=session->simulator->getStatistics();
+		const NetworkSimulator::Statistics& stats=sm.stats;
+		
+		/* Restart counting if the simulator was replaced since the previous report: */
+		NetworkSimulator::Statistics& lastStatistics=session->lastStatistics[report];
+		if(stats.numSteps<lastStatistics.numSteps||stats.numCommands<lastStatistics.numCommands)
+			lastStatistics=NetworkSimulator::Statistics();
+		
+		/* Calculate rates and averages over the reporting period: */
+		sm.numSteps=stats.numSteps-lastStatistics.numSteps;
+		sm.stepsPerSecond=double(sm.numSteps)/period;
+		double stepScale=sm.numSteps>0?1000.0/double(sm.numSteps):0.0;
+		sm.commandTime=(stats.commandTime-lastStatistics.commandTime)*stepScale;
+		sm.moveTime=(stats.moveTime-lastStatistics.moveTime)*stepScale;
+		sm.centralForceTime=(stats.centralForceTime-lastStatistics.centralForceTime)*stepScale;
+		sm.repellingForceTime=(stats.repellingForceTime-lastStatistics.repellingForceTime)*stepScale;
+		sm.constraintTime=(stats.constraintTime-lastStatistics.constraintTime)*stepScale;
+		sm.octreeTime=(stats.octreeTime-lastStatistics.octreeTime)*stepScale;
+		sm.updateTime=(stats.updateTime-lastStatistics.updateTime)*stepScale;
+		sm.numCommands=stats.numCommands-lastStatistics.numCommands;
+		sm.meanCommandLatency=sm.numCommands>0?(stats.commandLatency-lastStatistics.commandLatency)*1000.0/double(sm.numCommands):0.0;
+		lastStatistics=stats;
+		
+		sessionMetrics.push_back(sm);
+		}
+	
+	if(writeLog)
+		{
+		/* Write the simulator metrics of all sessions: */
+		Misc::formattedLogNote("NetworkViewer: %u sessions on %u simulation threads",(unsigned int)sessions.size(),scheduler.getNumThreads());
+		for(std::vector<SessionMetrics>::iterator smIt=sessionMetrics.begin();smIt!=sessionMetrics.end();++smIt)
+			{
+			const NetworkSimulator::Statistics& stats=smIt->stats;
+			Misc::formattedLogNote("NetworkViewer: Session \"%s\": %.1f steps/s; ms/step: commands %.3f, move %.3f, central %.3f, repel %.3f, constraints %.3f, octree %.3f, update %.3f",smIt->sessionName,smIt->stepsPerSecond,smIt->commandTime,smIt->moveTime,smIt->centralForceTime,smIt->repellingForceTime,smIt->constraintTime,smIt->octreeTime,smIt->updateTime);
+			Misc::formattedLogNote("NetworkViewer: Session \"%s\": %lu commands, latency mean %.3f ms, max %.3f ms, max queue depth %u",smIt->sessionName,smIt->numCommands,smIt->meanCommandLatency,stats.maxCommandLatency*1000.0,(unsigned int)stats.maxCommandQueueDepth);
+			Misc::formattedLogNote("NetworkViewer: Session \"%s\": octree depth %u, %u nodes, %u leaves; memory: network %llu KiB, DOM %llu KiB, particles %llu KiB",smIt->sessionName,stats.octreeDepth,(unsigned int)stats.numOctreeNodes,(unsigned int)stats.numOctreeLeaves,(unsigned long long)(stats.networkMemorySize>>10),(unsigned long long)(stats.domMemorySize>>10),(unsigned long long)(stats.particleSystemMemorySize>>10));
+			if(stats.qualityStep>0)
+				Misc::formattedLogNote("NetworkViewer: Session \"%s\": layout quality after step %lu: stress %.4f, link length mean %.3f CV %.4f, neighborhood preservation %.4f, %u overlaps, measured in %.3f ms",smIt->sessionName,stats.qualityStep,stats.quality.stress,stats.quality.meanLinkLength,stats.quality.linkLengthCV,stats.quality.neighborhoodPreservation,(unsigned int)stats.quality.numOverlaps,stats.quality.calcTime*1000.0);
+			}
+		}
+	
+	/* Open a temporary metrics file to atomically replace the previous one: */
+	std::string tempFileName;
+	FILE* file=0;
+	if(fileName!=0)
+		{
+		tempFileName=fileName;
+		tempFileName.append(".tmp");
+		file=fopen(tempFileName.c_str(),"w");
+		if(file==0)
+			Misc::formattedUserWarning("NetworkViewerServer: Cannot write metrics file %s",fileName);
+		}
+	
+	if(file!=0)
+		{
+		/* Write the simulator metrics of all sessions, grouped by metric: */
+		fprintf(file,"# TYPE networkviewer_sessions gauge\n");
+		fprintf(file,"networkviewer_sessions %u\n",(unsigned int)sessions.size());
+		fprintf(file,"# TYPE networkviewer_simulation_threads gauge\n");
+		fprintf(file,"networkviewer_simulation_threads %u\n",scheduler.getNumThreads());
+		std::vector<SessionMetrics>::iterator smIt;
+		fprintf(file,"# TYPE networkviewer_simulation_steps_total counter\n");
+		for(smIt=sessionMetrics.begin();smIt!=sessionMetrics.end();++smIt)
+			fprintf(file,"networkviewer_simulation_steps_total{session=\"%s\"} %lu\n",smIt->sessionLabel.c_str(),smIt->stats.numSteps);
+		fprintf(file,"# TYPE networkviewer_simulation_steps_per_second gauge\n");
+		for(smIt=sessionMetrics.begin();smIt!=sessionMetrics.end();++smIt)
+			fprintf(file,"networkviewer_simulation_steps_per_second{session=\"%s\"} %g\n",smIt->sessionLabel.c_str(),smIt->stepsPerSecond);
+		fprintf(file,"# TYPE networkviewer_step_phase_seconds_total counter\n");
+		for(smIt=sessionMetrics.begin();smIt!=sessionMetrics.end();++smIt)
+			{
+			const NetworkSimulator::Statistics& stats=smIt->stats;
+			fprintf(file,"networkviewer_step_phase_seconds_total{session=\"%s\",phase=\"commands\"} %g\n",smIt->sessionLabel.c_str(),stats.commandTime);
+			fprintf(file,"networkviewer_step_phase_seconds_total{session=\"%s\",phase=\"move\"} %g\n",smIt->sessionLabel.c_str(),stats.moveTime);
+			fprintf(file,"networkviewer_step_phase_seconds_total{session=\"%s\",phase=\"central\"} %g\n",smIt->sessionLabel.c_str(),stats.centralForceTime);
+			fprintf(file,"networkviewer_step_phase_seconds_total{session=\"%s\",phase=\"repel\"} %g\n",smIt->sessionLabel.c_str(),stats.repellingForceTime);
+			fprintf(file,"networkviewer_step_phase_seconds_total{session=\"%s\",phase=\"constraints\"} %g\n",smIt->sessionLabel.c_str(),stats.constraintTime);
+			fprintf(file,"networkviewer_step_phase_seconds_total{session=\"%s\",phase=\"octree\"} %g\n",smIt->sessionLabel.c_str(),stats.octreeTime);
+			fprintf(file,"networkviewer_step_phase_seconds_total{session=\"%s\",phase=\"update\"} %g\n",smIt->sessionLabel.c_str(),stats.updateTime);
+			}
+		fprintf(file,"# TYPE networkviewer_commands_total counter\n");
+		for(smIt=sessionMetrics.begin();smIt!=sessionMetrics.end();++smIt)
+			fprintf(file,"networkviewer_commands_total{session=\"%s\"} %lu\n",smIt->sessionLabel.c_str(),smIt->stats.numCommands);
+		fprintf(file,"# TYPE networkviewer_command_latency_seconds gauge\n");
+		for(smIt=sessionMetrics.begin();smIt!=sessionMetrics.end();++smIt)
+			{
+			fprintf(file,"networkviewer_command_latency_seconds{session=\"%s\",stat=\"mean\"} %g\n",smIt->sessionLabel.c_str(),smIt->meanCommandLatency/1000.0);
+			fprintf(file,"networkviewer_command_latency_seconds{session=\"%s\",stat=\"max\"} %g\n",smIt->sessionLabel.c_str(),smIt->stats.maxCommandLatency);
+			}
+		fprintf(file,"# TYPE networkviewer_command_queue_depth_max gauge\n");
+		for(smIt=sessionMetrics.begin();smIt!=sessionMetrics.end();++smIt)
+			fprintf(file,"networkviewer_command_queue_depth_max{session=\"%s\"} %u\n",smIt->sessionLabel.c_str(),(unsigned int)smIt->stats.maxCommandQueueDepth);
+		fprintf(file,"# TYPE networkviewer_octree_depth gauge\n");
+		for(smIt=sessionMetrics.begin();smIt!=sessionMetrics.end();++smIt)
+			fprintf(file,"networkviewer_octree_depth{session=\"%s\"} %u\n",smIt->sessionLabel.c_str(),smIt->stats.octreeDepth);
+		fprintf(file,"# TYPE networkviewer_octree_nodes gauge\n");
+		for(smIt=sessionMetrics.begin();smIt!=sessionMetrics.end();++smIt)
+			{
+			fprintf(file,"networkviewer_octree_nodes{session=\"%s\",kind=\"all\"} %u\n",smIt->sessionLabel.c_str(),(unsigned int)smIt->stats.numOctreeNodes);
+			fprintf(file,"networkviewer_octree_nodes{session=\"%s\",kind=\"leaf\"} %u\n",smIt->sessionLabel.c_str(),(unsigned int)smIt->stats.numOctreeLeaves);
+			}
+		fprintf(file,"# TYPE networkviewer_memory_bytes gauge\n");
+		for(smIt=sessionMetrics.begin();smIt!=sessionMetrics.end();++smIt)
+			{
+			fprintf(file,"networkviewer_memory_bytes{session=\"%s\",component=\"network\"} %llu\n",smIt->sessionLabel.c_str(),(unsigned long long)smIt->stats.networkMemorySize);
+			fprintf(file,"networkviewer_memory_bytes{session=\"%s\",component=\"dom\"} %llu\n",smIt->sessionLabel.c_str(),(unsigned long long)smIt->stats.domMemorySize);
+			fprintf(file,"networkviewer_memory_bytes{session=\"%s\",component=\"particles\"} %llu\n",smIt->sessionLabel.c_str(),(unsigned long long)smIt->stats.particleSystemMemorySize);
+			}
+		fprintf(file,"# TYPE networkviewer_layout_quality gauge\n");
+		for(smIt=sessionMetrics.begin();smIt!=sessionMetrics.end();++smIt)
+			if(smIt->stats.qualityStep>0)
+				{
+				const LayoutQuality::Metrics& quality=smIt->stats.quality;
+				fprintf(file,"networkviewer_layout_quality{session=\"%s\",metric=\"stress\"} %g\n",smIt->sessionLabel.c_str(),quality.stress);
+				fprintf(file,"networkviewer_layout_quality{session=\"%s\",metric=\"link_length_cv\"} %g\n",smIt->sessionLabel.c_str(),quality.linkLengthCV);
+				fprintf(file,"networkviewer_layout_quality{session=\"%s\",metric=\"neighborhood_preservation\"} %g\n",smIt->sessionLabel.c_str(),quality.neighborhoodPreservation);
+				fprintf(file,"networkviewer_layout_quality{session=\"%s\",metric=\"overlaps\"} %u\n",smIt->sessionLabel.c_str(),(unsigned int)quality.numOverlaps);
+				}
+		fprintf(file,"# TYPE networkviewer_client_update_bytes_total counter\n");
+		}
+	
+	/* Write per-client metrics: */
+	for(ClientIDList::iterator cIt=clients.begin();cIt!=clients.end();++cIt)
+		{
+		Client* nvClient=server->getPlugin<Client>(*cIt,pluginIndex);
+		double updateBytesPerSecond=double(nvClient->updateBytes-nvClient->reportedUpdateBytes[report])/period;
+		nvClient->reportedUpdateBytes[report]=nvClient->updateBytes;
+		
+		if(writeLog)
+			Misc::formattedLogNote("NetworkViewer: Client %u in session \"%s\": %.1f KiB/s of simulation updates via %s",*cIt,nvClient->session->name.c_str(),updateBytesPerSecond/1024.0,nvClient->datagramUpdates?"UDP":"TCP");
+		if(file!=0)
+			fprintf(file,"networkviewer_client_update_bytes_total{session=\"%s\",client=\"%u\"} %llu\n",escapeMetricsLabel(nvClient->session->name).c_str(),*cIt,(unsigned long long)nvClient->updateBytes);
+		}
+	
+	if(file!=0)
+		{
+		/* Close the temporary file and replace the metrics file: */
+		fclose(file);
+		if(rename(tempFileName.c_str(),fileName)!=0)
+			Misc::formattedUserWarning("NetworkViewerServer: Cannot replace metrics file %s",fileName);
+		}
+	}
+
+bool NetworkViewerServer::metricsTimerCallback(Threads::EventDispatcher::TimerEvent& event)
+	{
+	/* Write a periodic metrics report: */
+	reportMetrics(PeriodicReport,logMetrics,metricsFileName.empty()?0:metricsFileName.c_str());
+	
+	/* Keep the timer running: */
+	return false;
+	}
+
+void NetworkViewerServer::updateMetricsTimer(void)
+	{
+	/* Remove the current timer: */
+	if(metricsTimerActive)
+		{
+		server->getDispatcher().removeTimerEventListener(metricsTimerKey);
+		metricsTimerActive=false;
+		}
+	
+	/* Register a new timer if periodic reports are enabled and have a destination: */
+	if(metricsInterval>0&&(logMetrics||!metricsFileName.empty()))
+		{
+		Threads::EventDispatcher::Time interval(metricsInterval,0);
+		Threads::EventDispatcher::Time firstReport=Threads::EventDispatcher::Time::now();
+		firstReport+=interval;
+		metricsTimerKey=server->getDispatcher().addTimerEventListener(firstReport,interval,Threads::EventDispatcher::wrapMethod<NetworkViewerServer,&NetworkViewerServer::metricsTimerCallback>,this);
+		metricsTimerActive=true;
+		}
+	}
+
+void NetworkViewerServer::printMetricsCommandCallback(const char* argumentBegin,const char* argumentEnd)
+	{
+	/* Write a metrics report to the log: */
+	reportMetrics(CommandReport,true,0);
+	}
+
+void NetworkViewerServer::setMetricsIntervalCommandCallback(const char* argumentBegin,const char* argumentEnd)
+	{
+	/* Parse the new interval: */
+	std::string interval(argumentBegin,argumentEnd);
+	metricsInterval=(unsigned int)(atoi(interval.c_str()));
+	updateMetricsTimer();
+	}
+
+void NetworkViewerServer::setMetricsLogCommandCallback(const char* argumentBegin,const char* argumentEnd)
+	{
+	/* Parse the new flag: */
+	std::string flag(argumentBegin,argumentEnd);
+	logMetrics=strcasecmp(flag.c_str(),"on")==0||strcasecmp(flag.c_str(),"true")==0||flag=="1";
+	updateMetricsTimer();
+	}
+
+void NetworkViewerServer::setMetricsFileCommandCallback(const char* argumentBegin,const char* argumentEnd)
+	{
+	/* Set the new file name; an empty name disables writing metrics files: */
+	metricsFileName=std::string(argumentBegin,argumentEnd);
+	updateMetricsTimer();
+	}
+
+void NetworkViewerServer::setQualityIntervalCommandCallback(const char* argumentBegin,const char* argumentEnd)
+	{
+	/* Parse the new interval: */
+	std::string interval(argumentBegin,argumentEnd);
+	qualityInterval=atof(interval.c_str());
+	if(qualityInterval<0.0)
+		qualityInterval=0.0;
+	
+	/* Forward the interval to all sessions' simulators: */
+	for(SessionList::iterator sIt=sessions.begin();sIt!=sessions.end();++sIt)
+		if((*sIt)->simulator!=0)
+			(*sIt)->simulator->setQualityInterval(qualityInterval);
+	}
+
+void NetworkViewerServer::startTraceCommandCallback(const char* argumentBegin,const char* argumentEnd)
+	{
+	/* Parse the optional maximum number of spans per thread: */
+	std::string maxSpans(argumentBegin,argumentEnd);
+	size_t maxSpansPerThread=1000000;
+	if(!maxSpans.empty())
+		maxSpansPerThread=size_t(atol(maxSpans.c_str()));
+	
+	/* Name the calling thread, which dispatches client messages, and start recording spans from all threads: */
+	Tracer::setThreadName("Server main");
+	Tracer::start(maxSpansPerThread);
+	Misc::formattedLogNote("NetworkViewer: Started tracing with up to %u spans per thread",(unsigned int)(maxSpansPerThread));
+	}
+
+void NetworkViewerServer::stopTraceCommandCallback(const char* argumentBegin,const char* argumentEnd)
+	{
+	/* Stop recording spans: */
+	std::string fileName(argumentBegin,argumentEnd);
+	if(!Tracer::isEnabled())
+		{
+		Misc::userError("NetworkViewer::stopTrace: No trace is being recorded");
+		return;
+		}
+	Tracer::stop();
+	
+	/* Write the recorded spans to the given file unless no file name was given: */
+	if(fileName.empty())
+		return;
+	try
+		{
+		size_t numDropped=Tracer::write(fileName.c_str());
+		Misc::formattedLogNote("NetworkViewer: Wrote trace to %s; %u spans were dropped",fileName.c_str(),(unsigned int)(numDropped));
+		}
+	catch(const std::runtime_error& err)
+		{
+		Misc::formattedUserError("NetworkViewer::stopTrace: Unable to write trace file %s due to exception %s",fileName.c_str(),err.what());
+		}
+	}
+
+void NetworkViewerServer::stopRecording(NetworkViewerServer::Session* session)
+	{
+	if(session->recorder!=0)
+		{
+		/* Stop copying node positions in the session's simulation steps: */
+		session->recording=false;
+		
+		/* Finish the recording file: */
+		try
+			{
+			session->recorder->close();
+			Misc::formattedLogNote("NetworkViewer: Stopped recording session \"%s\" after %u simulation updates (%u key frames, %.1f MB)",session->name.c_str(),(unsigned int)(session->recorder->getNumFrames()),(unsigned int)(session->recorder->getNumKeyFrames()),double(session->recorder->getFileSize())/(1024.0*1024.0));
+			}
+		catch(const std::runtime_error& err)
+			{
+			/* Print an error message: */
+			Misc::formattedUserError("NetworkViewer::stopRecording: Unable to finish recording of session \"%s\" due to exception %s",session->name.c_str(),err.what());
+			}
+		delete session->recorder;
+		session->recorder=0;
+		}
+	}
+
+void NetworkViewerServer::stopReplay(NetworkViewerServer::Session* session)
+	{
+	if(session->player!=0)
+		{
+		/* Close the replayed recording: */
+		Misc::formattedLogNote("NetworkViewer: Stopped replaying recording to session \"%s\"",session->name.c_str());
+		delete session->player;
+		session->player=0;
+		
+		/* Resume the session's simulator from the replayed selection and label state if the session has clients: */
+		if(session->simulator!=0&&!session->clients.empty())
+			session->simulator->resume();
+		
+		updateReplayTimer();
+		}
+	}
+
+void NetworkViewerServer::applyReplayEvent(NetworkViewerServer::Session* session,const SessionPlayer::Event& event,bool notify)
+	{
+	Network& network=*session->network;
+	switch(event.type)
+		{
+		case SessionRecorder::SelectNode:
+			/* Change the node's selection state: */
+			switch(event.mode)
+				{
+				case 0: // Select node
+					network.selectNode(event.node);
+					break;
+				
+				case 1: // Deselect node
+					network.deselectNode(event.node);
+					break;
+				
+				case 2: // Toggle node's selection state
+					if(network.isSelected(event.node))
+						network.deselectNode(event.node);
+					else
+						network.selectNode(event.node);
+					break;
+				}
+			
+			if(notify)
+				{
+				MessageWriter selectNodeNotification(SelectNodeMsg::createMessage(serverMessageBase+SelectNodeNotification));
+				selectNodeNotification.write(session->networkVersion);
+				selectNodeNotification.write(NodeID(event.node));
+				selectNodeNotification.write(event.mode);
+				broadcastToSession(session,0,selectNodeNotification.getBuffer());
+				}
+			
+			break;
+		
+		case SessionRecorder::ChangeSelection:
+			/* Change the network's selection set: */
+			switch(event.mode)
+				{
+				case 0: // Clear selection
+					network.clearSelection();
+					break;
+				
+				case 1: // Grow selection
+					network.growSelection();
+					break;
+				
+				case 2: // Shrink selection
+					network.shrinkSelection();
+					break;
+				}
+			
+			if(notify)
+				{
+				MessageWriter changeSelectionNotification(ChangeSelectionMsg::createMessage(serverMessageBase+ChangeSelectionNotification));
+				changeSelectionNotification.write(session->networkVersion);
+				changeSelectionNotification.write(event.mode);
+				broadcastToSession(session,0,changeSelectionNotification.getBuffer());
+				}
+			
+			break;
+		
+		case SessionRecorder::SelectNodes:
+			/* Change the selection state of all recorded nodes at once: */
+			network.selectNodes(event.nodes,event.mode);
+			
+			if(notify)
+				{
+				size_t payloadSize;
+				Misc::UInt8 encoding=chooseNodeSetEncoding(event.nodes,payloadSize);
+				MessageWriter selectRegionNotification(SelectRegionNotificationMsg::createMessage(serverMessageBase,payloadSize));
+				selectRegionNotification.write(session->networkVersion);
+				selectRegionNotification.write(event.mode);
+				selectRegionNotification.write(encoding);
+				selectRegionNotification.write(Misc::UInt32(payloadSize));
+				writeNodeSet(event.nodes,encoding,selectRegionNotification);
+				broadcastToSession(session,0,selectRegionNotification.getBuffer());
+				}
+			
+			break;
+		
+		case SessionRecorder::DisplayLabel:
+			/* Change the label set: */
+			switch(event.mode)
+				{
+				case 0: // Clear label set
+					session->labeledNodes.clear();
+					break;
+				
+				case 1: // Show node label
+					session->labeledNodes.setEntry(NodeSet::Entry(event.node));
+					break;
+				
+				case 2: // Hide node label
+					session->labeledNodes.removeEntry(event.node);
+					break;
+				}
+			
+			if(notify)
+				{
+				MessageWriter displayLabelNotification(DisplayLabelMsg::createMessage(serverMessageBase+DisplayLabelNotification));
+				displayLabelNotification.write(session->networkVersion);
+				displayLabelNotification.write(NodeID(event.node));
+				displayLabelNotification.write(event.mode);
+				broadcastToSession(session,0,displayLabelNotification.getBuffer());
+				}
+			
+			break;
+		
+		case SessionRecorder::SetLabels:
+			/* Replace the label set: */
+			session->labeledNodes.clear();
+			for(std::vector<Index>::const_iterator nIt=event.nodes.begin();nIt!=event.nodes.end();++nIt)
+				session->labeledNodes.setEntry(NodeSet::Entry(*nIt));
+			
+			if(notify)
+				{
+				Misc::UInt32 numLabeledNodes(event.nodes.size());
+				MessageWriter labelSetNotification(NodeSetMsg::createMessage(serverMessageBase+LabelSetNotification,numLabeledNodes));
+				labelSetNotification.write(session->networkVersion);
+				labelSetNotification.write(numLabeledNodes);
+				for(std::vector<Index>::const_iterator nIt=event.nodes.begin();nIt!=event.nodes.end();++nIt)
+					labelSetNotification.write(NodeID(*nIt));
+				broadcastToSession(session,0,labelSetNotification.getBuffer());
+				}
+			
+			break;
+		
+		default:
+			;
+		}
+	}
+
+void NetworkViewerServer::seekReplay(NetworkViewerServer::Session* session,double time)
+	{
+	SessionPlayer* player=session->player;
+	
+	/* Limit the playback position to the recording: */
+	session->replayTime=Misc::max(Misc::min(time,player->getDuration()),0.0);
+	
+	/* Reconstruct the selection and label sets by applying all recorded changes up to the new playback position: */
+	session->network->clearSelection();
+	session->labeledNodes.clear();
+	const std::vector<SessionPlayer::Event>& events=player->getEvents();
+	session->nextReplayEvent=player->findEvent(session->replayTime);
+	for(size_t i=0;i<session->nextReplayEvent;++i)
+		applyReplayEvent(session,events[i],false);
+	
+	/* Reconstruct the node positions from the nearest preceding key frame and send them to the session's clients: */
+	player->seek(session->replayTime);
+	if(player->hasPositions())
+		sendSimulationUpdate(createSimulationUpdate(session,player->getNumNodes(),&player->getPositions().front()));
+	
+	/* Send the reconstructed selection and label sets to all clients in the session that have the session's current network: */
+	for(ClientIDList::iterator cIt=session->clients.begin();cIt!=session->clients.end();++cIt)
+		{
+		Server::Client* client=server->getClient(*cIt);
+		if(client->getPlugin<Client>(pluginIndex)->networkVersion==session->networkVersion)
+			sendNodeSets(session,client);
+		}
+	}
+
+bool NetworkViewerServer::replayTimerCallback(Threads::EventDispatcher::TimerEvent& event)
+	{
+	/* Calculate the time since the previous timer event: */
+	Realtime::TimePointMonotonic now;
+	double timeStep=double(now-lastReplayTime);
+	lastReplayTime=now;
+	
+	/* Advance all session replays: */
+	for(SessionList::iterator sIt=sessions.begin();sIt!=sessions.end();++sIt)
+		{
+		Session* session=*sIt;
+		SessionPlayer* player=session->player;
+		if(player==0)
+			continue;
+		
+		/* Advance the playback position, and hold at the end of the recording: */
+		session->replayTime=Misc::min(session->replayTime+timeStep*session->replaySpeed,player->getDuration());
+		
+		/* Replay all selection and label changes up to the new playback position: */
+		const std::vector<SessionPlayer::Event>& events=player->getEvents();
+		for(;session->nextReplayEvent<events.size()&&events[session->nextReplayEvent].time<=session->replayTime;++session->nextReplayEvent)
+			applyReplayEvent(session,events[session->nextReplayEvent],true);
+		
+		/* Decode all frames up to the new playback position and send the most recent one to the session's clients: */
+		if(player->advance(session->replayTime))
+			sendSimulationUpdate(createSimulationUpdate(session,player->getNumNodes(),&player->getPositions().front()));
+		}
+	
+	/* Keep the timer running: */
+	return false;
+	}
+
+void NetworkViewerServer::updateReplayTimer(void)
+	{
+	/* Check if any session is replaying a recording: */
+	bool replaying=false;
+	for(SessionList::iterator sIt=sessions.begin();sIt!=sessions.end()&&!replaying;++sIt)
+		replaying=(*sIt)->player!=0;
+	
+	if(replaying&&!replayTimerActive)
+		{
+		/* Register a timer advancing all replays at the typical simulation update rate: */
+		Threads::EventDispatcher::Time interval(0,16667);
+		Threads::EventDispatcher::Time firstEvent=Threads::EventDispatcher::Time::now();
+		firstEvent+=interval;
+		replayTimerKey=server->getDispatcher().addTimerEventListener(firstEvent,interval,Threads::EventDispatcher::wrapMethod<NetworkViewerServer,&NetworkViewerServer::replayTimerCallback>,this);
+		replayTimerActive=true;
+		lastReplayTime=Realtime::TimePointMonotonic();
+		}
+	else if(!replaying&&replayTimerActive)
+		{
+		/* Remove the timer: */
+		server->getDispatcher().removeTimerEventListener(replayTimerKey);
+		replayTimerActive=false;
+		}
+	}
+
+NetworkViewerServer::Session* NetworkViewerServer::parseSessionCommand(const char* argumentBegin,const char* argumentEnd,std::string& argument,const char* commandName)
+	{
+	/* Split off the first argument: */
+	const char* aPtr=argumentBegin;
+	while(aPtr!=argumentEnd&&isspace(*aPtr))
+		++aPtr;
+	const char* argBegin=aPtr;
+	while(aPtr!=argumentEnd&&!isspace(*aPtr))
+		++aPtr;
+	argument=std::string(argBegin,aPtr);
+	
+	/* Treat the rest of the arguments as the session name: */
+	while(aPtr!=argumentEnd&&isspace(*aPtr))
+		++aPtr;
+	const char* nameEnd=argumentEnd;
+	while(nameEnd!=aPtr&&isspace(nameEnd[-1]))
+		--nameEnd;
+	std::string sessionName(aPtr,nameEnd);
+	
+	/* Find the session: */
+	Session* session=findSession(sessionName);
+	if(session==0)
+		Misc::formattedUserError("NetworkViewer::%s: Session \"%s\" does not exist",commandName,sessionName.c_str());
+	
+	return session;
+	}
+
+void NetworkViewerServer::startRecordingCommandCallback(const char* argumentBegin,const char* argumentEnd)
+	{
+	/* Parse the recording file name and the session: */
+	std::string fileName;
+	Session* session=parseSessionCommand(argumentBegin,argumentEnd,fileName,"startRecording");
+	if(session==0)
+		return;
+	
+	/* Check that the session is running a live simulation: */
+	if(session->network==0||session->simulator==0||session->player!=0)
+		{
+		Misc::formattedUserError("NetworkViewer::startRecording: Session \"%s\" is not simulating a network",session->name.c_str());
+		return;
+		}
+	
+	/* Finish a previous recording: */
+	stopRecording(session);
+	
+	try
+		{
+		/* Start a new recording with 1/1000 unit position precision and a key frame at least every 120 simulation updates: */
+		session->recorder=new SessionRecorder(fileName.c_str(),session->networkName,Index(session->network->getNodes().size()),1.0e-3,120);
+		}
+	catch(const std::runtime_error& err)
+		{
+		Misc::formattedUserError("NetworkViewer::startRecording: Unable to create recording file %s due to exception %s",fileName.c_str(),err.what());
+		return;
+		}
+	
+	/* Record the session's current selection and label sets: */
+	{
+	std::vector<Index> nodes;
+	const Network::Selection& selection=session->network->getSelection();
+	for(Network::Selection::ConstIterator sIt=selection.begin();!sIt.isFinished();++sIt)
+		nodes.push_back(sIt->getSource());
+	std::sort(nodes.begin(),nodes.end());
+	session->recorder->recordSelectNodes(nodes,3);
+	}
+	{
+	std::vector<Index> nodes;
+	for(NodeSet::Iterator lnIt=session->labeledNodes.begin();!lnIt.isFinished();++lnIt)
+		nodes.push_back(lnIt->getSource());
+	std::sort(nodes.begin(),nodes.end());
+	session->recorder->recordSetLabels(nodes);
+	}
+	
+	/* Start copying node positions in the session's simulation steps: */
+	session->recording=true;
+	Misc::formattedLogNote("NetworkViewer: Recording session \"%s\" to %s",session->name.c_str(),fileName.c_str());
+	}
+
+void NetworkViewerServer::stopRecordingCommandCallback(const char* argumentBegin,const char* argumentEnd)
+	{
+	/* Find the session and finish its recording: */
+	Session* session=findSession(std::string(argumentBegin,argumentEnd));
+	if(session!=0)
+		stopRecording(session);
+	else
+		Misc::formattedUserError("NetworkViewer::stopRecording: Session \"%s\" does not exist",std::string(argumentBegin,argumentEnd).c_str());
+	}
+
+void NetworkViewerServer::startReplayCommandCallback(const char* argumentBegin,const char* argumentEnd)
+	{
+	/* Parse the recording file name and the session: */
+	std::string fileName;
+	Session* session=parseSessionCommand(argumentBegin,argumentEnd,fileName,"startReplay");
+	if(session==0)
+		return;
+	
+	/* Open the recording: */
+	SessionPlayer* player=0;
+	try
+		{
+		player=new SessionPlayer(fileName.c_str());
+		}
+	catch(const std::runtime_error& err)
+		{
+		Misc::formattedUserError("NetworkViewer::startReplay: Unable to open recording file %s due to exception %s",fileName.c_str(),err.what());
+		return;
+		}
+	
+	/* Check that the recording matches the session's network: */
+	if(session->network==0||session->network->getNodes().size()!=player->getNumNodes())
+		{
+		Misc::formattedUserError("NetworkViewer::startReplay: Recording of network %s with %u nodes does not match the network of session \"%s\"",player->getNetworkName().c_str(),(unsigned int)(player->getNumNodes()),session->name.c_str());
+		delete player;
+		return;
+		}
+	
+	/* Replace a previous replay, and stop recording the session: */
+	stopRecording(session);
+	if(session->player!=0)
+		{
+		delete session->player;
+		session->player=0;
+		}
+	
+	/* Suspend the session's simulator so that the replay can change the session's network: */
+	if(session->simulator!=0)
+		session->simulator->suspend();
+	
+	/* Cancel the active drag operations of all clients in the session: */
+	draggedPositions.clear();
+	for(ClientIDList::iterator cIt=session->clients.begin();cIt!=session->clients.end();++cIt)
+		{
+		Client* nvClient=server->getPlugin<Client>(*cIt,pluginIndex);
+		for(Client::ActiveDragMap::Iterator adIt=nvClient->activeDrags.begin();!adIt.isFinished();++adIt)
+			{
+			if(session->simulator!=0)
+				session->simulator->dragStop(*cIt,adIt->getSource());
+			sendDragDelta(session,0,*cIt,adIt->getSource(),draggedPositions);
+			}
+		nvClient->activeDrags.clear();
+		}
+	
+	/* Start replaying from the beginning of the recording at the original speed: */
+	Misc::formattedLogNote("NetworkViewer: Replaying %.1f s recording of network %s to session \"%s\"",player->getDuration(),player->getNetworkName().c_str(),session->name.c_str());
+	session->player=player;
+	session->replaySpeed=1.0;
+	seekReplay(session,0.0);
+	updateReplayTimer();
+	}
+
+void NetworkViewerServer::stopReplayCommandCallback(const char* argumentBegin,const char* argumentEnd)
+	{
+	/* Find the session and stop its replay: */
+	Session* session=findSession(std::string(argumentBegin,argumentEnd));
+	if(session!=0)
+		stopReplay(session);
+	else
+		Misc::formattedUserError("NetworkViewer::stopReplay: Session \"%s\" does not exist",std::string(argumentBegin,argumentEnd).c_str());
+	}
+
+void NetworkViewerServer::setReplaySpeedCommandCallback(const char* argumentBegin,const char* argumentEnd)
+	{
+	/* Parse the new playback speed and the session: */
+	std::string speed;
+	Session* session=parseSessionCommand(argumentBegin,argumentEnd,speed,"setReplaySpeed");
+	if(session==0)
+		return;
+	
+	/* Set the session's playback speed; 0 pauses the replay: */
+	session->replaySpeed=Misc::max(atof(speed.c_str()),0.0);
+	}
+
+void NetworkViewerServer::seekReplayCommandCallback(const char* argumentBegin,const char* argumentEnd)
+	{
+	/* Parse the new playback position and the session: */
+	std::string time;
+	Session* session=parseSessionCommand(argumentBegin,argumentEnd,time,"seekReplay");
+	if(session==0)
+		return;
+	
+	/* Move the session's replay to the new playback position: */
+	if(session->player!=0)
+		seekReplay(session,atof(time.c_str()));
+	else
+		Misc::formattedUserError("NetworkViewer::seekReplay: Session \"%s\" is not replaying a recording",session->name.c_str());
+	}
+
+NetworkViewerServer::NetworkViewerServer(Server* sServer)
+	:PluginServer(sServer),
+	 metadosis(MetadosisServer::requestServer(server)),
+	 vruiCore(VruiCoreServer::requestServer(server)),
+	 scheduler(0),
+	 metricsInterval(0),metricsTimerActive(false),logMetrics(false),
+	 qualityInterval(0.0),
+	 replayTimerActive(false)
+	{
+	/* Register dependencies with the service protocol plug-ins: */
+	metadosis->addDependentPlugin(this);
+	vruiCore->addDependentPlugin(this);
+	
+	/* Create the default session: */
+	sessions.push_back(new Session(""));
+	
+	/* Register signals with the server's event dispatcher: */
+	readNetworkJobCompleteSignalKey=server->getDispatcher().addSignalListener(Threads::EventDispatcher::wrapMethod<NetworkViewerServer,&NetworkViewerServer::readNetworkJobCompleteCallback>,this);
+	simulationUpdateSignalKey=server->getDispatcher().addSignalListener(Threads::EventDispatcher::wrapMethod<NetworkViewerServer,&NetworkViewerServer::sendSimulationUpdateCallback>,this);
+	selectRegionSignalKey=server->getDispatcher().addSignalListener(Threads::EventDispatcher::wrapMethod<NetworkViewerServer,&NetworkViewerServer::sendSelectRegionNotificationCallback>,this);
+	
+	/* Register pipe commands: */
+	server->getCommandDispatcher().addCommandCallback("NetworkViewer::loadNetwork",Misc::CommandDispatcher::wrapMethod<NetworkViewerServer,&NetworkViewerServer::loadNetworkCommandCallback>,this,"<network file name>","Loads the network file of the given name");
+	server->getCommandDispatcher().addCommandCallback("NetworkViewer::printMetrics",Misc::CommandDispatcher::wrapMethod<NetworkViewerServer,&NetworkViewerServer::printMetricsCommandCallback>,this,0,"Writes simulation and network metrics since the previous printMetrics command to the log");
+	server->getCommandDispatcher().addCommandCallback("NetworkViewer::setMetricsInterval",Misc::CommandDispatcher::wrapMethod<NetworkViewerServer,&NetworkViewerServer::setMetricsIntervalCommandCallback>,this,"<interval in seconds>","Sets the interval for periodic metrics reports; 0 disables periodic reports");
+	server->getCommandDispatcher().addCommandCallback("NetworkViewer::setMetricsLog",Misc::CommandDispatcher::wrapMethod<NetworkViewerServer,&NetworkViewerServer::setMetricsLogCommandCallback>,this,"on | off","Enables or disables writing periodic metrics reports to the log");
+	server->getCommandDispatcher().addCommandCallback("NetworkViewer::setMetricsFile",Misc::CommandDispatcher::wrapMethod<NetworkViewerServer,&NetworkViewerServer::setMetricsFileCommandCallback>,this,"[<metrics file name>]","Writes periodic metrics reports to the given file in Prometheus text format; no file name disables the file");
+	server->getCommandDispatcher().addCommandCallback("NetworkViewer::setQualityInterval",Misc::CommandDispatcher::wrapMethod<NetworkViewerServer,&NetworkViewerServer::setQualityIntervalCommandCallback>,this,"<interval in seconds>","Sets the interval for measuring layout quality metrics in all sessions' simulators; 0 disables measurements");
+	server->getCommandDispatcher().addCommandCallback("NetworkViewer::startTrace",Misc::CommandDispatcher::wrapMethod<NetworkViewerServer,&NetworkViewerServer::startTraceCommandCallback>,this,"[<maximum spans per thread>]","Starts recording timed spans of simulation and update work from all threads");
+	server->getCommandDispatcher().addCommandCallback("NetworkViewer::stopTrace",Misc::CommandDispatcher::wrapMethod<NetworkViewerServer,&NetworkViewerServer::stopTraceCommandCallback>,this,"[<trace file name>]","Stops recording spans and writes them to the given file in Chrome trace event format; no file name discards them");
+	server->getCommandDispatcher().addCommandCallback("NetworkViewer::startRecording",Misc::CommandDispatcher::wrapMethod<NetworkViewerServer,&NetworkViewerServer::startRecordingCommandCallback>,this,"<recording file name> [<session name>]","Records the given session's simulation updates and selection and label changes to the given file");
+	server->getCommandDispatcher().addCommandCallback("NetworkViewer::stopRecording",Misc::CommandDispatcher::wrapMethod<NetworkViewerServer,&NetworkViewerServer::stopRecordingCommandCallback>,this,"[<session name>]","Finishes the given session's recording");
+	server->getCommandDispatcher().addCommandCallback("NetworkViewer::startReplay",Misc::CommandDispatcher::wrapMethod<NetworkViewerServer,&NetworkViewerServer::startReplayCommandCallback>,this,"<recording file name> [<session name>]","Replays the given recording to the given session's clients in place of its simulator");
+	server->getCommandDispatcher().addCommandCallback("NetworkViewer::stopReplay",Misc::CommandDispatcher::wrapMethod<NetworkViewerServer,&NetworkViewerServer::stopReplayCommandCallback>,this,"[<session name>]","Stops the given session's replay and resumes its simulator");
+	server->getCommandDispatcher().addCommandCallback("NetworkViewer::setReplaySpeed",Misc::CommandDispatcher::wrapMethod<NetworkViewerServer,&NetworkViewerServer::setReplaySpeedCommandCallback>,this,"<speed> [<session name>]","Sets the playback speed of the given session's replay relative to the original speed; 0 pauses the replay");
+	server->getCommandDispatcher().addCommandCallback("NetworkViewer::seekReplay",Misc::CommandDispatcher::wrapMethod<NetworkViewerServer,&NetworkViewerServer::seekReplayCommandCallback>,this,"<time in seconds> [<session name>]","Moves the given session's replay to the given playback position");
+	}
+
+NetworkViewerServer::~NetworkViewerServer(void)
+	{
+	/* Shut down all sessions' simulators, recorders, and players and delete their networks: */
+	for(SessionList::iterator sIt=sessions.begin();sIt!=sessions.end();++sIt)
+		delete *sIt;
+	
+	/* Remove event dispatcher signals: */
+	server->getDispatcher().removeSignalListener(readNetworkJobCompleteSignalKey);
 	server->getDispatcher().removeSignalListener(simulationUpdateSignalKey);
+	server->getDispatcher().removeSignalListener(selectRegionSignalKey);
+	if(metricsTimerActive)
+		server->getDispatcher().removeTimerEventListener(metricsTimerKey);
+	if(replayTimerActive)
+		server->getDispatcher().removeTimerEventListener(replayTimerKey);
 	
 	/* Release dependencies from the service protocol plug-ins: */
 	vruiCore->removeDependentPlugin(this);
@@ -662,6 +2085,12 @@ void NetworkViewerServer::setMessageBases(unsigned int newClientMessageBase,unsi
 	server->setMessageHandler(clientMessageBase+DragStartRequest,Server::wrapMethod<NetworkViewerServer,&NetworkViewerServer::dragStartRequestCallback>,this,DragStartRequestMsg::size);
 	server->setMessageHandler(clientMessageBase+DragRequest,Server::wrapMethod<NetworkViewerServer,&NetworkViewerServer::dragRequestCallback>,this,DragRequestMsg::size);
 	server->setMessageHandler(clientMessageBase+DragStopRequest,Server::wrapMethod<NetworkViewerServer,&NetworkViewerServer::dragStopRequestCallback>,this,DragStopRequestMsg::size);
+	server->setMessageHandler(clientMessageBase+SelectRegionRequest,Server::wrapMethod<NetworkViewerServer,&NetworkViewerServer::selectRegionRequestCallback>,this,SelectRegionRequestMsg::size);
+	server->setMessageHandler(clientMessageBase+DatagramUpdatesRequest,Server::wrapMethod<NetworkViewerServer,&NetworkViewerServer::datagramUpdatesRequestCallback>,this,DatagramUpdatesMsg::size);
+	server->setMessageHandler(clientMessageBase+DatagramUpdateAck,Server::wrapMethod<NetworkViewerServer,&NetworkViewerServer::datagramUpdateAckCallback>,this,DatagramUpdateAckMsg::size);
+	server->setMessageHandler(clientMessageBase+JoinSessionRequest,Server::wrapMethod<NetworkViewerServer,&NetworkViewerServer::joinSessionRequestCallback>,this,JoinSessionRequestMsg::size);
+	server->setMessageHandler(clientMessageBase+NavDragStartRequest,Server::wrapMethod<NetworkViewerServer,&NetworkViewerServer::navDragStartRequestCallback>,this,NavDragStartRequestMsg::size);
+	server->setMessageHandler(clientMessageBase+NavDragRequest,Server::wrapMethod<NetworkViewerServer,&NetworkViewerServer::navDragRequestCallback>,this,NavDragRequestMsg::size);
 	}
 
 void NetworkViewerServer::start(void)
@@ -670,66 +2099,25 @@ void NetworkViewerServer::start(void)
 
 void NetworkViewerServer::clientConnected(unsigned int clientId)
 	{
-	/* Unpause the simulator if there is one, and this is the first client to connect : */
-	if(simulator!=0&&clients.empty())
-		{
-		Misc::logNote("NetworkViewer: Unpausing simulation thread");
-		simulator->resume();
-		}
-	
 	/* Call the base class method: */
 	PluginServer::clientConnected(clientId);
 	
 	/* Associate a client structure with the new client: */
 	Server::Client* client=server->getClient(clientId);
-	client->setPlugin(pluginIndex,new Client);
-	
-	/* Send the current simulation and rendering parameters to the new client: */
-	{
-	MessageWriter setSimulationParametersNotification(SetSimulationParametersMsg::createMessage(serverMessageBase+SetSimulationParametersNotification));
-	simulationParameters.write(setSimulationParametersNotification);
-	client->queueMessage(setSimulationParametersNotification.getBuffer());
-	}
-	{
-	MessageWriter setRenderingParametersNotification(SetRenderingParametersMsg::createMessage(serverMessageBase+SetRenderingParametersNotification));
-	renderingParameters.write(setRenderingParametersNotification);
-	client->queueMessage(setRenderingParametersNotification.getBuffer());
-	}
+	Client* nvClient=new Client;
+	client->setPlugin(pluginIndex,nvClient);
 	
-	/* Check if there is a network file: */
-	if(networkFile!=0)
-		{
-		/* Forward the network file to the new client: */
-		MessageWriter loadNetworkNotification(LoadNetworkMsg::createMessage(serverMessageBase+LoadNetworkNotification));
-		loadNetworkNotification.write(networkVersion);
-		stringToCharBuffer(networkName,loadNetworkNotification,LoadNetworkMsg::networkNameLen);
-		loadNetworkNotification.write(metadosis->forwardInStream(clientId,*networkFile,Threads::createFunctionCall(this,&NetworkViewerServer::forwardNetworkCompleteCallback,ForwardNetworkCompleteCallbackData(clientId,networkVersion))));
-		client->queueMessage(loadNetworkNotification.getBuffer());
-		}
+	/* Add the new client to the default session until it requests to join another one: */
+	joinSession(clientId,nvClient,sessions.front());
 	}
 
 void NetworkViewerServer::clientDisconnected(unsigned int clientId)
 	{
-	/* Access the network viewer client state object: */
-	Client* nvClient=server->getPlugin<Client>(clientId,pluginIndex);
-	
-	/* Check if there is a simulator: */
-	if(simulator!=0)
-		{
-		/* Remove the client's potentially remaining active drags: */
-		for(Client::ActiveDragMap::Iterator adIt=nvClient->activeDrags.begin();!adIt.isFinished();++adIt)
-			simulator->dragStop(clientId,adIt->getSource());
-		}
+	/* Remove the client from its session: */
+	leaveSession(clientId,server->getPlugin<Client>(clientId,pluginIndex));
 	
 	/* Call the base class method: */
 	PluginServer::clientDisconnected(clientId);
-	
-	/* Pause the simulator if there is one and this is the last client to disconnect: */
-	if(simulator!=0&&clients.empty())
-		{
-		Misc::logNote("NetworkViewer: Pausing simulation thread");
-		simulator->pause();
-		}
 	}
 
 /***********************
@@ -31,6 +31,7 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Threads/MutexCond.h>
 #include <Threads/TripleBuffer.h>
 #include <Threads/EventDispatcher.h>
+#include <Realtime/Time.h>
 #include <Geometry/OrthonormalTransformation.h>
 #include <Collaboration2/PluginServer.h>
 #include <Collaboration2/Plugins/MetadosisServer.h>
@@ -39,6 +40,10 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include "SimulationParameters.h"
 #include "RenderingParameters.h"
 #include "NetworkViewerProtocol.h"
+#include "SimulationScheduler.h"
+#include "NetworkSimulator.h"
+#include "SessionRecorder.h"
+#include "SessionPlayer.h"
 
 /* Forward declarations: */
 namespace Collab {
@@ -48,7 +53,6 @@ class VruiCoreServer;
 }
 }
 class Network;
-class NetworkSimulator;
 class ParticleSystem;
 
 namespace Collab {
@@ -59,6 +63,15 @@ class NetworkViewerServer:public PluginServer,public NetworkViewerProtocol
 	{
 	/* Embedded classes: */
 	private:
+	struct Session;
+	
+	enum MetricsReport // Enumerated type for the kinds of metrics reports, which measure their reporting periods independently
+		{
+		PeriodicReport=0, // Report written by the periodic metrics timer
+		CommandReport, // Report written by the printMetrics command
+		NumMetricsReports
+		};
+	
 	class Client:public PluginServer::Client // Class representing a client participating in the Network Viewer protocol
 		{
 		friend class NetworkViewerServer;
@@ -70,7 +83,7 @@ class NetworkViewerServer:public PluginServer,public NetworkViewerProtocol
 			/* Elements: */
 			public:
 			unsigned int inputDeviceId; // ID of the input device associated with the dragging operation
-			const VruiCoreProtocol::ClientInputDeviceState* deviceState; // Vrui Core state of the input device
+			const VruiCoreProtocol::ClientInputDeviceState* deviceState; // Vrui Core state of the input device, or null if the client sends drag transformations in navigational space
 			
 			/* Constructors and destructors: */
 			ActiveDrag(unsigned int sInputDeviceId,const VruiCoreProtocol::ClientInputDeviceState* sDeviceState)
@@ -83,8 +96,13 @@ class NetworkViewerServer:public PluginServer,public NetworkViewerProtocol
 		
 		/* Elements: */
 		private:
+		Session* session; // The session in which the client participates
 		unsigned int networkVersion; // Version number of the network that the client currently has
 		ActiveDragMap activeDrags; // Map of active drag operations by drag ID
+		bool datagramUpdates; // Flag whether the client receives simulation updates as unreliable datagrams
+		Misc::UInt32 lastAckedSequence; // Sequence number of the most recent simulation update acknowledged by the client, or 0 if none yet
+		size_t updateBytes; // Total number of simulation update bytes sent to the client
+		size_t reportedUpdateBytes[NumMetricsReports]; // Total numbers of simulation update bytes sent to the client at the times of the most recent metrics reports of each kind
 		
 		/* Constructors and destructors: */
 		Client(void);
@@ -93,37 +111,146 @@ class NetworkViewerServer:public PluginServer,public NetworkViewerProtocol
 	
 	typedef Misc::HashTable<unsigned int,void> NodeSet; // Type to represent sets of nodes
 	
+	struct Session // Structure representing an independent group of clients sharing a network and its simulator
+		{
+		/* Elements: */
+		public:
+		std::string name; // Name of the session; empty for the server's default session
+		ClientIDList clients; // List of IDs of clients participating in the session
+		Version networkVersion; // Version number of the session's current visualized network
+		std::string networkName; // Name of the visualized network
+		MetadosisServer::InStreamPtr networkFile; // The json file from which the visualized network was read, as transferred by the uploading client
+		Misc::UInt8 networkFileEncoding; // Encoding of the transferred network file
+		Network* network; // The visualized network
+		NodeSet labeledNodes; // Set of nodes currently displaying property labels
+		SimulationParameters simulationParameters; // Most recent simulation parameters requested for the network simulator
+		NetworkSimulator* simulator; // Pointer to a simulator for the visualized network
+		RenderingParameters renderingParameters; // Most recent rendering parameters
+		Misc::UInt32 updateSequence; // Sequence number of the most recent simulation update; only accessed from the session's simulation steps
+		volatile unsigned int numDatagramClients; // Number of clients in the session receiving simulation updates as datagrams; polled by the session's simulation steps
+		NetworkSimulator::Statistics lastStatistics[NumMetricsReports]; // Simulator performance counters at the times of the most recent metrics reports of each kind
+		SessionRecorder* recorder; // Recorder writing the session's simulation updates and selection and label changes to a file, or null
+		volatile bool recording; // Flag whether the session is being recorded; polled by the session's simulation steps
+		SessionPlayer* player; // Player replaying a session recording to the session's clients in place of the simulator, or null
+		double replayTime; // Current playback position in the replayed recording in seconds
+		double replaySpeed; // Playback speed relative to the recording's original speed
+		size_t nextReplayEvent; // Index of the next recorded selection or label change to replay
+		
+		/* Constructors and destructors: */
+		Session(const std::string& sName); // Creates an empty session of the given name
+		~Session(void); // Shuts down the session's simulator, recorder, and player and deletes its network
+		};
+	
+	typedef std::vector<Session*> SessionList; // Type for lists of sessions
+	
 	struct ForwardNetworkCompleteCallbackData // Callback data structure when a network file has been completely forwarded to a client
 		{
 		/* Elements: */
 		public:
 		unsigned int clientId; // ID of the client who has received the network file
+		Session* session; // Session whose network was forwarded to the client
 		Version networkVersion; // Version number of the network that was forwarded to the client
 		
 		/* Constructors and destructors: */
-		ForwardNetworkCompleteCallbackData(unsigned int sClientId,Version sNetworkVersion)
-			:clientId(sClientId),networkVersion(sNetworkVersion)
+		ForwardNetworkCompleteCallbackData(unsigned int sClientId,Session* sSession,Version sNetworkVersion)
+			:clientId(sClientId),session(sSession),networkVersion(sNetworkVersion)
+			{
+			}
+		};
+	
+	struct SimulationUpdate // Structure holding the messages for a simulation update, handed from the simulation thread to the frontend
+		{
+		/* Elements: */
+		public:
+		Session* session; // Session whose simulator produced the update
+		Misc::UInt32 sequenceNumber; // Sequence number of the simulation update
+		MessageBuffer* message; // Complete simulation update message for delivery over TCP
+		size_t messageSize; // Size of the complete simulation update message in bytes
+		std::vector<MessageBuffer*> chunks; // Independently decodable chunk messages for delivery as datagrams, or empty
+		size_t chunksSize; // Total size of all chunk messages in bytes
+		SessionRecorder::RPointList positions; // Node positions of the update for the session's recorder, or empty if the session is not being recorded
+		
+		/* Constructors and destructors: */
+		SimulationUpdate(Session* sSession,Misc::UInt32 sSequenceNumber,MessageBuffer* sMessage,size_t sMessageSize)
+			:session(sSession),sequenceNumber(sSequenceNumber),message(sMessage),messageSize(sMessageSize),chunksSize(0)
+			{
+			}
+		~SimulationUpdate(void)
+			{
+			/* Release all message buffers: */
+			message->unref();
+			for(std::vector<MessageBuffer*>::iterator cIt=chunks.begin();cIt!=chunks.end();++cIt)
+				(*cIt)->unref();
+			}
+		};
+	
+	struct SelectRegionCallbackData // Callback data structure when the network simulator has resolved a region selection request
+		{
+		/* Elements: */
+		public:
+		Session* session; // Session to whose network the request applied
+		Version networkVersion; // Version number of the network to which the request applied
+		Misc::UInt8 mode; // Selection mode of the request
+		
+		/* Constructors and destructors: */
+		SelectRegionCallbackData(Session* sSession,Version sNetworkVersion,Misc::UInt8 sMode)
+			:session(sSession),networkVersion(sNetworkVersion),mode(sMode)
+			{
+			}
+		};
+	
+	struct SessionMessage // Structure holding a message to be sent to all clients of a session, handed from a simulation step to the frontend
+		{
+		/* Elements: */
+		public:
+		Session* session; // Session to whose clients to send the message
+		MessageBuffer* message; // The message
+		bool record; // Flag whether the message's change should be recorded by the session's recorder
+		std::vector<Index> nodes; // Sorted set of nodes affected by the message for the session's recorder
+		Misc::UInt8 mode; // Selection mode of the message for the session's recorder
+		
+		/* Constructors and destructors: */
+		SessionMessage(Session* sSession,MessageBuffer* sMessage)
+			:session(sSession),message(sMessage),record(false),mode(0)
+			{
+			}
+		~SessionMessage(void)
 			{
+			/* Release the message buffer: */
+			message->unref();
 			}
 		};
 	
 	/* Elements: */
+	static const Misc::UInt32 maxUnackedUpdates=64; // Number of simulation updates a datagram client may fall behind in acknowledgments before it is switched back to TCP
 	MetadosisServer* metadosis; // Pointer to the Metadosis server plug-in
 	VruiCoreServer* vruiCore; // Pointer to the Vrui Core server plug-in
 	Threads::EventDispatcher::ListenerKey readNetworkJobCompleteSignalKey; // Event key to signal that a network file has been complete read in a background worker thread
 	Threads::EventDispatcher::ListenerKey simulationUpdateSignalKey; // Event key to signal that a simulation update message is ready to broadcast
-	Version networkVersion; // Version number of the current visualized network
-	std::string networkName; // Name of the visualized network
-	MetadosisServer::InStreamPtr networkFile; // The json file from which the visualized network was read
-	Network* network; // The visualized network
-	NodeSet labeledNodes; // Set of nodes currently displaying property labels
-	SimulationParameters simulationParameters; // Most recent simulation parameters requested for the network simulator
-	unsigned int numWorkerThreads; // Number of additional worker threads to use for network simulation
-	NetworkSimulator* simulator; // Pointer to a simulator for the visualized network
-	RenderingParameters renderingParameters; // Most recent rendering parameters
+	Threads::EventDispatcher::ListenerKey selectRegionSignalKey; // Event key to signal that a select region notification message is ready to broadcast
+	SimulationScheduler scheduler; // Scheduler running the simulators of all sessions on a shared thread pool
+	SessionList sessions; // List of all sessions created since the server started; the first session is the default session, and other sessions only keep their networks while they have clients
+	unsigned int metricsInterval; // Interval between periodic metrics reports in seconds, or 0 if periodic reports are disabled
+	bool metricsTimerActive; // Flag whether the periodic metrics report timer is registered with the server's event dispatcher
+	Threads::EventDispatcher::ListenerKey metricsTimerKey; // Event key of the periodic metrics report timer
+	bool logMetrics; // Flag whether periodic metrics reports are written to the log
+	std::string metricsFileName; // Name of a file to which periodic metrics reports are written in Prometheus text format, or empty
+	Realtime::TimePointMonotonic lastMetricsTimes[NumMetricsReports]; // Times of the most recent metrics reports of each kind
+	double qualityInterval; // Interval between layout quality measurements in all sessions' simulators in seconds, or 0 if layout quality is not measured
+	NetworkSimulator::DraggedPositionList draggedPositions; // Buffer for positions of dragged particles sent ahead of simulation updates
+	bool replayTimerActive; // Flag whether the session replay timer is registered with the server's event dispatcher
+	Threads::EventDispatcher::ListenerKey replayTimerKey; // Event key of the session replay timer
+	Realtime::TimePointMonotonic lastReplayTime; // Time of the most recent session replay timer event
 	
 	/* Private methods: */
+	Session* findSession(const std::string& name); // Returns the session of the given name, or null if none exists
+	Session* getSession(const std::string& name); // Returns the session of the given name; creates a new session if none exists
+	void broadcastToSession(Session* session,unsigned int exceptClientId,MessageBuffer* message); // Sends the given message to all clients in the given session except the given one; 0 sends to all clients
+	void joinSession(unsigned int clientId,Client* nvClient,Session* session); // Adds the given client to the given session and sends it the session's current state
+	void leaveSession(unsigned int clientId,Client* nvClient); // Removes the given client from its current session; releases the session's resources if it is not the default session and the client was the last to leave
+	void releaseSession(Session* session); // Stops recording and replaying the given session and deletes its simulator and network
 	void readNetworkJobCompleteCallback(Threads::EventDispatcher::SignalEvent& event); // Callback called when a network has been read from a network file in a background worker thread
+	void sendNodeSets(Session* session,Server::Client* client); // Sends the session's complete sets of selected and labeled nodes to the given client
 	void forwardNetworkCompleteCallback(MetadosisProtocol::StreamID streamId,ForwardNetworkCompleteCallbackData cbData); // Callback called when a client has completely received a forwarded network file
 	MessageContinuation* loadNetworkRequestCallback(unsigned int messageId,unsigned int clientId,MessageContinuation* continuation);
 	MessageContinuation* setSimulationParametersRequestCallback(unsigned int messageId,unsigned int clientId,MessageContinuation* continuation);
@@ -133,10 +260,45 @@ class NetworkViewerServer:public PluginServer,public NetworkViewerProtocol
 	MessageContinuation* displayLabelRequestCallback(unsigned int messageId,unsigned int clientId,MessageContinuation* continuation);
 	MessageContinuation* dragStartRequestCallback(unsigned int messageId,unsigned int clientId,MessageContinuation* continuation);
 	MessageContinuation* dragRequestCallback(unsigned int messageId,unsigned int clientId,MessageContinuation* continuation);
+	MessageContinuation* navDragStartRequestCallback(unsigned int messageId,unsigned int clientId,MessageContinuation* continuation);
+	MessageContinuation* navDragRequestCallback(unsigned int messageId,unsigned int clientId,MessageContinuation* continuation);
+	void sendDragDelta(Session* session,unsigned int exceptClientId,unsigned int clientId,unsigned int dragId,const NetworkSimulator::DraggedPositionList& positions); // Sends the positions of the nodes dragged by the given dragging operation to all clients in the given session except the given one; empty position list indicates the end of the dragging operation
 	MessageContinuation* dragStopRequestCallback(unsigned int messageId,unsigned int clientId,MessageContinuation* continuation);
-	void simulationUpdateCallback(const ParticleSystem& particles); // Callback called from the background simulation thread if a simulation update should be sent to clients
+	MessageContinuation* selectRegionRequestCallback(unsigned int messageId,unsigned int clientId,MessageContinuation* continuation);
+	MessageContinuation* datagramUpdatesRequestCallback(unsigned int messageId,unsigned int clientId,MessageContinuation* continuation);
+	MessageContinuation* datagramUpdateAckCallback(unsigned int messageId,unsigned int clientId,MessageContinuation* continuation);
+	MessageContinuation* joinSessionRequestCallback(unsigned int messageId,unsigned int clientId,MessageContinuation* continuation);
+	void selectRegionCompleteCallback(const std::vector<Index>& nodeIndices,SelectRegionCallbackData cbData); // Callback called from a simulation step when a region selection has been resolved
+	void sendSelectRegionNotificationCallback(Threads::EventDispatcher::SignalEvent& event); // Callback called in the frontend when a select region notification should be sent to clients
+	template <class PointParam>
+	SimulationUpdate* createSimulationUpdate(Session* session,Index numParticles,const PointParam* positions); // Creates the messages for a simulation update of the given session containing the given particle positions
+	void simulationUpdateCallback(const ParticleSystem& particles,Session* session); // Callback called from a simulation step of the given session if a simulation update should be sent to the session's clients
+	void sendSimulationUpdate(SimulationUpdate* update); // Sends the given simulation update to all clients in its session and releases it
 	void sendSimulationUpdateCallback(Threads::EventDispatcher::SignalEvent& event); // Callback called in the frontend when a simulation update should be sent to clients
 	void loadNetworkCommandCallback(const char* argumentBegin,const char* argumentEnd);
+	void reportMetrics(MetricsReport report,bool writeLog,const char* fileName); // Writes a metrics report covering the time since the previous report of the same kind to the log and/or a Prometheus text file of the given name
+	bool metricsTimerCallback(Threads::EventDispatcher::TimerEvent& event); // Callback called periodically to write metrics reports
+	void updateMetricsTimer(void); // Registers or unregisters the periodic metrics report timer based on current settings
+	void printMetricsCommandCallback(const char* argumentBegin,const char* argumentEnd);
+	void setMetricsIntervalCommandCallback(const char* argumentBegin,const char* argumentEnd);
+	void setMetricsLogCommandCallback(const char* argumentBegin,const char* argumentEnd);
+	void setMetricsFileCommandCallback(const char* argumentBegin,const char* argumentEnd);
+	void setQualityIntervalCommandCallback(const char* argumentBegin,const char* argumentEnd);
+	void startTraceCommandCallback(const char* argumentBegin,const char* argumentEnd);
+	void stopTraceCommandCallback(const char* argumentBegin,const char* argumentEnd);
+	void stopRecording(Session* session); // Finishes the given session's recording
+	void stopReplay(Session* session); // Stops replaying a recording to the given session's clients and resumes its simulator
+	void applyReplayEvent(Session* session,const SessionPlayer::Event& event,bool notify); // Applies a recorded selection or label change to the given session, and notifies the session's clients if the flag is true
+	void seekReplay(Session* session,double time); // Moves the given session's replay to the given playback position and sends the resulting state to the session's clients
+	bool replayTimerCallback(Threads::EventDispatcher::TimerEvent& event); // Callback called periodically to advance all session replays
+	void updateReplayTimer(void); // Registers or unregisters the session replay timer based on whether any session is replaying a recording
+	Session* parseSessionCommand(const char* argumentBegin,const char* argumentEnd,std::string& argument,const char* commandName); // Splits a pipe command's arguments into a first argument and an optional session name, and returns the named session or null if it does not exist
+	void startRecordingCommandCallback(const char* argumentBegin,const char* argumentEnd);
+	void stopRecordingCommandCallback(const char* argumentBegin,const char* argumentEnd);
+	void startReplayCommandCallback(const char* argumentBegin,const char* argumentEnd);
+	void stopReplayCommandCallback(const char* argumentBegin,const char* argumentEnd);
+	void setReplaySpeedCommandCallback(const char* argumentBegin,const char* argumentEnd);
+	void seekReplayCommandCallback(const char* argumentBegin,const char* argumentEnd);
 	
 	/* Constructors and destructors: */
 	public:
@@ -23,13 +23,14 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include "NetworkViewerTool.h"
 
 #include <Geometry/OrthogonalTransformation.h>
-#include <Geometry/PointPicker.h>
-#include <Geometry/RayPicker.h>
 #include <Vrui/Vrui.h>
 #include <Vrui/ToolManager.h>
 
 #include "Node.h"
 #include "Network.h"
+#include "SphereBVH.icpp"
+#include "PointSpherePicker.h"
+#include "RaySpherePicker.h"
 
 /********************************************
 Static elements of class NetworkViewer::Tool:
@@ -45,19 +46,23 @@ unsigned int NetworkViewer::Tool::pickNode(int buttonSlotIndex)
 	{
 	unsigned int result=~0x0U;
 	
+	/* Get the node hierarchy updated for the current particle positions: */
+	const SphereBVH& nodeBVH=application->getNodeBVH();
+	const NetworkViewer::NodePositionList& positions=application->getNodePositions();
+	
 	/* Check whether the tool is position-based or ray-based: */
 	if(getButtonDevice(buttonSlotIndex)->is6DOFDevice())
 		{
 		/* Issue a point pick request against all nodes: */
 		Point pickPoint(Vrui::getInverseNavigationTransformation().transform(getButtonDevicePosition(buttonSlotIndex)));
 		Scalar pickDist(Vrui::getPointPickDistance());
-		Geometry::PointPicker<Scalar,3> picker(pickPoint,pickDist);
-		const Network::NodeList& nodes=application->network->getNodes();
-		for(Network::NodeList::const_iterator nIt=nodes.begin();nIt!=nodes.end();++nIt)
-			picker(application->particles.getParticlePosition(nIt->getParticleIndex()));
+		PointSpherePicker picker(pickPoint,pickDist);
+		
+		/* Pick nodes as points, skipping hierarchy nodes that are too far away: */
+		nodeBVH.processSpheres(positions,std::vector<Scalar>(),picker);
 		
 		/* Check if a node was picked: */
-		if(picker.havePickedPoint())
+		if(picker.havePickedSphere())
 			{
 			/* Remember the picked node's index: */
 			result=picker.getPickIndex();
@@ -69,19 +74,20 @@ unsigned int NetworkViewer::Tool::pickNode(int buttonSlotIndex)
 		pickRay=getButtonDeviceRay(buttonSlotIndex);
 		pickRay.transform(Vrui::getInverseNavigationTransformation());
 		Scalar maxPickCos(Vrui::getRayPickCosine());
-		Geometry::RayPicker<Scalar,3> picker(Geometry::RayPicker<Scalar,3>::Ray(pickRay),maxPickCos);
-		const Network::NodeList& nodes=application->network->getNodes();
-		for(Network::NodeList::const_iterator nIt=nodes.begin();nIt!=nodes.end();++nIt)
-			picker(application->particles.getParticlePosition(nIt->getParticleIndex()));
+		RaySpherePicker picker(pickRay,maxPickCos);
+		
+		/* Pick nodes as points, skipping hierarchy nodes that are too far away: */
+		nodeBVH.processSpheres(positions,std::vector<Scalar>(),picker);
 		
 		/* Check if a node was picked: */
-		if(picker.havePickedPoint())
+		if(picker.havePickedSphere())
 			{
 			/* Remember the picked node's index: */
 			result=picker.getPickIndex();
 			
 			/* Remember the picked node's selection ray parameter: */
-			pickRayLambda=picker.getLambda();
+			const Vrui::Vector& d=pickRay.getDirection();
+			pickRayLambda=Scalar((d*(Vrui::Point(positions[result])-pickRay.getOrigin()))/d.sqr());
 			}
 		}
 	
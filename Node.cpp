@@ -86,6 +86,14 @@ Node::Node(JsonMapPointer jsonMap,Index sParticleIndex)
 		}
 	}
 
+Node::Node(const std::string& sId,Index sParticleIndex)
+	:id(sId),
+	 size(1),
+	 color(128U,128U,128U),
+	 particleIndex(sParticleIndex)
+	{
+	}
+
 void Node::createParticle(ParticleSystem& particles,Scalar domainSize)
 	{
 	/* Create a particle at a random position inside the domain: */
@@ -50,6 +50,7 @@ class Node
 	/* Constructors and destructors: */
 	public:
 	Node(JsonMapPointer jsonMap,Index sParticleIndex =-1); // Creates a node from a json entity with name/value pairs
+	Node(const std::string& sId,Index sParticleIndex); // Creates a node of the given ID with default size and color
 	
 	/* Methods: */
 	void createParticle(ParticleSystem& particles,Scalar domainSize); // Adds a particle representing the node to the given particle system
@@ -77,6 +78,10 @@ class Node
 		{
 		return linkedNodes;
 		}
+	size_t getMemorySize(void) const // Returns an estimate of the memory used by the node in bytes
+		{
+		return sizeof(Node)+id.capacity()+linkedNodes.capacity()*sizeof(Node*);
+		}
 	};
 
 #endif
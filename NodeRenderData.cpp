@@ -0,0 +1,38 @@
+/***********************************************************************
+NodeRenderData - Class to prepare render-ready per-node data of a
+visualized network independently of any display: node radii, a sphere
+hierarchy for picking and culling, interleaved node vertices, and the
+set of node labels closest to a viewer.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include "NodeRenderData.h"
+
+/*******************************
+Methods of class NodeRenderData:
+*******************************/
+
+NodeRenderData::NodeRenderData(SimulationScheduler* sScheduler)
+	:scheduler(sScheduler),
+	 nodeRadiiVersion(0),
+	 nodeBVHPositionVersion(0),nodeBVHRadiiVersion(0),
+	 nodeVerticesPositionVersion(0),nodeVerticesRadiiVersion(0),nodeVerticesColorVersion(0),nodeVerticesVersion(0),
+	 nodeVerticesChangedBegin(0),nodeVerticesChangedEnd(0)
+	{
+	}
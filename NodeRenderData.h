@@ -0,0 +1,105 @@
+/***********************************************************************
+NodeRenderData - Class to prepare render-ready per-node data of a
+visualized network independently of any display: node radii, a sphere
+hierarchy for picking and culling, interleaved node vertices, and the
+set of node labels closest to a viewer.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef NODERENDERDATA_INCLUDED
+#define NODERENDERDATA_INCLUDED
+
+#include <utility>
+#include <vector>
+#include <GL/gl.h>
+#include <GL/GLGeometryVertex.h>
+
+#include "ParticleTypes.h"
+#include "SphereBVH.h"
+
+/* Forward declarations: */
+class SimulationScheduler;
+struct RenderingParameters;
+
+class NodeRenderData
+	{
+	/* Embedded classes: */
+	public:
+	typedef GLGeometry::Vertex<void,0,GLubyte,4,void,GLfloat,4> Vertex; // Type for interleaved node vertices
+	typedef std::pair<double,unsigned int> NodeDistance; // Type for pairs of squared node distances and node indices
+	
+	/* Elements: */
+	private:
+	SimulationScheduler* scheduler; // Thread pool to prepare node vertices in parallel
+	std::vector<Scalar> nodeRadii; // Radii of all nodes of the visualized network based on current rendering settings
+	unsigned int nodeRadiiVersion; // Version number of the node radius array
+	SphereBVH nodeBVH; // Bounding volume hierarchy of node spheres to accelerate picking, snapping, and culling
+	unsigned int nodeBVHPositionVersion; // Version number of the position array reflected in the node hierarchy
+	unsigned int nodeBVHRadiiVersion; // Version number of the node radius array reflected in the node hierarchy
+	std::vector<Vertex> nodeVertices; // Interleaved node vertices prepared once per position update for upload into all OpenGL contexts
+	unsigned int nodeVerticesPositionVersion; // Version number of the position array reflected in the node vertex array
+	unsigned int nodeVerticesRadiiVersion; // Version number of the node radius array reflected in the node vertex array
+	unsigned int nodeVerticesColorVersion; // Version number of the network's node color array reflected in the node vertex array
+	unsigned int nodeVerticesVersion; // Version number of the node vertex array
+	Index nodeVerticesChangedBegin,nodeVerticesChangedEnd; // Half-open range of node vertices changed by the most recent update of the node vertex array
+	
+	/* Constructors and destructors: */
+	public:
+	NodeRenderData(SimulationScheduler* sScheduler); // Creates empty render data using the given thread pool
+	
+	/* Methods: */
+	template <class NetworkParam>
+	void updateNodeRadii(NetworkParam* network,const RenderingParameters& renderingParameters); // Recalculates the radii of all nodes of the given network, or removes all radii if the network is null
+	const std::vector<Scalar>& getNodeRadii(void) const // Returns the radii of all nodes
+		{
+		return nodeRadii;
+		}
+	Scalar getNodeRadius(unsigned int nodeIndex) const // Returns the radius of the given node
+		{
+		return nodeRadii[nodeIndex];
+		}
+	template <class PointListParam>
+	const SphereBVH& updateNodeBVH(const PointListParam& points,unsigned int positionVersion,bool valid); // Returns the node sphere hierarchy updated for the given list of node positions of the given version; flag indicates whether the positions belong to the network whose node radii were calculated
+	const SphereBVH& getNodeBVH(void) const // Returns the node sphere hierarchy as of its most recent update
+		{
+		return nodeBVH;
+		}
+	template <class NetworkParam,class PointListParam>
+	void updateNodeVertices(const NetworkParam* network,const PointListParam& points,unsigned int positionVersion,const RenderingParameters& renderingParameters); // Prepares the interleaved node vertex array for the given list of node positions of the given version and the given network's node colors; network is null if the positions do not belong to it
+	const std::vector<Vertex>& getNodeVertices(void) const // Returns the interleaved node vertex array
+		{
+		return nodeVertices;
+		}
+	unsigned int getNodeVerticesVersion(void) const // Returns the version number of the node vertex array
+		{
+		return nodeVerticesVersion;
+		}
+	Index getNodeVerticesChangedBegin(void) const // Returns the index of the first node vertex changed by the most recent update
+		{
+		return nodeVerticesChangedBegin;
+		}
+	Index getNodeVerticesChangedEnd(void) const // Returns the index after the last node vertex changed by the most recent update
+		{
+		return nodeVerticesChangedEnd;
+		}
+	template <class PointListParam,class TransformParam,class ViewerPointParam>
+	static void selectClosestNodes(const PointListParam& points,const std::vector<unsigned int>& nodeIndices,const TransformParam& transform,const ViewerPointParam& viewerPos,double maxDistance,size_t maxNumNodes,std::vector<NodeDistance>& closestNodes); // Replaces the given list with at most the given number of the given nodes closest to the given viewer position after transforming them with the given transformation, ignoring nodes farther away than the given distance
+	};
+
+#endif
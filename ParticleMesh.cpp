@@ -28,6 +28,101 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <GL/GLContextData.h>
 #include <GL/Extensions/GLARBVertexBufferObject.h>
 
+#include "SimulationScheduler.h"
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+class TriangleNormalLoop:public SimulationScheduler::ParallelFunction // Loop body calculating area-weighted normal vectors for ranges of triangles
+	{
+	/* Elements: */
+	private:
+	const ParticleSystem& particleSystem; // Particle system holding the interpolated vertex positions
+	const Index* vertexIndices; // Particle indices of mesh vertices
+	const GLuint* triangleVertexIndices; // Vertex indices of mesh triangles
+	Vector* triangleNormals; // Triangle normal array to write
+	
+	/* Constructors and destructors: */
+	public:
+	TriangleNormalLoop(const ParticleSystem& sParticleSystem,const Index* sVertexIndices,const GLuint* sTriangleVertexIndices,Vector* sTriangleNormals)
+		:particleSystem(sParticleSystem),vertexIndices(sVertexIndices),triangleVertexIndices(sTriangleVertexIndices),triangleNormals(sTriangleNormals)
+		{
+		}
+	
+	/* Methods from class SimulationScheduler::ParallelFunction: */
+	virtual void operator()(Index begin,Index end)
+		{
+		const GLuint* tviPtr=triangleVertexIndices+begin*3;
+		for(Index triangleIndex=begin;triangleIndex<end;++triangleIndex,tviPtr+=3)
+			{
+			/* Get the current positions of the triangle's three vertices from the particle system: */
+			const Point& v0=particleSystem.getRenderPosition(vertexIndices[tviPtr[0]]);
+			const Point& v1=particleSystem.getRenderPosition(vertexIndices[tviPtr[1]]);
+			const Point& v2=particleSystem.getRenderPosition(vertexIndices[tviPtr[2]]);
+			
+			/* Calculate the triangle's normal vector, scaled by the triangle's area: */
+			triangleNormals[triangleIndex]=(v1-v0)^(v2-v0);
+			}
+		}
+	};
+
+template <class VertexParam>
+class MeshVertexLoop:public SimulationScheduler::ParallelFunction // Loop body gathering normal vectors and writing interleaved vertices for ranges of mesh vertices
+	{
+	/* Elements: */
+	private:
+	const ParticleSystem& particleSystem; // Particle system holding the interpolated vertex positions
+	const Index* vertexIndices; // Particle indices of mesh vertices
+	const Index* vertexTriangleOffsets; // Offsets of each vertex's list of incident triangles
+	const Index* vertexTriangles; // Concatenated lists of triangles incident on each vertex
+	const Vector* triangleNormals; // Area-weighted triangle normal vectors
+	VertexParam* vertices; // Vertex array to write
+	
+	/* Constructors and destructors: */
+	public:
+	MeshVertexLoop(const ParticleSystem& sParticleSystem,const Index* sVertexIndices,const Index* sVertexTriangleOffsets,const Index* sVertexTriangles,const Vector* sTriangleNormals,VertexParam* sVertices)
+		:particleSystem(sParticleSystem),vertexIndices(sVertexIndices),
+		 vertexTriangleOffsets(sVertexTriangleOffsets),vertexTriangles(sVertexTriangles),triangleNormals(sTriangleNormals),
+		 vertices(sVertices)
+		{
+		}
+	
+	/* Methods from class SimulationScheduler::ParallelFunction: */
+	virtual void operator()(Index begin,Index end)
+		{
+		VertexParam* vPtr=vertices+begin;
+		for(Index vertexIndex=begin;vertexIndex<end;++vertexIndex,++vPtr)
+			{
+			/* Add the normal vectors of all triangles incident on the vertex: */
+			Vector normal=Vector::zero;
+			const Index* vtEnd=vertexTriangles+vertexTriangleOffsets[vertexIndex+1];
+			for(const Index* vtPtr=vertexTriangles+vertexTriangleOffsets[vertexIndex];vtPtr!=vtEnd;++vtPtr)
+				normal+=triangleNormals[*vtPtr];
+			vPtr->normal=normal;
+			
+			/* Copy the vertex's position from the particle system: */
+			vPtr->position=particleSystem.getRenderPosition(vertexIndices[vertexIndex]);
+			}
+		}
+	};
+
+/****************
+Helper functions:
+****************/
+
+inline void runLoop(SimulationScheduler* scheduler,Index numItems,SimulationScheduler::ParallelFunction& function) // Runs a loop using the given thread pool, or in the calling thread if the pool is null
+	{
+	if(scheduler!=0)
+		scheduler->parallelFor(numItems,function);
+	else if(numItems>0)
+		function(0,numItems);
+	}
+
+}
+
 /***************************************
 Methods of class ParticleMesh::DataItem:
 ***************************************/
@@ -55,8 +150,9 @@ ParticleMesh::DataItem::~DataItem(void)
 Methods of class ParticleMesh:
 *****************************/
 
-ParticleMesh::ParticleMesh(const ParticleSystem& sParticleSystem)
-	:particleSystem(sParticleSystem),
+ParticleMesh::ParticleMesh(const ParticleSystem& sParticleSystem,SimulationScheduler* sScheduler)
+	:particleSystem(sParticleSystem),scheduler(sScheduler),
+	 vertexTrianglesValid(false),
 	 vertexVersion(0),
 	 twoSided(false)
 	{
@@ -83,26 +179,53 @@ void ParticleMesh::initContext(GLContextData& contextData) const
 	glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,0);
 	}
 
+void ParticleMesh::updateVertexTriangles(void)
+	{
+	/* Count the number of triangles incident on each vertex: */
+	Index numVertices=Index(vertexIndices.size());
+	vertexTriangleOffsets.assign(numVertices+1,0);
+	for(std::vector<GLuint>::iterator tviIt=triangleVertexIndices.begin();tviIt!=triangleVertexIndices.end();++tviIt)
+		++vertexTriangleOffsets[*tviIt+1];
+	
+	/* Convert the counts into offsets into the incident triangle array: */
+	for(Index vertexIndex=0;vertexIndex<numVertices;++vertexIndex)
+		vertexTriangleOffsets[vertexIndex+1]+=vertexTriangleOffsets[vertexIndex];
+	
+	/* Enter each triangle into the lists of its three vertices: */
+	vertexTriangles.resize(vertexTriangleOffsets[numVertices]);
+	std::vector<Index> insertOffsets(vertexTriangleOffsets.begin(),vertexTriangleOffsets.end()-1);
+	Index numTriangles=Index(triangleVertexIndices.size()/3);
+	for(Index triangleIndex=0;triangleIndex<numTriangles;++triangleIndex)
+		for(int i=0;i<3;++i)
+			vertexTriangles[insertOffsets[triangleVertexIndices[triangleIndex*3+i]]++]=triangleIndex;
+	
+	/* Prepare the per-triangle normal vector and interleaved vertex arrays: */
+	triangleNormals.resize(numTriangles);
+	vertices.resize(numVertices);
+	
+	vertexTrianglesValid=true;
+	}
+
 void ParticleMesh::update(void)
 	{
-	/* Re-calculate per-vertex normal vectors: */
-	for(std::vector<Vector>::iterator vnIt=vertexNormals.begin();vnIt!=vertexNormals.end();++vnIt)
-		*vnIt=Vector::zero;
+	/* Re-create the vertex-to-triangle lists if the mesh topology changed: */
+	if(!vertexTrianglesValid)
+		updateVertexTriangles();
 	
-	/* Calculate the normal vectors of all triangles and accumulate them into the per-vertex normal array: */
-	for(std::vector<GLuint>::iterator tviIt=triangleVertexIndices.begin();tviIt!=triangleVertexIndices.end();tviIt+=3)
+	/* Calculate the area-weighted normal vectors of all triangles in parallel: */
+	Index numTriangles=Index(triangleNormals.size());
+	if(numTriangles>0)
 		{
-		/* Get the current positions of the triangle's three vertices from the particle system: */
-		const Point& v0=particleSystem.getParticlePosition(vertexIndices[tviIt[0]]);
-		const Point& v1=particleSystem.getParticlePosition(vertexIndices[tviIt[1]]);
-		const Point& v2=particleSystem.getParticlePosition(vertexIndices[tviIt[2]]);
-		
-		/* Calculate the triangle's normal vector, scaled by the triangle's area: */
-		Vector normal=(v1-v0)^(v2-v0);
-		
-		/* Add the scaled normal vector to the three vertices' per-vertex normal vectors: */
-		for(int i=0;i<3;++i)
-			vertexNormals[tviIt[i]]+=normal;
+		TriangleNormalLoop tnl(particleSystem,&vertexIndices.front(),&triangleVertexIndices.front(),&triangleNormals.front());
+		runLoop(scheduler,numTriangles,tnl);
+		}
+	
+	/* Gather the normal vectors of each vertex's incident triangles and write interleaved vertices in the same parallel pass: */
+	Index numVertices=Index(vertices.size());
+	if(numVertices>0)
+		{
+		MeshVertexLoop<Vertex> mvl(particleSystem,&vertexIndices.front(),&vertexTriangleOffsets.front(),vertexTriangles.empty()?0:&vertexTriangles.front(),numTriangles>0?&triangleNormals.front():0,&vertices.front());
+		runLoop(scheduler,numVertices,mvl);
 		}
 	
 	/* Invalidate the vertex buffer object: */
@@ -140,18 +263,9 @@ void ParticleMesh::glRenderAction(GLContextData& contextData) const
 	/* Check if the vertex buffer is outdated: */
 	if(dataItem->vertexVersion!=vertexVersion)
 		{
-		/* Copy current vertex positions and normal vectors into the buffer: */
-		Vertex* vPtr=static_cast<Vertex*>(glMapBufferARB(GL_ARRAY_BUFFER_ARB,GL_WRITE_ONLY));
-		std::vector<Vector>::const_iterator vnIt=vertexNormals.begin();
-		for(std::vector<Index>::const_iterator viIt=vertexIndices.begin();viIt!=vertexIndices.end();++viIt,++vnIt,++vPtr)
-			{
-			/* Copy the vertex's normal vector: */
-			vPtr->normal=*vnIt;
-			
-			/* Copy the vertex's position from the particle system: */
-			vPtr->position=particleSystem.getParticlePosition(*viIt);
-			}
-		glUnmapBufferARB(GL_ARRAY_BUFFER_ARB);
+		/* Upload the interleaved vertices prepared by the most recent update into the buffer: */
+		if(vertices.size()==vertexIndices.size()&&!vertices.empty())
+			glBufferSubDataARB(GL_ARRAY_BUFFER_ARB,0,vertices.size()*sizeof(Vertex),&vertices.front());
 		
 		/* Mark the vertex buffer as up-to-date: */
 		dataItem->vertexVersion=vertexVersion;
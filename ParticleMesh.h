@@ -31,6 +31,9 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include "ParticleSystem.h"
 
+/* Forward declarations: */
+class SimulationScheduler;
+
 class ParticleMesh:public GLObject
 	{
 	private:
@@ -52,9 +55,14 @@ class ParticleMesh:public GLObject
 	/* Elements: */
 	private:
 	const ParticleSystem& particleSystem; // Reference to the particle system controlling the mesh vertices
+	SimulationScheduler* scheduler; // Thread pool to update the mesh in parallel, or null to update it in the calling thread
 	std::vector<Index> vertexIndices; // List of indices of particles used as mesh vertices
 	std::vector<GLuint> triangleVertexIndices; // List of indices of vertices in the vertexIndices list defining mesh triangles
-	std::vector<Vector> vertexNormals; // List of per-vertex normal vectors
+	bool vertexTrianglesValid; // Flag whether the vertex-to-triangle lists reflect the current mesh topology
+	std::vector<Index> vertexTriangleOffsets; // Offsets of each vertex's list of incident triangles in the vertexTriangles array, followed by the total number of incidences
+	std::vector<Index> vertexTriangles; // Concatenated lists of the indices of triangles incident on each vertex
+	std::vector<Vector> triangleNormals; // List of area-weighted per-triangle normal vectors
+	std::vector<Vertex> vertices; // List of interleaved mesh vertices prepared once per update for upload into all OpenGL contexts
 	unsigned int vertexVersion; // Version number of mesh vertices
 	GLMaterial frontMaterial; // Rendering material properties for front faces
 	bool twoSided; // Flag whether this mesh is rendered from both sides
@@ -62,34 +70,41 @@ class ParticleMesh:public GLObject
 	
 	/* Constructors and destructors: */
 	public:
-	ParticleMesh(const ParticleSystem& sParticleSystem); // Creates an empty particle mesh using particles from the given particle system
+	ParticleMesh(const ParticleSystem& sParticleSystem,SimulationScheduler* sScheduler =0); // Creates an empty particle mesh using particles from the given particle system, updated by the given optional thread pool
 	~ParticleMesh(void); // Destroys the particle mesh
 	
 	/* Methods from class GLObject: */
 	virtual void initContext(GLContextData& contextData) const;
 	
+	/* Private methods: */
+	private:
+	void updateVertexTriangles(void); // Re-creates the lists of triangles incident on each vertex from the current mesh topology
+	
 	/* New methods: */
+	public:
 	void addVertex(Index newIndex) // Adds a new vertex to the mesh
 		{
 		vertexIndices.push_back(newIndex);
-		vertexNormals.push_back(Vector::zero);
+		vertexTrianglesValid=false;
 		}
 	void addTriangle(GLuint index0,GLuint index1,GLuint index2) // Adds a new triangle to the mesh
 		{
 		triangleVertexIndices.push_back(index0);
 		triangleVertexIndices.push_back(index1);
 		triangleVertexIndices.push_back(index2);
+		vertexTrianglesValid=false;
 		}
 	void addTriangle(const GLuint indices[3]) // Ditto
 		{
 		for(int i=0;i<3;++i)
 			triangleVertexIndices.push_back(indices[i]);
+		vertexTrianglesValid=false;
 		}
 	Index getVertexIndex(unsigned int index) const // Returns the particle index of the mesh vertex of the given index
 		{
 		return vertexIndices[index];
 		}
-	void update(void); // Updates the mesh with new particle positions from the given particle system
+	void update(void); // Updates the mesh's per-vertex normal vectors and interleaved vertices with the particle system's interpolated render positions
 	void setFrontMaterial(const GLMaterial& newFrontMaterial); // Sets the mesh's front face material
 	void setBackMaterial(const GLMaterial& newBackMaterial); // Sets the mesh's back face material and enables two-sided rendering
 	void glRenderAction(GLContextData& contextData) const; // Renders the particle mesh into the given OpenGL context
@@ -37,13 +37,6 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <iostream>
 #endif
 
-#define TESTING 0
-#if TESTING
-#include <iostream>
-#include <Realtime/Time.h>
-double totalTreeUpdateTime=0.0;
-#endif
-
 /*********************************************
 Static elements of class ParticleOctree::Node:
 *********************************************/
@@ -311,6 +304,26 @@ void ParticleOctree::Node::checkTree(const ParticleSystem& particles) const
 
 #endif
 
+void ParticleOctree::Node::accumulateStatistics(unsigned int level,unsigned int& depth,size_t& numNodes,size_t& numLeaves) const
+	{
+	++numNodes;
+	
+	/* Check if this node is an interior node: */
+	if(numParticles>maxParticlesPerNode)
+		{
+		/* Recurse into the children: */
+		for(int childIndex=0;childIndex<8;++childIndex)
+			children[childIndex].accumulateStatistics(level+1,depth,numNodes,numLeaves);
+		}
+	else
+		{
+		/* Count this leaf and update the maximum leaf depth: */
+		++numLeaves;
+		if(depth<level)
+			depth=level;
+		}
+	}
+
 void ParticleOctree::Node::glRenderAction(void) const
 	{
 	/* Check if this node is an interior node: */
@@ -442,10 +455,6 @@ ParticleOctree::~ParticleOctree(void)
 	{
 	/* Delete the entire octree: */
 	delete root;
-	
-	#if TESTING
-	std::cout<<"Total tree update time: "<<totalTreeUpdateTime*1000.0<<" ms"<<std::endl;
-	#endif
 	}
 
 void ParticleOctree::addParticle(Index particleIndex)
@@ -567,10 +576,6 @@ void ParticleOctree::updateParticles(void)
 	if(root==0)
 		return;
 	
-	#if TESTING
-	Realtime::TimePointMonotonic now;
-	#endif
-	
 	/* Update the entire octree: */
 	std::vector<Index> outOfDomainParticles;
 	root->updateParticles(particles,outOfDomainParticles);
@@ -587,16 +592,33 @@ void ParticleOctree::updateParticles(void)
 	root->updateCentersOfGravity(particles);
 	#endif
 	
-	#if TESTING
-	totalTreeUpdateTime+=now.setAndDiff();
-	#endif
-	
 	#if PARTICLEOCTREE_DEBUGGING
 	/* Check the tree for consistency: */
 	root->checkTree(particles);
 	#endif
 	}
 
+void ParticleOctree::getStatistics(unsigned int& depth,size_t& numNodes,size_t& numLeaves) const
+	{
+	/* Traverse the entire octree: */
+	depth=0;
+	numNodes=0;
+	numLeaves=0;
+	if(root!=0)
+		root->accumulateStatistics(0,depth,numNodes,numLeaves);
+	}
+
+size_t ParticleOctree::getMemorySize(void) const
+	{
+	/* Count the octree's nodes: */
+	unsigned int depth;
+	size_t numNodes,numLeaves;
+	getStatistics(depth,numNodes,numLeaves);
+	
+	/* Every node is a Node structure, and every leaf node additionally has a particle index array: */
+	return sizeof(ParticleOctree)+numNodes*sizeof(Node)+numLeaves*Node::maxParticlesPerNode*sizeof(Index);
+	}
+
 void ParticleOctree::glRenderAction(void) const
 	{
 	/* Set up OpenGL state: */
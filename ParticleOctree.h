@@ -60,7 +60,11 @@ class ParticleOctree
 	void finishUpdate(void); // Updates the octree after particles have been added or removed
 	template <class ProcessCloseParticlesFunctor>
 	void processCloseParticles(ProcessCloseParticlesFunctor& functor) const; // Processes particles close to a given position with the given functor, in approximate order of increasing distance; see traversal functor declaration below
+	template <class ProcessRegionParticlesFunctor>
+	void processRegionParticles(ProcessRegionParticlesFunctor& functor) const; // Processes all particles in octree nodes overlapping a region with the given functor; see traversal functor declaration below
 	void updateParticles(void); // Updates the octree after particles have moved due to a simulation step in the particle system
+	void getStatistics(unsigned int& depth,size_t& numNodes,size_t& numLeaves) const; // Returns the octree's maximum leaf depth and its total numbers of nodes and leaf nodes
+	size_t getMemorySize(void) const; // Returns an estimate of the memory used by the octree in bytes
 	void glRenderAction(void) const; // Renders the octree's structure into the current OpenGL context
 	#if PARTICLEOCTREE_BARNES_HUT
 	const Point& getCenterOfGravity(void) const; // Returns the octree's total center of gravity
@@ -78,6 +82,16 @@ class ProcessCloseParticlesFunctor // Declaration of functor class compatible wi
 	const Point& getCenterPosition(void) const; // Returns the center point around which to search for close-by particles
 	Scalar getMaxDist2(void) const; // Returns the squared maximum processing distance
 	void operator()(Index particleIndex,const Point& particlePosition,Scalar dist2); // Processes the particle of the given index at the given position and squared distance from the processing center position
+	void countNodeVisit(bool leaf); // Called for every visited octree node if PARTICLEOCTREE_COUNT_VISITS is enabled
+	};
+
+class ProcessRegionParticlesFunctor // Declaration of functor class compatible with processRegionParticles() method
+	{
+	/* Methods: */
+	public:
+	bool overlapsBox(const Point& min,const Point& max) const; // Returns true if the region to be processed might overlap the given axis-aligned box
+	void operator()(Index particleIndex,const Point& particlePosition); // Processes the particle of the given index at the given position; particle is not guaranteed to be inside the region
+	void countNodeVisit(bool leaf); // Called for every visited octree node if PARTICLEOCTREE_COUNT_VISITS is enabled
 	};
 
 class ForceAccumulationFunctor // Declaration of functor class compatible with calcForce() method
@@ -88,6 +102,7 @@ class ForceAccumulationFunctor // Declaration of functor class compatible with c
 	const Point& getParticlePosition(void) const; // Returns the position of the particle for which to accumulate forces
 	Scalar getTheta(void) const; // Returns the approximation threshold for the Barnes-Hut algorithm
 	void operator()(const Vector& dist,Scalar distLen2,Scalar mass); // Accumulate force from another particle or particle cluster with the given distance vector, squared distance, and particle/cluster mass
+	void countNodeVisit(bool leaf); // Called for every visited octree node if PARTICLEOCTREE_COUNT_VISITS is enabled
 	};
 
 #endif
@@ -0,0 +1,504 @@
+/***********************************************************************
+ParticleOctreeBenchmark - Headless micro-benchmark for the particle
+octree, measuring bulk insertion, updates after particle motion,
+Barnes-Hut force calculation, and radius queries for a range of maximum
+leaf node sizes.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+/* Notify traversal functors of every visited octree node: */
+#define PARTICLEOCTREE_COUNT_VISITS 1
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdexcept>
+#include <vector>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#include <Realtime/Time.h>
+#include <Math/Math.h>
+#include <Math/Random.h>
+
+#include "ParticleTypes.h"
+#include "ParticleSystem.h"
+#include "ParticleOctree.icpp"
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+class CacheMissCounter // Class to count the calling thread's hardware cache misses and references through the Linux performance counter interface, if available
+	{
+	/* Elements: */
+	private:
+	int missesFd,referencesFd; // Performance counter file descriptors for cache misses and cache references, or -1 if unavailable
+	long long misses,references; // Counts from the most recent measurement
+	
+	/* Private methods: */
+	static int openCounter(unsigned long long config) // Opens a disabled hardware counter of the given type for the calling thread; returns -1 on failure
+		{
+		#ifdef __linux__
+		struct perf_event_attr attr;
+		memset(&attr,0,sizeof(attr));
+		attr.type=PERF_TYPE_HARDWARE;
+		attr.size=sizeof(attr);
+		attr.config=config;
+		attr.disabled=1;
+		attr.exclude_kernel=1;
+		attr.exclude_hv=1;
+		return int(syscall(__NR_perf_event_open,&attr,0,-1,-1,0));
+		#else
+		return -1;
+		#endif
+		}
+	static long long readCounter(int fd) // Returns the current value of the given counter
+		{
+		long long value=0;
+		if(read(fd,&value,sizeof(value))!=ssize_t(sizeof(value)))
+			value=0;
+		return value;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	CacheMissCounter(void)
+		:missesFd(-1),referencesFd(-1),misses(0),references(0)
+		{
+		#ifdef __linux__
+		/* Try opening both counters; performance counters may be unsupported or prohibited by the system's paranoia level: */
+		missesFd=openCounter(PERF_COUNT_HW_CACHE_MISSES);
+		referencesFd=openCounter(PERF_COUNT_HW_CACHE_REFERENCES);
+		#endif
+		}
+	~CacheMissCounter(void)
+		{
+		if(missesFd>=0)
+			close(missesFd);
+		if(referencesFd>=0)
+			close(referencesFd);
+		}
+	
+	/* Methods: */
+	bool isValid(void) const // Returns true if cache misses can be counted
+		{
+		return missesFd>=0;
+		}
+	void start(void) // Starts counting from zero
+		{
+		#ifdef __linux__
+		if(missesFd>=0)
+			{
+			ioctl(missesFd,PERF_EVENT_IOC_RESET,0);
+			ioctl(missesFd,PERF_EVENT_IOC_ENABLE,0);
+			}
+		if(referencesFd>=0)
+			{
+			ioctl(referencesFd,PERF_EVENT_IOC_RESET,0);
+			ioctl(referencesFd,PERF_EVENT_IOC_ENABLE,0);
+			}
+		#endif
+		}
+	void stop(void) // Stops counting and retrieves the counts
+		{
+		#ifdef __linux__
+		if(missesFd>=0)
+			{
+			ioctl(missesFd,PERF_EVENT_IOC_DISABLE,0);
+			misses=readCounter(missesFd);
+			}
+		if(referencesFd>=0)
+			{
+			ioctl(referencesFd,PERF_EVENT_IOC_DISABLE,0);
+			references=readCounter(referencesFd);
+			}
+		#endif
+		}
+	void print(size_t numItems,const char* itemName) const // Prints the counts of the most recent measurement per item
+		{
+		if(missesFd>=0)
+			{
+			printf("; %.2f cache misses per %s",double(misses)/double(numItems),itemName);
+			if(referencesFd>=0&&references>0)
+				printf(" (%.1f%% of references)",double(misses)*100.0/double(references));
+			}
+		printf("\n");
+		}
+	};
+
+class LeafOccupancyFunctor // Particle octree traversal class to gather a histogram of the numbers of particles in leaf nodes
+	{
+	/* Elements: */
+	private:
+	std::vector<size_t>& histogram; // Histogram of leaf node particle counts
+	bool inLeaf; // Flag whether the most recently visited node is a leaf node
+	size_t numLeafParticles; // Number of particles handed to the functor since the most recent leaf node was visited
+	
+	/* Constructors and destructors: */
+	public:
+	LeafOccupancyFunctor(std::vector<size_t>& sHistogram)
+		:histogram(sHistogram),inLeaf(false),numLeafParticles(0)
+		{
+		}
+	
+	/* Methods: */
+	bool overlapsBox(const Point& min,const Point& max) const
+		{
+		return true;
+		}
+	void operator()(Index particleIndex,const Point& particlePosition)
+		{
+		++numLeafParticles;
+		}
+	void countNodeVisit(bool leaf)
+		{
+		finishLeaf();
+		inLeaf=leaf;
+		}
+	void finishLeaf(void) // Adds the most recently visited leaf node to the histogram
+		{
+		if(inLeaf)
+			{
+			if(histogram.size()<=numLeafParticles)
+				histogram.resize(numLeafParticles+1,0);
+			++histogram[numLeafParticles];
+			}
+		inLeaf=false;
+		numLeafParticles=0;
+		}
+	};
+
+class ForceFunctor // Particle octree traversal class to calculate the Barnes-Hut approximation of an inverse square force
+	{
+	/* Elements: */
+	private:
+	Index index; // Index of the particle on which the force acts
+	Point position; // Position of the particle on which the force acts
+	Scalar theta; // Approximation threshold
+	public:
+	Vector force; // Accumulated force
+	size_t numInteractions; // Number of particle or cluster interactions
+	size_t numVisits; // Number of visited octree nodes
+	
+	/* Constructors and destructors: */
+	ForceFunctor(Index sIndex,const Point& sPosition,Scalar sTheta)
+		:index(sIndex),position(sPosition),theta(sTheta),
+		 force(Vector::zero),numInteractions(0),numVisits(0)
+		{
+		}
+	
+	/* Methods: */
+	Index getParticleIndex(void) const
+		{
+		return index;
+		}
+	const Point& getParticlePosition(void) const
+		{
+		return position;
+		}
+	Scalar getTheta(void) const
+		{
+		return theta;
+		}
+	void operator()(const Vector& dist,Scalar distLen2,Scalar mass)
+		{
+		if(distLen2>Scalar(0))
+			force-=dist*(mass/(distLen2*Math::sqrt(distLen2)));
+		++numInteractions;
+		}
+	void countNodeVisit(bool leaf)
+		{
+		++numVisits;
+		}
+	};
+
+class RadiusQueryFunctor // Particle octree traversal class to count the particles within a radius around a point
+	{
+	/* Elements: */
+	private:
+	Point center; // Query center
+	Scalar maxDist2; // Squared query radius
+	public:
+	size_t numFound; // Number of particles within the query radius
+	size_t numVisits; // Number of visited octree nodes
+	
+	/* Constructors and destructors: */
+	RadiusQueryFunctor(const Point& sCenter,Scalar sMaxDist2)
+		:center(sCenter),maxDist2(sMaxDist2),
+		 numFound(0),numVisits(0)
+		{
+		}
+	
+	/* Methods: */
+	const Point& getCenterPosition(void) const
+		{
+		return center;
+		}
+	Scalar getMaxDist2(void) const
+		{
+		return maxDist2;
+		}
+	void operator()(Index particleIndex,const Point& particlePosition,Scalar dist2)
+		{
+		++numFound;
+		}
+	void countNodeVisit(bool leaf)
+		{
+		++numVisits;
+		}
+	};
+
+/****************
+Helper functions:
+****************/
+
+void parseNumberList(const char* list,std::vector<double>& numbers) // Splits the given comma-separated list into numbers
+	{
+	numbers.clear();
+	const char* numberStart=list;
+	while(*numberStart!='\0')
+		{
+		char* numberEnd;
+		double number=strtod(numberStart,&numberEnd);
+		if(numberEnd==numberStart)
+			break;
+		numbers.push_back(number);
+		numberStart=*numberEnd==','?numberEnd+1:numberEnd;
+		}
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	unsigned int numParticles=100000;
+	unsigned int numClusters=0;
+	std::vector<double> maxParticlesPerNodes;
+	parseNumberList("4,8,16,32,64",maxParticlesPerNodes);
+	std::vector<double> motions;
+	parseNumberList("0.01,0.1,1",motions);
+	unsigned int numUpdateRounds=10;
+	std::vector<double> thetas;
+	parseNumberList("0.25,0.5,1",thetas);
+	std::vector<double> radii;
+	parseNumberList("1,2,4",radii);
+	unsigned int numQueries=10000;
+	unsigned int seed=1;
+	for(int argi=1;argi<argc;++argi)
+		{
+		if(argv[argi][0]=='-')
+			{
+			if(strcasecmp(argv[argi]+1,"particles")==0&&argi+1<argc)
+				numParticles=(unsigned int)(atoi(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"clusters")==0&&argi+1<argc)
+				numClusters=(unsigned int)(atoi(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"maxPerNode")==0&&argi+1<argc)
+				parseNumberList(argv[++argi],maxParticlesPerNodes);
+			else if(strcasecmp(argv[argi]+1,"motion")==0&&argi+1<argc)
+				parseNumberList(argv[++argi],motions);
+			else if(strcasecmp(argv[argi]+1,"updateRounds")==0&&argi+1<argc)
+				numUpdateRounds=(unsigned int)(atoi(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"thetas")==0&&argi+1<argc)
+				parseNumberList(argv[++argi],thetas);
+			else if(strcasecmp(argv[argi]+1,"radii")==0&&argi+1<argc)
+				parseNumberList(argv[++argi],radii);
+			else if(strcasecmp(argv[argi]+1,"queries")==0&&argi+1<argc)
+				numQueries=(unsigned int)(atoi(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"seed")==0&&argi+1<argc)
+				seed=(unsigned int)(atoi(argv[++argi]));
+			else
+				fprintf(stderr,"ParticleOctreeBenchmark: Ignoring command line option %s\n",argv[argi]);
+			}
+		else
+			fprintf(stderr,"ParticleOctreeBenchmark: Ignoring command line argument %s\n",argv[argi]);
+		}
+	if(numParticles<2||numQueries==0||maxParticlesPerNodes.empty())
+		{
+		fprintf(stderr,"Usage: %s [-particles <number of particles>] [-clusters <number of clusters; 0 for uniform distribution>] [-maxPerNode <comma-separated list of maximum numbers of particles per leaf node>] [-motion <comma-separated list of maximum particle displacements per update>] [-updateRounds <number of updates per displacement>] [-thetas <comma-separated list of Barnes-Hut thresholds>] [-radii <comma-separated list of query radii>] [-queries <number of queries>] [-seed <random seed>]\n",argv[0]);
+		return 1;
+		}
+	if(numQueries>numParticles)
+		numQueries=numParticles;
+	
+	/* Create random particle positions at unit average density, either uniformly distributed or in dense clusters: */
+	srand(seed);
+	Scalar domainSize=Math::pow(Scalar(numParticles),Scalar(1.0/3.0));
+	std::vector<Point> clusterCenters;
+	for(unsigned int i=0;i<numClusters;++i)
+		{
+		Point c;
+		for(int j=0;j<3;++j)
+			c[j]=Math::randUniformCO(-domainSize*Scalar(0.5),domainSize*Scalar(0.5));
+		clusterCenters.push_back(c);
+		}
+	Scalar clusterSize=numClusters>0?domainSize*Scalar(0.25)/Math::pow(Scalar(numClusters),Scalar(1.0/3.0)):Scalar(0);
+	std::vector<Point> initialPositions;
+	initialPositions.reserve(numParticles);
+	for(unsigned int i=0;i<numParticles;++i)
+		{
+		Point p;
+		if(numClusters>0)
+			{
+			const Point& c=clusterCenters[(unsigned int)(Math::randUniformCO(0.0,double(numClusters)))];
+			for(int j=0;j<3;++j)
+				p[j]=c[j]+Math::randUniformCO(-clusterSize,clusterSize);
+			}
+		else
+			{
+			for(int j=0;j<3;++j)
+				p[j]=Math::randUniformCO(-domainSize*Scalar(0.5),domainSize*Scalar(0.5));
+			}
+		initialPositions.push_back(p);
+		}
+	
+	CacheMissCounter cmc;
+	if(numClusters>0)
+		printf("%u particles in %u clusters of size %.2f; ",numParticles,numClusters,double(clusterSize)*2.0);
+	else
+		printf("%u uniformly distributed particles in a domain of size %.2f; ",numParticles,double(domainSize));
+	printf("cache miss counters %s\n",cmc.isValid()?"available":"unavailable");
+	
+	for(std::vector<double>::iterator mppnIt=maxParticlesPerNodes.begin();mppnIt!=maxParticlesPerNodes.end();++mppnIt)
+		{
+		/* Set the maximum leaf node size before creating any octrees: */
+		size_t maxParticlesPerNode=size_t(*mppnIt);
+		if(maxParticlesPerNode<1)
+			continue;
+		ParticleOctree::setMaxParticlesPerNode(maxParticlesPerNode);
+		printf("\nMaximum %u particles per leaf node:\n",(unsigned int)(maxParticlesPerNode));
+		
+		/* Create a particle system holding the particle positions: */
+		ParticleSystem particles;
+		for(std::vector<Point>::iterator ipIt=initialPositions.begin();ipIt!=initialPositions.end();++ipIt)
+			particles.addParticle(Scalar(1),*ipIt,Vector::zero);
+		particles.finishUpdate();
+		
+		/* Insert all particles into a separate octree: */
+		ParticleOctree octree(particles);
+		cmc.start();
+		Realtime::TimePointMonotonic timer;
+		for(Index index=0;index<numParticles;++index)
+			octree.addParticle(index);
+		double insertTime=double(timer.setAndDiff());
+		octree.finishUpdate();
+		double finishTime=double(timer.setAndDiff());
+		cmc.stop();
+		printf("  Insertion: %.3f ms (%.1f ns per particle), finishing: %.3f ms",insertTime*1000.0,insertTime*1.0e9/double(numParticles),finishTime*1000.0);
+		cmc.print(numParticles,"particle");
+		
+		/* Report the octree's shape and leaf node occupancy: */
+		unsigned int depth;
+		size_t numNodes,numLeaves;
+		octree.getStatistics(depth,numNodes,numLeaves);
+		std::vector<size_t> histogram;
+		LeafOccupancyFunctor lof(histogram);
+		octree.processRegionParticles(lof);
+		lof.finishLeaf();
+		size_t numUsedLeaves=0;
+		for(size_t i=1;i<histogram.size();++i)
+			numUsedLeaves+=histogram[i];
+		size_t numFullLeaves=histogram.size()>maxParticlesPerNode?histogram[maxParticlesPerNode]:0;
+		printf("  Depth %u, %u nodes, %u leaves (%u empty); %.2f particles per non-empty leaf, at most %u, %.1f%% of leaves full; %.1f MB\n",depth,(unsigned int)(numNodes),(unsigned int)(numLeaves),(unsigned int)(histogram.empty()?0:histogram[0]),numUsedLeaves>0?double(numParticles)/double(numUsedLeaves):0.0,(unsigned int)(histogram.size()-1),numLeaves>0?double(numFullLeaves)*100.0/double(numLeaves):0.0,double(octree.getMemorySize())/(1024.0*1024.0));
+		
+		/* Update the octree after random particle displacements of several magnitudes: */
+		for(std::vector<double>::iterator mIt=motions.begin();mIt!=motions.end();++mIt)
+			{
+			Scalar motion(*mIt);
+			double updateTime=0.0;
+			cmc.start();
+			for(unsigned int round=0;round<numUpdateRounds;++round)
+				{
+				/* Displace all particles without counting: */
+				cmc.stop();
+				for(Index index=0;index<numParticles;++index)
+					{
+					Point& p=particles.getParticlePosition(index);
+					for(int j=0;j<3;++j)
+						p[j]+=Math::randUniformCO(-motion,motion);
+					}
+				cmc.start();
+				
+				timer.set();
+				octree.updateParticles();
+				updateTime+=double(timer.setAndDiff());
+				}
+			cmc.stop();
+			octree.getStatistics(depth,numNodes,numLeaves);
+			printf("  Motion %g: %.3f ms per update (%.1f ns per particle), then depth %u, %u nodes",*mIt,updateTime*1000.0/double(numUpdateRounds),updateTime*1.0e9/(double(numUpdateRounds)*double(numParticles)),depth,(unsigned int)(numNodes));
+			cmc.print(size_t(numUpdateRounds)*size_t(numParticles),"particle");
+			
+			/* Move all particles back to their initial positions: */
+			for(Index index=0;index<numParticles;++index)
+				particles.setParticlePosition(index,initialPositions[index]);
+			octree.updateParticles();
+			}
+		
+		/* Calculate Barnes-Hut forces on evenly spaced particles at several approximation thresholds: */
+		for(std::vector<double>::iterator tIt=thetas.begin();tIt!=thetas.end();++tIt)
+			{
+			size_t numInteractions=0,numVisits=0;
+			Vector totalForce=Vector::zero;
+			cmc.start();
+			timer.set();
+			for(unsigned int query=0;query<numQueries;++query)
+				{
+				Index index=Index((Misc::UInt64(query)*Misc::UInt64(numParticles))/Misc::UInt64(numQueries));
+				ForceFunctor ff(index,particles.getParticlePosition(index),Scalar(*tIt));
+				octree.calcForce(ff);
+				totalForce+=ff.force;
+				numInteractions+=ff.numInteractions;
+				numVisits+=ff.numVisits;
+				}
+			double forceTime=double(timer.setAndDiff());
+			cmc.stop();
+			printf("  Theta %g: %.3f us per query, %.1f interactions, %.1f node visits per query, net force %.3g",*tIt,forceTime*1.0e6/double(numQueries),double(numInteractions)/double(numQueries),double(numVisits)/double(numQueries),double(totalForce.mag()));
+			cmc.print(numQueries,"query");
+			}
+		
+		/* Find particles around evenly spaced particles within several radii: */
+		for(std::vector<double>::iterator rIt=radii.begin();rIt!=radii.end();++rIt)
+			{
+			size_t numFound=0,numVisits=0;
+			Scalar maxDist2=Math::sqr(Scalar(*rIt));
+			cmc.start();
+			timer.set();
+			for(unsigned int query=0;query<numQueries;++query)
+				{
+				Index index=Index((Misc::UInt64(query)*Misc::UInt64(numParticles))/Misc::UInt64(numQueries));
+				RadiusQueryFunctor rqf(particles.getParticlePosition(index),maxDist2);
+				octree.processCloseParticles(rqf);
+				numFound+=rqf.numFound;
+				numVisits+=rqf.numVisits;
+				}
+			double queryTime=double(timer.setAndDiff());
+			cmc.stop();
+			printf("  Radius %g: %.3f us per query, %.1f particles found, %.1f node visits per query",*rIt,queryTime*1.0e6/double(numQueries),double(numFound)/double(numQueries),double(numVisits)/double(numQueries));
+			cmc.print(numQueries,"query");
+			}
+		}
+	
+	return 0;
+	}
@@ -25,6 +25,7 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <utility>
 #include <stdexcept>
 #include <Threads/Barrier.h>
+#include <Realtime/Time.h>
 #include <Math/Math.h>
 #include <Math/Constants.h>
 #include <Math/Random.h>
@@ -34,6 +35,7 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <GL/GLModels.h>
 
 #include "ParticleOctree.icpp"
+#include "Tracer.h"
 
 /**********************************************************
 Declaration of class ParticleSystem::EnforceMinDistFunctor:
@@ -92,6 +94,20 @@ class ParticleSystem::EnforceMinDistFunctor
 		}
 	};
 
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+inline bool synchronize(Threads::Barrier& barrier) // Waits until all threads reach the given barrier and records the wait as a trace span; returns true in exactly one thread
+	{
+	Tracer::Span span("Barrier wait");
+	return barrier.synchronize();
+	}
+
+}
+
 /*******************************
 Methods of class ParticleSystem:
 *******************************/
@@ -104,14 +120,14 @@ ParticleSystem::ParticleSystem(void)
 	 numParticles(0),
 	 octree(*this),
 	 prevDt(1),
-	 numThreads(1),barrier(0),particleDeltas(0)
+	 numThreads(1),barrier(0),
+	 distConstraintListsValid(false),
+	 octreeUpdateTime(0.0)
 	{
 	}
 
 ParticleSystem::~ParticleSystem(void)
 	{
-	/* Release allocated resources: */
-	delete[] particleDeltas;
 	}
 
 void ParticleSystem::addDistConstraint(Index index0,Index index1,Scalar dist,Scalar strength)
@@ -128,6 +144,7 @@ void ParticleSystem::addDistConstraint(Index index0,Index index1,Scalar dist,Sca
 	/* Update the involved particles' distance constraint counters: */
 	++numDistConstraints[index0];
 	++numDistConstraints[index1];
+	distConstraintListsValid=false;
 	}
 
 void ParticleSystem::setDistConstraintStrength(Index distConstraintIndex,Scalar newStrength)
@@ -197,10 +214,6 @@ void ParticleSystem::setNumThreads(unsigned int newNumThreads,Threads::Barrier&
 	{
 	numThreads=newNumThreads;
 	barrier=&newBarrier;
-	
-	/* Re-allocate the particle position update vector array: */
-	delete[] particleDeltas;
-	particleDeltas=new Vector[size_t(numThreads)*size_t(numParticles)];
 	}
 
 Index ParticleSystem::addParticle(Scalar newInvMass,const Point& newPosition,const Vector& newVelocity)
@@ -224,6 +237,7 @@ Index ParticleSystem::addParticle(Scalar newInvMass,const Point& newPosition,con
 	
 	/* Increment the number of particles and return the new index: */
 	++numParticles;
+	distConstraintListsValid=false;
 	return result;
 	}
 
@@ -232,11 +246,11 @@ void ParticleSystem::finishUpdate(void)
 	/* Finish the particle octree: */
 	octree.finishUpdate();
 	
-	/* Allocate temporary storage: */
-	particleDeltas=new Vector[size_t(numThreads)*size_t(numParticles)];
+	/* Create the particles' lists of distance constraints: */
+	updateDistConstraintLists();
 	}
 
-void ParticleSystem::moveParticles(Scalar dt,unsigned int threadIndex)
+void ParticleSystem::moveParticles(Scalar dt,Index begin,Index end)
 	{
 	/* Calculate the Verlet integration coefficients: */
 	Scalar att=Math::pow(attenuation,prevDt);
@@ -248,10 +262,10 @@ void ParticleSystem::moveParticles(Scalar dt,unsigned int threadIndex)
 	Vector g=gravity*dt2; // Corresponds to Euler integration where velocity is updated before position
 	// Vector g=gravity*(Scalar(0.5)*dt2); // This would be g for a quadratic approximation, but there are problems with the octree
 	
-	/* Update the positions of all particles handled by this thread: */
-	std::vector<Point>::iterator ppEnd=prevPos.begin()+((threadIndex+1)*numParticles)/numThreads;
-	std::vector<Point>::iterator pIt=pos.begin()+(threadIndex*numParticles)/numThreads;
-	for(std::vector<Point>::iterator ppIt=prevPos.begin()+(threadIndex*numParticles)/numThreads;ppIt!=ppEnd;++ppIt,++pIt)
+	/* Update the positions of all particles in the given range: */
+	std::vector<Point>::iterator ppEnd=prevPos.begin()+end;
+	std::vector<Point>::iterator pIt=pos.begin()+begin;
+	for(std::vector<Point>::iterator ppIt=prevPos.begin()+begin;ppIt!=ppEnd;++ppIt,++pIt)
 		for(int i=0;i<3;++i)
 			{
 			// (*ppIt)[i]=(*pIt)[i]*c-(*ppIt)[i]*pc+g[i];
@@ -260,29 +274,151 @@ void ParticleSystem::moveParticles(Scalar dt,unsigned int threadIndex)
 			}
 	}
 
-void ParticleSystem::enforceConstraints(Scalar dt,unsigned int threadIndex)
+void ParticleSystem::projectPositions(std::vector<Point>::iterator pBegin,std::vector<Point>::iterator pEnd) const
 	{
-	/* Synchronize between all threads and let one thread swap the particle position arrays, then synchronize again: */
-	bool swapPositions=true;
-	if(barrier!=0)
-		swapPositions=barrier->synchronize();
-	if(swapPositions)
+	/* Process all box constraints: */
+	for(std::vector<BoxConstraint>::const_iterator bcIt=boxConstraints.begin();bcIt!=boxConstraints.end();++bcIt)
 		{
-		/* Swap previous and current particle positions: */
-		std::swap(prevPos,pos);
-		prevDt=dt;
+		/* Check the type of box constraint: */
+		if(bcIt->inside)
+			{
+			/* Keep all particles inside of the box: */
+			for(std::vector<Point>::iterator pIt=pBegin;pIt!=pEnd;++pIt)
+				for(int i=0;i<3;++i)
+					{
+					if((*pIt)[i]<bcIt->min[i])
+						(*pIt)[i]=bcIt->min[i];
+					else if((*pIt)[i]>bcIt->max[i])
+						(*pIt)[i]=bcIt->max[i];
+					}
+			}
+		else
+			{
+			/* Keep all particles outside of the box: */
+			for(std::vector<Point>::iterator pIt=pBegin;pIt!=pEnd;++pIt)
+				{
+				bool inside=true;
+				Scalar minDepth=Math::Constants<Scalar>::max;
+				int minAxis=0;
+				for(int i=0;i<3&&inside;++i)
+					{
+					inside=(*pIt)[i]>bcIt->min[i]&&(*pIt)[i]<bcIt->max[i];
+					if(inside)
+						{
+						Scalar mid=Math::mid(bcIt->min[i],bcIt->max[i]);
+						if((*pIt)[i]<mid)
+							{
+							Scalar depth=(*pIt)[i]-bcIt->min[i];
+							if(minDepth>depth)
+								{
+								minDepth=depth;
+								minAxis=-i-1;
+								}
+							}
+						else
+							{
+							Scalar depth=bcIt->max[i]-(*pIt)[i];
+							if(minDepth>depth)
+								{
+								minDepth=depth;
+								minAxis=i+1;
+								}
+							}
+						}
+					}
+				
+				if(inside)
+					{
+					if(minAxis<0)
+						(*pIt)[-minAxis-1]-=minDepth;
+					else
+						(*pIt)[minAxis-1]+=minDepth;
+					}
+				}
+			}
 		}
-	if(barrier!=0)
-		barrier->synchronize();
 	
-	/* Set the range of particles on which this thread will operate: */
-	Index iBegin((threadIndex*numParticles)/numThreads);
-	Index iEnd(((threadIndex+1)*numParticles)/numThreads);
-	std::vector<Point>::iterator pBegin=pos.begin()+iBegin;
-	std::vector<Point>::iterator pEnd=pos.begin()+iEnd;
-	std::vector<Point>::iterator ppBegin=prevPos.begin()+iBegin;
+	/* Process all sphere constraints: */
+	for(std::vector<SphereConstraint>::const_iterator scIt=sphereConstraints.begin();scIt!=sphereConstraints.end();++scIt)
+		{
+		/* Check the type of sphere constraint: */
+		if(scIt->inside)
+			{
+			/* Keep all particles inside of the sphere: */
+			for(std::vector<Point>::iterator pIt=pBegin;pIt!=pEnd;++pIt)
+				{
+				/* Check if the particle is outside the sphere: */
+				Scalar dist2=Geometry::sqrDist(*pIt,scIt->center);
+				if(dist2>scIt->radius2)
+					{
+					/* Project the particle back to the surface of the sphere: */
+					*pIt+=(*pIt-scIt->center)*(scIt->radius/Math::sqrt(dist2)-Scalar(1));
+					}
+				}
+			}
+		else
+			{
+			/* Keep all particles outside of the sphere: */
+			for(std::vector<Point>::iterator pIt=pBegin;pIt!=pEnd;++pIt)
+				{
+				/* Check if the particle is inside the sphere: */
+				Scalar dist2=Geometry::sqrDist(*pIt,scIt->center);
+				if(dist2<scIt->radius2)
+					{
+					/* Project the particle back to the surface of the sphere: */
+					*pIt+=(*pIt-scIt->center)*(scIt->radius/Math::sqrt(dist2)-Scalar(1));
+					}
+				}
+			}
+		}
+	}
+
+void ParticleSystem::updateDistConstraintLists(void)
+	{
+	/* Calculate the offsets of all particles' lists of distance constraints: */
+	distConstraintOffsets.resize(size_t(numParticles)+1);
+	Index offset=0;
+	for(Index index=0;index<numParticles;++index)
+		{
+		distConstraintOffsets[index]=offset;
+		offset+=numDistConstraints[index];
+		}
+	distConstraintOffsets[numParticles]=offset;
 	
-	/* Enforce boundary constraints (box and sphere) first to handle bounce and friction: */
+	/* Enter each distance constraint into the lists of both its particles: */
+	particleDistConstraints.resize(offset);
+	std::vector<Index> listEnds(distConstraintOffsets.begin(),distConstraintOffsets.end()-1);
+	for(Index dcIndex=0;dcIndex<Index(distConstraints.size());++dcIndex)
+		{
+		particleDistConstraints[listEnds[distConstraints[dcIndex].index0]++]=dcIndex;
+		particleDistConstraints[listEnds[distConstraints[dcIndex].index1]++]=dcIndex;
+		}
+	
+	/* Allocate the particle position update vectors: */
+	particleDeltas.resize(numParticles);
+	
+	distConstraintListsValid=true;
+	}
+
+void ParticleSystem::startConstraints(Scalar dt)
+	{
+	/* Swap previous and current particle positions: */
+	std::swap(prevPos,pos);
+	prevDt=dt;
+	
+	/* Bring the particles' lists of distance constraints up to date: */
+	if(!distConstraintListsValid)
+		updateDistConstraintLists();
+	}
+
+void ParticleSystem::enforceBoundaryConstraints(Index begin,Index end)
+	{
+	/* Access the range of particles to process: */
+	std::vector<Point>::iterator pBegin=pos.begin()+begin;
+	std::vector<Point>::iterator pEnd=pos.begin()+end;
+	std::vector<Point>::iterator ppBegin=prevPos.begin()+begin;
+	
+	/* Apply bounce and friction for all box constraints: */
 	for(std::vector<BoxConstraint>::iterator bcIt=boxConstraints.begin();bcIt!=boxConstraints.end();++bcIt)
 		{
 		/* Check the type of box constraint: */
@@ -526,199 +662,143 @@ void ParticleSystem::enforceConstraints(Scalar dt,unsigned int threadIndex)
 				}
 			}
 		}
-	
-	/* Set the range of distance constraints on which this thread operates: */
-	std::vector<DistConstraint>::iterator dcBegin=distConstraints.begin()+(threadIndex*distConstraints.size())/numThreads;
-	std::vector<DistConstraint>::iterator dcEnd=distConstraints.begin()+((threadIndex+1)*distConstraints.size())/numThreads;
-	
-	/* Enforce all constraints through iterative relaxation: */
-	for(unsigned int iteration=0;iteration<numRelaxationIterations;++iteration)
+	}
+
+void ParticleSystem::calcRelaxationDeltas(Index begin,Index end)
+	{
+	/* Calculate each particle's position update vector from all distance constraints it is part of: */
+	for(Index index=begin;index<end;++index)
 		{
-		/* Synchronize between all threads to switch from per-particle to per-constraint parallelization: */
-		if(barrier!=0)
-			barrier->synchronize();
-		
-		/* Reset this thread's particle position update vectors: */
-		Vector* pds=particleDeltas+size_t(threadIndex)*size_t(numParticles);
-		for(Index i=0;i<numParticles;++i)
-			pds[i]=Vector::zero;
-		
-		/* Process all distance constraints: */
-		for(std::vector<DistConstraint>::iterator dcIt=dcBegin;dcIt!=dcEnd;++dcIt)
+		Vector pd=Vector::zero;
+		std::vector<Index>::const_iterator pdcEnd=particleDistConstraints.begin()+distConstraintOffsets[index+1];
+		for(std::vector<Index>::const_iterator pdcIt=particleDistConstraints.begin()+distConstraintOffsets[index];pdcIt!=pdcEnd;++pdcIt)
 			{
+			const DistConstraint& dc=distConstraints[*pdcIt];
+			
 			/* Get the two particles' inverse masses and their sum: */
-			Scalar im0=invMass[dcIt->index0];
-			Scalar im1=invMass[dcIt->index1];
+			Scalar im0=invMass[dc.index0];
+			Scalar im1=invMass[dc.index1];
 			Scalar imSum=im0+im1;
 			
 			/* Calculate the current distance vector between the two particles and its squared length: */
-			Vector d=pos[dcIt->index1]-pos[dcIt->index0];
+			Vector d=pos[dc.index1]-pos[dc.index0];
 			Scalar d2=d.sqr();
 			Scalar dScale;
 			if(d2>=Scalar(1.0e-8))
 				{
 				/* Calculate the scale factor to bring the distance vector to the desired length: */
-				dScale=(Scalar(1)-dcIt->dist/Math::sqrt(d2))*dcIt->strength*distConstraintScale;
-				// dScale=(Scalar(1)-Scalar(2)*dcIt->dist2/(d2+dcIt->dist2))*dcIt->strength*distConstraintScale;
+				dScale=(Scalar(1)-dc.dist/Math::sqrt(d2))*dc.strength*distConstraintScale;
+				// dScale=(Scalar(1)-Scalar(2)*dc.dist2/(d2+dc.dist2))*dc.strength*distConstraintScale;
 				}
 			else
 				{
 				/* Create some "random" displacement vector to move the particles apart: */
 				d=Vector(1,0,0);
-				dScale=dcIt->dist*dcIt->strength*distConstraintScale;
+				dScale=dc.dist*dc.strength*distConstraintScale;
 				}
 			
 			/* Scale the update vector by the maximum number of distance constraints on both particles: */
-			dScale/=Scalar(Math::max(numDistConstraints[dcIt->index0],numDistConstraints[dcIt->index1]));
+			dScale/=Scalar(Math::max(numDistConstraints[dc.index0],numDistConstraints[dc.index1]));
 			
 			/* Check if at least one of the particles has finite mass: */
 			if(imSum>Scalar(0))
 				{
-				/* Distribute the distance correction vector between the particles based on their masses: */
-				pds[dcIt->index0]+=d*(dScale*im0/imSum);
-				pds[dcIt->index1]-=d*(dScale*im1/imSum);
+				/* Apply this particle's share of the distance correction vector based on the particles' masses: */
+				if(dc.index0==index)
+					pd+=d*(dScale*im0/imSum);
+				else
+					pd-=d*(dScale*im1/imSum);
 				}
 			else
 				{
-				/* Distribute the distance correction vector between the particles evenly: */
+				/* Apply half of the distance correction vector: */
 				d*=Math::div2(dScale);
-				pds[dcIt->index0]+=d;
-				pds[dcIt->index1]-=d;
-				}
-			}
-		
-		/* Synchronize between all threads to switch from per-constraint back to per-particle parallelization: */
-		if(barrier!=0)
-			barrier->synchronize();
-		
-		/* Update this thread's particle positions: */
-		for(unsigned int ti=0;ti<numThreads;++ti)
-			{
-			Vector* pdPtr=particleDeltas+(size_t(ti)*size_t(numParticles)+size_t(iBegin));
-			for(std::vector<Point>::iterator pIt=pBegin;pIt!=pEnd;++pIt,++pdPtr)
-				*pIt+=*pdPtr;
-			}
-		
-		#if 0 // This can't go here -- the octree isn't up-to-date!
-		if(minParticleDist2>Scalar(0))
-			{
-			/* Enforce a minimum distance between any pairs of particles: */
-			for(Index index0=0;index0<numParticles-1;++index0)
-				{
-				EnforceMinDistFunctor emdf(*this,index0,minParticleDist2);
-				octree.processCloseParticles(emdf);
-				}
-			}
-		#endif
-		
-		/* Process all box constraints: */
-		for(std::vector<BoxConstraint>::iterator bcIt=boxConstraints.begin();bcIt!=boxConstraints.end();++bcIt)
-			{
-			/* Check the type of box constraint: */
-			if(bcIt->inside)
-				{
-				/* Keep all particles inside of the box: */
-				for(std::vector<Point>::iterator pIt=pBegin;pIt!=pEnd;++pIt)
-					for(int i=0;i<3;++i)
-						{
-						if((*pIt)[i]<bcIt->min[i])
-							(*pIt)[i]=bcIt->min[i];
-						else if((*pIt)[i]>bcIt->max[i])
-							(*pIt)[i]=bcIt->max[i];
-						}
-				}
-			else
-				{
-				/* Keep all particles outside of the box: */
-				for(std::vector<Point>::iterator pIt=pBegin;pIt!=pEnd;++pIt)
-					{
-					bool inside=true;
-					Scalar minDepth=Math::Constants<Scalar>::max;
-					int minAxis=0;
-					for(int i=0;i<3&&inside;++i)
-						{
-						inside=(*pIt)[i]>bcIt->min[i]&&(*pIt)[i]<bcIt->max[i];
-						if(inside)
-							{
-							Scalar mid=Math::mid(bcIt->min[i],bcIt->max[i]);
-							if((*pIt)[i]<mid)
-								{
-								Scalar depth=(*pIt)[i]-bcIt->min[i];
-								if(minDepth>depth)
-									{
-									minDepth=depth;
-									minAxis=-i-1;
-									}
-								}
-							else
-								{
-								Scalar depth=bcIt->max[i]-(*pIt)[i];
-								if(minDepth>depth)
-									{
-									minDepth=depth;
-									minAxis=i+1;
-									}
-								}
-							}
-						}
-					
-					if(inside)
-						{
-						if(minAxis<0)
-							(*pIt)[-minAxis-1]-=minDepth;
-						else
-							(*pIt)[minAxis-1]+=minDepth;
-						}
-					}
+				if(dc.index0==index)
+					pd+=d;
+				else
+					pd-=d;
 				}
 			}
+		particleDeltas[index]=pd;
+		}
+	}
+
+void ParticleSystem::applyRelaxationDeltas(Index begin,Index end)
+	{
+	/* Access the range of particles to process: */
+	std::vector<Point>::iterator pBegin=pos.begin()+begin;
+	std::vector<Point>::iterator pEnd=pos.begin()+end;
+	
+	/* Update the particles' positions: */
+	std::vector<Vector>::const_iterator pdIt=particleDeltas.begin()+begin;
+	for(std::vector<Point>::iterator pIt=pBegin;pIt!=pEnd;++pIt,++pdIt)
+		*pIt+=*pdIt;
 	
-		/* Process all sphere constraints: */
-		for(std::vector<SphereConstraint>::iterator scIt=sphereConstraints.begin();scIt!=sphereConstraints.end();++scIt)
+	#if 0 // This can't go here -- the octree isn't up-to-date!
+	if(minParticleDist2>Scalar(0))
+		{
+		/* Enforce a minimum distance between any pairs of particles: */
+		for(Index index0=0;index0<numParticles-1;++index0)
 			{
-			/* Check the type of sphere constraint: */
-			if(scIt->inside)
-				{
-				/* Keep all particles inside of the sphere: */
-				for(std::vector<Point>::iterator pIt=pBegin;pIt!=pEnd;++pIt)
-					{
-					/* Check if the particle is outside the sphere: */
-					Scalar dist2=Geometry::sqrDist(*pIt,scIt->center);
-					if(dist2>scIt->radius2)
-						{
-						/* Project the particle back to the surface of the sphere: */
-						*pIt+=(*pIt-scIt->center)*(scIt->radius/Math::sqrt(dist2)-Scalar(1));
-						}
-					}
-				}
-			else
-				{
-				/* Keep all particles outside of the sphere: */
-				for(std::vector<Point>::iterator pIt=pBegin;pIt!=pEnd;++pIt)
-					{
-					/* Check if the particle is inside the sphere: */
-					Scalar dist2=Geometry::sqrDist(*pIt,scIt->center);
-					if(dist2<scIt->radius2)
-						{
-						/* Project the particle back to the surface of the sphere: */
-						*pIt+=(*pIt-scIt->center)*(scIt->radius/Math::sqrt(dist2)-Scalar(1));
-						}
-					}
-				}
+			EnforceMinDistFunctor emdf(*this,index0,minParticleDist2);
+			octree.processCloseParticles(emdf);
 			}
 		}
+	#endif
 	
-	/* Synchronize between all threads and let one thread update the particle octree, then synchronize again: */
-	bool updateOctree=true;
+	/* Project the particles onto all box and sphere constraints: */
+	projectPositions(pBegin,pEnd);
+	}
+
+void ParticleSystem::finishConstraints(void)
+	{
+	/* Update the particle octree and measure how long it takes: */
+	Tracer::Span span("Octree update");
+	Realtime::TimePointMonotonic octreeTimer;
+	octree.updateParticles();
+	octreeUpdateTime=double(octreeTimer.setAndDiff());
+	}
+
+void ParticleSystem::enforceConstraints(Scalar dt,unsigned int threadIndex)
+	{
+	/* Synchronize between all threads and let one thread start enforcing constraints, then synchronize again: */
+	bool start=true;
 	if(barrier!=0)
-		updateOctree=barrier->synchronize();
-	if(updateOctree)
+		start=synchronize(*barrier);
+	if(start)
+		startConstraints(dt);
+	if(barrier!=0)
+		synchronize(*barrier);
+	
+	/* Set the range of particles on which this thread will operate: */
+	Index iBegin((threadIndex*numParticles)/numThreads);
+	Index iEnd(((threadIndex+1)*numParticles)/numThreads);
+	
+	/* Enforce boundary constraints (box and sphere) first to handle bounce and friction: */
+	enforceBoundaryConstraints(iBegin,iEnd);
+	
+	/* Enforce all constraints through iterative relaxation: */
+	for(unsigned int iteration=0;iteration<numRelaxationIterations;++iteration)
 		{
-		/* Update the particle octree: */
-		octree.updateParticles();
+		/* Synchronize between all threads so that position update vectors are calculated from all particles' current positions: */
+		if(barrier!=0)
+			synchronize(*barrier);
+		calcRelaxationDeltas(iBegin,iEnd);
+		
+		/* Synchronize between all threads so that positions are only updated once all position update vectors have been calculated: */
+		if(barrier!=0)
+			synchronize(*barrier);
+		applyRelaxationDeltas(iBegin,iEnd);
 		}
+	
+	/* Synchronize between all threads and let one thread update the particle octree, then synchronize again: */
+	bool finish=true;
 	if(barrier!=0)
-		barrier->synchronize();
+		finish=synchronize(*barrier);
+	if(finish)
+		finishConstraints();
+	if(barrier!=0)
+		synchronize(*barrier);
 	}
 
 namespace {
@@ -813,6 +893,39 @@ void drawBox(bool inside,const Point& min,const Point& max,Scalar epsilon)
 
 }
 
+void ParticleSystem::interpolatePositions(Scalar weight)
+	{
+	/* Blend the positions of all particles from the previous and current time steps: */
+	renderPos.resize(numParticles);
+	std::vector<Point>::iterator pIt=pos.begin();
+	std::vector<Point>::iterator rpIt=renderPos.begin();
+	for(std::vector<Point>::iterator ppIt=prevPos.begin();ppIt!=prevPos.end();++ppIt,++pIt,++rpIt)
+		for(int i=0;i<3;++i)
+			(*rpIt)[i]=(*ppIt)[i]+((*pIt)[i]-(*ppIt)[i])*weight;
+	
+	/* Project the blended positions onto all box and sphere constraints, as bouncing reflects previous positions to the other side of a constraint's boundary: */
+	projectPositions(renderPos.begin(),renderPos.end());
+	}
+
+size_t ParticleSystem::getMemorySize(void) const
+	{
+	/* Add up the particle system's constraint and particle state arrays: */
+	size_t result=sizeof(ParticleSystem);
+	result+=distConstraints.capacity()*sizeof(DistConstraint);
+	result+=boxConstraints.capacity()*sizeof(BoxConstraint);
+	result+=sphereConstraints.capacity()*sizeof(SphereConstraint);
+	result+=invMass.capacity()*sizeof(Scalar);
+	result+=numDistConstraints.capacity()*sizeof(unsigned int);
+	result+=(pos.capacity()+prevPos.capacity()+renderPos.capacity())*sizeof(Point);
+	result+=(distConstraintOffsets.capacity()+particleDistConstraints.capacity())*sizeof(Index);
+	result+=particleDeltas.capacity()*sizeof(Vector);
+	
+	/* Add the octree, which is already counted by its structure size: */
+	result+=octree.getMemorySize()-sizeof(ParticleOctree);
+	
+	return result;
+	}
+
 void ParticleSystem::glRenderAction(bool transparent) const
 	{
 	if(transparent)
@@ -84,10 +84,19 @@ class ParticleSystem
 	std::vector<Point> pos; // Array of current particle positions
 	ParticleOctree octree; // Dynamic octree of particles for fast neighborhood searches
 	std::vector<Point> prevPos; // Array of particle positions at the previous time step
+	std::vector<Point> renderPos; // Array of particle positions interpolated between the previous and current time steps for rendering
 	Scalar prevDt; // Length of the previous time step
 	unsigned int numThreads; // Number of threads from which the particle system's state update methods will be called in parallel
 	Threads::Barrier* barrier; // Barrier to synchronize between multiple worker threads
-	Vector* particleDeltas; // Array holding particle position update vectors for each thread inside the enforceConstraints method
+	std::vector<Index> distConstraintOffsets; // Offsets of each particle's list of distance constraints in the concatenated lists, followed by the total length of all lists
+	std::vector<Index> particleDistConstraints; // Concatenated lists of the indices of the distance constraints each particle is part of
+	bool distConstraintListsValid; // Flag whether the particles' lists of distance constraints reflect the current particles and distance constraints
+	std::vector<Vector> particleDeltas; // Array holding particle position update vectors during distance constraint relaxation
+	double octreeUpdateTime; // Time spent updating the particle octree at the end of the most recent enforceConstraints call in seconds
+	
+	/* Private methods: */
+	void updateDistConstraintLists(void); // Rebuilds the particles' lists of distance constraints and the particle position update vector array
+	void projectPositions(std::vector<Point>::iterator pBegin,std::vector<Point>::iterator pEnd) const; // Projects the given range of positions onto all box and sphere constraints
 	
 	/* Constructors and destructors: */
 	public:
@@ -173,7 +182,11 @@ class ParticleSystem
 		{
 		prevPos[index]=pos[index]-newVelocity*prevDt;
 		}
-	void moveParticles(Scalar dt,unsigned int threadIndex =0); // First part of advance method
+	void moveParticles(Scalar dt,Index begin,Index end); // First part of advance method for the particles in the half-open index range [begin, end); can be called in parallel for disjoint ranges
+	void moveParticles(Scalar dt,unsigned int threadIndex =0) // First part of advance method for the calling thread's share of particles
+		{
+		moveParticles(dt,Index((threadIndex*numParticles)/numThreads),Index(((threadIndex+1)*numParticles)/numThreads));
+		}
 	void accelerateParticle(Index index,const Vector& acceleration,Scalar dt2) // Accelerates the given particle with the given acceleration vector over the given squared time step
 		{
 		/* Move the particle's new position by the given acceleration vector, scaled by squared time step: */
@@ -184,16 +197,31 @@ class ParticleSystem
 		/* Move the particle's new position by the given acceleration vector, scaled by squared time step: */
 		prevPos[index]+=force*(invMass[index]*dt2);
 		}
+	void startConstraints(Scalar dt); // Starts the second part of the advance method; must be called from a single thread after all particles were moved and accelerated
+	void enforceBoundaryConstraints(Index begin,Index end); // Applies bounce and friction of boundary constraints to the particles in the half-open index range [begin, end); can be called in parallel for disjoint ranges
+	void calcRelaxationDeltas(Index begin,Index end); // Calculates the position update vectors of one distance constraint relaxation iteration for the particles in the half-open index range [begin, end); can be called in parallel for disjoint ranges
+	void applyRelaxationDeltas(Index begin,Index end); // Applies the position update vectors to the particles in the half-open index range [begin, end) and projects them onto boundary constraints; can be called in parallel for disjoint ranges once all update vectors were calculated
+	void finishConstraints(void); // Finishes the second part of the advance method by updating the particle octree; must be called from a single thread after the last relaxation iteration
 	void enforceConstraints(Scalar dt,unsigned int threadIndex =0); // Second step of advance method; accelerate particles between steps 1 and 2
 	void advance(Scalar dt,unsigned int threadIndex =0) // Shortcut to advance particle system's state by the given time step without applying forces
 		{
 		moveParticles(dt,threadIndex);
 		enforceConstraints(dt,threadIndex);
 		}
+	void interpolatePositions(Scalar weight); // Interpolates all particles' positions between the previous and current time steps with the given weight in [0, 1] for rendering
+	const Point& getRenderPosition(Index index) const // Returns a particle's position as interpolated by the most recent call to interpolatePositions
+		{
+		return renderPos[index];
+		}
+	double getOctreeUpdateTime(void) const // Returns the time spent updating the particle octree during the most recent time step in seconds
+		{
+		return octreeUpdateTime;
+		}
 	const ParticleOctree& getOctree(void) const // Returns the particle system's octree
 		{
 		return octree;
 		}
+	size_t getMemorySize(void) const; // Returns an estimate of the memory used by the particle system, including its octree, in bytes
 	template <class ProcessCloseParticlesFunctor>
 	void processCloseParticles(ProcessCloseParticlesFunctor& functor) const // Processes particles close to a given position with the given functor, in approximate order of increasing distance; see traversal functor declaration below
 		{
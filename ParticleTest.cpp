@@ -19,6 +19,7 @@ with the Network Viewer; if not, write to the Free Software Foundation,
 Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 ***********************************************************************/
 
+#include <stdlib.h>
 #include <string.h>
 #include <vector>
 #include <Misc/MessageLogger.h>
@@ -45,6 +46,7 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Vrui/ToolManager.h>
 
 #include "ParticleSystem.h"
+#include "SimulationScheduler.h"
 #include "ParticleMesh.h"
 #include "Body.h"
 #include "Whip.h"
@@ -60,9 +62,13 @@ class ParticleTest:public Vrui::Application,public Vrui::TransparentObject
 	/* Elements: */
 	private:
 	ParticleSystem particles; // A particle system
+	SimulationScheduler meshScheduler; // Thread pool to update large particle meshes in parallel
 	std::vector<ParticleMesh*> meshes; // A list of particle meshes
 	std::vector<GLMaterial> meshMaterials; // Material properties to render the particle meshes
 	std::vector<Body*> bodies; // A list of bodies, each composed of multiple particles
+	Scalar stepTime; // Fixed time step by which to advance the particle system
+	unsigned int maxStepsPerFrame; // Maximum number of fixed time steps to take during a single frame
+	Scalar stepAccumulator; // Simulation time that has elapsed but not yet been simulated
 	GLMotif::PopupWindow* particleParameterDialog; // Dialog window to control parameters of the particle system
 	std::vector<Index> atoms; // List of atoms in the environment
 	
@@ -215,6 +221,8 @@ GLMotif::PopupWindow* ParticleTest::createParticleParameterDialog(void)
 
 ParticleTest::ParticleTest(int& argc,char**& argv)
 	:Vrui::Application(argc,argv),
+	 meshScheduler(0),
+	 stepTime(Scalar(1)/Scalar(120)),maxStepsPerFrame(8),stepAccumulator(0),
 	 particleParameterDialog(0)
 	{
 	/* Enforce minimum particle distance: */
@@ -288,7 +296,7 @@ ParticleTest::ParticleTest(int& argc,char**& argv)
 				double scale=2.5/double(size);
 				Scalar bondStrength(0.5);
 				// Scalar bondStrength(1);
-				ParticleMesh* rag=new ParticleMesh(particles);
+				ParticleMesh* rag=new ParticleMesh(particles,&meshScheduler);
 				for(int y=0;y<size;++y)
 					for(int x=0;x<size;++x)
 						rag->addVertex(particles.addParticle(1.0,Point(3.0+double(x)*scale,6.0+double(y)*scale,7.0),Vector::zero));
@@ -321,6 +329,20 @@ ParticleTest::ParticleTest(int& argc,char**& argv)
 				rag->setBackMaterial(GLMaterial(GLMaterial::Color(0.7f,0.8f,0.3f),GLMaterial::Color(0.5f,0.5f,0.5f),32.0f));
 				meshes.push_back(rag);
 				}
+			else if(strcasecmp(argv[argi],"-stepRate")==0&&argi+1<argc)
+				{
+				/* Set the number of fixed simulation time steps per second: */
+				Scalar stepRate=Scalar(atof(argv[++argi]));
+				if(stepRate>Scalar(0))
+					stepTime=Scalar(1)/stepRate;
+				}
+			else if(strcasecmp(argv[argi],"-maxSteps")==0&&argi+1<argc)
+				{
+				/* Set the maximum number of simulation time steps per frame: */
+				int maxSteps=atoi(argv[++argi]);
+				if(maxSteps>0)
+					maxStepsPerFrame=(unsigned int)(maxSteps);
+				}
 			else if(strcasecmp(argv[argi],"-whip")==0)
 				{
 				/* Create a whip: */
@@ -347,7 +369,7 @@ ParticleTest::ParticleTest(int& argc,char**& argv)
 					for(int j=i+1;j<4;++j)
 						particles.addDistConstraint(tetVertexIndices[i],tetVertexIndices[j],1,Scalar(1));
 				
-				ParticleMesh* tetrahedron=new ParticleMesh(particles);
+				ParticleMesh* tetrahedron=new ParticleMesh(particles,&meshScheduler);
 				for(int face=0;face<4;++face)
 					{
 					for(int v=0;v<3;++v)
@@ -402,22 +424,35 @@ ParticleTest::~ParticleTest(void)
 
 void ParticleTest::frame(void)
 	{
-	/* Get the time delta of the previous frame: */
+	/* Add the time delta of the previous frame to the time that still needs to be simulated: */
 	Scalar frameTime(Vrui::getFrameTime());
 	if(frameTime>Scalar(0))
+		stepAccumulator+=frameTime;
+	
+	/* Advance the particle system by fixed time steps until it catches up, but take at most the maximum number of steps: */
+	Scalar stepTime2=Math::sqr(stepTime);
+	for(unsigned int step=0;step<maxStepsPerFrame&&stepAccumulator>=stepTime;++step)
 		{
-		/* Move the particles by their velocities from the previous frame: */
-		particles.moveParticles(frameTime);
+		/* Move the particles by their velocities from the previous time step: */
+		particles.moveParticles(stepTime);
 		
 		/* Let all bodies apply forces to the particles: */
-		Scalar frameTime2=Math::sqr(frameTime);
 		for(std::vector<Body*>::iterator bIt=bodies.begin();bIt!=bodies.end();++bIt)
-			(*bIt)->applyForces(frameTime,frameTime2);
+			(*bIt)->applyForces(stepTime,stepTime2);
 		
 		/* Enforce the particle system's constraints: */
-		particles.enforceConstraints(frameTime);
+		particles.enforceConstraints(stepTime);
+		
+		stepAccumulator-=stepTime;
 		}
 	
+	/* Drop any time that could not be simulated during this frame to keep the cost of a frame bounded: */
+	if(stepAccumulator>=stepTime)
+		stepAccumulator-=Math::floor(stepAccumulator/stepTime)*stepTime;
+	
+	/* Interpolate particle positions for rendering between the last two simulated states: */
+	particles.interpolatePositions(stepAccumulator/stepTime);
+	
 	/* Update all meshes: */
 	for(std::vector<ParticleMesh*>::iterator mIt=meshes.begin();mIt!=meshes.end();++mIt)
 		(*mIt)->update();
@@ -454,7 +489,7 @@ void ParticleTest::display(GLContextData& contextData) const
 	glBegin(GL_POINTS);
 	glColor3f(1.0f,0.0f,1.0f);
 	for(std::vector<Index>::const_iterator aIt=atoms.begin();aIt!=atoms.end();++aIt)
-		glVertex(particles.getParticlePosition(*aIt));
+		glVertex(particles.getRenderPosition(*aIt));
 	glEnd();
 	
 	glPopAttrib();
@@ -50,7 +50,22 @@ class PointSpherePicker
 		}
 	
 	/* Methods: */
-	bool operator()(const Point& center,Scalar radius) // Checks if the given sphere registers as a pick and is closer than the previously picked sphere; returns true if sphere was picked
+	bool overlapsBox(const Point& min,const Point& max) const // Returns true if any sphere contained in the given axis-aligned box might register as a pick and be closer than the previously picked sphere
+		{
+		/* Calculate the squared distance from the query point to the box: */
+		Scalar dist2(0);
+		for(int i=0;i<3;++i)
+			{
+			if(queryPoint[i]<min[i])
+				dist2+=Math::sqr(min[i]-queryPoint[i]);
+			else if(queryPoint[i]>max[i])
+				dist2+=Math::sqr(queryPoint[i]-max[i]);
+			}
+		
+		/* Spheres' centers are inside the box, and their surfaces are no farther from the box than the maximum picking distance: */
+		return dist2<=Math::sqr(maxPickDist)&&dist2<pickDist2;
+		}
+	bool operator()(Index index,const Point& center,Scalar radius) // Checks if the given sphere of the given index registers as a pick and is closer than the previously picked sphere; returns true if sphere was picked
 		{
 		bool result=false;
 		
@@ -62,17 +77,19 @@ class PointSpherePicker
 			if(dist2<=Math::sqr(radius+maxPickDist))
 				{
 				/* Pick the sphere: */
-				pickIndex=sphereIndex;
+				pickIndex=index;
 				pickDist2=dist2;
 				result=true;
 				}
 			}
 		
-		/* Prepare to process the next sphere: */
-		++sphereIndex;
-		
 		return result;
 		}
+	bool operator()(const Point& center,Scalar radius) // Checks if the given sphere registers as a pick and is closer than the previously picked sphere; returns true if sphere was picked
+		{
+		/* Pick the sphere and prepare to process the next sphere: */
+		return operator()(sphereIndex++,center,radius);
+		}
 	Index getNumSpheres(void) const // Returns the total number of processed spheres
 		{
 		return sphereIndex;
@@ -40,6 +40,7 @@ class RaySpherePicker
 	/* Elements: */
 	private:
 	Ray queryRay; // The normalized query ray
+	Scalar cosMaxPickAngle; // Cosine of the maximum angle between query ray and surface of a sphere to register a pick
 	Scalar cosMaxPickAngle2; // Squared cosine of the maximum angle between query ray and surface of a sphere to register a pick
 	Scalar sinMaxPickAngle; // Sine of maximum pick angle
 	Index sphereIndex; // Index of the next sphere to be picked
@@ -50,7 +51,7 @@ class RaySpherePicker
 	public:
 	RaySpherePicker(const Ray& sQueryRay,Scalar sCosMaxPickAngle) // Creates a ray sphere picker for the given query ray and cosine of maximum picking angle
 		:queryRay(sQueryRay),
-		 cosMaxPickAngle2(Math::sqr(sCosMaxPickAngle)),sinMaxPickAngle(Math::sqrt(Scalar(1)-cosMaxPickAngle2)),
+		 cosMaxPickAngle(sCosMaxPickAngle),cosMaxPickAngle2(Math::sqr(sCosMaxPickAngle)),sinMaxPickAngle(Math::sqrt(Scalar(1)-cosMaxPickAngle2)),
 		 sphereIndex(0),
 		 pickIndex(~Index(0)),pickDist2(Math::Constants<Scalar>::max)
 		{
@@ -59,7 +60,31 @@ class RaySpherePicker
 		}
 	
 	/* Methods: */
-	bool operator()(const Point& center,Scalar radius) // Checks if the given sphere registers as a pick and is closer than the previously picked sphere; returns true if sphere was picked
+	bool overlapsBox(const Point& min,const Point& max) const // Returns true if any sphere contained in the given axis-aligned box might register as a pick and be closer than the previously picked sphere
+		{
+		/* Check the box's bounding sphere, which registers as a pick if any sphere it contains does: */
+		Point center=Geometry::mid(min,max);
+		Scalar radius2=Geometry::sqrDist(min,center);
+		Vector d=center-queryRay.getOrigin();
+		Scalar d2=d.sqr();
+		if(d2<=radius2)
+			{
+			/* The query ray starts inside the bounding sphere: */
+			return true;
+			}
+		
+		/* Reject the box if all spheres it contains are farther from the query ray's start than the currently picked sphere: */
+		Scalar dist=Math::sqrt(d2);
+		Scalar radius=Math::sqrt(radius2);
+		if(Math::sqr(dist-radius)>=pickDist2)
+			return false;
+		
+		/* Check if the angle between the query ray and the bounding sphere's center is smaller than the sphere's apparent angle plus the maximum pick angle: */
+		Scalar sinApparent=radius/dist;
+		Scalar cosApparent=Math::sqrt(Scalar(1)-Math::sqr(sinApparent));
+		return queryRay.getDirection()*d>=(cosApparent*cosMaxPickAngle-sinApparent*sinMaxPickAngle)*dist;
+		}
+	bool operator()(Index index,const Point& center,Scalar radius) // Checks if the given sphere of the given index registers as a pick and is closer than the previously picked sphere; returns true if sphere was picked
 		{
 		bool result=false;
 		
@@ -86,18 +111,20 @@ class RaySpherePicker
 				if(Math::sqr(qrdd+radius*sinMaxPickAngle)>=r2d2*cosMaxPickAngle2)
 					{
 					/* Pick the sphere: */
-					pickIndex=sphereIndex;
+					pickIndex=index;
 					pickDist2=d2;
 					result=true;
 					}
 				}
 			}
 		
-		/* Prepare to process the next sphere: */
-		++sphereIndex;
-		
 		return result;
 		}
+	bool operator()(const Point& center,Scalar radius) // Checks if the given sphere registers as a pick and is closer than the previously picked sphere; returns true if sphere was picked
+		{
+		/* Pick the sphere and prepare to process the next sphere: */
+		return operator()(sphereIndex++,center,radius);
+		}
 	Index getNumSpheres(void) const // Returns the total number of processed spheres
 		{
 		return sphereIndex;
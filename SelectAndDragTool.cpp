@@ -28,7 +28,6 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Vrui/Vrui.h>
 #include <Vrui/ToolManager.h>
 
-#include "Node.h"
 #include "Network.h"
 
 /*********************************************************
@@ -44,8 +43,6 @@ Methods of class NetworkViewer::SelectAndDragTool:
 void NetworkViewer::SelectAndDragTool::beginDrag(unsigned int pickedNodeIndex,const NetworkViewer::SelectAndDragTool::DragTransform& initialDragTransform)
 	{
 	Network* network=application->network;
-	const Network::NodeList& nodes=network->getNodes();
-	ParticleSystem& particles=application->particles;
 	
 	/* Try locking the set of selected nodes: */
 	draggingSelection=application->lockSelection();
@@ -57,59 +54,31 @@ void NetworkViewer::SelectAndDragTool::beginDrag(unsigned int pickedNodeIndex,co
 			/* Set the selection to the picked node: */
 			network->setSelection(pickedNodeIndex);
 			}
-		
-		/* Begin dragging the set of selected nodes: */
-		const Network::Selection& selection=network->getSelection();
-		draggedParticles.reserve(selection.getNumEntries());
-		for(Network::Selection::ConstIterator sIt=selection.begin();!sIt.isFinished();++sIt)
-			{
-			DraggedParticle dp;
-			dp.particleIndex=nodes[sIt->getSource()].getParticleIndex();
-			
-			/* Remember the particle's original mass and set it to infinity during dragging: */
-			dp.particleInvMass=application->particles.getParticleInvMass(dp.particleIndex);
-			particles.setParticleInvMass(dp.particleIndex,Scalar(0));
-			
-			/* Calculate the particle's position in drag space: */
-			dp.dragPosition=initialDragTransform.inverseTransform(particles.getParticlePosition(dp.particleIndex));
-			
-			draggedParticles.push_back(dp);
-			}
 		}
-	else if(!network->isSelected(pickedNodeIndex))
+	else if(network->isSelected(pickedNodeIndex))
 		{
-		/* Begin dragging the picked node: */
-		DraggedParticle dp;
-		dp.particleIndex=nodes[pickedNodeIndex].getParticleIndex();
-		
-		/* Remember the particle's original mass and set it to infinity during dragging: */
-		dp.particleInvMass=particles.getParticleInvMass(dp.particleIndex);
-		particles.setParticleInvMass(dp.particleIndex,Scalar(0));
-		
-		/* Calculate the particle's position in drag space: */
-		dp.dragPosition=initialDragTransform.inverseTransform(particles.getParticlePosition(dp.particleIndex));
-		
-		draggedParticles.push_back(dp);
+		/* Don't drag nodes that are part of a locked selection: */
+		return;
 		}
+	
+	/* Start dragging the selection, or only the picked node if it is not selected, in the network simulator: */
+	dragging=true;
+	dragId=application->nextDragId++;
+	application->simulator->dragStart(0,dragId,pickedNodeIndex,initialDragTransform);
 	}
 
 void NetworkViewer::SelectAndDragTool::drag(const NetworkViewer::SelectAndDragTool::DragTransform& dragTransform)
 	{
-	/* Move all dragged particles: */
-	ParticleSystem& particles=application->particles;
-	for(std::vector<DraggedParticle>::iterator dpIt=draggedParticles.begin();dpIt!=draggedParticles.end();++dpIt)
-		particles.setParticlePosition(dpIt->particleIndex,dragTransform.transform(dpIt->dragPosition));
+	/* Send the new drag transformation to the network simulator: */
+	application->simulator->drag(0,dragId,dragTransform);
 	}
 
 void NetworkViewer::SelectAndDragTool::endDrag(void)
 	{
-	/* Reset the mass of all dragged particles: */
-	ParticleSystem& particles=application->particles;
-	for(std::vector<DraggedParticle>::iterator dpIt=draggedParticles.begin();dpIt!=draggedParticles.end();++dpIt)
-		particles.setParticleInvMass(dpIt->particleIndex,dpIt->particleInvMass);
-	
-	/* Clear the list of dragged particles: */
-	draggedParticles.clear();
+	/* Stop dragging in the network simulator, which restores the masses of all dragged particles: */
+	if(dragging)
+		application->simulator->dragStop(0,dragId);
+	dragging=false;
 	
 	/* Unlock the set of selected node if it was being dragged: */
 	if(draggingSelection)
@@ -132,7 +101,8 @@ void NetworkViewer::SelectAndDragTool::initClass(void)
 
 NetworkViewer::SelectAndDragTool::SelectAndDragTool(const Vrui::ToolFactory* factory,const Vrui::ToolInputAssignment& inputAssignment)
 	:Tool(factory,inputAssignment),
-	 draggingSelection(false)
+	 draggingSelection(false),
+	 dragging(false),dragId(0)
 	{
 	}
 
@@ -179,8 +149,8 @@ void NetworkViewer::SelectAndDragTool::buttonCallback(int buttonSlotIndex,Vrui::
 
 void NetworkViewer::SelectAndDragTool::frame(void)
 	{
-	/* Check if the tool is dragging particles: */
-	if(!draggedParticles.empty())
+	/* Check if the tool is dragging nodes: */
+	if(dragging)
 		{
 		/* Calculate the drag transformation: */
 		Vrui::NavTransform devTrans=Vrui::getInverseNavigationTransformation()*Vrui::NavTransform(getButtonDeviceTransformation(0));
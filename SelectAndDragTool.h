@@ -23,10 +23,9 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef SELECTANDDRAGTOOL_INCLUDED
 #define SELECTANDDRAGTOOL_INCLUDED
 
-#include <vector>
-#include <Geometry/OrthonormalTransformation.h>
 #include <Vrui/GenericToolFactory.h>
 
+#include "NetworkSimulator.h"
 #include "NetworkViewerTool.h"
 
 /*****************************************************
@@ -37,24 +36,16 @@ class NetworkViewer::SelectAndDragTool:public NetworkViewer::Tool
 	{
 	/* Embedded classes: */
 	private:
-	typedef Geometry::OrthonormalTransformation<Scalar,3> DragTransform; // Type for dragging transformations
+	typedef NetworkSimulator::DragTransform DragTransform; // Type for dragging transformations
 	typedef Vrui::GenericToolFactory<SelectAndDragTool> Factory; // Factory class for this tool class
 	friend class Vrui::GenericToolFactory<SelectAndDragTool>;
 	
-	struct DraggedParticle // Structure to represent a dragged particle
-		{
-		/* Element: */
-		public:
-		Index particleIndex; // Index of the dragged particle
-		Scalar particleInvMass; // Original mass of the dragged particle
-		Point dragPosition; // Position of the dragged particle relative to tool's drag transformation
-		};
-	
 	/* Elements: */
 	private:
 	static Factory* factory; // Pointer to the factory object for this class
 	bool draggingSelection; // Flag whether this tool is currently dragging the set of selected nodes
-	std::vector<DraggedParticle> draggedParticles; // List of currently dragged particles
+	bool dragging; // Flag whether this tool is currently dragging nodes
+	unsigned int dragId; // ID of the tool's current dragging operation in the network simulator
 	
 	/* Private methods: */
 	void beginDrag(unsigned int pickedNodeIndex,const DragTransform& initialDragTransform); // Prepares for dragging the currently selected nodes, or the picked node if the selection is locked
@@ -0,0 +1,216 @@
+/***********************************************************************
+SelectionRegion - Structure describing a region of space or a node
+property predicate to select network nodes in bulk.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SELECTIONREGION_INCLUDED
+#define SELECTIONREGION_INCLUDED
+
+#include <stddef.h>
+#include <string>
+#include <Misc/SizedTypes.h>
+#include <Math/Math.h>
+#include <Geometry/Point.h>
+#include <Geometry/Vector.h>
+
+#include "ParticleTypes.h"
+
+struct SelectionRegion
+	{
+	/* Embedded classes: */
+	public:
+	enum Type // Enumerated type for selection region shapes
+		{
+		Sphere=0, // Sphere around a center point
+		Box, // Axis-aligned box
+		RayCone, // Infinite cone around a ray, defined by the cosine of the cone's half opening angle
+		Property // Predicate on the value of a node property; independent of node positions
+		};
+	
+	enum Comparison // Enumerated type for node property comparison operators
+		{
+		Equal=0,
+		NotEqual,
+		Less,
+		LessEqual,
+		Greater,
+		GreaterEqual
+		};
+	
+	/* Elements: */
+	static const size_t size=sizeof(Misc::UInt8)+7*sizeof(Scalar)+sizeof(Misc::UInt8); // Size of the region's geometric parameters when read from/written to a binary source/sink; property name and value are sent separately
+	Misc::UInt8 type; // Region type
+	Point center; // Center point of a sphere region, or apex of a ray cone region
+	Scalar radius; // Radius of a sphere region
+	Point min,max; // Corner points of a box region
+	Vector axis; // Normalized axis direction of a ray cone region
+	Scalar cosAngle; // Cosine of a ray cone region's half opening angle; clamped to [0, 1]
+	Misc::UInt8 comparison; // Comparison operator for a property region
+	std::string propertyName; // Name of the node property tested by a property region
+	std::string propertyValue; // Value against which a property region compares node properties
+	
+	/* Constructors and destructors: */
+	SelectionRegion(void) // Creates an empty sphere region
+		:type(Sphere),center(Point::origin),radius(0),
+		 min(Point::origin),max(Point::origin),
+		 axis(0,0,1),cosAngle(1),
+		 comparison(Equal)
+		{
+		}
+	
+	/* Methods: */
+	bool isSpatial(void) const // Returns true if the region selects nodes by their positions
+		{
+		return type!=Property;
+		}
+	bool overlapsBox(const Point& boxMin,const Point& boxMax) const // Returns true if the region might contain points inside the given axis-aligned box
+		{
+		switch(type)
+			{
+			case Sphere:
+				{
+				/* Calculate the squared distance from the sphere's center to the box: */
+				Scalar dist2(0);
+				for(int i=0;i<3;++i)
+					{
+					if(center[i]<boxMin[i])
+						dist2+=Math::sqr(boxMin[i]-center[i]);
+					else if(center[i]>boxMax[i])
+						dist2+=Math::sqr(center[i]-boxMax[i]);
+					}
+				return dist2<=Math::sqr(radius);
+				}
+			
+			case Box:
+				return min[0]<=boxMax[0]&&max[0]>=boxMin[0]&&min[1]<=boxMax[1]&&max[1]>=boxMin[1]&&min[2]<=boxMax[2]&&max[2]>=boxMin[2];
+			
+			case RayCone:
+				{
+				/* Test the cone conservatively against the box's bounding sphere: */
+				Vector d=Geometry::mid(boxMin,boxMax)-center;
+				Scalar dLen=d.mag();
+				Scalar boxRadius=Geometry::dist(boxMin,boxMax)*Scalar(0.5);
+				if(dLen<=boxRadius)
+					return true;
+				
+				/* Compare the angle between cone axis and sphere center to the sum of the cone's and sphere's apparent half angles: */
+				Scalar sinS=boxRadius/dLen;
+				Scalar cosS=Math::sqrt(Scalar(1)-Math::sqr(sinS));
+				Scalar sinA=Math::sqrt(Scalar(1)-Math::sqr(cosAngle));
+				return (d*axis)>=dLen*(cosAngle*cosS-sinA*sinS);
+				}
+			
+			default:
+				return false;
+			}
+		}
+	bool contains(const Point& p) const // Returns true if the given point is inside the region
+		{
+		switch(type)
+			{
+			case Sphere:
+				return Geometry::sqrDist(center,p)<=Math::sqr(radius);
+			
+			case Box:
+				return p[0]>=min[0]&&p[0]<=max[0]&&p[1]>=min[1]&&p[1]<=max[1]&&p[2]>=min[2]&&p[2]<=max[2];
+			
+			case RayCone:
+				{
+				Vector d=p-center;
+				Scalar along=d*axis;
+				return along>=Scalar(0)&&Math::sqr(along)>=Math::sqr(cosAngle)*d.sqr();
+				}
+			
+			default:
+				return false;
+			}
+		}
+	template <class SourceParam>
+	void read(SourceParam& source) // Reads the region's type and geometric parameters from a binary source
+		{
+		source.read(type);
+		Scalar params[7];
+		for(int i=0;i<7;++i)
+			source.read(params[i]);
+		source.read(comparison);
+		
+		/* Unpack the geometric parameters based on the region's type: */
+		switch(type)
+			{
+			case Sphere:
+				center=Point(params);
+				radius=params[3];
+				break;
+			
+			case Box:
+				min=Point(params);
+				max=Point(params+3);
+				break;
+			
+			case RayCone:
+				center=Point(params);
+				axis=Vector(params+3);
+				if(axis.sqr()>Scalar(0))
+					axis.normalize();
+				cosAngle=Math::clamp(params[6],Scalar(0),Scalar(1));
+				break;
+			}
+		}
+	template <class SinkParam>
+	void write(SinkParam& sink) const // Writes the region's type and geometric parameters to a binary sink
+		{
+		sink.write(type);
+		
+		/* Pack the geometric parameters based on the region's type: */
+		Scalar params[7];
+		for(int i=0;i<7;++i)
+			params[i]=Scalar(0);
+		switch(type)
+			{
+			case Sphere:
+				for(int i=0;i<3;++i)
+					params[i]=center[i];
+				params[3]=radius;
+				break;
+			
+			case Box:
+				for(int i=0;i<3;++i)
+					{
+					params[i]=min[i];
+					params[3+i]=max[i];
+					}
+				break;
+			
+			case RayCone:
+				for(int i=0;i<3;++i)
+					{
+					params[i]=center[i];
+					params[3+i]=axis[i];
+					}
+				params[6]=cosAngle;
+				break;
+			}
+		for(int i=0;i<7;++i)
+			sink.write(params[i]);
+		sink.write(comparison);
+		}
+	};
+
+#endif
@@ -0,0 +1,337 @@
+/***********************************************************************
+SessionPlayer - Class to play back the simulation updates and selection
+and label changes of a network viewer session from a file written by a
+session recorder.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include "SessionPlayer.h"
+
+#include <string.h>
+#include <stdexcept>
+#include <Misc/Endianness.h>
+#include <IO/OpenFile.h>
+
+/******************************
+Methods of class SessionPlayer:
+******************************/
+
+void SessionPlayer::readEventBody(SessionPlayer::Event& event)
+	{
+	event.node=0;
+	event.mode=0;
+	event.nodes.clear();
+	switch(event.type)
+		{
+		case SessionRecorder::SelectNode:
+		case SessionRecorder::DisplayLabel:
+			event.node=file->read<Misc::UInt32>();
+			event.mode=file->read<Misc::UInt8>();
+			if(event.node>=numNodes)
+				throw std::runtime_error("SessionPlayer::readEventBody: Invalid node index in event record");
+			break;
+		
+		case SessionRecorder::ChangeSelection:
+			event.mode=file->read<Misc::UInt8>();
+			break;
+		
+		case SessionRecorder::SelectNodes:
+		case SessionRecorder::SetLabels:
+			{
+			if(event.type==SessionRecorder::SelectNodes)
+				event.mode=file->read<Misc::UInt8>();
+			Misc::UInt32 numEventNodes=file->read<Misc::UInt32>();
+			
+			/* Reject node sets that are larger than the network or than the rest of the file: */
+			if(numEventNodes>numNodes||IO::SeekableFile::Offset(numEventNodes)*IO::SeekableFile::Offset(sizeof(Misc::UInt32))>file->getSize()-file->getReadPosAbs())
+				throw std::runtime_error("SessionPlayer::readEventBody: Invalid node set size in event record");
+			
+			event.nodes.reserve(numEventNodes);
+			for(Misc::UInt32 i=0;i<numEventNodes;++i)
+				{
+				Index node=file->read<Misc::UInt32>();
+				if(node>=numNodes)
+					throw std::runtime_error("SessionPlayer::readEventBody: Invalid node index in event record");
+				event.nodes.push_back(node);
+				}
+			break;
+			}
+		
+		default:
+			throw std::runtime_error("SessionPlayer::readEventBody: Invalid event record");
+		}
+	}
+
+void SessionPlayer::skipRecordBody(SessionRecorder::RecordType type)
+	{
+	switch(type)
+		{
+		case SessionRecorder::KeyFrame:
+			file->skip<RScalar>(size_t(numNodes)*3);
+			break;
+		
+		case SessionRecorder::DeltaFrame8:
+			file->skip<Misc::SInt8>(size_t(numNodes)*3);
+			break;
+		
+		case SessionRecorder::DeltaFrame16:
+			file->skip<Misc::SInt16>(size_t(numNodes)*3);
+			break;
+		
+		default:
+			{
+			/* Read and discard the event: */
+			Event event;
+			event.type=type;
+			readEventBody(event);
+			}
+		}
+	}
+
+void SessionPlayer::readIndex(IO::SeekableFile::Offset indexOffset)
+	{
+	/* Read the recording's duration and the key frame index: */
+	file->setReadPosAbs(indexOffset);
+	duration=file->read<Misc::Float64>();
+	Misc::UInt32 numKeyFrames=file->read<Misc::UInt32>();
+	if(IO::SeekableFile::Offset(numKeyFrames)*IO::SeekableFile::Offset(sizeof(Misc::Float64)+sizeof(Misc::UInt64))>file->getSize()-file->getReadPosAbs())
+		throw std::runtime_error("SessionPlayer::readIndex: Invalid number of key frames in index");
+	keyFrames.reserve(numKeyFrames);
+	for(Misc::UInt32 i=0;i<numKeyFrames;++i)
+		{
+		double time=file->read<Misc::Float64>();
+		IO::SeekableFile::Offset offset=IO::SeekableFile::Offset(file->read<Misc::UInt64>());
+		keyFrames.push_back(std::make_pair(time,offset));
+		}
+	
+	/* Read the event index: */
+	Misc::UInt32 numEvents=file->read<Misc::UInt32>();
+	if(IO::SeekableFile::Offset(numEvents)*IO::SeekableFile::Offset(sizeof(Misc::UInt64))>file->getSize()-file->getReadPosAbs())
+		throw std::runtime_error("SessionPlayer::readIndex: Invalid number of events in index");
+	std::vector<IO::SeekableFile::Offset> eventOffsets;
+	eventOffsets.reserve(numEvents);
+	for(Misc::UInt32 i=0;i<numEvents;++i)
+		eventOffsets.push_back(IO::SeekableFile::Offset(file->read<Misc::UInt64>()));
+	
+	/* Read all events: */
+	events.resize(numEvents);
+	for(Misc::UInt32 i=0;i<numEvents;++i)
+		{
+		file->setReadPosAbs(eventOffsets[i]);
+		events[i].type=SessionRecorder::RecordType(file->read<Misc::UInt8>());
+		events[i].time=file->read<Misc::Float64>();
+		readEventBody(events[i]);
+		}
+	
+	recordsEnd=indexOffset;
+	}
+
+void SessionPlayer::scanRecords(void)
+	{
+	/* Read all record headers until the end of the file or the first incomplete record, e.g., from a recording that was not closed properly: */
+	IO::SeekableFile::Offset fileSize=file->getSize();
+	IO::SeekableFile::Offset offset=recordsBegin;
+	try
+		{
+		file->setReadPosAbs(offset);
+		while(offset<fileSize)
+			{
+			/* Read the record header: */
+			SessionRecorder::RecordType type=SessionRecorder::RecordType(file->read<Misc::UInt8>());
+			if(type>=SessionRecorder::NumRecordTypes)
+				break;
+			double time=file->read<Misc::Float64>();
+			
+			/* Process the record body: */
+			if(type>=SessionRecorder::SelectNode)
+				{
+				Event event;
+				event.time=time;
+				event.type=type;
+				readEventBody(event);
+				events.push_back(event);
+				}
+			else
+				{
+				skipRecordBody(type);
+				if(file->getReadPosAbs()>fileSize)
+					break;
+				if(type==SessionRecorder::KeyFrame)
+					keyFrames.push_back(std::make_pair(time,offset));
+				}
+			
+			/* Go to the next record: */
+			duration=time;
+			offset=file->getReadPosAbs();
+			}
+		}
+	catch(const std::runtime_error&)
+		{
+		/* Ignore the incomplete record: */
+		}
+	
+	recordsEnd=offset;
+	}
+
+SessionPlayer::SessionPlayer(const char* fileName)
+	:file(IO::openSeekableFile(fileName)),
+	 numNodes(0),quantum(0),
+	 recordsBegin(0),recordsEnd(0),duration(0.0),
+	 nextRecord(0),havePositions(false)
+	{
+	/* Read the file header: */
+	file->setEndianness(Misc::LittleEndian);
+	char tag[sizeof(SessionRecorder::fileTag)];
+	file->read(tag,sizeof(tag));
+	if(memcmp(tag,SessionRecorder::fileTag,sizeof(tag))!=0)
+		throw std::runtime_error("SessionPlayer::SessionPlayer: File is not a network viewer session recording");
+	numNodes=file->read<Misc::UInt32>();
+	quantum=file->read<Misc::Float32>();
+	Misc::UInt32 networkNameLength=file->read<Misc::UInt32>();
+	networkName.resize(networkNameLength);
+	if(networkNameLength>0)
+		file->read(&networkName[0],networkNameLength);
+	recordsBegin=file->getReadPosAbs();
+	
+	/* Check if the file has an index trailer: */
+	IO::SeekableFile::Offset fileSize=file->getSize();
+	bool haveIndex=false;
+	if(fileSize>=recordsBegin+IO::SeekableFile::Offset(SessionRecorder::trailerSize))
+		{
+		file->setReadPosAbs(fileSize-IO::SeekableFile::Offset(SessionRecorder::trailerSize));
+		IO::SeekableFile::Offset indexOffset=IO::SeekableFile::Offset(file->read<Misc::UInt64>());
+		char indexTag[sizeof(SessionRecorder::indexTag)];
+		file->read(indexTag,sizeof(indexTag));
+		if(memcmp(indexTag,SessionRecorder::indexTag,sizeof(indexTag))==0&&indexOffset>=recordsBegin&&indexOffset<fileSize)
+			{
+			readIndex(indexOffset);
+			haveIndex=true;
+			}
+		}
+	
+	/* Otherwise, build the index by scanning the file: */
+	if(!haveIndex)
+		scanRecords();
+	if(keyFrames.empty())
+		throw std::runtime_error("SessionPlayer::SessionPlayer: Session recording does not contain any simulation updates");
+	
+	positions.resize(numNodes);
+	deltas.resize(size_t(numNodes)*3);
+	nextRecord=recordsBegin;
+	}
+
+SessionPlayer::~SessionPlayer(void)
+	{
+	}
+
+size_t SessionPlayer::findEvent(double time) const
+	{
+	/* Binary search for the first event after the given time: */
+	size_t l=0;
+	size_t r=events.size();
+	while(l<r)
+		{
+		size_t m=(l+r)>>1;
+		if(events[m].time<=time)
+			l=m+1;
+		else
+			r=m;
+		}
+	
+	return l;
+	}
+
+void SessionPlayer::seek(double time)
+	{
+	/* Find the last key frame at or before the given time, or the first key frame if there is none: */
+	size_t l=0;
+	size_t r=keyFrames.size();
+	while(r-l>1)
+		{
+		size_t m=(l+r)>>1;
+		if(keyFrames[m].first<=time)
+			l=m;
+		else
+			r=m;
+		}
+	
+	/* Restart playback from the key frame and read all following frames up to the given time: */
+	nextRecord=keyFrames[l].second;
+	havePositions=false;
+	advance(time>=keyFrames[l].first?time:keyFrames[l].first);
+	}
+
+bool SessionPlayer::advance(double time)
+	{
+	bool result=false;
+	while(nextRecord<recordsEnd)
+		{
+		/* Read the next record's header and stop if the record is in the future: */
+		file->setReadPosAbs(nextRecord);
+		SessionRecorder::RecordType type=SessionRecorder::RecordType(file->read<Misc::UInt8>());
+		double recordTime=file->read<Misc::Float64>();
+		if(recordTime>time)
+			break;
+		
+		switch(type)
+			{
+			case SessionRecorder::KeyFrame:
+				/* Read the complete set of node positions: */
+				for(RPointList::iterator pIt=positions.begin();pIt!=positions.end();++pIt)
+					file->read(pIt->getComponents(),3);
+				havePositions=true;
+				result=true;
+				break;
+			
+			case SessionRecorder::DeltaFrame8:
+			case SessionRecorder::DeltaFrame16:
+				if(havePositions)
+					{
+					/* Read the quantized position changes: */
+					if(type==SessionRecorder::DeltaFrame8)
+						{
+						for(std::vector<Misc::SInt32>::iterator dIt=deltas.begin();dIt!=deltas.end();++dIt)
+							*dIt=file->read<Misc::SInt8>();
+						}
+					else
+						{
+						for(std::vector<Misc::SInt32>::iterator dIt=deltas.begin();dIt!=deltas.end();++dIt)
+							*dIt=file->read<Misc::SInt16>();
+						}
+					
+					/* Apply the position changes to the reconstructed positions: */
+					std::vector<Misc::SInt32>::iterator dIt=deltas.begin();
+					for(RPointList::iterator pIt=positions.begin();pIt!=positions.end();++pIt,dIt+=3)
+						SessionRecorder::applyDelta(*pIt,&*dIt,quantum);
+					result=true;
+					}
+				else
+					skipRecordBody(type);
+				break;
+			
+			default:
+				/* Events are handled from the event list: */
+				skipRecordBody(type);
+			}
+		
+		nextRecord=file->getReadPosAbs();
+		}
+	
+	return result;
+	}
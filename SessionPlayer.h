@@ -0,0 +1,115 @@
+/***********************************************************************
+SessionPlayer - Class to play back the simulation updates and selection
+and label changes of a network viewer session from a file written by a
+session recorder.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SESSIONPLAYER_INCLUDED
+#define SESSIONPLAYER_INCLUDED
+
+#include <string>
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <IO/SeekableFile.h>
+
+#include "ParticleTypes.h"
+#include "SessionRecorder.h"
+
+class SessionPlayer
+	{
+	/* Embedded classes: */
+	public:
+	typedef SessionRecorder::RScalar RScalar;
+	typedef SessionRecorder::RPoint RPoint;
+	typedef SessionRecorder::RPointList RPointList;
+	
+	struct Event // Structure for recorded selection and label changes
+		{
+		/* Elements: */
+		public:
+		double time; // Time of the change relative to the start of recording in seconds
+		SessionRecorder::RecordType type; // Type of the change
+		Index node; // Affected node for single-node changes
+		Misc::UInt8 mode; // Selection mode or command of the change
+		std::vector<Index> nodes; // Sorted set of affected nodes for multi-node changes
+		};
+	
+	/* Elements: */
+	private:
+	IO::SeekableFilePtr file; // The session recording file
+	std::string networkName; // Name of the recorded network
+	Index numNodes; // Number of nodes in the recorded network
+	RScalar quantum; // Quantization step for position changes in delta frames
+	IO::SeekableFile::Offset recordsBegin; // File offset of the first record
+	IO::SeekableFile::Offset recordsEnd; // File offset after the last record
+	std::vector<std::pair<double,IO::SeekableFile::Offset> > keyFrames; // Times and file offsets of all key frames
+	std::vector<Event> events; // List of all selection and label changes in time order
+	double duration; // Time of the last record relative to the start of recording in seconds
+	IO::SeekableFile::Offset nextRecord; // File offset of the next record to be read during playback
+	RPointList positions; // Node positions reconstructed up to the most recently read frame
+	bool havePositions; // Flag whether any frame has been read since the most recent seek
+	std::vector<Misc::SInt32> deltas; // Buffer for quantized position changes read from delta frames
+	
+	/* Private methods: */
+	void readEventBody(Event& event); // Reads the body of a selection or label change record from the current file position
+	void skipRecordBody(SessionRecorder::RecordType type); // Skips the body of a record of the given type
+	void readIndex(IO::SeekableFile::Offset indexOffset); // Reads the file's index
+	void scanRecords(void); // Builds the index by scanning the file's records if the file has no index
+	
+	/* Constructors and destructors: */
+	public:
+	SessionPlayer(const char* fileName); // Opens the session recording file of the given name
+	~SessionPlayer(void);
+	
+	/* Methods: */
+	const std::string& getNetworkName(void) const // Returns the name of the recorded network
+		{
+		return networkName;
+		}
+	Index getNumNodes(void) const // Returns the number of nodes in the recorded network
+		{
+		return numNodes;
+		}
+	double getDuration(void) const // Returns the length of the recording in seconds
+		{
+		return duration;
+		}
+	size_t getNumKeyFrames(void) const // Returns the number of key frames in the recording
+		{
+		return keyFrames.size();
+		}
+	const std::vector<Event>& getEvents(void) const // Returns the list of recorded selection and label changes
+		{
+		return events;
+		}
+	size_t findEvent(double time) const; // Returns the index of the first recorded selection or label change after the given time
+	void seek(double time); // Reconstructs node positions from the last frame at or before the given time, starting from the nearest preceding key frame
+	bool advance(double time); // Reads all frames after the current playback position up to the given time; returns true if node positions changed
+	bool hasPositions(void) const // Returns true if node positions have been reconstructed since the most recent seek
+		{
+		return havePositions;
+		}
+	const RPointList& getPositions(void) const // Returns the reconstructed node positions
+		{
+		return positions;
+		}
+	};
+
+#endif
@@ -0,0 +1,222 @@
+/***********************************************************************
+SessionRecorder - Class to record the simulation updates and selection
+and label changes of a network viewer session to a compressed, seekable
+file.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include "SessionRecorder.h"
+
+#include <stdexcept>
+#include <Misc/Endianness.h>
+#include <Misc/MessageLogger.h>
+#include <Math/Math.h>
+#include <IO/OpenFile.h>
+
+/****************************************
+Static elements of class SessionRecorder:
+****************************************/
+
+const char SessionRecorder::fileTag[32]="Network Viewer Session 1.0\n";
+const char SessionRecorder::indexTag[8]={'N','V','S','I','n','d','e','x'};
+
+/********************************
+Methods of class SessionRecorder:
+********************************/
+
+double SessionRecorder::startRecord(SessionRecorder::RecordType type)
+	{
+	/* Write the record type and its time stamp relative to the start of recording: */
+	double time=double(Realtime::TimePointMonotonic()-startTime);
+	file->write(Misc::UInt8(type));
+	file->write(Misc::Float64(time));
+	lastTime=time;
+	
+	return time;
+	}
+
+SessionRecorder::SessionRecorder(const char* fileName,const std::string& networkName,Index sNumNodes,double sQuantum,unsigned int sKeyFrameInterval)
+	:file(IO::openSeekableFile(fileName,IO::File::WriteOnly)),
+	 numNodes(sNumNodes),quantum(RScalar(sQuantum)),keyFrameInterval(sKeyFrameInterval),
+	 numDeltaFrames(0),numFrames(0),lastTime(0.0),closed(false)
+	{
+	/* Check the quantization step: */
+	if(!(quantum>RScalar(0)))
+		throw std::runtime_error("SessionRecorder::SessionRecorder: Invalid quantization step");
+	
+	/* Write the file header: */
+	file->setEndianness(Misc::LittleEndian);
+	file->write(fileTag,sizeof(fileTag));
+	file->write(Misc::UInt32(numNodes));
+	file->write(Misc::Float32(quantum));
+	file->write(Misc::UInt32(networkName.size()));
+	file->write(networkName.data(),networkName.size());
+	
+	deltas.resize(size_t(numNodes)*3);
+	}
+
+SessionRecorder::~SessionRecorder(void)
+	{
+	/* Write the file's index if the recording was not closed explicitly: */
+	if(!closed)
+		{
+		try
+			{
+			close();
+			}
+		catch(const std::runtime_error& err)
+			{
+			/* Print an error message: */
+			Misc::formattedUserError("SessionRecorder::~SessionRecorder: Unable to write recording index due to exception %s",err.what());
+			}
+		}
+	}
+
+void SessionRecorder::recordFrame(const SessionRecorder::RPointList& positions)
+	{
+	/* Ignore frames that don't match the recorded network: */
+	if(positions.size()!=numNodes)
+		return;
+	
+	/* Quantize the position changes relative to the previous frame and find their range: */
+	Misc::SInt32 maxDelta=0;
+	if(!reference.empty()&&numDeltaFrames<keyFrameInterval)
+		{
+		std::vector<Misc::SInt32>::iterator dIt=deltas.begin();
+		RPointList::iterator rIt=reference.begin();
+		for(RPointList::const_iterator pIt=positions.begin();pIt!=positions.end()&&maxDelta<=32767;++pIt,++rIt)
+			for(int i=0;i<3;++i,++dIt)
+				{
+				double delta=Math::floor(double((*pIt)[i]-(*rIt)[i])/double(quantum)+0.5);
+				*dIt=Math::abs(delta)<=32767.0?Misc::SInt32(delta):Misc::SInt32(32768);
+				if(maxDelta<Math::abs(*dIt))
+					maxDelta=Math::abs(*dIt);
+				}
+		}
+	else
+		maxDelta=32768;
+	
+	if(maxDelta<=32767)
+		{
+		/* Write a delta frame using the smallest sufficient quantization: */
+		if(maxDelta<=127)
+			{
+			startRecord(DeltaFrame8);
+			for(std::vector<Misc::SInt32>::iterator dIt=deltas.begin();dIt!=deltas.end();++dIt)
+				file->write(Misc::SInt8(*dIt));
+			}
+		else
+			{
+			startRecord(DeltaFrame16);
+			for(std::vector<Misc::SInt32>::iterator dIt=deltas.begin();dIt!=deltas.end();++dIt)
+				file->write(Misc::SInt16(*dIt));
+			}
+		
+		/* Update the reconstructed positions exactly as a player will: */
+		std::vector<Misc::SInt32>::iterator dIt=deltas.begin();
+		for(RPointList::iterator rIt=reference.begin();rIt!=reference.end();++rIt,dIt+=3)
+			applyDelta(*rIt,&*dIt,quantum);
+		++numDeltaFrames;
+		}
+	else
+		{
+		/* Write a key frame and remember its location in the index: */
+		IO::SeekableFile::Offset offset=file->getWritePosAbs();
+		double time=startRecord(KeyFrame);
+		keyFrames.push_back(std::make_pair(time,offset));
+		for(RPointList::const_iterator pIt=positions.begin();pIt!=positions.end();++pIt)
+			file->write(pIt->getComponents(),3);
+		
+		/* Reset the reconstructed positions: */
+		reference=positions;
+		numDeltaFrames=0;
+		}
+	
+	++numFrames;
+	}
+
+void SessionRecorder::recordSelectNode(Index node,Misc::UInt8 mode)
+	{
+	events.push_back(file->getWritePosAbs());
+	startRecord(SelectNode);
+	file->write(Misc::UInt32(node));
+	file->write(mode);
+	}
+
+void SessionRecorder::recordChangeSelection(Misc::UInt8 command)
+	{
+	events.push_back(file->getWritePosAbs());
+	startRecord(ChangeSelection);
+	file->write(command);
+	}
+
+void SessionRecorder::recordSelectNodes(const std::vector<Index>& nodes,Misc::UInt8 mode)
+	{
+	events.push_back(file->getWritePosAbs());
+	startRecord(SelectNodes);
+	file->write(mode);
+	file->write(Misc::UInt32(nodes.size()));
+	for(std::vector<Index>::const_iterator nIt=nodes.begin();nIt!=nodes.end();++nIt)
+		file->write(Misc::UInt32(*nIt));
+	}
+
+void SessionRecorder::recordDisplayLabel(Index node,Misc::UInt8 command)
+	{
+	events.push_back(file->getWritePosAbs());
+	startRecord(DisplayLabel);
+	file->write(Misc::UInt32(node));
+	file->write(command);
+	}
+
+void SessionRecorder::recordSetLabels(const std::vector<Index>& nodes)
+	{
+	events.push_back(file->getWritePosAbs());
+	startRecord(SetLabels);
+	file->write(Misc::UInt32(nodes.size()));
+	for(std::vector<Index>::const_iterator nIt=nodes.begin();nIt!=nodes.end();++nIt)
+		file->write(Misc::UInt32(*nIt));
+	}
+
+void SessionRecorder::close(void)
+	{
+	/* Don't write the index twice, even if writing it failed: */
+	if(closed)
+		return;
+	closed=true;
+	
+	/* Write the index of key frames and selection and label change records: */
+	IO::SeekableFile::Offset indexOffset=file->getWritePosAbs();
+	file->write(Misc::Float64(lastTime));
+	file->write(Misc::UInt32(keyFrames.size()));
+	for(std::vector<std::pair<double,IO::SeekableFile::Offset> >::iterator kfIt=keyFrames.begin();kfIt!=keyFrames.end();++kfIt)
+		{
+		file->write(Misc::Float64(kfIt->first));
+		file->write(Misc::UInt64(kfIt->second));
+		}
+	file->write(Misc::UInt32(events.size()));
+	for(std::vector<IO::SeekableFile::Offset>::iterator eIt=events.begin();eIt!=events.end();++eIt)
+		file->write(Misc::UInt64(*eIt));
+	
+	/* Write the index trailer: */
+	file->write(Misc::UInt64(indexOffset));
+	file->write(indexTag,sizeof(indexTag));
+	
+	/* Write all buffered data to the file: */
+	file->flush();
+	}
@@ -0,0 +1,115 @@
+/***********************************************************************
+SessionRecorder - Class to record the simulation updates and selection
+and label changes of a network viewer session to a compressed, seekable
+file.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SESSIONRECORDER_INCLUDED
+#define SESSIONRECORDER_INCLUDED
+
+#include <string>
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <Realtime/Time.h>
+#include <IO/SeekableFile.h>
+#include <Geometry/Point.h>
+
+#include "ParticleTypes.h"
+
+class SessionRecorder
+	{
+	/* Embedded classes: */
+	public:
+	typedef Misc::Float32 RScalar; // Scalar type for recorded positions
+	typedef Geometry::Point<RScalar,3> RPoint; // Type for recorded positions
+	typedef std::vector<RPoint> RPointList; // Type for lists of recorded positions
+	
+	enum RecordType // Enumerated type for records in a session recording file
+		{
+		KeyFrame=0, // Complete set of node positions
+		DeltaFrame8, // Node position changes relative to the previous frame, quantized to 8 bits per component
+		DeltaFrame16, // Node position changes relative to the previous frame, quantized to 16 bits per component
+		SelectNode, // Change to the selection state of a single node
+		ChangeSelection, // Global change to the selection set
+		SelectNodes, // Change to the selection state of a set of nodes
+		DisplayLabel, // Change to the label set
+		SetLabels, // Replacement of the label set
+		NumRecordTypes
+		};
+	
+	/* Elements: */
+	static const char fileTag[32]; // Tag at the beginning of a session recording file
+	static const char indexTag[8]; // Tag at the end of a session recording file with a complete index
+	static const size_t trailerSize=16; // Size of the index trailer at the end of a session recording file
+	private:
+	IO::SeekableFilePtr file; // The session recording file
+	Index numNodes; // Number of nodes in the recorded network
+	RScalar quantum; // Quantization step for position changes in delta frames
+	unsigned int keyFrameInterval; // Maximum number of delta frames between key frames
+	Realtime::TimePointMonotonic startTime; // Time at which recording started
+	RPointList reference; // Node positions as reconstructed from the most recent frames
+	std::vector<Misc::SInt32> deltas; // Quantized position changes of the current frame
+	unsigned int numDeltaFrames; // Number of delta frames since the most recent key frame
+	std::vector<std::pair<double,IO::SeekableFile::Offset> > keyFrames; // Times and file offsets of all key frames
+	std::vector<IO::SeekableFile::Offset> events; // File offsets of all selection and label change records
+	size_t numFrames; // Total number of recorded frames
+	double lastTime; // Time stamp of the most recent record
+	bool closed; // Flag whether the file's index has been written
+	
+	/* Private methods: */
+	double startRecord(RecordType type); // Writes the header of a record of the given type and returns its time stamp
+	
+	/* Constructors and destructors: */
+	public:
+	SessionRecorder(const char* fileName,const std::string& networkName,Index sNumNodes,double sQuantum,unsigned int sKeyFrameInterval); // Starts recording a session whose network of the given name has the given number of nodes into the file of the given name
+	~SessionRecorder(void); // Writes the file's index if close was not called, logging instead of throwing errors, and closes the file
+	
+	/* Methods: */
+	static void applyDelta(RPoint& position,const Misc::SInt32 delta[3],RScalar quantum) // Adds a quantized position change to a reconstructed position; shared by recorder and player to reconstruct identical positions
+		{
+		for(int i=0;i<3;++i)
+			position[i]+=RScalar(delta[i])*quantum;
+		}
+	Index getNumNodes(void) const // Returns the number of nodes in the recorded network
+		{
+		return numNodes;
+		}
+	size_t getNumFrames(void) const // Returns the number of recorded frames
+		{
+		return numFrames;
+		}
+	size_t getNumKeyFrames(void) const // Returns the number of recorded key frames
+		{
+		return keyFrames.size();
+		}
+	IO::SeekableFile::Offset getFileSize(void) const // Returns the current size of the recording file in bytes
+		{
+		return file->getWritePosAbs();
+		}
+	void recordFrame(const RPointList& positions); // Records a simulation update with the given node positions
+	void recordSelectNode(Index node,Misc::UInt8 mode); // Records a change to the selection state of a single node; mode 0: select, 1: deselect, 2: toggle
+	void recordChangeSelection(Misc::UInt8 command); // Records a global change to the selection set; 0: clear, 1: grow, 2: shrink
+	void recordSelectNodes(const std::vector<Index>& nodes,Misc::UInt8 mode); // Records a change to the selection state of the given sorted set of nodes; mode 0: select, 1: deselect, 2: toggle, 3: replace
+	void recordDisplayLabel(Index node,Misc::UInt8 command); // Records a change to the label set; 0: clear, 1: show node label, 2: hide node label
+	void recordSetLabels(const std::vector<Index>& nodes); // Records a replacement of the label set with the given set of nodes
+	void close(void); // Writes the file's index and flushes the file; no more records can be written afterwards
+	};
+
+#endif
@@ -0,0 +1,376 @@
+/***********************************************************************
+SimulationBenchmark - Headless utility to measure the performance of the
+network simulation on synthetic graphs of several families and sizes
+across numbers of threads and repelling force modes, and to report the
+results as CSV or json records.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdexcept>
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <Threads/FunctionCalls.h>
+#include <Realtime/Time.h>
+
+#include "ParticleTypes.h"
+#include "ParticleSystem.h"
+#include "Network.h"
+#include "SimulationParameters.h"
+#include "SimulationScheduler.h"
+#include "NetworkSimulator.h"
+#include "GraphGenerator.h"
+#include "LayoutQuality.h"
+#include "Tracer.h"
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+class StepCounter // Class to count simulation steps from the simulation thread and to decide when a run is finished
+	{
+	/* Elements: */
+	private:
+	unsigned long numSteps; // Number of steps to run
+	unsigned long numCountedSteps; // Number of simulation updates received so far
+	Realtime::TimePointMonotonic firstStepTime; // Time at which the first step finished
+	Realtime::TimePointMonotonic lastStepTime; // Time at which the last counted step finished
+	volatile bool finished; // Flag whether the requested number of steps has been run
+	
+	/* Constructors and destructors: */
+	public:
+	StepCounter(unsigned long sNumSteps)
+		:numSteps(sNumSteps),numCountedSteps(0),finished(false)
+		{
+		}
+	
+	/* Methods: */
+	void simulationUpdateCallback(const ParticleSystem& particles) // Called from the simulation thread after every simulation step
+		{
+		if(finished)
+			return;
+		
+		/* Count the step and remember the times of the first and last steps: */
+		Realtime::TimePointMonotonic now;
+		if(numCountedSteps==0)
+			firstStepTime=now;
+		lastStepTime=now;
+		if(++numCountedSteps>=numSteps)
+			finished=true;
+		}
+	bool isFinished(void) const // Returns true if the requested number of steps has been run
+		{
+		return finished;
+		}
+	double getStepsPerSecond(void) const // Returns the simulation rate between the first and last counted steps; must only be called after the run is finished
+		{
+		double time=double(lastStepTime-firstStepTime);
+		return numCountedSteps>1&&time>0.0?double(numCountedSteps-1)/time:0.0;
+		}
+	};
+
+struct BenchmarkResult // Structure holding the results of one benchmark run
+	{
+	/* Elements: */
+	public:
+	const char* modelName; // Short name of the graph family
+	unsigned int numNodes,numLinks; // Size of the simulated network
+	unsigned int numThreads; // Number of threads in the simulation thread pool
+	const char* forceModeName; // Name of the repelling force mode
+	double generateTime; // Time to generate the graph and create the network in seconds
+	double setupTime; // Time to create the simulator's particle system in seconds
+	double stepsPerSecond; // Simulation rate
+	unsigned long numSteps; // Number of simulation steps reflected in the phase times
+	double moveTime,centralForceTime,repellingForceTime,constraintTime,octreeTime,updateTime; // Average times per simulation step in ms
+	NetworkSimulator::Statistics stats; // Simulator's performance counters at the end of the run
+	LayoutQuality::Metrics quality; // Quality of the layout at the end of the run
+	};
+
+/****************
+Helper functions:
+****************/
+
+void parseList(const char* list,std::vector<std::string>& items) // Splits the given comma-separated list into items
+	{
+	items.clear();
+	const char* itemStart=list;
+	while(true)
+		{
+		const char* itemEnd;
+		for(itemEnd=itemStart;*itemEnd!='\0'&&*itemEnd!=',';++itemEnd)
+			;
+		if(itemEnd!=itemStart)
+			items.push_back(std::string(itemStart,itemEnd));
+		if(*itemEnd=='\0')
+			break;
+		itemStart=itemEnd+1;
+		}
+	}
+
+void runBenchmark(Network& network,const SimulationParameters& simulationParameters,unsigned int numThreads,unsigned long numSteps,LayoutQuality* layoutQuality,BenchmarkResult& result) // Runs the given number of simulation steps on the given network with the given number of threads, and measures the resulting layout if the quality calculator is not null
+	{
+	/* Create the thread pool and the simulator, which starts running immediately and reports back after every step: */
+	SimulationScheduler scheduler(numThreads);
+	StepCounter counter(numSteps);
+	Realtime::TimePointMonotonic timer;
+	NetworkSimulator simulator(network,simulationParameters,*Threads::createFunctionCall(&counter,&StepCounter::simulationUpdateCallback),scheduler);
+	simulator.setUpdateInterval(0.0);
+	result.setupTime=double(timer.setAndDiff());
+	
+	/* Wait until the requested number of steps has run, then stop the simulator: */
+	while(!counter.isFinished())
+		usleep(1000);
+	simulator.suspend();
+	
+	/* Calculate per-step phase times from the simulator's final performance counters: */
+	result.numThreads=scheduler.getNumThreads();
+	result.stepsPerSecond=counter.getStepsPerSecond();
+	result.stats=simulator.getSuspendedStatistics();
+	const NetworkSimulator::Statistics& stats=result.stats;
+	result.numSteps=stats.numSteps;
+	double stepScale=stats.numSteps>0?1000.0/double(stats.numSteps):0.0;
+	result.moveTime=stats.moveTime*stepScale;
+	result.centralForceTime=stats.centralForceTime*stepScale;
+	result.repellingForceTime=stats.repellingForceTime*stepScale;
+	result.constraintTime=stats.constraintTime*stepScale;
+	result.octreeTime=stats.octreeTime*stepScale;
+	result.updateTime=stats.updateTime*stepScale;
+	
+	/* Measure the quality of the final layout using the now idle thread pool: */
+	if(layoutQuality!=0)
+		layoutQuality->calcMetrics(simulator.getSuspendedParticles(),&scheduler,result.quality);
+	}
+
+void writeCsvHeader(FILE* file) // Writes the column names of benchmark results in CSV format
+	{
+	fprintf(file,"model,nodes,links,threads,forceMode,generateSeconds,setupSeconds,steps,stepsPerSecond,moveMs,centralMs,repelMs,constraintMs,octreeMs,updateMs,octreeDepth,octreeNodes,octreeLeaves,networkBytes,particleSystemBytes,stress,meanLinkLength,linkLengthCV,neighborhoodPreservation,overlaps,qualitySeconds\n");
+	}
+
+void writeCsvResult(FILE* file,const BenchmarkResult& r) // Writes a benchmark result in CSV format
+	{
+	fprintf(file,"%s,%u,%u,%u,%s,%.6f,%.6f,%lu,%.3f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%u,%lu,%lu,%lu,%lu,",r.modelName,r.numNodes,r.numLinks,r.numThreads,r.forceModeName,r.generateTime,r.setupTime,r.numSteps,r.stepsPerSecond,r.moveTime,r.centralForceTime,r.repellingForceTime,r.constraintTime,r.octreeTime,r.updateTime,r.stats.octreeDepth,(unsigned long)(r.stats.numOctreeNodes),(unsigned long)(r.stats.numOctreeLeaves),(unsigned long)(r.stats.networkMemorySize),(unsigned long)(r.stats.particleSystemMemorySize));
+	fprintf(file,"%.6f,%.6f,%.6f,%.6f,%lu,%.6f\n",r.quality.stress,r.quality.meanLinkLength,r.quality.linkLengthCV,r.quality.neighborhoodPreservation,(unsigned long)(r.quality.numOverlaps),r.quality.calcTime);
+	}
+
+void writeJsonResult(FILE* file,const BenchmarkResult& r,bool first) // Writes a benchmark result as a json object, preceded by a separator unless it is the first
+	{
+	fprintf(file,"%s    {\"model\": \"%s\", \"nodes\": %u, \"links\": %u, \"threads\": %u, \"forceMode\": \"%s\", \"generateSeconds\": %.6f, \"setupSeconds\": %.6f, \"steps\": %lu, \"stepsPerSecond\": %.3f, ",first?"\n":",\n",r.modelName,r.numNodes,r.numLinks,r.numThreads,r.forceModeName,r.generateTime,r.setupTime,r.numSteps,r.stepsPerSecond);
+	fprintf(file,"\"phaseMs\": {\"move\": %.6f, \"central\": %.6f, \"repel\": %.6f, \"constraints\": %.6f, \"octree\": %.6f, \"update\": %.6f}, ",r.moveTime,r.centralForceTime,r.repellingForceTime,r.constraintTime,r.octreeTime,r.updateTime);
+	fprintf(file,"\"octree\": {\"depth\": %u, \"nodes\": %lu, \"leaves\": %lu}, \"memoryBytes\": {\"network\": %lu, \"particleSystem\": %lu}, ",r.stats.octreeDepth,(unsigned long)(r.stats.numOctreeNodes),(unsigned long)(r.stats.numOctreeLeaves),(unsigned long)(r.stats.networkMemorySize),(unsigned long)(r.stats.particleSystemMemorySize));
+	fprintf(file,"\"quality\": {\"stress\": %.6f, \"meanLinkLength\": %.6f, \"linkLengthCV\": %.6f, \"neighborhoodPreservation\": %.6f, \"overlaps\": %lu, \"seconds\": %.6f}}",r.quality.stress,r.quality.meanLinkLength,r.quality.linkLengthCV,r.quality.neighborhoodPreservation,(unsigned long)(r.quality.numOverlaps),r.quality.calcTime);
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	std::vector<std::string> modelNames;
+	modelNames.push_back("er");
+	modelNames.push_back("ba");
+	modelNames.push_back("sbm");
+	modelNames.push_back("grid");
+	modelNames.push_back("tree");
+	unsigned int minNumNodes=1000;
+	unsigned int maxNumNodes=100000;
+	double meanDegree=4.0;
+	unsigned int numBlocks=16;
+	double mixing=0.05;
+	std::vector<std::string> threadCounts;
+	threadCounts.push_back("1");
+	threadCounts.push_back("0");
+	std::vector<std::string> forceModes;
+	forceModes.push_back("linear");
+	unsigned long numSteps=100;
+	Misc::UInt64 seed=1;
+	bool measureQuality=true;
+	double overlapDist=0.1;
+	bool json=false;
+	const char* outputFileName=0;
+	const char* traceFileName=0;
+	for(int argi=1;argi<argc;++argi)
+		{
+		if(argv[argi][0]=='-')
+			{
+			if(strcasecmp(argv[argi]+1,"models")==0&&argi+1<argc)
+				parseList(argv[++argi],modelNames);
+			else if(strcasecmp(argv[argi]+1,"nodes")==0&&argi+2<argc)
+				{
+				minNumNodes=(unsigned int)(strtoul(argv[++argi],0,10));
+				maxNumNodes=(unsigned int)(strtoul(argv[++argi],0,10));
+				}
+			else if(strcasecmp(argv[argi]+1,"degree")==0&&argi+1<argc)
+				meanDegree=atof(argv[++argi]);
+			else if(strcasecmp(argv[argi]+1,"blocks")==0&&argi+2<argc)
+				{
+				numBlocks=(unsigned int)(atoi(argv[++argi]));
+				mixing=atof(argv[++argi]);
+				}
+			else if(strcasecmp(argv[argi]+1,"threads")==0&&argi+1<argc)
+				parseList(argv[++argi],threadCounts);
+			else if(strcasecmp(argv[argi]+1,"forceModes")==0&&argi+1<argc)
+				parseList(argv[++argi],forceModes);
+			else if(strcasecmp(argv[argi]+1,"steps")==0&&argi+1<argc)
+				numSteps=strtoul(argv[++argi],0,10);
+			else if(strcasecmp(argv[argi]+1,"seed")==0&&argi+1<argc)
+				seed=Misc::UInt64(strtoull(argv[++argi],0,10));
+			else if(strcasecmp(argv[argi]+1,"noQuality")==0)
+				measureQuality=false;
+			else if(strcasecmp(argv[argi]+1,"overlapDist")==0&&argi+1<argc)
+				overlapDist=atof(argv[++argi]);
+			else if(strcasecmp(argv[argi]+1,"json")==0)
+				json=true;
+			else if(strcasecmp(argv[argi]+1,"output")==0&&argi+1<argc)
+				outputFileName=argv[++argi];
+			else if(strcasecmp(argv[argi]+1,"trace")==0&&argi+1<argc)
+				traceFileName=argv[++argi];
+			else
+				fprintf(stderr,"SimulationBenchmark: Ignoring command line option %s\n",argv[argi]);
+			}
+		else
+			fprintf(stderr,"SimulationBenchmark: Ignoring command line argument %s\n",argv[argi]);
+		}
+	
+	/* Validate the graph families and repelling force modes: */
+	std::vector<GraphGenerator::Model> models;
+	bool valid=minNumNodes>=2&&maxNumNodes>=minNumNodes&&numSteps>=2&&!threadCounts.empty();
+	for(std::vector<std::string>::iterator mnIt=modelNames.begin();mnIt!=modelNames.end();++mnIt)
+		{
+		GraphGenerator::Model model;
+		if(GraphGenerator::parseModelName(mnIt->c_str(),model))
+			models.push_back(model);
+		else
+			{
+			fprintf(stderr,"SimulationBenchmark: Unknown graph model %s\n",mnIt->c_str());
+			valid=false;
+			}
+		}
+	for(std::vector<std::string>::iterator fmIt=forceModes.begin();fmIt!=forceModes.end();++fmIt)
+		if(strcasecmp(fmIt->c_str(),"linear")!=0&&strcasecmp(fmIt->c_str(),"quadratic")!=0)
+			{
+			fprintf(stderr,"SimulationBenchmark: Unknown repelling force mode %s\n",fmIt->c_str());
+			valid=false;
+			}
+	if(!valid||models.empty()||forceModes.empty())
+		{
+		fprintf(stderr,"Usage: %s [-models <comma-separated list of er, ba, sbm, grid, tree>] [-nodes <min number of nodes> <max number of nodes>] [-degree <mean degree>] [-blocks <number of blocks> <mixing fraction>] [-threads <comma-separated list of thread counts; 0 for all cores>] [-forceModes <comma-separated list of linear, quadratic>] [-steps <number of steps per run>] [-seed <random seed>] [-noQuality] [-overlapDist <node overlap distance>] [-json] [-output <output file name>] [-trace <trace file name>]\n",argv[0]);
+		return 1;
+		}
+	
+	/* Open the output file: */
+	FILE* file=stdout;
+	if(outputFileName!=0)
+		{
+		file=fopen(outputFileName,"w");
+		if(file==0)
+			{
+			fprintf(stderr,"SimulationBenchmark: Unable to create output file %s\n",outputFileName);
+			return 1;
+			}
+		}
+	if(json)
+		fprintf(file,"{\n  \"steps\": %lu,\n  \"meanDegree\": %g,\n  \"seed\": %llu,\n  \"results\": [",numSteps,meanDegree,(unsigned long long)(seed));
+	else
+		writeCsvHeader(file);
+	fflush(file);
+	
+	/* Run all combinations of graph family, network size, repelling force mode, and number of threads: */
+	GraphGenerator generator(seed);
+	generator.setMeanDegree(meanDegree);
+	generator.setBlockParameters(numBlocks,mixing);
+	GraphGenerator::LinkList links;
+	bool first=true;
+	if(traceFileName!=0)
+		{
+		Tracer::setThreadName("Main");
+		Tracer::start();
+		}
+	try
+		{
+		for(std::vector<GraphGenerator::Model>::iterator mIt=models.begin();mIt!=models.end();++mIt)
+			for(Misc::UInt64 numNodes=minNumNodes;numNodes<=maxNumNodes;numNodes*=10)
+				{
+				/* Generate a repeatable graph and create a network from it: */
+				Realtime::TimePointMonotonic timer;
+				generator.setSeed(seed);
+				generator.generate(*mIt,(unsigned int)(numNodes),links);
+				Network network((unsigned int)(numNodes),links);
+				double generateTime=double(timer.setAndDiff());
+				fprintf(stderr,"SimulationBenchmark: Created %s graph with %u nodes and %u links in %.3f s\n",GraphGenerator::getModelName(*mIt),(unsigned int)(numNodes),(unsigned int)(network.getLinks().size()),generateTime);
+				
+				/* Prepare to measure the quality of the network's layouts: */
+				LayoutQuality* layoutQuality=0;
+				if(measureQuality)
+					{
+					layoutQuality=new LayoutQuality(network);
+					layoutQuality->setOverlapDist(Scalar(overlapDist));
+					}
+				
+				for(std::vector<std::string>::iterator fmIt=forceModes.begin();fmIt!=forceModes.end();++fmIt)
+					for(std::vector<std::string>::iterator tcIt=threadCounts.begin();tcIt!=threadCounts.end();++tcIt)
+						{
+						/* Run the benchmark: */
+						SimulationParameters simulationParameters;
+						bool quadratic=strcasecmp(fmIt->c_str(),"quadratic")==0;
+						simulationParameters.repellingForceMode=quadratic?SimulationParameters::Quadratic:SimulationParameters::Linear;
+						BenchmarkResult result;
+						result.modelName=GraphGenerator::getModelName(*mIt);
+						result.numNodes=(unsigned int)(numNodes);
+						result.numLinks=(unsigned int)(network.getLinks().size());
+						result.forceModeName=quadratic?"quadratic":"linear";
+						result.generateTime=generateTime;
+						runBenchmark(network,simulationParameters,(unsigned int)(atoi(tcIt->c_str())),numSteps,layoutQuality,result);
+						
+						/* Write the result: */
+						if(json)
+							writeJsonResult(file,result,first);
+						else
+							writeCsvResult(file,result);
+						fflush(file);
+						first=false;
+						}
+				
+				delete layoutQuality;
+				}
+		
+		/* Write the spans recorded during all runs: */
+		if(traceFileName!=0)
+			{
+			Tracer::stop();
+			size_t numDropped=Tracer::write(traceFileName);
+			fprintf(stderr,"SimulationBenchmark: Wrote trace to %s; %u spans were dropped\n",traceFileName,(unsigned int)(numDropped));
+			}
+		}
+	catch(const std::runtime_error& err)
+		{
+		fprintf(stderr,"SimulationBenchmark: Terminating due to exception %s\n",err.what());
+		}
+	
+	if(json)
+		fprintf(file,"\n  ]\n}\n");
+	if(file!=stdout)
+		fclose(file);
+	
+	return 0;
+	}
@@ -0,0 +1,248 @@
+/***********************************************************************
+SimulationScheduler - Class to run any number of simulations on a shared
+pool of threads, with round-robin time slicing between active
+simulations and cooperative parallel loops inside simulation steps.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include "SimulationScheduler.h"
+
+#include <unistd.h>
+#include <algorithm>
+#include <Realtime/Time.h>
+
+#include "Tracer.h"
+
+/************************************************
+Methods of class SimulationScheduler::Task:
+************************************************/
+
+SimulationScheduler::Task::~Task(void)
+	{
+	}
+
+/*******************************************************
+Methods of class SimulationScheduler::ParallelFunction:
+*******************************************************/
+
+SimulationScheduler::ParallelFunction::~ParallelFunction(void)
+	{
+	}
+
+/************************************
+Methods of class SimulationScheduler:
+************************************/
+
+bool SimulationScheduler::runLoopChunk(SimulationScheduler::ParallelLoop* loop)
+	{
+	/* Find a parallel loop with unclaimed items if no loop was given: */
+	if(loop==0)
+		{
+		for(std::vector<ParallelLoop*>::iterator lIt=loops.begin();lIt!=loops.end()&&loop==0;++lIt)
+			if((*lIt)->nextItem<(*lIt)->numItems)
+				loop=*lIt;
+		if(loop==0)
+			return false;
+		}
+	else if(loop->nextItem>=loop->numItems)
+		return false;
+	
+	/* Claim the next chunk of loop items: */
+	Index begin=loop->nextItem;
+	Index end=std::min(begin+loop->chunkSize,loop->numItems);
+	loop->nextItem=end;
+	
+	/* Process the chunk without holding the state mutex: */
+	stateMutex.unlock();
+	{
+	Tracer::Span span("Parallel loop chunk");
+	(*loop->function)(begin,end);
+	}
+	stateMutex.lock();
+	
+	/* Wake up the loop's owner if the loop is finished: */
+	loop->numUnfinishedItems-=end-begin;
+	if(loop->numUnfinishedItems==0)
+		stateCond.broadcast();
+	
+	return true;
+	}
+
+void* SimulationScheduler::threadMethod(void)
+	{
+	Tracer::setThreadName("Simulation pool");
+	
+	stateMutex.lock();
+	while(keepRunning)
+		{
+		/* Help with parallel loops first, as they are holding up running tasks: */
+		if(runLoopChunk(0))
+			continue;
+		
+		/* Run the next time slice of the waiting task that has used the least pool time so far: */
+		if(!runQueue.empty())
+			{
+			std::deque<Task*>::iterator tIt=runQueue.begin();
+			for(std::deque<Task*>::iterator rqIt=runQueue.begin()+1;rqIt!=runQueue.end();++rqIt)
+				if((*rqIt)->runTime<(*tIt)->runTime)
+					tIt=rqIt;
+			Task* task=*tIt;
+			runQueue.erase(tIt);
+			task->queued=false;
+			task->running=true;
+			if(virtualTime<task->runTime)
+				virtualTime=task->runTime;
+			
+			stateMutex.unlock();
+			Realtime::TimePointMonotonic stepStart;
+			task->step();
+			double stepTime=double(Realtime::TimePointMonotonic()-stepStart);
+			stateMutex.lock();
+			
+			/* Charge the time slice to the task and put it back into the run queue if it is still active: */
+			task->runTime+=stepTime;
+			task->running=false;
+			if(task->active)
+				{
+				runQueue.push_back(task);
+				task->queued=true;
+				}
+			
+			/* Wake up threads waiting for the task to finish its time slice or for new work: */
+			stateCond.broadcast();
+			continue;
+			}
+		
+		/* Wait for something to do: */
+		stateCond.wait(stateMutex);
+		}
+	stateMutex.unlock();
+	
+	return 0;
+	}
+
+SimulationScheduler::SimulationScheduler(unsigned int sNumThreads)
+	:numThreads(sNumThreads),threads(0),
+	 keepRunning(true),virtualTime(0.0)
+	{
+	/* Use one thread per available CPU core by default: */
+	if(numThreads==0)
+		{
+		long numCores=sysconf(_SC_NPROCESSORS_ONLN);
+		numThreads=numCores>0?(unsigned int)(numCores):1U;
+		}
+	
+	/* Start the pool threads: */
+	threads=new Threads::Thread[numThreads];
+	for(unsigned int i=0;i<numThreads;++i)
+		threads[i].start(this,&SimulationScheduler::threadMethod);
+	}
+
+SimulationScheduler::~SimulationScheduler(void)
+	{
+	/* Shut down the pool threads: */
+	{
+	Threads::Mutex::Lock stateLock(stateMutex);
+	keepRunning=false;
+	stateCond.broadcast();
+	}
+	for(unsigned int i=0;i<numThreads;++i)
+		threads[i].join();
+	delete[] threads;
+	}
+
+void SimulationScheduler::activate(SimulationScheduler::Task& task)
+	{
+	Threads::Mutex::Lock stateLock(stateMutex);
+	
+	/* Put the task into the run queue unless it is already queued or running: */
+	task.active=true;
+	if(!task.queued&&!task.running)
+		{
+		/* Don't let a task that was idle catch up on the time it did not use: */
+		if(task.runTime<virtualTime)
+			task.runTime=virtualTime;
+		
+		runQueue.push_back(&task);
+		task.queued=true;
+		stateCond.broadcast();
+		}
+	}
+
+void SimulationScheduler::deactivate(SimulationScheduler::Task& task)
+	{
+	Threads::Mutex::Lock stateLock(stateMutex);
+	
+	/* Remove the task from the run queue; a running task will not be re-queued: */
+	task.active=false;
+	if(task.queued)
+		{
+		runQueue.erase(std::find(runQueue.begin(),runQueue.end(),&task));
+		task.queued=false;
+		}
+	}
+
+void SimulationScheduler::remove(SimulationScheduler::Task& task)
+	{
+	Threads::Mutex::Lock stateLock(stateMutex);
+	
+	/* Deactivate the task: */
+	task.active=false;
+	if(task.queued)
+		{
+		runQueue.erase(std::find(runQueue.begin(),runQueue.end(),&task));
+		task.queued=false;
+		}
+	
+	/* Wait until the task's current time slice has finished: */
+	while(task.running)
+		stateCond.wait(stateMutex);
+	}
+
+void SimulationScheduler::parallelFor(Index numItems,SimulationScheduler::ParallelFunction& function,Index minChunkSize)
+	{
+	/* Create a parallel loop split into enough chunks to balance the load between all pool threads: */
+	ParallelLoop loop;
+	loop.function=&function;
+	loop.numItems=numItems;
+	loop.chunkSize=std::max(numItems/(Index(numThreads)*4),std::max(minChunkSize,Index(1)));
+	loop.nextItem=0;
+	loop.numUnfinishedItems=numItems;
+	
+	Threads::Mutex::Lock stateLock(stateMutex);
+	
+	/* Offer the loop to idle pool threads: */
+	loops.push_back(&loop);
+	stateCond.broadcast();
+	
+	/* Process chunks of the loop from the calling thread until all are claimed: */
+	while(runLoopChunk(&loop))
+		;
+	
+	/* Wait until all claimed chunks have been processed: */
+	if(loop.numUnfinishedItems>0)
+		{
+		Tracer::Span span("Parallel loop wait");
+		while(loop.numUnfinishedItems>0)
+			stateCond.wait(stateMutex);
+		}
+	
+	/* Remove the loop: */
+	loops.erase(std::find(loops.begin(),loops.end(),&loop));
+	}
@@ -0,0 +1,118 @@
+/***********************************************************************
+SimulationScheduler - Class to run any number of simulations on a shared
+pool of threads, with round-robin time slicing between active
+simulations and cooperative parallel loops inside simulation steps.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SIMULATIONSCHEDULER_INCLUDED
+#define SIMULATIONSCHEDULER_INCLUDED
+
+#include <deque>
+#include <vector>
+#include <Threads/Mutex.h>
+#include <Threads/Cond.h>
+#include <Threads/Thread.h>
+
+#include "ParticleTypes.h"
+
+class SimulationScheduler
+	{
+	/* Embedded classes: */
+	public:
+	class Task // Base class for simulations scheduled onto the thread pool
+		{
+		friend class SimulationScheduler;
+		
+		/* Elements: */
+		private:
+		bool active; // Flag whether the task wants to be scheduled
+		bool queued; // Flag whether the task is in the scheduler's run queue
+		bool running; // Flag whether a pool thread is currently executing the task's step method
+		double runTime; // Total time the task's step method has executed in seconds, advanced to the scheduler's virtual time when the task is activated
+		
+		/* Constructors and destructors: */
+		public:
+		Task(void)
+			:active(false),queued(false),running(false),runTime(0.0)
+			{
+			}
+		virtual ~Task(void);
+		
+		/* Methods: */
+		virtual void step(void) =0; // Executes one time slice of the task; called from one pool thread at a time
+		};
+	
+	class ParallelFunction // Base class for loop bodies executed cooperatively by pool threads
+		{
+		/* Constructors and destructors: */
+		public:
+		virtual ~ParallelFunction(void);
+		
+		/* Methods: */
+		virtual void operator()(Index begin,Index end) =0; // Processes the half-open range of loop items [begin, end)
+		};
+	
+	private:
+	struct ParallelLoop // Structure representing a parallel loop in progress
+		{
+		/* Elements: */
+		public:
+		ParallelFunction* function; // The loop body
+		Index numItems; // Total number of loop items
+		Index chunkSize; // Number of loop items handed to a thread at once
+		Index nextItem; // Index of the next unclaimed loop item
+		Index numUnfinishedItems; // Number of loop items that have not yet been processed
+		};
+	
+	/* Elements: */
+	unsigned int numThreads; // Number of threads in the pool
+	Threads::Thread* threads; // Array of pool threads
+	Threads::Mutex stateMutex; // Mutex serializing access to the scheduler's state
+	Threads::Cond stateCond; // Condition variable signaling changes to the scheduler's state
+	volatile bool keepRunning; // Flag to shut down the pool threads
+	std::deque<Task*> runQueue; // Queue of active tasks waiting for their next time slice
+	double virtualTime; // Run time of the most recently started time slice's task; newly activated tasks start from here
+	std::vector<ParallelLoop*> loops; // List of parallel loops in progress
+	
+	/* Private methods: */
+	bool runLoopChunk(ParallelLoop* loop); // Processes the next chunk of the given parallel loop, or of any parallel loop if null; must be called with the state mutex locked; returns false if there was no unclaimed chunk
+	void* threadMethod(void); // Method implementing a pool thread
+	
+	/* Constructors and destructors: */
+	public:
+	SimulationScheduler(unsigned int sNumThreads); // Creates a scheduler with the given number of pool threads; 0 uses one thread per available CPU core
+	private:
+	SimulationScheduler(const SimulationScheduler& source); // Prohibit copy constructor
+	SimulationScheduler& operator=(const SimulationScheduler& source); // Prohibit assignment operator
+	public:
+	~SimulationScheduler(void); // Shuts down the pool threads; all tasks must have been removed
+	
+	/* Methods: */
+	unsigned int getNumThreads(void) const // Returns the number of threads in the pool
+		{
+		return numThreads;
+		}
+	void activate(Task& task); // Schedules the given task for repeated execution; waiting tasks are started in order of least total run time, giving each active task a fair share of pool time
+	void deactivate(Task& task); // Stops scheduling the given task; a time slice that is currently executing will finish
+	void remove(Task& task); // Stops scheduling the given task and waits until its current time slice has finished
+	void parallelFor(Index numItems,ParallelFunction& function,Index minChunkSize =64); // Processes the given number of loop items with the given loop body, using the calling thread and any idle pool threads, handing at least the given number of items to a thread at once; returns when all items have been processed
+	};
+
+#endif
@@ -0,0 +1,98 @@
+/***********************************************************************
+SimulationUpdateAssembler - Class to assemble node positions from
+simulation update chunks received as unreliable datagrams, which can
+arrive out of order, duplicated, or not at all.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+
+#include "SimulationUpdateAssembler.h"
+
+#include <Misc/Utility.h>
+
+/******************************************
+Methods of class SimulationUpdateAssembler:
+******************************************/
+
+SimulationUpdateAssembler::SimulationUpdateAssembler(void)
+	:networkVersion(0),numValidChunks(0),sequence(0),dirty(false)
+	{
+	}
+
+int SimulationUpdateAssembler::startChunk(SimulationUpdateAssembler::Version currentNetworkVersion,SimulationUpdateAssembler::Version chunkNetworkVersion,Misc::UInt32 sequenceNumber,size_t numParticles,size_t firstParticle,size_t numChunkParticles,size_t numPositionBytes)
+	{
+	/* Ignore chunks for other networks: */
+	if(chunkNetworkVersion!=currentNetworkVersion)
+		return 0x0;
+	
+	/* Ignore malformed chunks, which must start at a chunk boundary inside the update and be full unless they are the update's last chunk: */
+	if(firstParticle>=numParticles||firstParticle%maxChunkParticles!=0||numChunkParticles!=Misc::min(numParticles-firstParticle,size_t(maxChunkParticles)))
+		return 0x0;
+	
+	/* Ignore truncated chunks: */
+	if(numPositionBytes<numChunkParticles*pointSize)
+		return 0x0;
+	
+	/* Reset the assembled positions if the network changed: */
+	size_t numChunks=(numParticles+maxChunkParticles-1)/maxChunkParticles;
+	if(networkVersion!=chunkNetworkVersion||positions.size()!=numParticles)
+		{
+		networkVersion=chunkNetworkVersion;
+		positions.clear();
+		positions.resize(numParticles,NVPoint::origin);
+		chunkSequences.clear();
+		chunkSequences.resize(numChunks,0U);
+		numValidChunks=0;
+		sequence=0;
+		dirty=false;
+		}
+	
+	/* Check if this chunk starts a newer simulation update: */
+	int result=0x0;
+	if(sequence==0||Misc::SInt32(sequenceNumber-sequence)>0)
+		{
+		/* Post the previous update's partially received positions; chunks lost from it keep their most recent data: */
+		if(dirty&&numValidChunks==numChunks)
+			result|=PostPrevious;
+		sequence=sequenceNumber;
+		result|=NewUpdate;
+		}
+	
+	/* Apply the chunk only if it is newer than the data already received for the same chunk: */
+	Misc::UInt32& chunkSequence=chunkSequences[firstParticle/maxChunkParticles];
+	if(chunkSequence==0||Misc::SInt32(sequenceNumber-chunkSequence)>0)
+		{
+		if(chunkSequence==0)
+			++numValidChunks;
+		chunkSequence=sequenceNumber;
+		result|=ReadChunk;
+		}
+	
+	return result;
+	}
+
+bool SimulationUpdateAssembler::finishChunk(size_t firstParticle,Misc::UInt32 sequenceNumber)
+	{
+	/* Mark the assembled positions as changed: */
+	dirty=true;
+	
+	/* Check if this was the last chunk of the current update, and all chunks have been received at least once: */
+	size_t numChunks=chunkSequences.size();
+	return firstParticle/maxChunkParticles==numChunks-1&&sequenceNumber==sequence&&numValidChunks==numChunks;
+	}
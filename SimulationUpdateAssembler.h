@@ -0,0 +1,78 @@
+/***********************************************************************
+SimulationUpdateAssembler - Class to assemble node positions from
+simulation update chunks received as unreliable datagrams, which can
+arrive out of order, duplicated, or not at all.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SIMULATIONUPDATEASSEMBLER_INCLUDED
+#define SIMULATIONUPDATEASSEMBLER_INCLUDED
+
+#include <stddef.h>
+#include <vector>
+#include <Misc/SizedTypes.h>
+
+#include "NetworkViewerProtocol.h"
+
+class SimulationUpdateAssembler:public Collab::Plugins::NetworkViewerProtocol
+	{
+	/* Embedded classes: */
+	public:
+	typedef std::vector<NVPoint> NVPointList;
+	
+	enum ChunkActions // Enumerated type for actions the caller has to take after a chunk header was processed
+		{
+		PostPrevious=0x1, // The previous simulation update is complete and must be posted before the chunk's positions are read
+		NewUpdate=0x2, // The chunk starts a newer simulation update than any chunk received before
+		ReadChunk=0x4 // The chunk's positions must be read into the array returned by getChunkPositions
+		};
+	
+	/* Elements: */
+	static const size_t maxChunkParticles=SimulationUpdateChunkMsg::maxChunkParticles; // Maximum number of node positions in a simulation update chunk
+	
+	private:
+	Version networkVersion; // Version number of the network to which the assembled positions belong
+	NVPointList positions; // Node positions assembled from simulation update chunks
+	std::vector<Misc::UInt32> chunkSequences; // Sequence numbers of the simulation updates from which each chunk of node positions was most recently updated, or 0
+	size_t numValidChunks; // Number of chunks of node positions that have been updated at least once
+	Misc::UInt32 sequence; // Sequence number of the newest simulation update from which any chunk was received
+	bool dirty; // Flag whether the assembled positions changed since they were last posted
+	
+	/* Constructors and destructors: */
+	public:
+	SimulationUpdateAssembler(void); // Creates an empty assembler
+	
+	/* Methods: */
+	const NVPointList& getPositions(void) const // Returns the assembled node positions
+		{
+		return positions;
+		}
+	int startChunk(Version currentNetworkVersion,Version chunkNetworkVersion,Misc::UInt32 sequenceNumber,size_t numParticles,size_t firstParticle,size_t numChunkParticles,size_t numPositionBytes); // Processes the header of a chunk for the network of the given current version, followed by the given number of bytes of particle positions, and returns a combination of ChunkActions; returns 0 for malformed or truncated chunks
+	NVPoint* getChunkPositions(size_t firstParticle) // Returns the array into which to read the positions of the chunk starting at the given particle
+		{
+		return &positions[firstParticle];
+		}
+	bool finishChunk(size_t firstParticle,Misc::UInt32 sequenceNumber); // Notifies the assembler that the chunk's positions were read; returns true if the assembled positions are complete and must be posted
+	void posted(void) // Notifies the assembler that the assembled positions were posted
+		{
+		dirty=false;
+		}
+	};
+
+#endif
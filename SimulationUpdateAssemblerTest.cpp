@@ -0,0 +1,273 @@
+/***********************************************************************
+SimulationUpdateAssemblerTest - Headless utility to verify the
+reassembly of simulation updates sent as datagram chunks under chunk
+loss, reordering, and malformed or truncated chunks.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <vector>
+#include <algorithm>
+#include <Misc/SizedTypes.h>
+
+#include "SimulationUpdateAssembler.h"
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+typedef SimulationUpdateAssembler::Version Version;
+typedef SimulationUpdateAssembler::NVPoint NVPoint;
+typedef SimulationUpdateAssembler::NVPointList NVPointList;
+
+struct Chunk // Structure describing a simulation update chunk in transit
+	{
+	/* Elements: */
+	public:
+	Misc::UInt32 sequenceNumber; // Sequence number of the simulation update of which the chunk is a part
+	size_t firstParticle; // Index of the first particle in the chunk
+	size_t numChunkParticles; // Number of particles in the chunk
+	double deliveryKey; // Sort key determining the order in which chunks arrive
+	
+	/* Methods: */
+	bool operator<(const Chunk& other) const // Orders chunks by arrival
+		{
+		return deliveryKey<other.deliveryKey;
+		}
+	};
+
+class Receiver // Class receiving chunks in the same way as the network viewer client and checking every posted set of positions
+	{
+	/* Elements: */
+	private:
+	Version networkVersion; // Version of the network to which all chunks belong
+	size_t numParticles; // Number of particles in each simulation update
+	SimulationUpdateAssembler assembler; // The assembler under test
+	std::vector<Misc::UInt32> postedSequences; // Sequence numbers from which each chunk was most recently posted, or 0
+	
+	/* Private methods: */
+	void post(void) // Checks the assembled positions and posts them
+		{
+		const NVPointList& positions=assembler.getPositions();
+		const size_t maxChunkParticles=SimulationUpdateAssembler::maxChunkParticles;
+		bool complete=true;
+		for(size_t chunkIndex=0;chunkIndex<postedSequences.size();++chunkIndex)
+			{
+			/* Check that all positions of the chunk come from the same update, and that the update is not older than the one posted before: */
+			size_t first=chunkIndex*maxChunkParticles;
+			size_t end=std::min(first+maxChunkParticles,numParticles);
+			Misc::UInt32 sequence=Misc::UInt32(positions[first][0]);
+			if(sequence==0||sequence<postedSequences[chunkIndex])
+				++numErrors;
+			for(size_t i=first;i<end;++i)
+				if(positions[i][0]!=NVPoint::Scalar(sequence)||positions[i][1]!=NVPoint::Scalar(i))
+					++numErrors;
+			postedSequences[chunkIndex]=sequence;
+			if(sequence!=postedSequences[0])
+				complete=false;
+			}
+		++numPosts;
+		if(complete)
+			++numCompletePosts;
+		
+		assembler.posted();
+		}
+	
+	/* Elements: */
+	public:
+	unsigned int numPosts; // Number of times assembled positions were posted
+	unsigned int numCompletePosts; // Number of posts where all chunks came from the same update
+	unsigned int numErrors; // Number of detected errors
+	
+	/* Constructors and destructors: */
+	Receiver(Version sNetworkVersion,size_t sNumParticles)
+		:networkVersion(sNetworkVersion),numParticles(sNumParticles),
+		 postedSequences((numParticles+SimulationUpdateAssembler::maxChunkParticles-1)/SimulationUpdateAssembler::maxChunkParticles,0U),
+		 numPosts(0),numCompletePosts(0),numErrors(0)
+		{
+		}
+	
+	/* Methods: */
+	int receive(Version chunkNetworkVersion,Misc::UInt32 sequenceNumber,size_t chunkNumParticles,size_t firstParticle,size_t numChunkParticles,size_t numPositionBytes) // Receives a chunk with the given header, followed by the given number of bytes of positions; returns the assembler's actions
+		{
+		int actions=assembler.startChunk(networkVersion,chunkNetworkVersion,sequenceNumber,chunkNumParticles,firstParticle,numChunkParticles,numPositionBytes);
+		if(actions&SimulationUpdateAssembler::PostPrevious)
+			post();
+		if(actions&SimulationUpdateAssembler::ReadChunk)
+			{
+			/* "Read" the chunk's positions, encoding the update's sequence number and each particle's index: */
+			NVPoint* positions=assembler.getChunkPositions(firstParticle);
+			for(size_t i=0;i<numChunkParticles;++i)
+				positions[i]=NVPoint(NVPoint::Scalar(sequenceNumber),NVPoint::Scalar(firstParticle+i),NVPoint::Scalar(0));
+			if(assembler.finishChunk(firstParticle,sequenceNumber))
+				post();
+			}
+		return actions;
+		}
+	int receive(const Chunk& chunk) // Receives a well-formed chunk
+		{
+		return receive(networkVersion,chunk.sequenceNumber,numParticles,chunk.firstParticle,chunk.numChunkParticles,chunk.numChunkParticles*SimulationUpdateAssembler::pointSize);
+		}
+	const NVPointList& getPositions(void) const
+		{
+		return assembler.getPositions();
+		}
+	};
+
+/****************
+Helper functions:
+****************/
+
+double randUnit(void) // Returns a pseudo-random number in [0, 1)
+	{
+	return double(rand())/(double(RAND_MAX)+1.0);
+	}
+
+void createChunks(size_t numParticles,unsigned int numUpdates,double loss,double reorderWindow,std::vector<Chunk>& chunks) // Creates the chunks of the given number of simulation updates, drops the given fraction of them, and shuffles them within the given window of chunks
+	{
+	const size_t maxChunkParticles=SimulationUpdateAssembler::maxChunkParticles;
+	chunks.clear();
+	double sendIndex=0.0;
+	for(unsigned int update=1;update<=numUpdates;++update)
+		for(size_t firstParticle=0;firstParticle<numParticles;firstParticle+=maxChunkParticles,sendIndex+=1.0)
+			{
+			if(randUnit()<loss)
+				continue;
+			Chunk chunk;
+			chunk.sequenceNumber=Misc::UInt32(update);
+			chunk.firstParticle=firstParticle;
+			chunk.numChunkParticles=std::min(numParticles-firstParticle,maxChunkParticles);
+			chunk.deliveryKey=sendIndex+randUnit()*reorderWindow;
+			chunks.push_back(chunk);
+			}
+	std::stable_sort(chunks.begin(),chunks.end());
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	size_t numParticles=1050;
+	unsigned int numUpdates=2000;
+	double loss=0.1;
+	double reorderWindow=8.0;
+	unsigned int seed=1;
+	for(int argi=1;argi<argc;++argi)
+		{
+		if(argv[argi][0]=='-')
+			{
+			if(strcasecmp(argv[argi]+1,"particles")==0&&argi+1<argc)
+				numParticles=size_t(strtoul(argv[++argi],0,10));
+			else if(strcasecmp(argv[argi]+1,"updates")==0&&argi+1<argc)
+				numUpdates=(unsigned int)(atoi(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"loss")==0&&argi+1<argc)
+				loss=atof(argv[++argi]);
+			else if(strcasecmp(argv[argi]+1,"reorder")==0&&argi+1<argc)
+				reorderWindow=atof(argv[++argi]);
+			else if(strcasecmp(argv[argi]+1,"seed")==0&&argi+1<argc)
+				seed=(unsigned int)(atoi(argv[++argi]));
+			else
+				fprintf(stderr,"SimulationUpdateAssemblerTest: Ignoring command line option %s\n",argv[argi]);
+			}
+		else
+			fprintf(stderr,"SimulationUpdateAssemblerTest: Ignoring command line argument %s\n",argv[argi]);
+		}
+	if(numParticles==0||numUpdates==0||loss<0.0||loss>=1.0||reorderWindow<0.0)
+		{
+		fprintf(stderr,"Usage: %s [-particles <number of particles>] [-updates <number of updates>] [-loss <fraction of dropped chunks>] [-reorder <reordering window in chunks>] [-seed <random seed>]\n",argv[0]);
+		return 1;
+		}
+	srand(seed);
+	const Version networkVersion=1;
+	unsigned int numErrors=0;
+	
+	/* Deliver all chunks in order and check that every update is posted completely exactly once: */
+	std::vector<Chunk> chunks;
+	createChunks(numParticles,numUpdates,0.0,0.0,chunks);
+	{
+	Receiver receiver(networkVersion,numParticles);
+	for(std::vector<Chunk>::iterator cIt=chunks.begin();cIt!=chunks.end();++cIt)
+		receiver.receive(*cIt);
+	printf("In-order delivery: %u of %u updates posted, %u complete\n",receiver.numPosts,numUpdates,receiver.numCompletePosts);
+	if(receiver.numErrors!=0||receiver.numPosts!=numUpdates||receiver.numCompletePosts!=numUpdates)
+		++numErrors;
+	numErrors+=receiver.numErrors;
+	}
+	
+	/* Deliver chunks with loss and reordering and check that posted positions are consistent and never move back in time; late chunks can cause additional posts: */
+	createChunks(numParticles,numUpdates,loss,reorderWindow,chunks);
+	{
+	Receiver receiver(networkVersion,numParticles);
+	for(std::vector<Chunk>::iterator cIt=chunks.begin();cIt!=chunks.end();++cIt)
+		receiver.receive(*cIt);
+	printf("Delivery with %.1f%% loss and a %g chunk reordering window: %u chunks of %u updates arrived, %u posts, %u complete\n",loss*100.0,reorderWindow,(unsigned int)(chunks.size()),numUpdates,receiver.numPosts,receiver.numCompletePosts);
+	if(receiver.numPosts==0||receiver.numPosts>chunks.size())
+		++numErrors;
+	numErrors+=receiver.numErrors;
+	}
+	
+	/* Check that malformed and truncated chunks are ignored without touching the assembled positions: */
+	{
+	Receiver receiver(networkVersion,numParticles);
+	createChunks(numParticles,1,0.0,0.0,chunks);
+	for(std::vector<Chunk>::iterator cIt=chunks.begin();cIt!=chunks.end();++cIt)
+		receiver.receive(*cIt);
+	NVPointList positions=receiver.getPositions();
+	
+	const size_t maxChunkParticles=SimulationUpdateAssembler::maxChunkParticles;
+	const size_t pointSize=SimulationUpdateAssembler::pointSize;
+	size_t lastFirst=((numParticles-1)/maxChunkParticles)*maxChunkParticles;
+	size_t lastCount=numParticles-lastFirst;
+	unsigned int numAccepted=0;
+	if(receiver.receive(networkVersion+1,2,numParticles,0,std::min(numParticles,maxChunkParticles),maxChunkParticles*pointSize)!=0) // Wrong network version
+		++numAccepted;
+	if(receiver.receive(networkVersion,2,numParticles,lastFirst+maxChunkParticles,1,pointSize)!=0) // Chunk starts beyond the last particle
+		++numAccepted;
+	if(receiver.receive(networkVersion,2,numParticles,1,1,pointSize)!=0) // Chunk does not start at a chunk boundary
+		++numAccepted;
+	if(receiver.receive(networkVersion,2,numParticles,lastFirst,lastCount+1,(lastCount+1)*pointSize)!=0) // Last chunk extends beyond the last particle
+		++numAccepted;
+	if(receiver.receive(networkVersion,2,numParticles,0,maxChunkParticles+1,(maxChunkParticles+1)*pointSize)!=0) // Chunk is larger than the maximum
+		++numAccepted;
+	if(numParticles>maxChunkParticles&&receiver.receive(networkVersion,2,numParticles,0,maxChunkParticles-1,(maxChunkParticles-1)*pointSize)!=0) // Inner chunk is not full
+		++numAccepted;
+	if(receiver.receive(networkVersion,2,numParticles,lastFirst,lastCount,lastCount*pointSize-1)!=0) // Chunk's positions are truncated
+		++numAccepted;
+	if(receiver.receive(networkVersion,2,0,0,0,0)!=0) // Update contains no particles
+		++numAccepted;
+	bool unchanged=receiver.getPositions().size()==positions.size()&&std::equal(positions.begin(),positions.end(),receiver.getPositions().begin());
+	printf("Malformed chunks: %u accepted, positions %s\n",numAccepted,unchanged?"unchanged":"changed");
+	if(numAccepted!=0||!unchanged)
+		++numErrors;
+	numErrors+=receiver.numErrors;
+	}
+	
+	if(numErrors!=0)
+		{
+		printf("Simulation update reassembly FAILED with %u errors\n",numErrors);
+		return 1;
+		}
+	printf("Simulation update reassembly OK\n");
+	return 0;
+	}
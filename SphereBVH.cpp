@@ -0,0 +1,61 @@
+/***********************************************************************
+SphereBVH - Class for bounding volume hierarchies over sets of spheres
+to accelerate picking and snapping queries, which are refit to moving
+spheres instead of being rebuilt.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include "SphereBVH.h"
+
+/**********************************
+Static elements of class SphereBVH:
+**********************************/
+
+const Scalar SphereBVH::rebuildFactor(2);
+
+/**************************
+Methods of class SphereBVH:
+**************************/
+
+Scalar SphereBVH::calcArea(const SphereBVH::Node& node)
+	{
+	Scalar dx=node.max[0]-node.min[0];
+	Scalar dy=node.max[1]-node.min[1];
+	Scalar dz=node.max[2]-node.min[2];
+	return Scalar(2)*(dx*dy+dy*dz+dz*dx);
+	}
+
+SphereBVH::SphereBVH(void)
+	:numSpheres(0),builtArea(0),
+	 numBuilds(0),numRefits(0)
+	{
+	}
+
+void SphereBVH::clear(void)
+	{
+	numSpheres=0;
+	sphereIndices.clear();
+	nodes.clear();
+	builtArea=Scalar(0);
+	}
+
+size_t SphereBVH::getMemorySize(void) const
+	{
+	return sizeof(SphereBVH)+sphereIndices.capacity()*sizeof(Index)+nodes.capacity()*sizeof(Node);
+	}
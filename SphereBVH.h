@@ -0,0 +1,108 @@
+/***********************************************************************
+SphereBVH - Class for bounding volume hierarchies over sets of spheres
+to accelerate picking, snapping, and visibility queries, which are refit
+to moving spheres instead of being rebuilt.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SPHEREBVH_INCLUDED
+#define SPHEREBVH_INCLUDED
+
+#include <vector>
+
+#include "ParticleTypes.h"
+
+class SphereBVH
+	{
+	/* Embedded classes: */
+	private:
+	struct Node // Structure for hierarchy nodes
+		{
+		/* Elements: */
+		public:
+		Point min,max; // Bounding box of all spheres in the node's subtree
+		Index firstSphere; // Index of the node's first sphere in the sorted sphere index array
+		Index numSpheres; // Number of spheres in the node's subtree, which are contiguous in the sorted sphere index array
+		Index secondChild; // Index of the node's second child for interior nodes, or 0 for leaf nodes; first child immediately follows the node
+		};
+	
+	/* Elements: */
+	static const Index maxLeafSpheres=8; // Maximum number of spheres in a leaf node
+	static const Scalar rebuildFactor; // Ratio between the refit and built hierarchy's total node surface areas at which the hierarchy is rebuilt
+	Index numSpheres; // Number of spheres in the hierarchy
+	std::vector<Index> sphereIndices; // Sphere indices sorted into leaf nodes
+	std::vector<Node> nodes; // Hierarchy nodes in depth-first order
+	Scalar builtArea; // Total surface area of all nodes after the hierarchy was most recently built
+	unsigned int numBuilds; // Number of times the hierarchy was built
+	unsigned int numRefits; // Number of times the hierarchy was refit
+	
+	/* Private methods: */
+	static Scalar calcArea(const Node& node); // Returns the surface area of a node's bounding box
+	template <class CenterListParam>
+	Index buildSubtree(const CenterListParam& centers,Index firstSphere,Index numSubtreeSpheres); // Creates a subtree for the given range of sorted sphere indices and returns its root node's index
+	template <class CenterListParam>
+	Scalar refit(const CenterListParam& centers,const std::vector<Scalar>& radii); // Recalculates all nodes' bounding boxes bottom-up and returns the hierarchy's total node surface area
+	
+	/* Constructors and destructors: */
+	public:
+	SphereBVH(void); // Creates an empty hierarchy
+	
+	/* Methods: */
+	void clear(void); // Removes all spheres from the hierarchy
+	template <class CenterListParam>
+	void update(const CenterListParam& centers,const std::vector<Scalar>& radii,Index newNumSpheres); // Updates the hierarchy for the given sphere centers and radii after the spheres moved; rebuilds it if the number of spheres changed or its quality degraded too far; radii list can be empty to treat spheres as points
+	template <class CenterListParam,class ProcessSpheresFunctor>
+	void processSpheres(const CenterListParam& centers,const std::vector<Scalar>& radii,ProcessSpheresFunctor& functor) const; // Processes all spheres in leaf nodes whose bounding boxes are accepted by the given functor; see functor declaration below
+	template <class ProcessClustersFunctor>
+	void processClusters(ProcessClustersFunctor& functor) const; // Processes hierarchy nodes as clusters of spheres top-down, descending into the children of clusters as requested by the given functor; see functor declaration below
+	Index getNumSpheres(void) const // Returns the number of spheres in the hierarchy
+		{
+		return numSpheres;
+		}
+	unsigned int getNumBuilds(void) const // Returns the number of times the hierarchy was built
+		{
+		return numBuilds;
+		}
+	unsigned int getNumRefits(void) const // Returns the number of times the hierarchy was refit without rebuilding
+		{
+		return numRefits;
+		}
+	size_t getMemorySize(void) const; // Returns an estimate of the memory used by the hierarchy in bytes
+	};
+
+#if 0
+
+class ProcessSpheresFunctor // Declaration of functor class compatible with processSpheres() method
+	{
+	/* Methods: */
+	public:
+	bool overlapsBox(const Point& min,const Point& max) const; // Returns true if any sphere contained in the given axis-aligned box might be processed
+	void operator()(Index sphereIndex,const Point& center,Scalar radius); // Processes the sphere of the given index, center, and radius
+	};
+
+class ProcessClustersFunctor // Declaration of functor class compatible with processClusters() method
+	{
+	/* Methods: */
+	public:
+	bool operator()(const Point& min,const Point& max,const Index* spheres,Index numSpheres,bool leaf); // Processes a cluster of the given number of spheres, whose indices are in the given array, contained in the given axis-aligned box; returns true if the cluster's children should be processed as well; return value is ignored for leaf clusters
+	};
+
+#endif
+
+#endif
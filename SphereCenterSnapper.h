@@ -0,0 +1,90 @@
+/***********************************************************************
+SphereCenterSnapper - Functor class to snap an object snapper tool's
+snap request against the centers of spheres processed by a sphere
+bounding volume hierarchy.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SPHERECENTERSNAPPER_INCLUDED
+#define SPHERECENTERSNAPPER_INCLUDED
+
+#include <Math/Math.h>
+#include <Geometry/Point.h>
+#include <Geometry/Vector.h>
+#include <Vrui/Geometry.h>
+#include <Vrui/ObjectSnapperToolFactory.h>
+
+#include "ParticleTypes.h"
+
+class SphereCenterSnapper
+	{
+	/* Elements: */
+	private:
+	Vrui::ObjectSnapperToolFactory::SnapRequest& snapRequest; // The snap request
+	Vector snapDirection; // Normalized direction of the snap ray for ray-based snap requests
+	Scalar sinSnapAngle; // Sine of the maximum snapping angle for ray-based snap requests
+	
+	/* Constructors and destructors: */
+	public:
+	SphereCenterSnapper(Vrui::ObjectSnapperToolFactory::SnapRequest& sSnapRequest) // Creates a snapper for the given snap request
+		:snapRequest(sSnapRequest),
+		 snapDirection(snapRequest.snapRay.getDirection()),
+		 sinSnapAngle(Math::sqrt(Scalar(1)-Math::sqr(Scalar(snapRequest.snapRayCosine))))
+		{
+		snapDirection.normalize();
+		}
+	
+	/* Methods: */
+	bool overlapsBox(const Point& min,const Point& max) const // Returns true if any sphere center contained in the given axis-aligned box might snap
+		{
+		if(snapRequest.rayBased)
+			{
+			/* Check the box's bounding sphere against the snap ray's snapping cone: */
+			Point center=Geometry::mid(min,max);
+			Scalar radius=Geometry::dist(min,center);
+			Vector d=center-Point(snapRequest.snapRay.getOrigin());
+			Scalar dist=d.mag();
+			if(dist<=radius)
+				return true;
+			Scalar sinApparent=radius/dist;
+			Scalar cosApparent=Math::sqrt(Scalar(1)-Math::sqr(sinApparent));
+			return snapDirection*d>=(cosApparent*Scalar(snapRequest.snapRayCosine)-sinApparent*sinSnapAngle)*dist;
+			}
+		else
+			{
+			/* Check the distance from the snap position to the box against the current snapping radius: */
+			Scalar dist2(0);
+			for(int i=0;i<3;++i)
+				{
+				Scalar p(snapRequest.snapPosition[i]);
+				if(p<min[i])
+					dist2+=Math::sqr(min[i]-p);
+				else if(p>max[i])
+					dist2+=Math::sqr(p-max[i]);
+				}
+			return dist2<=Math::sqr(Scalar(snapRequest.snapRadius));
+			}
+		}
+	void operator()(Index sphereIndex,const Point& center,Scalar radius) // Snaps the request against the given sphere's center
+		{
+		snapRequest.snapPoint(Vrui::Point(center));
+		}
+	};
+
+#endif
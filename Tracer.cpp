@@ -0,0 +1,259 @@
+/***********************************************************************
+Tracer - Class to record timed spans of work from any number of threads
+while enabled at run time, and to write them as a trace event file for
+Chrome's or Perfetto's trace viewers.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include "Tracer.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <Threads/Mutex.h>
+#include <Threads/Spinlock.h>
+#include <Realtime/Time.h>
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+struct TracedSpan // Structure for a finished span
+	{
+	/* Elements: */
+	public:
+	const char* name; // Name of the span
+	double begin; // Begin time of the span in microseconds since tracing was started
+	double duration; // Duration of the span in microseconds
+	};
+
+struct ThreadBuffer // Structure holding the spans recorded by one thread
+	{
+	/* Elements: */
+	public:
+	unsigned int threadId; // Sequential ID of the thread in the trace
+	std::string threadName; // Name of the thread in the trace
+	Threads::Spinlock spansMutex; // Lock serializing access to the span list between the recording thread and start() or write()
+	std::vector<TracedSpan> spans; // List of spans recorded by the thread
+	size_t numDropped; // Number of spans dropped because the list was full
+	
+	/* Constructors and destructors: */
+	ThreadBuffer(unsigned int sThreadId)
+		:threadId(sThreadId),numDropped(0)
+		{
+		char name[32];
+		snprintf(name,sizeof(name),"Thread %u",threadId);
+		threadName=name;
+		}
+	};
+
+/************
+Tracer state:
+************/
+
+Realtime::TimePointMonotonic epoch; // Fixed time point from which span times are measured
+double startTime=0.0; // Time at which tracing was most recently started in microseconds since the epoch; only changed while all thread buffers are locked
+size_t maxSpansPerThread=0; // Maximum number of spans kept per thread; only changed while all thread buffers are locked
+Threads::Mutex buffersMutex; // Mutex serializing access to the list of thread buffers
+std::vector<ThreadBuffer*> buffers; // List of the buffers of all threads that ever recorded a span or set their name; buffers are kept after their threads exit so their spans can be written
+pthread_once_t bufferKeyOnce=PTHREAD_ONCE_INIT; // Guard to create the thread-local buffer key once
+pthread_key_t bufferKey; // Key to retrieve the calling thread's buffer
+
+/****************
+Helper functions:
+****************/
+
+void createBufferKey(void)
+	{
+	pthread_key_create(&bufferKey,0);
+	}
+
+ThreadBuffer* getThreadBuffer(void)
+	{
+	/* Return the calling thread's buffer if it already has one: */
+	pthread_once(&bufferKeyOnce,createBufferKey);
+	ThreadBuffer* buffer=static_cast<ThreadBuffer*>(pthread_getspecific(bufferKey));
+	if(buffer==0)
+		{
+		/* Create and register a new buffer: */
+		Threads::Mutex::Lock buffersLock(buffersMutex);
+		buffer=new ThreadBuffer(buffers.size()+1);
+		buffers.push_back(buffer);
+		pthread_setspecific(bufferKey,buffer);
+		}
+	
+	return buffer;
+	}
+
+void writeString(FILE* file,const char* string)
+	{
+	/* Write the string as a JSON string with escaped special characters: */
+	fputc('\"',file);
+	for(const char* sPtr=string;*sPtr!='\0';++sPtr)
+		{
+		if(*sPtr=='\"'||*sPtr=='\\')
+			fputc('\\',file);
+		if((unsigned char)(*sPtr)>=0x20U)
+			fputc(*sPtr,file);
+		}
+	fputc('\"',file);
+	}
+
+}
+
+/*******************************
+Static elements of class Tracer:
+*******************************/
+
+volatile bool Tracer::enabled=false;
+volatile unsigned int Tracer::currentGeneration=0;
+
+/***********************
+Methods of class Tracer:
+***********************/
+
+double Tracer::getTime(void)
+	{
+	return double(Realtime::TimePointMonotonic()-epoch)*1.0e6;
+	}
+
+void Tracer::record(const char* name,unsigned int generation,double begin,double end)
+	{
+	/* Drop spans that were still open when tracing was stopped: */
+	if(!enabled)
+		return;
+	
+	/* Lock the calling thread's buffer, which keeps start() from beginning a new tracing run: */
+	ThreadBuffer* buffer=getThreadBuffer();
+	Threads::Spinlock::Lock spansLock(buffer->spansMutex);
+	
+	/* Drop spans that began before the current tracing run was started: */
+	if(generation!=currentGeneration||begin<startTime)
+		return;
+	
+	/* Append the span to the buffer if there is room: */
+	if(buffer->spans.size()<maxSpansPerThread)
+		{
+		TracedSpan span;
+		span.name=name;
+		span.begin=begin-startTime;
+		span.duration=end-begin;
+		buffer->spans.push_back(span);
+		}
+	else
+		++buffer->numDropped;
+	}
+
+void Tracer::start(size_t newMaxSpansPerThread)
+	{
+	/* Stop recording while the buffers are reset: */
+	enabled=false;
+	
+	/* Lock all thread buffers so that no span can be recorded while the tracing run changes: */
+	{
+	Threads::Mutex::Lock buffersLock(buffersMutex);
+	for(std::vector<ThreadBuffer*>::iterator bIt=buffers.begin();bIt!=buffers.end();++bIt)
+		(*bIt)->spansMutex.lock();
+	
+	/* Discard all previously recorded spans: */
+	for(std::vector<ThreadBuffer*>::iterator bIt=buffers.begin();bIt!=buffers.end();++bIt)
+		{
+		(*bIt)->spans.clear();
+		(*bIt)->numDropped=0;
+		}
+	
+	/* Start a new tracing run: */
+	++currentGeneration;
+	maxSpansPerThread=newMaxSpansPerThread;
+	startTime=getTime();
+	
+	/* Unlock all thread buffers: */
+	for(std::vector<ThreadBuffer*>::iterator bIt=buffers.begin();bIt!=buffers.end();++bIt)
+		(*bIt)->spansMutex.unlock();
+	}
+	
+	/* Start recording: */
+	enabled=true;
+	}
+
+void Tracer::stop(void)
+	{
+	enabled=false;
+	}
+
+void Tracer::setThreadName(const char* newThreadName)
+	{
+	ThreadBuffer* buffer=getThreadBuffer();
+	Threads::Mutex::Lock buffersLock(buffersMutex);
+	buffer->threadName=newThreadName;
+	}
+
+size_t Tracer::write(const char* fileName)
+	{
+	/* Open the trace file: */
+	FILE* file=fopen(fileName,"w");
+	if(file==0)
+		throw std::runtime_error(std::string("Tracer::write: Unable to open trace file ")+fileName);
+	
+	/* Write all threads' names and spans as a list of trace events: */
+	size_t numDropped=0;
+	fprintf(file,"{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	bool first=true;
+	{
+	Threads::Mutex::Lock buffersLock(buffersMutex);
+	for(std::vector<ThreadBuffer*>::iterator bIt=buffers.begin();bIt!=buffers.end();++bIt)
+		{
+		/* Copy the thread's spans to hold its lock only briefly: */
+		std::vector<TracedSpan> spans;
+		{
+		Threads::Spinlock::Lock spansLock((*bIt)->spansMutex);
+		spans=(*bIt)->spans;
+		numDropped+=(*bIt)->numDropped;
+		}
+		if(spans.empty())
+			continue;
+		
+		/* Write a metadata event naming the thread: */
+		fprintf(file,"%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":",first?"":",\n",(*bIt)->threadId);
+		writeString(file,(*bIt)->threadName.c_str());
+		fprintf(file,"}}");
+		first=false;
+		
+		/* Write a complete event for each span: */
+		for(std::vector<TracedSpan>::iterator sIt=spans.begin();sIt!=spans.end();++sIt)
+			{
+			fprintf(file,",\n{\"name\":");
+			writeString(file,sIt->name);
+			fprintf(file,",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",sIt->begin,sIt->duration,(*bIt)->threadId);
+			}
+		}
+	}
+	fprintf(file,"\n]}\n");
+	
+	/* Check for errors and close the file: */
+	bool ok=ferror(file)==0;
+	if(fclose(file)!=0||!ok)
+		throw std::runtime_error(std::string("Tracer::write: Error while writing trace file ")+fileName);
+	
+	return numDropped;
+	}
@@ -0,0 +1,79 @@
+/***********************************************************************
+Tracer - Class to record timed spans of work from any number of threads
+while enabled at run time, and to write them as a trace event file for
+Chrome's or Perfetto's trace viewers.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef TRACER_INCLUDED
+#define TRACER_INCLUDED
+
+#include <stddef.h>
+
+class Tracer
+	{
+	/* Embedded classes: */
+	public:
+	class Span // Class recording the lifetime of an object as a span of work in the calling thread if tracing is enabled at construction
+		{
+		/* Elements: */
+		private:
+		const char* name; // Name of the span, which must remain valid until the trace is written; null if tracing was disabled
+		unsigned int generation; // Tracing run during which the span began
+		double begin; // Time at which the span began in microseconds since the tracer's epoch
+		
+		/* Constructors and destructors: */
+		public:
+		Span(const char* sName)
+			:name(enabled?sName:0),generation(currentGeneration),begin(name!=0?getTime():0.0)
+			{
+			}
+		private:
+		Span(const Span& source); // Prohibit copy constructor
+		Span& operator=(const Span& source); // Prohibit assignment operator
+		public:
+		~Span(void)
+			{
+			if(name!=0)
+				record(name,generation,begin,getTime());
+			}
+		};
+	
+	/* Elements: */
+	private:
+	static volatile bool enabled; // Flag whether new spans are recorded
+	static volatile unsigned int currentGeneration; // Number of the current tracing run, incremented each time tracing is started
+	
+	/* Private methods: */
+	static double getTime(void); // Returns the current time in microseconds since the tracer's fixed epoch
+	static void record(const char* name,unsigned int generation,double begin,double end); // Records a finished span in the calling thread's buffer unless it began before the current tracing run was started
+	
+	/* Methods: */
+	public:
+	static bool isEnabled(void) // Returns true if new spans are recorded
+		{
+		return enabled;
+		}
+	static void start(size_t maxSpansPerThread =1000000); // Discards all previously recorded spans and starts recording new ones, keeping at most the given number of spans per thread; spans still open from a previous run will not be recorded
+	static void stop(void); // Stops recording new spans; spans that are still open will not be recorded
+	static void setThreadName(const char* newThreadName); // Sets the name under which the calling thread's spans appear in the trace
+	static size_t write(const char* fileName); // Writes all recorded spans to a trace event file of the given name; returns the number of spans that were dropped because a thread's buffer was full
+	};
+
+#endif
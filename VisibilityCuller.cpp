@@ -0,0 +1,128 @@
+/***********************************************************************
+VisibilityCuller - Class to determine the sets of network nodes and
+links that are visible from a view, and the level of detail at which to
+render visible nodes, using a cluster hierarchy over node positions.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include "VisibilityCuller.h"
+
+#include <Math/Math.h>
+
+/***************************************
+Methods of class VisibilityCuller::View:
+***************************************/
+
+VisibilityCuller::View::View(const double projection[4][4],unsigned int viewportWidth,unsigned int viewportHeight)
+	{
+	/* Extract the frustum's left, right, bottom, top, near, and far planes from the projection matrix: */
+	for(int plane=0;plane<6;++plane)
+		{
+		int row=plane>>1;
+		double sign=(plane&0x1)?-1.0:1.0;
+		for(int i=0;i<4;++i)
+			planes[plane][i]=Scalar(projection[3][i]+sign*projection[row][i]);
+		
+		/* Normalize the plane equation: */
+		Scalar normalLen=Math::sqrt(Math::sqr(planes[plane][0])+Math::sqr(planes[plane][1])+Math::sqr(planes[plane][2]));
+		for(int i=0;i<4;++i)
+			planes[plane][i]/=normalLen;
+		}
+	
+	/* Extract the homogeneous weight row: */
+	for(int i=0;i<4;++i)
+		w[i]=Scalar(projection[3][i]);
+	wScale=Math::sqrt(Math::sqr(w[0])+Math::sqr(w[1])+Math::sqr(w[2]));
+	
+	/* Calculate the scale factor from homogeneous radii to projected radii in pixels along the larger viewport axis: */
+	Scalar xScale=Math::sqrt(Math::sqr(Scalar(projection[0][0]))+Math::sqr(Scalar(projection[0][1]))+Math::sqr(Scalar(projection[0][2])))*Scalar(viewportWidth);
+	Scalar yScale=Math::sqrt(Math::sqr(Scalar(projection[1][0]))+Math::sqr(Scalar(projection[1][1]))+Math::sqr(Scalar(projection[1][2])))*Scalar(viewportHeight);
+	pixelScale=Math::max(xScale,yScale)*Scalar(0.5);
+	}
+
+int VisibilityCuller::View::classifyBox(const Point& min,const Point& max) const
+	{
+	int result=1;
+	for(int plane=0;plane<6;++plane)
+		{
+		/* Find the box vertices farthest inside and farthest outside of the plane: */
+		Scalar inside=planes[plane][3];
+		Scalar outside=planes[plane][3];
+		for(int i=0;i<3;++i)
+			{
+			if(planes[plane][i]>=Scalar(0))
+				{
+				inside+=planes[plane][i]*max[i];
+				outside+=planes[plane][i]*min[i];
+				}
+			else
+				{
+				inside+=planes[plane][i]*min[i];
+				outside+=planes[plane][i]*max[i];
+				}
+			}
+		
+		/* Check the box against the plane: */
+		if(inside<Scalar(0))
+			return -1;
+		if(outside<Scalar(0))
+			result=0;
+		}
+	
+	return result;
+	}
+
+bool VisibilityCuller::View::isSphereVisible(const Point& center,Scalar radius) const
+	{
+	for(int plane=0;plane<6;++plane)
+		if(planes[plane][0]*center[0]+planes[plane][1]*center[1]+planes[plane][2]*center[2]+planes[plane][3]<-radius)
+			return false;
+	
+	return true;
+	}
+
+/*********************************************
+Methods of class VisibilityCuller::VisibleSet:
+*********************************************/
+
+void VisibilityCuller::VisibleSet::clear(void)
+	{
+	nodeLods.clear();
+	sphereNodes.clear();
+	dotNodes.clear();
+	impostors.clear();
+	links.clear();
+	numVisitedClusters=0;
+	}
+
+/*********************************
+Methods of class VisibilityCuller:
+*********************************/
+
+VisibilityCuller::VisibilityCuller(SimulationScheduler* sScheduler)
+	:scheduler(sScheduler),
+	 sphereSize(1.5),impostorSize(1)
+	{
+	}
+
+void VisibilityCuller::setLodSizes(Scalar newSphereSize,Scalar newImpostorSize)
+	{
+	sphereSize=newSphereSize;
+	impostorSize=newImpostorSize;
+	}
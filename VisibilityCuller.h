@@ -0,0 +1,128 @@
+/***********************************************************************
+VisibilityCuller - Class to determine the sets of network nodes and
+links that are visible from a view, and the level of detail at which to
+render visible nodes, using a cluster hierarchy over node positions.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef VISIBILITYCULLER_INCLUDED
+#define VISIBILITYCULLER_INCLUDED
+
+#include <vector>
+#include <Misc/SizedTypes.h>
+
+#include "ParticleTypes.h"
+#include "Network.h"
+
+/* Forward declarations: */
+class SphereBVH;
+class SimulationScheduler;
+
+class VisibilityCuller
+	{
+	/* Embedded classes: */
+	public:
+	enum LevelOfDetail // Enumerated type for the ways in which nodes are rendered
+		{
+		Culled=0, // Node is outside the view frustum
+		Sphere, // Node is rendered as a full sphere
+		Dot, // Node is rendered as a single point
+		Impostor // Node is represented by the impostor of its cluster
+		};
+	
+	class View // Class describing a view frustum and the size of its viewport
+		{
+		/* Elements: */
+		private:
+		Scalar planes[6][4]; // Plane equations of the view frustum's six planes with normalized normal vectors pointing inside
+		Scalar w[4]; // Row of the projection matrix calculating homogeneous weights
+		Scalar wScale; // Length of the homogeneous weight row's vector part
+		Scalar pixelScale; // Factor converting radii divided by homogeneous weights to projected radii in pixels
+		
+		/* Constructors and destructors: */
+		public:
+		View(const double projection[4][4],unsigned int viewportWidth,unsigned int viewportHeight); // Creates a view from a combined modelview and projection matrix in row-major order and the viewport size in pixels
+		
+		/* Methods: */
+		int classifyBox(const Point& min,const Point& max) const; // Returns -1 if the given axis-aligned box is outside the view frustum, 1 if it is completely inside, and 0 if it intersects the frustum's boundary
+		bool isSphereVisible(const Point& center,Scalar radius) const; // Returns true if the given sphere intersects the view frustum
+		Scalar calcWeight(const Point& p) const // Returns the homogeneous weight of the given point, i.e., its distance from the eye along the viewing direction
+			{
+			return w[0]*p[0]+w[1]*p[1]+w[2]*p[2]+w[3];
+			}
+		Scalar calcNearWeight(const Point& center,Scalar radius) const // Returns the smallest homogeneous weight of any point inside the given sphere
+			{
+			return calcWeight(center)-radius*wScale;
+			}
+		Scalar calcProjectedRadius(Scalar radius,Scalar weight) const // Returns the projected radius in pixels of a sphere of the given radius at the given positive homogeneous weight
+			{
+			return radius*pixelScale/weight;
+			}
+		};
+	
+	struct ClusterImpostor // Structure for single spheres representing clusters of nodes that are too small to be rendered individually
+		{
+		/* Elements: */
+		public:
+		Point center; // Center of the impostor sphere
+		Scalar radius; // Radius of the impostor sphere
+		Index representative; // Index of a node in the cluster whose color the impostor assumes
+		Index numNodes; // Number of nodes represented by the impostor
+		};
+	
+	struct VisibleSet // Structure holding the results of a culling pass
+		{
+		/* Elements: */
+		public:
+		std::vector<Misc::UInt8> nodeLods; // Level of detail at which each node is rendered
+		std::vector<Index> sphereNodes; // Indices of nodes rendered as full spheres
+		std::vector<Index> dotNodes; // Indices of nodes rendered as single points
+		std::vector<ClusterImpostor> impostors; // List of impostors for clusters of nodes
+		std::vector<Index> links; // Indices of links that are rendered
+		Index numVisitedClusters; // Number of hierarchy clusters visited during the culling pass
+		
+		/* Methods: */
+		void clear(void); // Clears the visible set while retaining allocated memory
+		};
+	
+	/* Elements: */
+	private:
+	SimulationScheduler* scheduler; // Thread pool to process clusters and links in parallel, or 0 to process them in the calling thread
+	Scalar sphereSize; // Minimum projected node radius in pixels at which nodes are rendered as full spheres
+	Scalar impostorSize; // Maximum projected cluster radius in pixels at which clusters are collapsed into impostors
+	
+	/* Constructors and destructors: */
+	public:
+	VisibilityCuller(SimulationScheduler* sScheduler); // Creates a culler using the given thread pool, or the calling thread if null
+	
+	/* Methods: */
+	Scalar getSphereSize(void) const // Returns the sphere size threshold
+		{
+		return sphereSize;
+		}
+	Scalar getImpostorSize(void) const // Returns the impostor size threshold
+		{
+		return impostorSize;
+		}
+	void setLodSizes(Scalar newSphereSize,Scalar newImpostorSize); // Sets the projected sizes in pixels at which nodes switch from spheres to points, and at which clusters collapse into impostors
+	template <class CenterListParam>
+	void cull(const View& view,const SphereBVH& bvh,const CenterListParam& centers,const std::vector<Scalar>& radii,const Network::LinkList& links,VisibleSet& result) const; // Determines the visible sets of nodes and links of a network with the given node positions, node radii, and links, using the given hierarchy over the nodes; links are rendered if at least one of their nodes is rendered as a sphere or point
+	};
+
+#endif
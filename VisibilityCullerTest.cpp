@@ -0,0 +1,221 @@
+/***********************************************************************
+VisibilityCullerTest - Headless utility to verify and benchmark the
+visibility culling and level of detail selection passes on synthetic
+networks without requiring a graphics card.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <Realtime/Time.h>
+#include <Math/Math.h>
+#include <Math/Constants.h>
+#include <Math/Random.h>
+
+#include "ParticleTypes.h"
+#include "Network.h"
+#include "SphereBVH.h"
+#include "SimulationScheduler.h"
+#include "VisibilityCuller.icpp"
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+void createView(double distance,double fov,double aspect,double projection[4][4]) // Creates a combined modelview and projection matrix looking at the origin from the given distance along the z axis with the given vertical field of view in degrees and the given viewport aspect ratio
+	{
+	/* Create a perspective projection matrix: */
+	double near=distance*0.01;
+	double far=distance*10.0;
+	double f=1.0/Math::tan(Math::rad(fov)*0.5);
+	double p[4][4]={{f/aspect,0.0,0.0,0.0},{0.0,f,0.0,0.0},{0.0,0.0,(far+near)/(near-far),2.0*far*near/(near-far)},{0.0,0.0,-1.0,0.0}};
+	
+	/* Multiply with a translation moving the origin in front of the eye: */
+	for(int i=0;i<4;++i)
+		{
+		for(int j=0;j<3;++j)
+			projection[i][j]=p[i][j];
+		projection[i][3]=p[i][3]-p[i][2]*distance;
+		}
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	Index numNodes=100000;
+	Index numLinks=200000;
+	Scalar domainSize(100);
+	Scalar nodeRadius(0.1);
+	unsigned int numThreads=0;
+	bool serial=false;
+	unsigned int numIterations=20;
+	double distance=150.0;
+	double fov=60.0;
+	unsigned int viewportSize[2]={1920,1080};
+	Scalar sphereSize(1.5);
+	Scalar impostorSize(1);
+	for(int argi=1;argi<argc;++argi)
+		{
+		if(argv[argi][0]=='-')
+			{
+			if(strcasecmp(argv[argi]+1,"nodes")==0&&argi+1<argc)
+				numNodes=Index(atoi(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"links")==0&&argi+1<argc)
+				numLinks=Index(atoi(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"domainSize")==0&&argi+1<argc)
+				domainSize=Scalar(atof(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"nodeRadius")==0&&argi+1<argc)
+				nodeRadius=Scalar(atof(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"threads")==0&&argi+1<argc)
+				numThreads=(unsigned int)(atoi(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"serial")==0)
+				serial=true;
+			else if(strcasecmp(argv[argi]+1,"iterations")==0&&argi+1<argc)
+				numIterations=(unsigned int)(atoi(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"distance")==0&&argi+1<argc)
+				distance=atof(argv[++argi]);
+			else if(strcasecmp(argv[argi]+1,"fov")==0&&argi+1<argc)
+				fov=atof(argv[++argi]);
+			else if(strcasecmp(argv[argi]+1,"viewport")==0&&argi+2<argc)
+				{
+				for(int i=0;i<2;++i)
+					viewportSize[i]=(unsigned int)(atoi(argv[++argi]));
+				}
+			else if(strcasecmp(argv[argi]+1,"lodSizes")==0&&argi+2<argc)
+				{
+				sphereSize=Scalar(atof(argv[++argi]));
+				impostorSize=Scalar(atof(argv[++argi]));
+				}
+			else
+				fprintf(stderr,"VisibilityCullerTest: Ignoring command line option %s\n",argv[argi]);
+			}
+		else
+			fprintf(stderr,"VisibilityCullerTest: Ignoring command line argument %s\n",argv[argi]);
+		}
+	if(numNodes==0||numIterations==0)
+		{
+		fprintf(stderr,"Usage: %s [-nodes <number of nodes>] [-links <number of links>] [-domainSize <size>] [-nodeRadius <radius>] [-threads <number of threads>] [-serial] [-iterations <number of iterations>] [-distance <eye distance>] [-fov <vertical field of view>] [-viewport <width> <height>] [-lodSizes <sphere size> <impostor size>]\n",argv[0]);
+		return 1;
+		}
+	
+	/* Create a synthetic network of randomly placed nodes of random sizes connected by random links: */
+	std::vector<Point> centers;
+	std::vector<Scalar> radii;
+	centers.reserve(numNodes);
+	radii.reserve(numNodes);
+	for(Index i=0;i<numNodes;++i)
+		{
+		Point p;
+		for(int j=0;j<3;++j)
+			p[j]=Math::randUniformCO(-domainSize*Scalar(0.5),domainSize*Scalar(0.5));
+		centers.push_back(p);
+		radii.push_back(nodeRadius*Math::randUniformCO(Scalar(0.5),Scalar(2)));
+		}
+	Network::LinkList links;
+	links.reserve(numLinks);
+	for(Index i=0;i<numLinks;++i)
+		{
+		unsigned int node0=(unsigned int)(Math::randUniformCO(0.0,double(numNodes)));
+		unsigned int node1=(unsigned int)(Math::randUniformCO(0.0,double(numNodes)));
+		links.push_back(Link(0,node0,0,node1,Scalar(1)));
+		}
+	
+	/* Build the cluster hierarchy: */
+	Realtime::TimePointMonotonic timer;
+	SphereBVH bvh;
+	bvh.update(centers,radii,numNodes);
+	double buildTime=double(timer.setAndDiff());
+	bvh.update(centers,radii,numNodes);
+	double refitTime=double(timer.setAndDiff());
+	printf("Hierarchy over %u nodes: built in %.3f ms, refit in %.3f ms, %.1f MB\n",(unsigned int)(numNodes),buildTime*1000.0,refitTime*1000.0,double(bvh.getMemorySize())/(1024.0*1024.0));
+	
+	/* Create the view: */
+	double projection[4][4];
+	createView(distance,fov,double(viewportSize[0])/double(viewportSize[1]),projection);
+	VisibilityCuller::View view(projection,viewportSize[0],viewportSize[1]);
+	
+	/* Create the culler: */
+	SimulationScheduler* scheduler=serial?0:new SimulationScheduler(numThreads);
+	VisibilityCuller culler(scheduler);
+	culler.setLodSizes(sphereSize,impostorSize);
+	
+	/* Run the culling pass repeatedly: */
+	VisibilityCuller::VisibleSet visibleSet;
+	culler.cull(view,bvh,centers,radii,links,visibleSet);
+	timer.set();
+	for(unsigned int iteration=0;iteration<numIterations;++iteration)
+		culler.cull(view,bvh,centers,radii,links,visibleSet);
+	double cullTime=double(timer.setAndDiff())/double(numIterations);
+	
+	/* Run a brute-force pass testing all nodes and links for comparison: */
+	std::vector<Misc::UInt8> visible;
+	visible.reserve(numNodes);
+	Index numVisibleNodes=0;
+	for(Index i=0;i<numNodes;++i)
+		{
+		visible.push_back(view.isSphereVisible(centers[i],radii[i])?1:0);
+		numVisibleNodes+=visible.back();
+		}
+	Index numVisibleLinks=0;
+	for(Network::LinkList::iterator lIt=links.begin();lIt!=links.end();++lIt)
+		if(visible[lIt->getNodeIndex(0)]||visible[lIt->getNodeIndex(1)])
+			++numVisibleLinks;
+	double bruteForceTime=double(timer.setAndDiff());
+	
+	printf("Culling with %u threads: %.3f ms per pass, brute force: %.3f ms\n",scheduler!=0?scheduler->getNumThreads():1U,cullTime*1000.0,bruteForceTime*1000.0);
+	Index numImpostorNodes=0;
+	for(std::vector<VisibilityCuller::ClusterImpostor>::iterator iIt=visibleSet.impostors.begin();iIt!=visibleSet.impostors.end();++iIt)
+		numImpostorNodes+=iIt->numNodes;
+	printf("Visited %u clusters; %u spheres, %u points, %u impostors for %u nodes, %u links\n",(unsigned int)(visibleSet.numVisitedClusters),(unsigned int)(visibleSet.sphereNodes.size()),(unsigned int)(visibleSet.dotNodes.size()),(unsigned int)(visibleSet.impostors.size()),(unsigned int)(numImpostorNodes),(unsigned int)(visibleSet.links.size()));
+	printf("Brute force: %u visible nodes, %u visible links\n",(unsigned int)(numVisibleNodes),(unsigned int)(numVisibleLinks));
+	
+	/* Check that no visible node was culled, and that every individually rendered node is visible: */
+	unsigned int numErrors=0;
+	for(Index i=0;i<numNodes;++i)
+		{
+		Misc::UInt8 lod=visibleSet.nodeLods[i];
+		if(visible[i]&&lod==VisibilityCuller::Culled)
+			++numErrors;
+		if(!visible[i]&&(lod==VisibilityCuller::Sphere||lod==VisibilityCuller::Dot))
+			++numErrors;
+		}
+	if(visibleSet.sphereNodes.size()+visibleSet.dotNodes.size()+numImpostorNodes<numVisibleNodes)
+		++numErrors;
+	
+	/* Without impostors, the culled link set must match the brute-force link set exactly: */
+	if(visibleSet.impostors.empty()&&visibleSet.links.size()!=numVisibleLinks)
+		++numErrors;
+	
+	delete scheduler;
+	
+	if(numErrors!=0)
+		{
+		printf("Culling pass FAILED with %u errors\n",numErrors);
+		return 1;
+		}
+	printf("Culling pass OK\n");
+	return 0;
+	}
@@ -0,0 +1,362 @@
+/***********************************************************************
+VisualNetwork - Class adding the presentation state used by the network
+viewers, i.e., node colors and the list of node property names, to a
+network.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include "VisualNetwork.h"
+
+#include <deque>
+#include <algorithm>
+#include <stdexcept>
+#include <Misc/StringHashFunctions.h>
+#include <Misc/ConvertColorComponent.h>
+#include <Math/Math.h>
+#include <Math/Random.h>
+#include <Math/Interval.h>
+
+#include "JsonEntity.h"
+#include "JsonBoolean.h"
+#include "JsonNumber.h"
+#include "JsonString.h"
+#include "JsonMap.h"
+
+/******************************
+Methods of class VisualNetwork:
+******************************/
+
+void VisualNetwork::finishColorChange(void)
+	{
+	/* Publish a new version of the color array if any colors changed: */
+	if(changingColorsBegin<changingColorsEnd)
+		{
+		changedColorsBegin=changingColorsBegin;
+		changedColorsEnd=changingColorsEnd;
+		++colorVersion;
+		}
+	}
+
+void VisualNetwork::selectionChanged(void)
+	{
+	if(getSelectionSize()!=0)
+		{
+		/* Color nodes by distance to the selection: */
+		mapNodeColorsFromSelectionDistance();
+		}
+	else
+		{
+		/* Color nodes from their color property: */
+		mapNodeColorsFromNode();
+		}
+	}
+
+VisualNetwork::VisualNetwork(IO::File& networkFile)
+	:Network(networkFile),
+	 colorVersion(0),changedColorsBegin(0),changedColorsEnd(0),changingColorsBegin(0),changingColorsEnd(0),
+	 nodeSizeFactorsExponent(0)
+	{
+	/* Initialize the node color mapping: */
+	const NodeList& nodes=getNodes();
+	nodeColors.reserve(nodes.size());
+	for(NodeList::const_iterator nIt=nodes.begin();nIt!=nodes.end();++nIt)
+		nodeColors.push_back(nIt->getColor());
+	
+	/* Calculate the logarithms of all node sizes once, and initialize the node size factors for an exponent of zero: */
+	logNodeSizes.reserve(nodes.size());
+	for(NodeList::const_iterator nIt=nodes.begin();nIt!=nodes.end();++nIt)
+		logNodeSizes.push_back(Math::log(nIt->getSize()));
+	nodeSizeFactors.resize(nodes.size(),Scalar(1));
+	
+	/* Collect the names of all properties appearing in the network's nodes: */
+	{
+	Misc::HashTable<std::string,void> nodePropertyNameMap(17);
+	for(JsonList::List::iterator nIt=jsonNodes->getList().begin();nIt!=jsonNodes->getList().end();++nIt)
+		{
+		/* Iterate through the node's properties: */
+		const JsonMap::Map& nodeProperties=JsonMapPointer(*nIt)->getMap();
+		for(JsonMap::Map::ConstIterator npIt=nodeProperties.begin();!npIt.isFinished();++npIt)
+			{
+			/* Collect the property's name: */
+			nodePropertyNameMap.setEntry(Misc::HashTable<std::string,void>::Entry(npIt->getSource()));
+			}
+		}
+	
+	/* Put the collected property names into a list: */
+	nodePropertyNames.reserve(nodePropertyNameMap.getNumEntries());
+	for(Misc::HashTable<std::string,void>::Iterator npnIt=nodePropertyNameMap.begin();!npnIt.isFinished();++npnIt)
+		nodePropertyNames.push_back(npnIt->getSource());
+	}
+	
+	/* Sort the list of node property names: */
+	std::sort(nodePropertyNames.begin(),nodePropertyNames.end());
+	
+	/* Create a color map for node distances: */
+	static const GLColorMap::Color sdColors[6]=
+		{
+		GLColorMap::Color(1.0f,0.0f,0.0f),
+		GLColorMap::Color(1.0f,1.0f,0.0f),
+		GLColorMap::Color(0.0f,1.0f,0.0f),
+		GLColorMap::Color(0.0f,1.0f,1.0f),
+		GLColorMap::Color(0.0f,0.0f,1.0f),
+		GLColorMap::Color(1.0f,0.0f,1.0f)
+		};
+	GLdouble sdKeys[6];
+	for(int i=0;i<6;++i)
+		sdKeys[i]=double(i);
+	selectionDistanceMap.setColors(6,sdColors,sdKeys);
+	}
+
+VisualNetwork::~VisualNetwork(void)
+	{
+	}
+
+void VisualNetwork::mapNodeColorsFromNode(void)
+	{
+	/* Set all nodes' colors to their color properties' values: */
+	startColorChange();
+	Index nodeIndex=0;
+	for(NodeList::const_iterator nIt=getNodes().begin();nIt!=getNodes().end();++nIt,++nodeIndex)
+		changeNodeColor(nodeIndex,nIt->getColor());
+	finishColorChange();
+	}
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+Node::Color randomColor(void)
+	{
+	typedef Misc::ColorComponentTraits<Node::Color::Scalar> NodeColorTraits;
+	Node::Color result;
+	for(int i=0;i<3;++i)
+		result[i]=Node::Color::Scalar(Math::randUniformCC(NodeColorTraits::zero,NodeColorTraits::one));
+	result[3]=NodeColorTraits::one;
+	return result;
+	}
+
+Node::Color convertColor(const GLColorMap::Color& glColor)
+	{
+	Node::Color result;
+	for(int i=0;i<4;++i)
+		result[i]=Misc::convertColorComponent<Node::Color::Scalar,GLColorMap::Color::Scalar>(glColor[i]);
+	return result;
+	}
+
+}
+
+void VisualNetwork::mapNodeColorsFromNodeProperty(const std::string& propertyName,GLColorMap& numericalPropertyValueMap)
+	{
+	/* Collect the set of values of the given property from all nodes: */
+	Misc::HashTable<bool,Node::Color> booleanValueColors(17);
+	Misc::HashTable<std::string,Node::Color> stringValueColors(17);
+	Math::Interval<double> numberValueRange=Math::Interval<double>::empty;
+	for(JsonList::List::iterator nIt=jsonNodes->getList().begin();nIt!=jsonNodes->getList().end();++nIt)
+		{
+		/* Get the map of node properties and check if the node has the requested property: */
+		JsonMapPointer nodeMap(*nIt);
+		if(nodeMap->hasProperty(propertyName))
+			{
+			/* Get the property's value and handle it based on its type: */
+			JsonPointer value=nodeMap->getProperty(propertyName);
+			switch(value->getType())
+				{
+				case JsonEntity::BOOLEAN:
+					{
+					bool bValue=getBoolean(value);
+					if(!booleanValueColors.isEntry(bValue))
+						booleanValueColors[bValue]=randomColor();
+					break;
+					}
+				
+				case JsonEntity::NUMBER:
+					numberValueRange.addValue(getNumber(value));
+					break;
+				
+				case JsonEntity::STRING:
+					{
+					const std::string& sValue=getString(value);
+					if(!stringValueColors.isEntry(sValue))
+						stringValueColors[sValue]=randomColor();
+					break;
+					}
+				
+				default:
+					;
+				}
+			}
+		}
+	
+	/* Assign colors to all nodes: */
+	numericalPropertyValueMap.setScalarRange(numberValueRange.getMin(),numberValueRange.getMax());
+	startColorChange();
+	Index nodeIndex=0;
+	for(JsonList::List::iterator nIt=jsonNodes->getList().begin();nIt!=jsonNodes->getList().end();++nIt,++nodeIndex)
+		{
+		/* Get the map of node properties and check if the node has the requested property: */
+		JsonMapPointer nodeMap(*nIt);
+		if(nodeMap->hasProperty(propertyName))
+			{
+			/* Get the property's value and handle it based on its type: */
+			JsonPointer value=nodeMap->getProperty(propertyName);
+			switch(value->getType())
+				{
+				case JsonEntity::BOOLEAN:
+					changeNodeColor(nodeIndex,booleanValueColors[getBoolean(value)].getDest());
+					break;
+				
+				case JsonEntity::NUMBER:
+					changeNodeColor(nodeIndex,convertColor(numericalPropertyValueMap(getNumber(value))));
+					break;
+				
+				case JsonEntity::STRING:
+					changeNodeColor(nodeIndex,stringValueColors[getString(value)].getDest());
+					break;
+				
+				default:
+					/* Color nodes with unsupported property types grey: */
+					changeNodeColor(nodeIndex,Node::Color(128U,128U,128U));
+				}
+			}
+		else
+			{
+			/* Color nodes without the requested property grey: */
+			changeNodeColor(nodeIndex,Node::Color(128U,128U,128U));
+			}
+		}
+	finishColorChange();
+	}
+
+void VisualNetwork::mapNodeColorsFromSelectionDistance(void)
+	{
+	/* Calculate the distance of all nodes from the current selection: */
+	const NodeList& nodes=getNodes();
+	unsigned int numNodes=(unsigned int)(nodes.size());
+	std::vector<unsigned int> nodeDistances;
+	nodeDistances.reserve(numNodes);
+	for(NodeList::const_iterator nIt=nodes.begin();nIt!=nodes.end();++nIt)
+		nodeDistances.push_back(numNodes);
+	
+	/* Initialize the distance of all selected nodes to zero and add them into the breadth-first queue: */
+	std::deque<unsigned int> queue;
+	for(Selection::ConstIterator sIt=getSelection().begin();!sIt.isFinished();++sIt)
+		{
+		nodeDistances[sIt->getSource()]=0;
+		queue.push_back(sIt->getSource());
+		}
+	
+	/* Traverse connected nodes in breadth-first order: */
+	unsigned int maxNodeDistance=0;
+	while(!queue.empty())
+		{
+		/* Grab the next node in the breadth-first queue: */
+		unsigned int nodeIndex=queue.front();
+		queue.pop_front();
+		const Node& node=nodes[nodeIndex];
+		
+		/* Assign distances to all nodes connected to the next node in the queue: */
+		unsigned int nodeDistance=nodeDistances[nodeIndex];
+		for(std::vector<Node*>::const_iterator lnIt=node.getLinkedNodes().begin();lnIt!=node.getLinkedNodes().end();++lnIt)
+			{
+			/* Get the linked node's index: */
+			unsigned int linkedNodeIndex=*lnIt-&nodes.front();
+			
+			/* Check if the linked node has not yet been visited: */
+			if(nodeDistances[linkedNodeIndex]==numNodes)
+				{
+				/* Assign a distance to the linked node and add it into the breadth-first queue: */
+				nodeDistances[linkedNodeIndex]=nodeDistance+1;
+				if(maxNodeDistance<nodeDistance+1)
+					maxNodeDistance=nodeDistance+1;
+				queue.push_back(linkedNodeIndex);
+				}
+			else
+				{
+				/* Check that the linked node does not have a larger distance than as a neighbor of the next node: */
+				if(nodeDistances[linkedNodeIndex]>nodeDistance+1)
+					throw std::runtime_error("VisualNetwork::mapNodeColorsFromSelectionDistance: Took the long way around in network traversal");
+				}
+			}
+		}
+	
+	/* Assign colors to nodes based on their computed distances: */
+	selectionDistanceMap.setScalarRange(0.0,double(maxNodeDistance));
+	startColorChange();
+	for(unsigned int nodeIndex=0;nodeIndex<numNodes;++nodeIndex)
+		{
+		if(nodeDistances[nodeIndex]<numNodes)
+			{
+			/* Assign a color based on the distance color map: */
+			changeNodeColor(nodeIndex,convertColor(selectionDistanceMap(double(nodeDistances[nodeIndex]))));
+			}
+		else
+			{
+			/* Color unconnected nodes grey: */
+			changeNodeColor(nodeIndex,Node::Color(128U,128U,128U));
+			}
+		}
+	finishColorChange();
+	}
+
+void VisualNetwork::calcNodeRadii(Scalar nodeRadius,bool useNodeSize,Scalar nodeSizeExponent,std::vector<Scalar>& nodeRadii)
+	{
+	size_t numNodes=nodeSizeFactors.size();
+	nodeRadii.resize(numNodes);
+	if(useNodeSize)
+		{
+		/* Raise all node sizes to the new exponent if it changed: */
+		if(nodeSizeFactorsExponent!=nodeSizeExponent)
+			{
+			if(nodeSizeExponent==Scalar(0))
+				{
+				/* Node sizes raised to zero are all one: */
+				for(size_t i=0;i<numNodes;++i)
+					nodeSizeFactors[i]=Scalar(1);
+				}
+			else if(nodeSizeExponent==Scalar(1))
+				{
+				/* Node sizes raised to one are the node sizes themselves: */
+				const NodeList& nodes=getNodes();
+				for(size_t i=0;i<numNodes;++i)
+					nodeSizeFactors[i]=nodes[i].getSize();
+				}
+			else
+				{
+				/* Calculate s^e as exp(e*log(s)) in a branch-free loop over contiguous arrays that the compiler can vectorize: */
+				const Scalar* lsPtr=logNodeSizes.empty()?0:&logNodeSizes.front();
+				Scalar* nsfPtr=nodeSizeFactors.empty()?0:&nodeSizeFactors.front();
+				for(size_t i=0;i<numNodes;++i)
+					nsfPtr[i]=Math::exp(nodeSizeExponent*lsPtr[i]);
+				}
+			nodeSizeFactorsExponent=nodeSizeExponent;
+			}
+		
+		/* Scale the node size factors by the node radius: */
+		for(size_t i=0;i<numNodes;++i)
+			nodeRadii[i]=nodeRadius*nodeSizeFactors[i];
+		}
+	else
+		{
+		/* Assign the same radius to all nodes: */
+		for(size_t i=0;i<numNodes;++i)
+			nodeRadii[i]=nodeRadius;
+		}
+	}
@@ -0,0 +1,110 @@
+/***********************************************************************
+VisualNetwork - Class adding the presentation state used by the network
+viewers, i.e., node colors and the list of node property names, to a
+network.
+Copyright (c) 2025 Oliver Kreylos
+
+This file is part of the Network Viewer.
+
+The Network Viewer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Network Viewer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Network Viewer; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef VISUALNETWORK_INCLUDED
+#define VISUALNETWORK_INCLUDED
+
+#include <string>
+#include <vector>
+#include <GL/gl.h>
+#include <GL/GLColorMap.h>
+
+#include "ParticleTypes.h"
+#include "Node.h"
+#include "Network.h"
+
+class VisualNetwork:public Network
+	{
+	/* Embedded classes: */
+	public:
+	typedef std::vector<Node::Color> ColorList;
+	typedef std::vector<std::string> StringList;
+	
+	/* Elements: */
+	private:
+	ColorList nodeColors; // Current color values assigned to each node
+	unsigned int colorVersion; // Version number of the node color array, incremented on every change
+	Index changedColorsBegin,changedColorsEnd; // Half-open range of nodes whose colors were changed by the most recent change
+	Index changingColorsBegin,changingColorsEnd; // Half-open range of nodes whose colors were changed so far by a change in progress
+	std::vector<Scalar> logNodeSizes; // Natural logarithms of all nodes' sizes, to raise node sizes to arbitrary exponents with a single exponential
+	std::vector<Scalar> nodeSizeFactors; // Node sizes raised to the node size exponent reflected in the array
+	Scalar nodeSizeFactorsExponent; // Node size exponent reflected in the node size factor array
+	StringList nodePropertyNames; // List of names of all node properties defined in the network json file
+	GLColorMap selectionDistanceMap; // Color map mapping node distances from the selection to colors
+	
+	/* Private methods: */
+	void startColorChange(void) // Prepares to track the range of nodes whose colors change
+		{
+		changingColorsBegin=Index(nodeColors.size());
+		changingColorsEnd=0;
+		}
+	void changeNodeColor(Index nodeIndex,const Node::Color& newColor) // Sets the color of the given node and extends the range of changed colors if the color differs from the node's current color
+		{
+		Node::Color& nc=nodeColors[nodeIndex];
+		if(nc[0]!=newColor[0]||nc[1]!=newColor[1]||nc[2]!=newColor[2]||nc[3]!=newColor[3])
+			{
+			nc=newColor;
+			if(changingColorsBegin>nodeIndex)
+				changingColorsBegin=nodeIndex;
+			changingColorsEnd=nodeIndex+1;
+			}
+		}
+	void finishColorChange(void); // Publishes a new version of the node color array if any colors changed
+	
+	/* Protected methods from class Network: */
+	protected:
+	virtual void selectionChanged(void);
+	
+	/* Constructors and destructors: */
+	public:
+	VisualNetwork(IO::File& networkFile); // Parses a network from a json file
+	virtual ~VisualNetwork(void);
+	
+	/* Methods: */
+	void mapNodeColorsFromNode(void); // Retrieves node colors from the nodes' color properties
+	void mapNodeColorsFromNodeProperty(const std::string& propertyName,GLColorMap& numericalPropertyValueMap); // Colors nodes by their values of the given property
+	void mapNodeColorsFromSelectionDistance(void); // Colors nodes by their distance from the current selection
+	const ColorList& getNodeColors(void) const // Returns the array of node colors
+		{
+		return nodeColors;
+		}
+	unsigned int getColorVersion(void) const // Returns the version number of the node color array
+		{
+		return colorVersion;
+		}
+	Index getChangedColorsBegin(void) const // Returns the index of the first node whose color was changed by the most recent change
+		{
+		return changedColorsBegin;
+		}
+	Index getChangedColorsEnd(void) const // Returns one past the index of the last node whose color was changed by the most recent change
+		{
+		return changedColorsEnd;
+		}
+	void calcNodeRadii(Scalar nodeRadius,bool useNodeSize,Scalar nodeSizeExponent,std::vector<Scalar>& nodeRadii); // Replaces the given array with the radii of all nodes for the given rendering settings
+	const StringList& getNodePropertyNames(void) const // Returns the list of all node property names found in the network json file
+		{
+		return nodePropertyNames;
+		}
+	};
+
+#endif
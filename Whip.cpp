@@ -218,10 +218,10 @@ void Whip::glRenderAction(GLContextData& contextData) const
 	
 	/* Calculate the total length of the whip and compare it to the ideal length: */
 	Scalar whipLength(0);
-	const Point* p0=&particles.getParticlePosition(particleIndices[0]);
+	const Point* p0=&particles.getRenderPosition(particleIndices[0]);
 	for(unsigned int i=1;i<numParticles;++i)
 		{
-		const Point* p1=&particles.getParticlePosition(particleIndices[i]);
+		const Point* p1=&particles.getRenderPosition(particleIndices[i]);
 		whipLength+=Geometry::dist(*p0,*p1);
 		
 		/* Go to the next segment: */
@@ -233,8 +233,8 @@ void Whip::glRenderAction(GLContextData& contextData) const
 	/* Render the whip's handle: */
 	glBegin(GL_LINES);
 	glColor3f(1.0f,0.0f,0.0f);
-	glVertex(particles.getParticlePosition(particleIndices[0]));
-	glVertex(particles.getParticlePosition(particleIndices[1]));
+	glVertex(particles.getRenderPosition(particleIndices[0]));
+	glVertex(particles.getRenderPosition(particleIndices[1]));
 	glEnd();
 	
 	/* Render the whip: */
@@ -244,7 +244,7 @@ void Whip::glRenderAction(GLContextData& contextData) const
 	glColor3f(ratio,1.0f,-ratio);
 	
 	for(unsigned int i=1;i<numParticles;++i)
-		glVertex(particles.getParticlePosition(particleIndices[i]));
+		glVertex(particles.getRenderPosition(particleIndices[i]));
 	glEnd();
 	
 	/* Reset OpenGL state: */